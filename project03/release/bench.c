@@ -0,0 +1,224 @@
+/*bench.c*/
+
+//
+// Benchmark driver: times the execution of nuPython programs in
+// the interpreter alone (-nojit) and with the JIT, before and after
+// the program graph is optimized (see optimize.h), and checks that
+// all of them end with the same memory. Program output goes to stdout as
+// usual, timings go to stderr, so run with stdout redirected:
+//
+//   ./bench.out bench01.py > /dev/null
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>   // strcmp
+#include <time.h>     // clock_gettime
+
+#include "parser.h"
+#include "programgraph.h"
+#include "ram.h"
+#include "execute.h"
+#include "output.h"
+#include "infer.h"
+#include "optimize.h"
+
+
+//
+// Private functions:
+//
+
+//
+// now
+//
+// Returns the current time in seconds, from a monotonic clock.
+//
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//
+// same_value
+//
+// Returns true if the two values are the same, comparing strings,
+// lists and dicts by their contents, false if not.
+//
+static bool same_value(struct RAM_VALUE* v1, struct RAM_VALUE* v2)
+{
+  if (v1->value_type != v2->value_type)
+    return false;
+
+  if (v1->value_type == RAM_TYPE_STR)
+    return strcmp(v1->types.s, v2->types.s) == 0;
+
+  if (v1->value_type == RAM_TYPE_REAL)
+    return v1->types.d == v2->types.d;
+
+  if (v1->value_type == RAM_TYPE_LIST) {
+    struct RAM_LIST* l1 = v1->types.l;
+    struct RAM_LIST* l2 = v2->types.l;
+
+    if (l1->length != l2->length)
+      return false;
+
+    for (int i = 0; i < l1->length; i++) {
+      if (!same_value(&l1->items[i], &l2->items[i]))
+        return false;
+    }
+
+    return true;
+  }
+
+  if (v1->value_type == RAM_TYPE_DICT) {
+    struct RAM_DICT* d1 = v1->types.m;
+    struct RAM_DICT* d2 = v2->types.m;
+
+    if (d1->length != d2->length)
+      return false;
+
+    for (int i = 0; i < d1->length; i++) {
+      if (!same_value(&d1->entries[i].key, &d2->entries[i].key) ||
+          !same_value(&d1->entries[i].value, &d2->entries[i].value))
+        return false;
+    }
+
+    return true;
+  }
+
+  if (v1->value_type != RAM_TYPE_NONE)
+    return v1->types.i == v2->types.i;
+
+  return true;
+}
+
+//
+// same_memory
+//
+// Returns true if the two memories hold the same variables with
+// the same values, false if not.
+//
+static bool same_memory(struct RAM* m1, struct RAM* m2)
+{
+  if (m1->num_values != m2->num_values)
+    return false;
+
+  for (int i = 0; i < m1->num_values; i++) {
+    if (!same_value(&m1->values[i], &m2->values[i]))
+      return false;
+  }
+
+  return true;
+}
+
+//
+// run
+//
+// Executes the program against a new memory, with or without
+// the JIT, returning the memory and the time taken in seconds
+// via seconds.
+//
+static struct RAM* run(struct STMT* program, bool jit, double* seconds)
+{
+  struct RAM* memory = ram_init();
+
+  execute_set_jit(jit);
+
+  double start = now();
+  execute(program, memory, NULL);
+  *seconds = now() - start;
+
+  return memory;
+}
+
+
+//
+// main
+//
+// usage: bench.out filename.py ...
+//
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s filename.py ...\n", argv[0]);
+    return 0;
+  }
+
+  output_init(OUTPUT_FLUSH_AT_EXIT, 0);
+  parser_init();
+
+  for (int arg = 1; arg < argc; arg++) {
+    char* filename = argv[arg];
+    FILE* input = fopen(filename, "r");
+
+    if (input == NULL) {
+      fprintf(stderr, "**ERROR: unable to open input file '%s' for input.\n", filename);
+      continue;
+    }
+
+    struct TokenQueue* tokens = parser_parse(input);
+    fclose(input);
+
+    if (tokens == NULL) {
+      fprintf(stderr, "%s: syntax error\n", filename);
+      continue;
+    }
+
+    struct STMT* program = programgraph_build(tokens);
+
+    if (program == NULL) {
+      fprintf(stderr, "%s: semantic errors\n", filename);
+      continue;
+    }
+
+    if (infer_types(program) > 0) {
+      fprintf(stderr, "%s: type errors\n", filename);
+      programgraph_destroy(program);
+      continue;
+    }
+
+    execute_prepare(program);
+
+    double interpreted, compiled;
+    struct RAM* m1 = run(program, false, &interpreted);
+    struct RAM* m2 = run(program, true, &compiled);
+
+    fprintf(stderr, "%s: interpreter %.3f s, jit %.3f s, speedup %.2fx%s\n",
+      filename, interpreted, compiled, interpreted / compiled,
+      same_memory(m1, m2) ? "" : " (**MEMORY DIFFERS**)");
+
+    //
+    // and again, optimized:
+    //
+    struct OPTIMIZE_STATS stats;
+    program = optimize(program, &stats);
+    execute_prepare(program);
+
+    double optimized, optimized_compiled;
+    struct RAM* m3 = run(program, false, &optimized);
+    struct RAM* m4 = run(program, true, &optimized_compiled);
+
+    fprintf(stderr, "%s: optimized (%d removed, %d moved): interpreter %.3f s, jit %.3f s, speedup %.2fx / %.2fx%s\n",
+      filename, stats.passes + stats.unreachable + stats.dead_stores, stats.hoisted,
+      optimized, optimized_compiled, interpreted / optimized, compiled / optimized_compiled,
+      same_memory(m1, m3) && same_memory(m1, m4) ? "" : " (**MEMORY DIFFERS**)");
+
+    ram_destroy(m1);
+    ram_destroy(m2);
+    ram_destroy(m3);
+    ram_destroy(m4);
+    programgraph_destroy(program);
+  }
+
+  return 0;
+}
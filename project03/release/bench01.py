@@ -0,0 +1,55 @@
+n = 100000
+nodes = alloc(200000)
+end = alloc(2)
+k = 0
+prev = nodes
+last = n - 1
+while k < last:
+{
+  k = k + 1
+  idx = k * 7919
+  idx = idx % n
+  off = idx * 2
+  node = nodes + off
+  link = prev + 1
+  pass
+  *prev = 1
+  pass
+  *link = node
+  prev = node
+}
+link = prev + 1
+pass
+*prev = 1
+pass
+*link = end
+print("list built")
+rounds = 0
+total = 0
+while rounds < 20:
+{
+  node = nodes
+  while node != end:
+  {
+    v = *node
+    total = total + v
+    link = node + 1
+    node = *link
+  }
+  rounds = rounds + 1
+}
+print(total)
+acc = alloc(1)
+pass
+*acc = 0.0
+i = 0
+while i < 2000000:
+{
+  sum = *acc
+  sum = sum + i
+  pass
+  *acc = sum
+  i = i + 1
+}
+result = *acc
+print(result)
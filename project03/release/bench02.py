@@ -0,0 +1,28 @@
+rows = 300
+cols = 2000
+rate = 1.0001
+base = 3
+total = 0.0
+checks = 0
+i = 0
+while i < rows:
+{
+  offset = base * rows
+  step = rate * 2.0
+  j = 0
+  while j < cols:
+  {
+    limit = cols - 1
+    weight = step * rate
+    bias = offset + 7
+    x = j * weight
+    x = x + bias
+    total = total + x
+    inside = j < limit
+    j = j + 1
+  }
+  checks = checks + 1
+  i = i + 1
+}
+print(total)
+print(checks)
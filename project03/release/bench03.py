@@ -0,0 +1,29 @@
+ints = ['0', '7', '-42', '12345', '2147483647', '-2147483648']
+reals = ['0.5', '3.14159', '-2.75', '1e-3', '6.02214076e23', '0.1']
+total = 0
+acc = 0.0
+i = 0
+while i < 200000:
+{
+  for s in ints:
+  {
+    n = int(s)
+    total = total + n
+  }
+  for r in reals:
+  {
+    x = float(r)
+    acc = acc + x
+  }
+  i = i + 1
+}
+print(total)
+print(acc)
+k = 0
+x = 0.0
+while k < 300000:
+{
+  print(x, k)
+  x = x + 0.125
+  k = k + 1
+}
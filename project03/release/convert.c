@@ -0,0 +1,256 @@
+/*convert.c*/
+
+//
+// Conversion of strings to numbers: strict, exact and
+// allocation-free (see convert.h).
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>   // strtod
+#include <stdbool.h>  // true, false
+#include <stdint.h>   // uint64_t
+#include <limits.h>   // INT_MAX
+#include <math.h>     // INFINITY, NAN
+
+#include "convert.h"
+
+
+//
+// powers of ten that are exact as doubles:
+//
+static const double powers_of_ten[] =
+{
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define MAX_EXACT_POWER 22
+#define MAX_EXACT_INT   (1ULL << 53)  // every integer up to here is a double
+#define MAX_DIGITS      19            // any 19 digits fit in a uint64_t
+
+
+//
+// Private functions:
+//
+
+static bool is_space(char c)
+{
+  return c == ' ' || c == '\t';
+}
+
+static bool is_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+//
+// lower
+//
+// Returns the given letter in lowercase.
+//
+static char lower(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+//
+// match_word
+//
+// If the string starts with the given lowercase word, in any case,
+// returns a pointer to the char after it, otherwise NULL.
+//
+static const char* match_word(const char* s, const char* word)
+{
+  while (*word != '\0') {
+    if (lower(*s) != *word)
+      return NULL;
+    s++;
+    word++;
+  }
+
+  return s;
+}
+
+//
+// at_end
+//
+// Returns true if nothing but spaces is left in the string.
+//
+static bool at_end(const char* s)
+{
+  while (is_space(*s))
+    s++;
+
+  return *s == '\0';
+}
+
+
+//
+// Public functions:
+//
+
+//
+// convert_int
+//
+// Converts the given string to an int; see convert.h.
+//
+bool convert_int(const char* s, int* result)
+{
+  while (is_space(*s))
+    s++;
+
+  bool negative = (*s == '-');
+  if (*s == '-' || *s == '+')
+    s++;
+
+  if (!is_digit(*s))
+    return false;
+
+  //
+  // the magnitude may be one more than INT_MAX, for INT_MIN:
+  //
+  long long limit = (long long)INT_MAX + (negative ? 1 : 0);
+  long long value = 0;
+
+  while (is_digit(*s)) {
+    value = value * 10 + (*s - '0');
+    if (value > limit)
+      return false;
+    s++;
+  }
+
+  if (!at_end(s))
+    return false;
+
+  *result = (int)(negative ? -value : value);
+  return true;
+}
+
+//
+// convert_real
+//
+// Converts the given string to a real; see convert.h.
+//
+bool convert_real(const char* s, double* result)
+{
+  while (is_space(*s))
+    s++;
+
+  const char* start = s;  // for strtod
+
+  bool negative = (*s == '-');
+  if (*s == '-' || *s == '+')
+    s++;
+
+  if (!is_digit(*s) && *s != '.') {
+    const char* rest;
+    double special;
+
+    if ((rest = match_word(s, "infinity")) != NULL || (rest = match_word(s, "inf")) != NULL)
+      special = INFINITY;
+    else if ((rest = match_word(s, "nan")) != NULL)
+      special = NAN;
+    else
+      return false;
+
+    if (!at_end(rest))
+      return false;
+
+    *result = negative ? -special : special;
+    return true;
+  }
+
+  //
+  // the significant digits, as an integer, and the power of ten
+  // to scale it by; leading zeros don't count, and digits past the
+  // first 19 only shift the exponent (and send us to strtod):
+  //
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any_digits = false;
+  bool truncated = false;
+
+  for (; is_digit(*s); s++) {
+    any_digits = true;
+    if (digits < MAX_DIGITS) {
+      mantissa = mantissa * 10 + (uint64_t)(*s - '0');
+      if (mantissa != 0)
+        digits++;
+    }
+    else {
+      exponent++;
+      truncated = truncated || (*s != '0');
+    }
+  }
+
+  if (*s == '.') {
+    s++;
+
+    for (; is_digit(*s); s++) {
+      any_digits = true;
+      if (digits < MAX_DIGITS) {
+        mantissa = mantissa * 10 + (uint64_t)(*s - '0');
+        if (mantissa != 0)
+          digits++;
+        exponent--;
+      }
+      else
+        truncated = truncated || (*s != '0');
+    }
+  }
+
+  if (!any_digits)
+    return false;
+
+  if (*s == 'e' || *s == 'E') {
+    s++;
+
+    bool negative_exponent = (*s == '-');
+    if (*s == '-' || *s == '+')
+      s++;
+
+    if (!is_digit(*s))
+      return false;
+
+    int e = 0;
+
+    for (; is_digit(*s); s++) {
+      if (e < 100000)  // way past inf or 0 already
+        e = e * 10 + (*s - '0');
+    }
+
+    exponent += negative_exponent ? -e : e;
+  }
+
+  if (!at_end(s))
+    return false;
+
+  //
+  // with an exact mantissa and an exact power of ten, one multiply
+  // or divide gives the correctly rounded result:
+  //
+  if (!truncated && mantissa <= MAX_EXACT_INT &&
+      exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+    double d = (double)mantissa;
+
+    if (exponent < 0)
+      d /= powers_of_ten[-exponent];
+    else
+      d *= powers_of_ten[exponent];
+
+    *result = negative ? -d : d;
+    return true;
+  }
+
+  //
+  // otherwise the string is a valid number that strtod reads the
+  // same way, up to the trailing spaces:
+  //
+  *result = strtod(start, NULL);
+  return true;
+}
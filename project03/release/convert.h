@@ -0,0 +1,53 @@
+/*convert.h*/
+
+//
+// Conversion of strings to numbers, for int() and float() and
+// for the int and real literals in a program. Unlike atoi and
+// atof, the whole string must be a number, so int('12abc') and
+// float('') are errors rather than 12 and 0.0; an int must also
+// fit in 32 bits.
+//
+// What's accepted is what Python accepts (without underscores):
+// surrounding spaces and tabs, an optional sign, and then
+//
+//   int:   digits
+//   float: digits, with an optional . and fraction, and an
+//          optional exponent (e.g. 1.5, .5, 5., 1e-3), or inf,
+//          infinity or nan, in any case
+//
+// Nothing is allocated, and the result doesn't depend on the C
+// locale. A real with at most 19 significant digits and a small
+// exponent (the common case) is computed with one exact multiply
+// or divide, which is correctly rounded; any other real is handed
+// to strtod, which is exact too, once the string has been checked.
+// nuPython never changes the locale, so strtod reads '.' as the
+// decimal point.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include <stdbool.h>  // true, false
+
+
+//
+// convert_int
+//
+// Converts the given string to an int, returned via result.
+// Returns true if successful, false if the string is not an
+// int or the int doesn't fit in 32 bits.
+//
+bool convert_int(const char* s, int* result);
+
+//
+// convert_real
+//
+// Converts the given string to a real, returned via result.
+// Returns true if successful, false if the string is not a
+// real. A real too big for a double converts to inf, as it does
+// in Python.
+//
+bool convert_real(const char* s, double* result);
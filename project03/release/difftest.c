@@ -0,0 +1,829 @@
+/*difftest.c*/
+
+//
+// Differential tester: generates random, well-typed nuPython
+// programs and runs each one through the reference interpreter
+// and through every optimized execution mode (see modes[] below),
+// checking that all of them print the same output and end with
+// the same memory, as shown by ram_print. A mismatch prints the
+// program and the first line that differs, and the tester exits
+// with status 1. The time each mode spends executing programs is
+// totalled and reported as a speedup over the interpreter:
+//
+//   ./difftest.out [# of programs] [seed]
+//
+// Each run happens in a child process with stdout redirected to
+// a temporary file, so a mode that crashes or panics shows up as
+// a difference instead of taking the tester down with it.
+//
+// The programs stick to what every mode must agree on: int, real,
+// string and boolean variables, arithmetic and relational
+// expressions (the relational results are booleans, a quirk of
+// execute_binary_expr worth checking), print(), pass, nested while
+// loops (now and then one that never runs, or a store that is
+// overwritten right away, for the optimizer), and lists of ints
+// with append(), len(), for loops and the vectorized builtins.
+// Numbers are kept small by taking results % 1000, and strings
+// grow by at most a literal per statement, so no program
+// overflows or runs away.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, fork, fileno
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>   // strcmp, strchr
+#include <stdarg.h>   // va_list
+#include <time.h>     // clock_gettime
+#include <unistd.h>   // fork, pipe, dup2
+#include <sys/wait.h> // waitpid
+
+#include "parser.h"
+#include "programgraph.h"
+#include "ram.h"
+#include "execute.h"
+#include "output.h"
+#include "infer.h"
+#include "optimize.h"
+
+
+//
+// An execution mode: a name for the report, and a function that
+// sets up execution in the child process before the program runs.
+// It may also rewrite the program graph, or replace it, since the
+// child has its own copy. The first mode is the reference the others are
+// checked against.
+//
+struct MODE
+{
+  char* name;
+  void (*prepare)(struct STMT** program);
+};
+
+static void prepare_interpreter(struct STMT** program)
+{
+  execute_set_jit(false);
+}
+
+static void prepare_jit(struct STMT** program)
+{
+  execute_set_jit(true);
+}
+
+static void prepare_typed(struct STMT** program)
+{
+  execute_set_jit(false);
+  infer_types(*program);
+}
+
+static void prepare_optimized(struct STMT** program)
+{
+  execute_set_jit(true);
+  infer_types(*program);
+  *program = optimize(*program, NULL);
+}
+
+static struct MODE modes[] =
+{
+  { "interpreter", prepare_interpreter },
+  { "jit",         prepare_jit },
+  { "typed",       prepare_typed },
+  { "optimized",   prepare_optimized }
+};
+
+#define NUM_MODES ((int)(sizeof(modes) / sizeof(modes[0])))
+
+
+//
+// Program generation:
+//
+#define MAX_VARS   10  // variables are named v0, v1, ...
+#define MAX_DEPTH  2   // loops nest at most this deep
+#define MAX_OUTER  300 // most iterations of a top-level while loop
+#define MAX_INNER  10  // most iterations of a nested while loop
+
+enum GEN_TYPES
+{
+  GEN_NONE = 0,  // not assigned yet
+  GEN_INT,
+  GEN_REAL,
+  GEN_STR,
+  GEN_BOOL,
+  GEN_LIST       // list of ints
+};
+
+struct GENERATOR
+{
+  char*  text;      // the program so far
+  size_t length;
+  size_t capacity;
+
+  int  types[MAX_VARS];     // type of variable vN
+  bool nonempty[MAX_VARS];  // lists: known to hold at least one item?
+  int  num_counters;        // loop counters c0, c1, ... used so far
+  int  depth;               // # of loops the next statement is nested in
+  bool in_for;              // inside a for loop? (no appends there)
+};
+
+static unsigned long long random_state;
+
+
+//
+// Private functions:
+//
+
+//
+// now
+//
+// Returns the current time in seconds, from a monotonic clock.
+//
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//
+// random_below
+//
+// Returns a pseudo-random int in 0..n-1, from a xorshift
+// generator so programs are the same on every platform.
+//
+static int random_below(int n)
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+
+  return (int)(random_state % (unsigned long long)n);
+}
+
+//
+// emit
+//
+// Appends a printf-style formatted line to the program, indented
+// to the current nesting depth.
+//
+static void emit(struct GENERATOR* g, const char* format, ...)
+{
+  char line[256];
+  int indent = 2 * g->depth;
+
+  memset(line, ' ', indent);
+
+  va_list args;
+  va_start(args, format);
+  int n = indent + vsnprintf(line + indent, sizeof(line) - indent, format, args);
+  va_end(args);
+
+  if (g->length + n + 1 > g->capacity) {
+    g->capacity = 2 * (g->capacity + n + 1);
+    g->text = (char*)realloc(g->text, g->capacity);
+  }
+
+  memcpy(g->text + g->length, line, n + 1);
+  g->length += n;
+}
+
+//
+// pick_var
+//
+// Returns a random variable of the given type, or -1 if there are
+// none.
+//
+static int pick_var(struct GENERATOR* g, int type)
+{
+  int candidates[MAX_VARS];
+  int n = 0;
+
+  for (int v = 0; v < MAX_VARS; v++) {
+    if (g->types[v] == type)
+      candidates[n++] = v;
+  }
+
+  return (n == 0) ? -1 : candidates[random_below(n)];
+}
+
+//
+// pick_target
+//
+// Returns a variable to assign a value of the given type to, or -1
+// if there is none. Outside loops any variable will do, so types
+// change from time to time; inside a loop a variable keeps its
+// type, since the statements before it in the body see the value
+// from the previous iteration.
+//
+static int pick_target(struct GENERATOR* g, int type)
+{
+  int v = random_below(MAX_VARS);
+
+  if (g->depth == 0 || g->types[v] == GEN_NONE || g->types[v] == type)
+    return v;
+
+  return pick_var(g, type);
+}
+
+//
+// operand
+//
+// Writes an element of the given type to s: usually a variable of
+// that type, otherwise a literal.
+//
+static void operand(struct GENERATOR* g, int type, char* s, size_t size)
+{
+  static const char* fractions[] = { "0", "25", "5", "75", "1" };
+  static const char* strings[] = { "a", "b", "xy", "hello", "" };
+
+  int v = pick_var(g, type);
+
+  if (v >= 0 && random_below(4) != 0) {
+    snprintf(s, size, "v%d", v);
+    return;
+  }
+
+  switch (type) {
+    case GEN_INT:
+      snprintf(s, size, "%d", random_below(100));
+      break;
+
+    case GEN_REAL:
+      snprintf(s, size, "%d.%s", random_below(100), fractions[random_below(5)]);
+      break;
+
+    case GEN_STR:
+      snprintf(s, size, "'%s'", strings[random_below(5)]);
+      break;
+
+    default:
+      snprintf(s, size, random_below(2) ? "True" : "False");
+      break;
+  }
+}
+
+//
+// gen_arithmetic
+//
+// Generates an int or real assignment v = a op b, followed by
+// v = v % 1000 to keep the value small. A division or modulus
+// divides by a non-zero literal.
+//
+static void gen_arithmetic(struct GENERATOR* g, int type)
+{
+  static const char* ops[] = { "+", "-", "*", "/", "%" };
+
+  char lhs[32], rhs[32];
+  int op = random_below(type == GEN_INT ? 5 : 4);
+
+  if (type == GEN_INT)
+    operand(g, GEN_INT, lhs, sizeof(lhs));
+  else
+    operand(g, random_below(3) ? GEN_REAL : GEN_INT, lhs, sizeof(lhs));
+
+  if (op >= 3)
+    snprintf(rhs, sizeof(rhs), "%d", 1 + random_below(9));
+  else
+    operand(g, type, rhs, sizeof(rhs));
+
+  int target = pick_target(g, type);
+
+  if (target < 0) {
+    emit(g, "pass\n");
+    return;
+  }
+
+  //
+  // now and then store something first that's overwritten before
+  // it's read:
+  //
+  if (g->types[target] == type && random_below(6) == 0)
+    emit(g, type == GEN_INT ? "v%d = %d\n" : "v%d = %d.5\n", target, random_below(100));
+
+  emit(g, "v%d = %s %s %s\n", target, lhs, ops[op], rhs);
+  emit(g, "v%d = v%d %% %s\n", target, target, type == GEN_INT ? "1000" : "1000.5");
+
+  g->types[target] = type;
+}
+
+//
+// gen_string
+//
+// Generates a string assignment. At least one side is a literal,
+// and inside loops both are, so strings grow slowly.
+//
+static void gen_string(struct GENERATOR* g)
+{
+  char lhs[32], rhs[32];
+
+  if (g->depth == 0)
+    operand(g, GEN_STR, lhs, sizeof(lhs));
+  else
+    snprintf(lhs, sizeof(lhs), "'s'");
+
+  snprintf(rhs, sizeof(rhs), "'%c'", 'a' + random_below(26));
+
+  int target = pick_target(g, GEN_STR);
+
+  if (target < 0) {
+    emit(g, "pass\n");
+    return;
+  }
+
+  emit(g, "v%d = %s + %s\n", target, lhs, rhs);
+
+  g->types[target] = GEN_STR;
+}
+
+//
+// gen_relational
+//
+// Generates v = a op b for a relational operator, comparing two
+// numbers or two strings; the result is a boolean.
+//
+static void gen_relational(struct GENERATOR* g)
+{
+  static const char* ops[] = { "==", "!=", "<", "<=", ">", ">=" };
+
+  char lhs[32], rhs[32];
+
+  if (random_below(4) == 0) {
+    operand(g, GEN_STR, lhs, sizeof(lhs));
+    operand(g, GEN_STR, rhs, sizeof(rhs));
+  }
+  else {
+    operand(g, random_below(2) ? GEN_INT : GEN_REAL, lhs, sizeof(lhs));
+    operand(g, random_below(2) ? GEN_INT : GEN_REAL, rhs, sizeof(rhs));
+  }
+
+  int target = pick_target(g, GEN_BOOL);
+
+  if (target < 0) {
+    emit(g, "pass\n");
+    return;
+  }
+
+  emit(g, "v%d = %s %s %s\n", target, lhs, ops[random_below(6)], rhs);
+
+  g->types[target] = GEN_BOOL;
+}
+
+//
+// gen_print
+//
+// Generates a print() of one to three variables; lists are only
+// printed outside loops, so the output stays a reasonable size.
+//
+static void gen_print(struct GENERATOR* g)
+{
+  char line[128] = "print(";
+  int n = 1 + random_below(3);
+  int printed = 0;
+
+  for (int i = 0; i < n; i++) {
+    int v = random_below(MAX_VARS);
+
+    if (g->types[v] == GEN_NONE || (g->types[v] == GEN_LIST && g->depth > 0))
+      continue;
+
+    char arg[16];
+    snprintf(arg, sizeof(arg), "%sv%d", printed > 0 ? ", " : "", v);
+    strcat(line, arg);
+    printed++;
+  }
+
+  if (printed == 0)
+    strcat(line, "'-'");
+
+  emit(g, "%s)\n", line);
+}
+
+//
+// gen_list
+//
+// Generates a statement working with a list of ints: creating
+// one, appending to one, or applying len(), sum(), max(), dot(),
+// add() or scale() to one.
+//
+static void gen_list(struct GENERATOR* g)
+{
+  int list = pick_var(g, GEN_LIST);
+  int r = random_below(8);
+
+  if (list < 0 || (r == 0 && g->depth == 0)) {
+    if (g->depth > 0) {
+      emit(g, "pass\n");
+      return;
+    }
+
+    int target = random_below(MAX_VARS);
+
+    emit(g, "v%d = []\n", target);
+
+    g->types[target] = GEN_LIST;
+    g->nonempty[target] = false;
+    return;
+  }
+
+  if (r <= 2 && !g->in_for) {
+    char item[32];
+    operand(g, GEN_INT, item, sizeof(item));
+
+    emit(g, "append(v%d, %s)\n", list, item);
+
+    g->nonempty[list] = true;
+    return;
+  }
+
+  if (r <= 2)  // no appends in a for loop, so something else
+    r = 3 + r;
+
+  int result_type = (r >= 6) ? GEN_LIST : GEN_INT;
+  int target = pick_target(g, result_type);
+
+  if (target < 0) {
+    emit(g, "pass\n");
+    return;
+  }
+
+  bool nonempty = g->nonempty[list];
+
+  //
+  // inside a loop, a list known to hold items stays that way,
+  // since earlier statements in the body may rely on it:
+  //
+  if (g->depth > 0 && g->types[target] == GEN_LIST && g->nonempty[target] && !nonempty) {
+    emit(g, "pass\n");
+    return;
+  }
+
+  if (r == 3)
+    emit(g, "v%d = len(v%d)\n", target, list);
+  else if (r == 4)
+    emit(g, "v%d = sum(v%d)\n", target, list);
+  else if (r == 5 && nonempty)
+    emit(g, "v%d = max(v%d)\n", target, list);
+  else if (r == 5)
+    emit(g, "v%d = dot(v%d, v%d)\n", target, list, list);
+  else if (r == 6)
+    emit(g, "v%d = add(v%d, v%d)\n", target, list, list);
+  else
+    emit(g, "v%d = scale(v%d, %d)\n", target, list, random_below(5));
+
+  g->types[target] = result_type;
+  g->nonempty[target] = nonempty;
+}
+
+static void gen_stmt(struct GENERATOR* g);
+
+//
+// gen_body
+//
+// Generates the start of a loop body: a { and one to five
+// statements, one level deeper. The caller adds any statements of
+// its own, then closes the body with depth-- and a }.
+//
+static void gen_body(struct GENERATOR* g)
+{
+  int n = 1 + random_below(5);
+
+  emit(g, "{\n");
+  g->depth++;
+
+  for (int i = 0; i < n; i++)
+    gen_stmt(g);
+}
+
+//
+// gen_while
+//
+// Generates a while loop counting c = 0, 1, ..., k-1; the counter
+// is used by nothing else, so every loop ends. Now and then the
+// loop is one like while 3 > 7: that never runs, and whatever its
+// body assigns stays as it was.
+//
+static void gen_while(struct GENERATOR* g)
+{
+  if (random_below(10) == 0) {
+    int types[MAX_VARS];
+    bool nonempty[MAX_VARS];
+    int a = random_below(10);
+
+    memcpy(types, g->types, sizeof(types));
+    memcpy(nonempty, g->nonempty, sizeof(nonempty));
+
+    emit(g, "while %d > %d:\n", a, a + random_below(3));
+
+    gen_body(g);
+
+    g->depth--;
+    emit(g, "}\n");
+
+    memcpy(g->types, types, sizeof(types));
+    memcpy(g->nonempty, nonempty, sizeof(nonempty));
+    return;
+  }
+
+  int c = g->num_counters++;
+  int k = 1 + random_below(g->depth == 0 ? MAX_OUTER : MAX_INNER);
+
+  emit(g, "c%d = 0\n", c);
+  emit(g, "while c%d < %d:\n", c, k);
+
+  gen_body(g);
+
+  emit(g, "c%d = c%d + 1\n", c, c);
+  g->depth--;
+  emit(g, "}\n");
+}
+
+//
+// gen_for
+//
+// Generates a for loop over a list of ints that holds at least
+// one item (so the body runs, and assigns whatever it assigns).
+// The body appends to no list, or the loop might never end.
+//
+static void gen_for(struct GENERATOR* g)
+{
+  int candidates[MAX_VARS];
+  int n = 0;
+
+  for (int v = 0; v < MAX_VARS; v++) {
+    if (g->types[v] == GEN_LIST && g->nonempty[v])
+      candidates[n++] = v;
+  }
+
+  if (n == 0) {
+    gen_while(g);
+    return;
+  }
+
+  int list = candidates[random_below(n)];
+  int var = random_below(MAX_VARS);
+
+  emit(g, "for v%d in v%d:\n", var, list);
+
+  g->types[var] = GEN_INT;
+
+  bool in_for = g->in_for;
+  g->in_for = true;
+
+  gen_body(g);
+
+  g->depth--;
+  emit(g, "}\n");
+
+  g->in_for = in_for;
+}
+
+//
+// gen_stmt
+//
+// Generates one random statement at the current depth.
+//
+static void gen_stmt(struct GENERATOR* g)
+{
+  int r = random_below(100);
+
+  if (r < 25)
+    gen_arithmetic(g, GEN_INT);
+  else if (r < 40)
+    gen_arithmetic(g, GEN_REAL);
+  else if (r < 46)
+    gen_string(g);
+  else if (r < 54)
+    gen_relational(g);
+  else if (r < 64)
+    gen_print(g);
+  else if (r < 68)
+    emit(g, "pass\n");
+  else if (r < 80)
+    gen_list(g);
+  else if (r < 93 && g->depth < MAX_DEPTH)
+    gen_while(g);
+  else if (g->depth == 0)
+    gen_for(g);
+  else
+    gen_arithmetic(g, GEN_INT);
+}
+
+//
+// generate
+//
+// Returns the text of a new random program, which the caller
+// must free.
+//
+static char* generate(void)
+{
+  struct GENERATOR g;
+
+  memset(&g, 0, sizeof(g));
+
+  int n = 10 + random_below(21);
+
+  for (int i = 0; i < n; i++)
+    gen_stmt(&g);
+
+  emit(&g, "print('end')\n");
+
+  return g.text;
+}
+
+//
+// parse
+//
+// Parses the given program text and builds its program graph,
+// returning NULL if there is a syntax error.
+//
+static struct STMT* parse(char* text)
+{
+  FILE* input = tmpfile();
+
+  if (input == NULL)
+    return NULL;
+
+  fputs(text, input);
+  rewind(input);
+
+  struct TokenQueue* tokens = parser_parse(input);
+  fclose(input);
+
+  if (tokens == NULL)
+    return NULL;
+
+  struct STMT* program = programgraph_build(tokens);
+  tokenqueue_destroy(tokens);
+
+  return program;
+}
+
+//
+// run_mode
+//
+// Runs the program in the given mode in a child process, and
+// returns everything it printed to stdout (output, memory, and
+// how the child ended if it didn't exit normally) as a string the
+// caller must free, and the time execute() took via seconds.
+//
+static char* run_mode(struct STMT* program, struct MODE* mode, double* seconds)
+{
+  FILE* out = tmpfile();
+  int fds[2];
+
+  if (out == NULL || pipe(fds) != 0) {
+    fprintf(stderr, "**ERROR: unable to create temporary file or pipe.\n");
+    exit(1);
+  }
+
+  fflush(stdout);
+
+  pid_t pid = fork();
+
+  if (pid == 0) {
+    //
+    // child: run the program with stdout going to the file,
+    // and send the time back through the pipe:
+    //
+    close(fds[0]);
+    dup2(fileno(out), STDOUT_FILENO);
+
+    mode->prepare(&program);
+    execute_prepare(program);
+
+    struct RAM* memory = ram_init();
+
+    double start = now();
+    execute(program, memory, NULL);
+    double elapsed = now() - start;
+
+    output_flush();
+    ram_print(memory);
+    fflush(stdout);
+
+    if (write(fds[1], &elapsed, sizeof(elapsed)) != sizeof(elapsed))
+      _exit(2);
+
+    _exit(0);
+  }
+
+  close(fds[1]);
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+
+  if (read(fds[0], seconds, sizeof(*seconds)) != sizeof(*seconds))
+    *seconds = 0.0;
+
+  close(fds[0]);
+
+  fseek(out, 0, SEEK_END);
+  long size = ftell(out);
+  rewind(out);
+
+  char* text = (char*)malloc(size + 64);
+  size_t n = fread(text, 1, size, out);
+  text[n] = '\0';
+  fclose(out);
+
+  if (WIFSIGNALED(status))
+    sprintf(text + n, "**killed by signal %d\n", WTERMSIG(status));
+  else if (WEXITSTATUS(status) != 0)
+    sprintf(text + n, "**exit status %d\n", WEXITSTATUS(status));
+
+  return text;
+}
+
+//
+// print_difference
+//
+// Prints the first line where the two outputs differ.
+//
+static void print_difference(char* expected, char* actual)
+{
+  int line = 1;
+  int start = 0;  // where the current line starts
+  int i = 0;
+
+  while (expected[i] != '\0' && expected[i] == actual[i]) {
+    if (expected[i] == '\n') {
+      line++;
+      start = i + 1;
+    }
+
+    i++;
+  }
+
+  int e = (int)strcspn(expected + start, "\n");
+  int a = (int)strcspn(actual + start, "\n");
+
+  printf("  line %d: expected '%.*s'\n", line, e, expected + start);
+  printf("  line %d: but got  '%.*s'\n", line, a, actual + start);
+}
+
+
+//
+// main
+//
+// usage: difftest.out [# of programs] [seed]
+//
+int main(int argc, char* argv[])
+{
+  int num_programs = (argc > 1) ? atoi(argv[1]) : 100;
+  unsigned long long seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+
+  random_state = (seed == 0) ? 1 : seed;
+
+  parser_init();
+
+  double totals[NUM_MODES] = { 0.0 };
+  int failures = 0;
+
+  for (int p = 1; p <= num_programs; p++) {
+    char* text = generate();
+    struct STMT* program = parse(text);
+
+    if (program == NULL) {
+      printf("program %d: **generated a syntax or semantic error:\n%s", p, text);
+      free(text);
+      failures++;
+      continue;
+    }
+
+    double seconds;
+    char* expected = run_mode(program, &modes[0], &seconds);
+    totals[0] += seconds;
+
+    for (int m = 1; m < NUM_MODES; m++) {
+      char* actual = run_mode(program, &modes[m], &seconds);
+      totals[m] += seconds;
+
+      if (strcmp(expected, actual) != 0) {
+        printf("program %d: **%s differs from %s:\n", p, modes[m].name, modes[0].name);
+        print_difference(expected, actual);
+        printf("%s\n", text);
+        failures++;
+      }
+
+      free(actual);
+    }
+
+    free(expected);
+    programgraph_destroy(program);
+    free(text);
+  }
+
+  for (int m = 0; m < NUM_MODES; m++) {
+    printf("%-12s %8.3f s, speedup %.2fx\n", modes[m].name, totals[m],
+      totals[m] > 0.0 ? totals[0] / totals[m] : 0.0);
+  }
+
+  printf("%d programs, %d failures\n", num_programs, failures);
+
+  return (failures == 0) ? 0 : 1;
+}
@@ -16,43 +16,123 @@
 #include <string.h>
 #include <assert.h>
 #include <math.h>
+#include <limits.h>  // LLONG_MAX, INT_MIN, INT_MAX
+#include <stdatomic.h>  // atomic_bool
 
 #include "programgraph.h"
 #include "ram.h"
 #include "execute.h"
+#include "output.h"
+#include "jit.h"
+#include "vector.h"
+#include "convert.h"
+#include "input.h"
+#include "util.h"     // dupString
+
+
+//
+// is the JIT used for contexts created from now on?
+//
+static bool jit_enabled = true;
+
+//
+// the slots of the function being executed, NULL at the top level;
+// execute_step sets this from its context, and keeps it up to date
+// as functions are called and return. One per thread, so programs
+// can execute on several threads at once (each with its own RAM):
+//
+static _Thread_local struct RAM_VALUE* frame = NULL;
+
+//
+// value_type of a local variable that hasn't been assigned yet:
+//
+#define UNASSIGNED -1
+
+//
+// how deep may calls nest?
+//
+#define MAX_CALL_DEPTH 10000
 
 
 //
 // Private functions:
 //
 
+//
+// out_of_memory
+//
+// Outputs the error for a value that memory couldn't make room
+// for: over its limit, if it has one (see ram_set_limit), or
+// too large for it at all. Returns false, for the caller to
+// return.
+//
+static bool out_of_memory(struct STMT* stmt, struct RAM* memory)
+{
+  if (memory->bytes_limit > 0)
+    output_printf("**EXECUTION ERROR: memory limit of %lld bytes exceeded (line %d)\n", memory->bytes_limit, stmt->line);
+  else
+    output_printf("**EXECUTION ERROR: out of memory (line %d)\n", stmt->line);
+
+  return false;
+}
+
+//
+// get_variable
+//
+// Returns a pointer to the value of the given variable: its slot
+// in the current frame if it's local (slot >= 0), its memory cell
+// if not. Returns NULL if the variable has no value yet, after 
+// outputting an error message.
+//
+static const struct RAM_VALUE* get_variable(struct STMT* stmt, struct RAM* memory, char* var_name, int slot)
+{
+  if (slot >= 0) {
+    if (frame[slot].value_type == UNASSIGNED) {
+      output_printf("**SEMANTIC ERROR: local variable '%s' referenced before assignment (line %d)\n", var_name, stmt->line);
+      return NULL;
+    }
+
+    return &frame[slot];
+  }
+
+  const struct RAM_VALUE* cell_value = ram_peek_cell_by_id(memory, var_name);
+
+  if (cell_value == NULL)
+    output_printf("**SEMANTIC ERROR: name '%s' is not defined (line %d)\n", var_name, stmt->line);
+
+  return cell_value;
+}
+
 //
 // get_element_value
 //
 // Given a basic element of an expression --- an identifier
 // "x" or some kind of literal like 123 --- the value of 
 // this identifier or literal is returned via the reference 
-// parameter. Returns ram value if successful, NULL if not.
+// parameter. Returns true if successful, false if not.
 //
 // Why would it fail? If the identifier does not exist in 
-// memory. This is a semantic error, and an error message is 
-// output before returning.
+// memory (or, for a local, has not been assigned). This is a
+// semantic error, and an error message is output before
+// returning.
 //
-static struct RAM_VALUE* get_element_value(struct STMT* stmt, struct RAM* memory, struct ELEMENT* element, struct RAM_VALUE* ram_value)
+// NOTE: nothing is allocated. The value of a variable is a
+// shallow copy of its memory cell (or frame slot), so a string
+// value borrows the string stored there; it remains valid until
+// that variable is written.
+//
+static bool get_element_value(struct STMT* stmt, struct RAM* memory, struct ELEMENT* element, struct RAM_VALUE* ram_value)
 {
-  char* literal = element->element_value;
-  ram_value = (struct RAM_VALUE*)malloc(sizeof(struct RAM_VALUE));
-
   if (element->element_type == ELEMENT_INT_LITERAL) { 
-    ram_value->types.i = atoi(literal);
+    ram_value->types.i = element->literal.i;
     ram_value->value_type = RAM_TYPE_INT;
   }
   else if (element->element_type == ELEMENT_REAL_LITERAL) { 
-    ram_value->types.d = atof(literal);
+    ram_value->types.d = element->literal.d;
     ram_value->value_type = RAM_TYPE_REAL;
   }
   else if (element->element_type == ELEMENT_STR_LITERAL) { 
-    ram_value->types.s = literal;
+    ram_value->types.s = element->element_value;
     ram_value->value_type = RAM_TYPE_STR;
   }
   else if (element->element_type == ELEMENT_TRUE) {
@@ -63,51 +143,231 @@ static struct RAM_VALUE* get_element_value(struct STMT* stmt, struct RAM* memory
     ram_value->types.i = false;
     ram_value->value_type = RAM_TYPE_BOOLEAN;
   }
+  else if (element->element_type == ELEMENT_NONE) {
+    ram_value->types.i = 0;
+    ram_value->value_type = RAM_TYPE_NONE;
+  }
   else if (element->element_type == ELEMENT_IDENTIFIER){
     //
     // identifier => variable
     //
 
-    char* var_name = element->element_value;
-    ram_value = ram_read_cell_by_id(memory, var_name);
+    const struct RAM_VALUE* cell_value = get_variable(stmt, memory, element->element_value, element->slot);
 
-    if (ram_value == NULL) {
-      printf("**SEMANTIC ERROR: name '%s' is not defined (line %d)\n", var_name, stmt->line);
-      return NULL;
-    }
+    if (cell_value == NULL)
+      return false;
+
+    *ram_value = *cell_value;
+  }
+  else return false;
+
+  return true;
+}
+
+
+//
+// get_pointer_target
+//
+// Given the value of a pointer being dereferenced (*p), returns
+// the memory address it points to, or -1 if the value is not a 
+// pointer or the address is not valid. An error message is
+// output before -1 is returned.
+//
+static int get_pointer_target(struct STMT* stmt, struct RAM* memory, struct RAM_VALUE* ptr, char* ptr_name)
+{
+  if (ptr->value_type != RAM_TYPE_PTR) {
+    output_printf("**SEMANTIC ERROR: '%s' is not a pointer (line %d)\n", ptr_name, stmt->line);
+    return -1;
+  }
+
+  if (ptr->types.i < 0 || ptr->types.i >= memory->num_values) {
+    output_printf("**EXECUTION ERROR: invalid memory address %d (line %d)\n", ptr->types.i, stmt->line);
+    return -1;
+  }
+
+  return ptr->types.i;
+}
+
+//
+// get_list_index
+//
+// Given a list being indexed (xs[i]) and the value of the index,
+// returns the position of the item in the list, or -1 if the
+// index is not valid. As in Python, a negative index counts from
+// the end of the list. An error message is output before -1 is
+// returned.
+//
+static int get_list_index(struct STMT* stmt, struct RAM_LIST* list, struct RAM_VALUE* index)
+{
+  if (index->value_type != RAM_TYPE_INT) {
+    output_printf("**SEMANTIC ERROR: list indices must be integers (line %d)\n", stmt->line);
+    return -1;
+  }
+
+  int position = index->types.i;
+
+  if (position < 0)
+    position += list->length;
+
+  if (position < 0 || position >= list->length) {
+    output_printf("**EXECUTION ERROR: list index %d out of range (line %d)\n", index->types.i, stmt->line);
+    return -1;
   }
-  else return NULL;
 
-  return ram_value;
+  return position;
+}
+
+//
+// check_key
+//
+// Returns true if the given value can be a dict key (an int or a
+// string), false if not. An error message is output before false
+// is returned.
+//
+static bool check_key(struct STMT* stmt, struct RAM_VALUE* key)
+{
+  if (key->value_type == RAM_TYPE_INT || key->value_type == RAM_TYPE_STR)
+    return true;
+
+  output_printf("**SEMANTIC ERROR: dict keys must be ints or strings (line %d)\n", stmt->line);
+  return false;
 }
 
+//
+// get_item
+//
+// Given the value of a list or dict being indexed (xs[i] or d[k])
+// and the index element, returns the item via the reference 
+// parameter. Returns true if successful, false if not (the value
+// is not a list or dict, the index is not valid, or the key is not
+// in the dict). An error message is output before false is returned.
+//
+// NOTE: nothing is allocated, the item is a shallow copy of the
+// one in the list or dict.
+//
+static bool get_item(struct STMT* stmt, struct RAM* memory, struct RAM_VALUE* container, char* name, struct ELEMENT* index_element, struct RAM_VALUE* item)
+{
+  if (container->value_type != RAM_TYPE_LIST && container->value_type != RAM_TYPE_DICT) {
+    output_printf("**SEMANTIC ERROR: '%s' is not a list or dict (line %d)\n", name, stmt->line);
+    return false;
+  }
+
+  struct RAM_VALUE index;
+
+  if (!get_element_value(stmt, memory, index_element, &index))
+    return false;
+
+  if (container->value_type == RAM_TYPE_LIST) {
+    int position = get_list_index(stmt, container->types.l, &index);
+    if (position < 0)
+      return false;
+
+    *item = *ram_list_peek(container->types.l, position);
+    return true;
+  }
+
+  if (!check_key(stmt, &index))
+    return false;
+
+  const struct RAM_VALUE* value = ram_dict_get(memory, container->types.m, index);
+
+  if (value == NULL) {
+    if (index.value_type == RAM_TYPE_STR)
+      output_printf("**EXECUTION ERROR: key '%s' not found (line %d)\n", index.types.s, stmt->line);
+    else
+      output_printf("**EXECUTION ERROR: key %d not found (line %d)\n", index.types.i, stmt->line);
+    return false;
+  }
+
+  *item = *value;
+  return true;
+}
 
 //
 // get_unary_value
 //
 // Given a unary expr, returns the value that it represents.
 // This could be the result of a literal 123 or the value
-// from memory for an identifier such as "x". Unary values
-// may have unary operators, such as + or -, applied.
+// from memory for an identifier such as "x", with a unary
+// operator applied: +x, -x, &x (the address of x), *p
+// (the value p points to), xs[i] (an item of a list) or d[k]
+// (the value of a key in a dict).
 // This value is "returned" via the reference parameter.
-// Returns ram value if successful, NULL if not.
+// Returns true if successful, false if not.
 //
 // Why would it fail? If the identifier does not exist in 
-// memory. This is a semantic error, and an error message is 
-// output before returning.
+// memory, the operator doesn't apply to the value, or a
+// pointer is invalid. An error message is output before 
+// returning.
 //
-static struct RAM_VALUE* get_unary_value(struct STMT* stmt, struct RAM* memory, struct UNARY_EXPR* unary)
+static bool get_unary_value(struct STMT* stmt, struct RAM* memory, struct UNARY_EXPR* unary, struct RAM_VALUE* ram_value)
 {
-  //
-  // we only have simple elements so far (no unary operators):
-  //
-  assert(unary->expr_type == UNARY_ELEMENT);
-
   struct ELEMENT* element = unary->element;
 
-  struct RAM_VALUE ram_value;
+  if (unary->expr_type == UNARY_ADDRESS_OF) {
+    //
+    // the parser guarantees &identifier; locals live in frames,
+    // not memory, so they have no address:
+    //
+    if (element->slot >= 0) {
+      output_printf("**SEMANTIC ERROR: cannot take the address of local variable '%s' (line %d)\n", element->element_value, stmt->line);
+      return false;
+    }
+
+    int address = ram_get_addr(memory, element->element_value);
+
+    if (address < 0) {
+      output_printf("**SEMANTIC ERROR: name '%s' is not defined (line %d)\n", element->element_value, stmt->line);
+      return false;
+    }
+
+    ram_value->value_type = RAM_TYPE_PTR;
+    ram_value->types.i = address;
+    return true;
+  }
+
+  if (!get_element_value(stmt, memory, element, ram_value))
+    return false;
+
+  switch (unary->expr_type)
+  {
+    case UNARY_ELEMENT:
+      return true;
+
+    case UNARY_PTR_DEREF: {
+      int address = get_pointer_target(stmt, memory, ram_value, element->element_value);
+      if (address < 0)
+        return false;
+
+      *ram_value = *ram_peek_cell_by_addr(memory, address);
+      return true;
+    }
+
+    case UNARY_INDEX: {
+      struct RAM_VALUE container = *ram_value;
+
+      return get_item(stmt, memory, &container, element->element_value, unary->index, ram_value);
+    }
+
+    case UNARY_PLUS:
+    case UNARY_MINUS:
+      if (ram_value->value_type == RAM_TYPE_INT) {
+        if (unary->expr_type == UNARY_MINUS)  // negate as unsigned so INT_MIN wraps
+          ram_value->types.i = (int)(0U - (unsigned int)ram_value->types.i);
+        return true;
+      }
+      if (ram_value->value_type == RAM_TYPE_REAL) {
+        if (unary->expr_type == UNARY_MINUS)
+          ram_value->types.d = -ram_value->types.d;
+        return true;
+      }
+      output_printf("**SEMANTIC ERROR: invalid operand types (line %d)\n", stmt->line);
+      return false;
 
-  return get_element_value(stmt, memory, element, &ram_value);
+    default:
+      output_printf("**EXECUTION ERROR: unexpected unary expression (%d) (line %d)\n", unary->expr_type, stmt->line);
+      return false;
+  }
 }
 
 //
@@ -169,9 +429,144 @@ static bool execute_real(double* left, double* right, int operator) {
         break;
 
       default:
-        printf("**EXECUTION ERROR: unexpected operator (%d) in execute_binary_expr\n", operator);
+        output_printf("**EXECUTION ERROR: unexpected operator (%d) in execute_binary_expr\n", operator);
+        return false;
+    }
+  return true;
+}
+
+//
+// execute_pointer_expr
+//
+// Pointer arithmetic on memory addresses: ptr + int, int + ptr
+// and ptr - int yield a pointer, ptr - ptr yields the # of cells
+// between them (an int), and pointers can be compared with the 
+// relational operators. The result is stored in lhs; returns 
+// true if successful and false if not.
+//
+static bool execute_pointer_expr(struct STMT* stmt, struct RAM_VALUE* lhs, int operator, struct RAM_VALUE rhs)
+{
+  long long left = lhs->types.i;
+  long long right = rhs.types.i;
+
+  if (lhs->value_type == RAM_TYPE_PTR && rhs.value_type == RAM_TYPE_PTR) {
+    int result;
+
+    switch (operator)
+    {
+      case OPERATOR_MINUS:     lhs->value_type = RAM_TYPE_INT; lhs->types.i = (int)(left - right); return true;
+      case OPERATOR_EQUAL:     result = (left == right); break;
+      case OPERATOR_NOT_EQUAL: result = (left != right); break;
+      case OPERATOR_LT:        result = (left < right); break;
+      case OPERATOR_LTE:       result = (left <= right); break;
+      case OPERATOR_GT:        result = (left > right); break;
+      case OPERATOR_GTE:       result = (left >= right); break;
+      default:
+        output_printf("**SEMANTIC ERROR: invalid operand types (line %d)\n", stmt->line);
         return false;
     }
+
+    lhs->value_type = RAM_TYPE_BOOLEAN;
+    lhs->types.i = result;
+    return true;
+  }
+
+  long long address;
+
+  if (lhs->value_type == RAM_TYPE_PTR && rhs.value_type == RAM_TYPE_INT && operator == OPERATOR_PLUS)
+    address = left + right;
+  else if (lhs->value_type == RAM_TYPE_PTR && rhs.value_type == RAM_TYPE_INT && operator == OPERATOR_MINUS)
+    address = left - right;
+  else if (lhs->value_type == RAM_TYPE_INT && rhs.value_type == RAM_TYPE_PTR && operator == OPERATOR_PLUS)
+    address = left + right;
+  else {
+    output_printf("**SEMANTIC ERROR: invalid operand types (line %d)\n", stmt->line);
+    return false;
+  }
+
+  //
+  // addresses out of range are caught when dereferenced:
+  //
+  if (address < INT_MIN || address > INT_MAX)
+    address = -1;
+
+  lhs->value_type = RAM_TYPE_PTR;
+  lhs->types.i = (int)address;
+  return true;
+}
+
+//
+// same_value
+//
+// Returns true if the two values are equal as far as the in 
+// operator is concerned: numbers by value (so 1 equals 1.0),
+// strings by their contents, and lists and dicts by identity.
+//
+static bool same_value(struct RAM_VALUE* v1, struct RAM_VALUE* v2)
+{
+  bool numeric1 = (v1->value_type == RAM_TYPE_INT || v1->value_type == RAM_TYPE_REAL);
+  bool numeric2 = (v2->value_type == RAM_TYPE_INT || v2->value_type == RAM_TYPE_REAL);
+
+  if (numeric1 && numeric2) {
+    double d1 = (v1->value_type == RAM_TYPE_INT) ? v1->types.i : v1->types.d;
+    double d2 = (v2->value_type == RAM_TYPE_INT) ? v2->types.i : v2->types.d;
+
+    return d1 == d2;
+  }
+
+  if (v1->value_type != v2->value_type)
+    return false;
+
+  switch (v1->value_type)
+  {
+    case RAM_TYPE_STR:
+      return strcmp(v1->types.s, v2->types.s) == 0;
+
+    case RAM_TYPE_LIST:
+      return v1->types.l == v2->types.l;
+
+    case RAM_TYPE_DICT:
+      return v1->types.m == v2->types.m;
+
+    case RAM_TYPE_NONE:
+      return true;
+
+    default:  // PTR, BOOLEAN
+      return v1->types.i == v2->types.i;
+  }
+}
+
+//
+// execute_in
+//
+// Executes x in xs (is x an item of the list?), k in d (is k a
+// key of the dict?) or s in t (is s a substring of t?), storing
+// the boolean result in lhs. Returns true if successful and false
+// if not.
+//
+static bool execute_in(struct STMT* stmt, struct RAM* memory, struct RAM_VALUE* lhs, struct RAM_VALUE rhs)
+{
+  bool found = false;
+
+  if (rhs.value_type == RAM_TYPE_DICT) {
+    found = (ram_dict_get(memory, rhs.types.m, *lhs) != NULL);
+  }
+  else if (rhs.value_type == RAM_TYPE_LIST) {
+    struct RAM_LIST* list = rhs.types.l;
+
+    for (int i = 0; i < list->length && !found; i++)
+      found = same_value(lhs, &list->items[i]);
+  }
+  else if (rhs.value_type == RAM_TYPE_STR && lhs->value_type == RAM_TYPE_STR) {
+    found = (strstr(rhs.types.s, lhs->types.s) != NULL);
+  }
+  else {
+    output_printf("**SEMANTIC ERROR: invalid operand types (line %d)\n", stmt->line);
+    return false;
+  }
+
+  lhs->value_type = RAM_TYPE_BOOLEAN;
+  lhs->types.i = found;
   return true;
 }
 
@@ -183,10 +578,17 @@ static bool execute_real(double* left, double* right, int operator) {
 // because a pointer to the value is passed in). Returns
 // true if successful and false if not.
 //
-static bool execute_binary_expr(struct STMT* stmt, struct RAM_VALUE* lhs, int operator, struct RAM_VALUE rhs)
+// NOTE: string concatenation produces a new string in lhs,
+// which the caller owns and must eventually free. This is the
+// only way the result can be a string.
+//
+static bool execute_binary_expr(struct STMT* stmt, struct RAM* memory, struct RAM_VALUE* lhs, int operator, struct RAM_VALUE rhs)
 {
   assert(operator != OPERATOR_NO_OP);
 
+  if (operator == OPERATOR_IN)
+    return execute_in(stmt, memory, lhs, rhs);
+
   //go through different operand combinations
   if (lhs->value_type == RAM_TYPE_INT && rhs.value_type == RAM_TYPE_INT) {
     lhs->types.d = lhs->types.i;
@@ -246,13 +648,16 @@ static bool execute_binary_expr(struct STMT* stmt, struct RAM_VALUE* lhs, int op
           break;
 
         default:
-          printf("**EXECUTION ERROR: unexpected operator (%d) in execute_binary_expr\n", operator);
+          output_printf("**EXECUTION ERROR: unexpected operator (%d) in execute_binary_expr\n", operator);
           return false;
       }
     }
   }
+  else if (lhs->value_type == RAM_TYPE_PTR || rhs.value_type == RAM_TYPE_PTR) {
+    return execute_pointer_expr(stmt, lhs, operator, rhs);
+  }
   else {
-    printf("**SEMANTIC ERROR: invalid operand types (line %d)\n", stmt->line);
+    output_printf("**SEMANTIC ERROR: invalid operand types (line %d)\n", stmt->line);
     return false;
   }
 
@@ -277,301 +682,1610 @@ static bool execute_binary_expr(struct STMT* stmt, struct RAM_VALUE* lhs, int op
 }
 
 //
-// execute_function
+// execute_typed_binary_expr
 //
-// Given a function call and ram value, executes given function and returns a pointer
-// to the ram_value with the result of the function. Supports 3 types of functions:
-// 1) input(): takes in a string literal from input, removes the EOL characters
-//    and saves it into memory.
-// 2) int(): takes in a string literal and converts it to an int. Returns an error
-//    if conversion is unsuccessful.
-// 3) float(): takes in a string literal and converts it to a real. Returns an error
-//    if conversion is unsuccessful.
+// Like execute_binary_expr, but for an expression whose operand
+// types were inferred before execution (see infer.h). When both
+// operands are known to be numbers, the operation is done right
+// here, without looking at the values' types; the results are
+// exactly those of execute_binary_expr, which handles everything
+// else.
 //
-static struct RAM_VALUE* execute_function(struct STMT* stmt, struct RAM* memory, struct VALUE_FUNCTION_CALL* function_call, struct RAM_VALUE* ram_value) 
+static bool execute_typed_binary_expr(struct STMT* stmt, struct RAM* memory, struct VALUE_EXPR* expr, struct RAM_VALUE* lhs, struct RAM_VALUE rhs)
 {
-  ram_value = (struct RAM_VALUE*)malloc(sizeof(struct RAM_VALUE));
+  int lhs_type = expr->lhs_type;
+  int rhs_type = expr->rhs_type;
 
-  char* function_name = function_call->function_name;
-  struct ELEMENT* param = function_call->parameter;
-  struct RAM_VALUE* value = get_element_value(stmt, memory, param, ram_value);
+  if ((lhs_type != RAM_TYPE_INT && lhs_type != RAM_TYPE_REAL) ||
+      (rhs_type != RAM_TYPE_INT && rhs_type != RAM_TYPE_REAL) ||
+      expr->operator > OPERATOR_GTE)  // is, in
+    return execute_binary_expr(stmt, memory, lhs, expr->operator, rhs);
 
-  if (strcmp(function_name, "input") == 0) {
-    printf(value->types.s);
-    char line[256];
+  double left = (lhs_type == RAM_TYPE_INT) ? lhs->types.i : lhs->types.d;
+  double right = (rhs_type == RAM_TYPE_INT) ? rhs.types.i : rhs.types.d;
 
-    fgets(line, sizeof(line), stdin);
-    // delete EOL chars from input:
-    line[strcspn(line, "\r\n")] = '\0';
-    
-    size_t bytes = sizeof(char) * (strlen(line) + 1);
-    char* s = (char*) malloc(bytes);
-    strcpy(s, line);
-    ram_value->value_type = RAM_TYPE_STR;
-    ram_value->types.s = s;
-  }
+  if (!execute_real(&left, &right, expr->operator))
+    return false;
 
-  else if (strcmp(function_name, "int") == 0) {
-    int i = atoi(value->types.s);
-    if((strchr(value->types.s, '0') != NULL) || i != 0) {
-      ram_value->value_type = RAM_TYPE_INT;
-      ram_value->types.i = i;
-    }
-    else {
-      printf("**SEMANTIC ERROR: invalid string for %s() (line %d)\n", function_name, stmt->line);
-      return NULL;
-    }
+  if (expr->operator >= OPERATOR_EQUAL) {  // relational
+    lhs->value_type = RAM_TYPE_BOOLEAN;
+    lhs->types.i = (left != 0);
   }
-  
-  else if (strcmp(function_name, "float") == 0) {
-    //check if string has any zeros
-    double d = atof(value->types.s);
-    if((strchr(value->types.s, '0') != NULL) || (d != 0)) {
-      ram_value->value_type = RAM_TYPE_REAL;
-      ram_value->types.d = d;
-    }
-    else {
-      printf("**SEMANTIC ERROR: invalid string for %s() (line %d)\n", function_name, stmt->line);
-      return NULL;
-    }
+  else if (lhs_type == RAM_TYPE_INT && rhs_type == RAM_TYPE_INT) {
+    lhs->value_type = RAM_TYPE_INT;
+    lhs->types.i = left;
   }
   else {
-    printf("**EXECUTION ERROR: unexpected function (%s) in execute_function\n", function_name);
-    return NULL;
+    lhs->value_type = RAM_TYPE_REAL;
+    lhs->types.d = left;
   }
 
-  return ram_value;
+  return true;
 }
 
 //
-// execute_assignment
+// check_numbers
 //
-// Executes an assignment statement, returning true if 
-// successful and false if not (an error message will be
-// output before false is returned, so the caller doesn't
-// need to output anything).
-// 
-// Examples: x = 123
-//           y = x ** 2
+// Checks that the value of the given argument is a list of numbers
+// (ints and/or reals), returning what kind of numbers via type (see
+// vector.h). Returns true if so; if not, an error message is output
+// and false is returned.
 //
-static bool execute_assignment(struct STMT* stmt, struct RAM* memory)
+static bool check_numbers(struct STMT* stmt, char* function_name, struct ELEMENT* param, struct RAM_VALUE* value, int* type)
 {
-  struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+  if (value->value_type != RAM_TYPE_LIST) {
+    output_printf("**SEMANTIC ERROR: '%s' is not a list (line %d)\n", param->element_value, stmt->line);
+    return false;
+  }
 
-  char* var_name = assign->var_name;
-  //
-  // no pointers yet:
-  //
-  assert(assign->isPtrDeref == false);
-  //
-  // we only have expressions on the RHS, no function calls:
-  //
-  if (assign->rhs->value_type == VALUE_EXPR) {
-    struct VALUE_EXPR* expr = assign->rhs->types.expr;
-    //
-    // we always have a LHS:
-    //
-    assert(expr->lhs != NULL);
+  *type = vector_type(value->types.l);
+
+  if (*type == VECTOR_NOT_NUMERIC) {
+    output_printf("**SEMANTIC ERROR: %s() needs a list of numbers (line %d)\n", function_name, stmt->line);
+    return false;
+  }
 
-    struct RAM_VALUE* value = get_unary_value(stmt, memory, expr->lhs);
+  return true;
+}
 
-    if (value == NULL)  // semantic error? If so, return now:
-      return false;
+//
+// Builtin functions:
+//
+// Each builtin evaluates its own arguments, whose # has already
+// been checked (see call_builtin), and returns its result via the
+// reference parameter, None if it has no result. Returns true if
+// successful and false if not (an error message is output before
+// false is returned). The name is the name it was called by, for
+// error messages.
+//
+// NOTE: a string, list or dict a builtin returns is new, and is
+// owned by the caller.
+//
 
-    //
-    // do we have a binary expression?
-    //
-    if (expr->isBinaryExpr)
-    {
-      assert(expr->rhs != NULL);  // we must have a RHS
-      assert(expr->operator != OPERATOR_NO_OP);  // we must have an operator
+static void print_value(struct RAM_VALUE* value, int depth);
 
-      struct RAM_VALUE* rhs_value = get_unary_value(stmt, memory, expr->rhs);
+//
+// builtin_input
+//
+// input(prompt): outputs the prompt (unless input is batched, see
+// input.h), then inputs a line and returns it as a string, 
+// without the EOL characters. Running out of input is an error.
+//
+static bool builtin_input(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
 
-      if (rhs_value == NULL) {  // semantic error? If so, return now:
-        return false;
-      }
-      //
-      // perform the operation, updating value:
-      //
-      bool success = execute_binary_expr(stmt, value, expr->operator, *rhs_value);
+  if (!get_element_value(stmt, memory, params, &value))
+    return false;
 
-      if (!success) {
-        return false;
-      }
-      //
-      // success! Fall through and write value to memory:
-      //
-    }
-    return ram_write_cell_by_id(memory, *value, var_name);
+  if (input_prompts()) {
+    output_string(value.types.s);
+    output_flush();  // make sure the prompt is visible
   }
-  else {
-    assert(assign->rhs->value_type == VALUE_FUNCTION_CALL);
-
-    struct VALUE_FUNCTION_CALL* function_call = assign->rhs->types.function_call;
-    struct RAM_VALUE ram_value;
-    struct RAM_VALUE* value = execute_function(stmt, memory, function_call, &ram_value);
 
-    if (value == NULL) return false;
+  size_t length;
+  char* line = input_line(&length);
 
-    return ram_write_cell_by_id(memory, *value, var_name); 
+  if (line == NULL) {
+    output_printf("**EXECUTION ERROR: %s() reached the end of the input (line %d)\n", name, stmt->line);
+    return false;
   }
-  return false;
-}
 
+  char* s = (char*)malloc(length + 1);
+  if (s == NULL) {
+    output_printf("**EXECUTION ERROR: out of memory (line %d)\n", stmt->line);
+    return false;
+  }
+
+  memcpy(s, line, length + 1);
+  result->value_type = RAM_TYPE_STR;
+  result->types.s = s;
+
+  return true;
+}
+
+//
+// builtin_int
+//
+// int(s): converts the string to an int. Returns an error if the
+// string is not an int (see convert.h).
+//
+static bool builtin_int(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
+
+  if (!get_element_value(stmt, memory, params, &value))
+    return false;
+
+  if (value.value_type == RAM_TYPE_STR && convert_int(value.types.s, &result->types.i)) {
+    result->value_type = RAM_TYPE_INT;
+    return true;
+  }
+
+  output_printf("**SEMANTIC ERROR: invalid string for %s() (line %d)\n", name, stmt->line);
+  return false;
+}
+
+//
+// builtin_float
+//
+// float(s): converts the string to a real. Returns an error if
+// the string is not a number (see convert.h).
+//
+static bool builtin_float(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
+
+  if (!get_element_value(stmt, memory, params, &value))
+    return false;
+
+  if (value.value_type == RAM_TYPE_STR && convert_real(value.types.s, &result->types.d)) {
+    result->value_type = RAM_TYPE_REAL;
+    return true;
+  }
+
+  output_printf("**SEMANTIC ERROR: invalid string for %s() (line %d)\n", name, stmt->line);
+  return false;
+}
+
+//
+// builtin_alloc
+//
+// alloc(N): allocates N consecutive cells on the heap, returning
+// a pointer to the first one. Returns an error if N is not a 
+// positive int, is more cells than memory can have, or if the
+// memory limit would be exceeded.
+//
+static bool builtin_alloc(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
+
+  if (!get_element_value(stmt, memory, params, &value))
+    return false;
+
+  if (value.value_type != RAM_TYPE_INT || value.types.i <= 0) {
+    output_printf("**SEMANTIC ERROR: invalid size for %s() (line %d)\n", name, stmt->line);
+    return false;
+  }
+
+  int address = ram_alloc_cells(memory, value.types.i);
+
+  if (address == RAM_ALLOC_INVALID) {
+    output_printf("**SEMANTIC ERROR: invalid size for %s() (line %d)\n", name, stmt->line);
+    return false;
+  }
+
+  if (address == RAM_ALLOC_LIMIT)
+    return out_of_memory(stmt, memory);
+
+  result->value_type = RAM_TYPE_PTR;
+  result->types.i = address;
+
+  return true;
+}
+
+//
+// builtin_len
+//
+// len(x): returns the length of a list, dict or string.
+//
+static bool builtin_len(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
+
+  if (!get_element_value(stmt, memory, params, &value))
+    return false;
+
+  if (value.value_type == RAM_TYPE_LIST)
+    result->types.i = value.types.l->length;
+  else if (value.value_type == RAM_TYPE_DICT)
+    result->types.i = value.types.m->length;
+  else if (value.value_type == RAM_TYPE_STR)
+    result->types.i = (int)strlen(value.types.s);
+  else {
+    output_printf("**SEMANTIC ERROR: invalid argument for %s() (line %d)\n", name, stmt->line);
+    return false;
+  }
+
+  result->value_type = RAM_TYPE_INT;
+
+  return true;
+}
+
+//
+// builtin_sum
+//
+// sum(xs): returns the sum of a list of numbers. Like the other
+// builtins on lists of numbers, it runs as a vectorized kernel
+// over the whole list (see vector.h).
+//
+static bool builtin_sum(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
+  int type;
+
+  if (!get_element_value(stmt, memory, params, &value))
+    return false;
+
+  if (!check_numbers(stmt, name, params, &value, &type))
+    return false;
+
+  *result = vector_sum(value.types.l, type);
+
+  return true;
+}
+
+//
+// get_nonempty_numbers
+//
+// Gets the one argument of min() or max(), returning the list via
+// value and the type of its items via type. Returns true if it's
+// a list of numbers with at least one item, false if not (an
+// error message is output before false is returned).
+//
+static bool get_nonempty_numbers(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* value, int* type)
+{
+  if (!get_element_value(stmt, memory, params, value))
+    return false;
+
+  if (!check_numbers(stmt, name, params, value, type))
+    return false;
+
+  if (value->types.l->length == 0) {
+    output_printf("**EXECUTION ERROR: %s() of an empty list (line %d)\n", name, stmt->line);
+    return false;
+  }
+
+  return true;
+}
+
+//
+// builtin_min
+//
+// min(xs): returns the smallest item of a list of numbers. min()
+// of an empty list is an error.
+//
+static bool builtin_min(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
+  int type;
+
+  if (!get_nonempty_numbers(stmt, memory, name, params, &value, &type))
+    return false;
+
+  *result = vector_min(value.types.l, type);
+
+  return true;
+}
+
+//
+// builtin_max
+//
+// max(xs): returns the largest item of a list of numbers. max()
+// of an empty list is an error.
+//
+static bool builtin_max(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
+  int type;
+
+  if (!get_nonempty_numbers(stmt, memory, name, params, &value, &type))
+    return false;
+
+  *result = vector_max(value.types.l, type);
+
+  return true;
+}
+
+//
+// get_number_lists
+//
+// Gets the two arguments of dot() or add(), returning the lists
+// via xs and ys and the types of their items via xtype and ytype.
+// Returns true if they're lists of numbers of the same length,
+// false if not (an error message is output before false is
+// returned).
+//
+static bool get_number_lists(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params,
+  struct RAM_LIST** xs, int* xtype, struct RAM_LIST** ys, int* ytype)
+{
+  struct RAM_VALUE value;
+  struct RAM_VALUE value2;
+
+  if (!get_element_value(stmt, memory, params, &value) ||
+      !get_element_value(stmt, memory, params->next, &value2))
+    return false;
+
+  if (!check_numbers(stmt, name, params, &value, xtype) ||
+      !check_numbers(stmt, name, params->next, &value2, ytype))
+    return false;
+
+  *xs = value.types.l;
+  *ys = value2.types.l;
+
+  if ((*xs)->length != (*ys)->length) {
+    output_printf("**EXECUTION ERROR: %s() of lists with different lengths (line %d)\n", name, stmt->line);
+    return false;
+  }
+
+  return true;
+}
+
+//
+// builtin_dot
+//
+// dot(xs, ys): returns the dot product of two lists of numbers of
+// the same length.
+//
+static bool builtin_dot(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_LIST* xs;
+  struct RAM_LIST* ys;
+  int xtype, ytype;
+
+  if (!get_number_lists(stmt, memory, name, params, &xs, &xtype, &ys, &ytype))
+    return false;
+
+  *result = vector_dot(xs, xtype, ys, ytype);
+
+  return true;
+}
+
+//
+// builtin_add
+//
+// add(xs, ys): returns a new list of the sums xs[i] + ys[i] of
+// two lists of numbers of the same length.
+//
+static bool builtin_add(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_LIST* xs;
+  struct RAM_LIST* ys;
+  int xtype, ytype;
+
+  if (!get_number_lists(stmt, memory, name, params, &xs, &xtype, &ys, &ytype))
+    return false;
+
+  struct RAM_LIST* sums = ram_list_create(memory, xs->length);
+
+  if (sums == NULL)
+    return out_of_memory(stmt, memory);
+
+  vector_add(xs, xtype, ys, ytype, sums);
+
+  result->value_type = RAM_TYPE_LIST;
+  result->types.l = sums;
+
+  return true;
+}
+
+//
+// builtin_scale
+//
+// scale(xs, k): returns a new list of the products xs[i] * k.
+//
+static bool builtin_scale(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE value;
+  struct RAM_VALUE value2;
+  int type;
+
+  if (!get_element_value(stmt, memory, params, &value) ||
+      !get_element_value(stmt, memory, params->next, &value2))
+    return false;
+
+  if (!check_numbers(stmt, name, params, &value, &type))
+    return false;
+
+  if (value2.value_type != RAM_TYPE_INT && value2.value_type != RAM_TYPE_REAL) {
+    output_printf("**SEMANTIC ERROR: invalid argument for %s() (line %d)\n", name, stmt->line);
+    return false;
+  }
+
+  struct RAM_LIST* products = ram_list_create(memory, value.types.l->length);
+
+  if (products == NULL)
+    return out_of_memory(stmt, memory);
+
+  vector_scale(value.types.l, type, value2, products);
+
+  result->value_type = RAM_TYPE_LIST;
+  result->types.l = products;
+
+  return true;
+}
+
+//
+// builtin_print
+//
+// print(x, y, ...): outputs the values of any # of elements, i.e.
+// identifiers or literals (or True, False, None), separated by
+// spaces and followed by a newline. Each value is output as soon
+// as it's found, so if one isn't, the ones before it are still
+// output.
+//
+static bool builtin_print(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  for (struct ELEMENT* param = params; param != NULL; param = param->next) {
+    struct RAM_VALUE value;
+
+    if (!get_element_value(stmt, memory, param, &value))
+      return false;
+
+    print_value(&value, 0);
+
+    if (param->next != NULL)
+      output_char(' ');
+  }
+
+  output_char('\n');
+
+  return true;
+}
+
+//
+// builtin_append
+//
+// append(xs, x): adds x to the end of the list xs.
+//
+static bool builtin_append(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM_VALUE list;
+  struct RAM_VALUE item;
+
+  if (!get_element_value(stmt, memory, params, &list))
+    return false;
+
+  if (list.value_type != RAM_TYPE_LIST) {
+    output_printf("**SEMANTIC ERROR: '%s' is not a list (line %d)\n", params->element_value, stmt->line);
+    return false;
+  }
+
+  if (!get_element_value(stmt, memory, params->next, &item))
+    return false;
+
+  if (!ram_list_append(memory, list.types.l, item))
+    return out_of_memory(stmt, memory);
+
+  return true;
+}
+
+//
+// The builtin functions, by id: the ones nuPython comes with,
+// then the native ones added by execute_register. Calls are
+// resolved to ids before execution (see execute_prepare), so a
+// call indexes this table rather than searching it by name. Once
+// a program has been prepared, no more natives can be added, so
+// the table never moves while programs run.
+//
+struct BUILTIN
+{
+  char* name;
+  int   num_args;  // -1 => any #
+  bool  (*function)(struct STMT* stmt, struct RAM* memory, char* name, struct ELEMENT* params, struct RAM_VALUE* result);
+  EXECUTE_NATIVE native;  // for a native builtin, NULL otherwise
+};
+
+static struct BUILTIN builtins[] =
+{
+  { "print",  -1, builtin_print,   NULL },
+  { "append",  2, builtin_append,  NULL },
+  { "input",   1, builtin_input,   NULL },
+  { "int",     1, builtin_int,     NULL },
+  { "float",   1, builtin_float,   NULL },
+  { "alloc",   1, builtin_alloc,   NULL },
+  { "len",     1, builtin_len,     NULL },
+  { "sum",     1, builtin_sum,     NULL },
+  { "min",     1, builtin_min,     NULL },
+  { "max",     1, builtin_max,     NULL },
+  { "dot",     2, builtin_dot,     NULL },
+  { "add",     2, builtin_add,     NULL },
+  { "scale",   2, builtin_scale,   NULL }
+};
+
+#define NUM_BUILTINS ((int)(sizeof(builtins) / sizeof(builtins[0])))
+
+static struct BUILTIN* natives = NULL;  // ids NUM_BUILTINS and up
+static int num_natives = 0;
+static int natives_capacity = 0;
+static atomic_bool natives_sealed = false;
+
+//
+// find_builtin
+//
+// Returns the id of the builtin function with the given name, or
+// -1 if there is none.
+//
+static int find_builtin(char* name)
+{
+  for (int id = 0; id < NUM_BUILTINS; id++) {
+    if (strcmp(builtins[id].name, name) == 0)
+      return id;
+  }
+
+  for (int i = 0; i < num_natives; i++) {
+    if (strcmp(natives[i].name, name) == 0)
+      return NUM_BUILTINS + i;
+  }
+
+  return -1;
+}
+
+//
+// resolve_builtins
+//
+// Resolves the calls of builtin functions in the given block of
+// statements, up to the given stop statement (the loop a body
+// links back to), to their ids. Calls of functions defined with
+// def were resolved when the program graph was built.
+//
+static void resolve_builtins(struct STMT* stmt, struct STMT* stop)
+{
+  while (stmt != NULL && stmt != stop) {
+    switch (stmt->stmt_type)
+    {
+      case STMT_ASSIGNMENT: {
+        struct VALUE* rhs = stmt->types.assignment->rhs;
+
+        if (rhs->value_type == VALUE_FUNCTION_CALL && rhs->types.function_call->function == NULL)
+          rhs->types.function_call->builtin = find_builtin(rhs->types.function_call->function_name);
+
+        stmt = stmt->types.assignment->next_stmt;
+        break;
+      }
+
+      case STMT_FUNCTION_CALL: {
+        struct STMT_FUNCTION_CALL* call = stmt->types.function_call;
+
+        if (call->function == NULL)
+          call->builtin = find_builtin(call->function_name);
+
+        stmt = call->next_stmt;
+        break;
+      }
+
+      case STMT_WHILE_LOOP:
+        resolve_builtins(stmt->types.while_loop->loop_body, stmt);
+        stmt = stmt->types.while_loop->next_stmt;
+        break;
+
+      case STMT_FOR_LOOP:
+        resolve_builtins(stmt->types.for_loop->loop_body, stmt);
+        stmt = stmt->types.for_loop->next_stmt;
+        break;
+
+      case STMT_FUNCTION_DEF:
+        resolve_builtins(stmt->types.function_def->body, NULL);
+        stmt = stmt->types.function_def->next_stmt;
+        break;
+
+      case STMT_RETURN:
+        stmt = stmt->types.return_stmt->next_stmt;
+        break;
+
+      case STMT_PASS:
+        stmt = stmt->types.pass->next_stmt;
+        break;
+
+      default:
+        return;  // if statements are not supported
+    }
+  }
+}
+
+//
+// call_native
+//
+// Calls the given native builtin with the values of the given
+// arguments, returning its result via the reference parameter.
+// Returns true if successful and false if not (an error message
+// is output before false is returned).
+//
+static bool call_native(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt, struct BUILTIN* builtin, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct RAM* memory = ctx->memory;
+  struct RAM_VALUE args[EXECUTE_MAX_ARGS];
+  int num_args = 0;
+
+  for (struct ELEMENT* param = params; param != NULL; param = param->next) {
+    if (num_args == EXECUTE_MAX_ARGS) {
+      output_printf("**SEMANTIC ERROR: %s() takes at most %d arguments (line %d)\n", builtin->name, EXECUTE_MAX_ARGS, stmt->line);
+      return false;
+    }
+
+    if (!get_element_value(stmt, memory, param, &args[num_args]))
+      return false;
+
+    num_args++;
+  }
+
+  return builtin->native(memory, ctx->native_data, args, num_args, result, stmt->line);
+}
+
+//
+// call_builtin
+//
+// Calls the builtin function with the given id, returning its
+// result via the reference parameter (None if it has none). 
+// Returns true if successful and false if not (an error message
+// is output before false is returned).
+//
+static bool call_builtin(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt, int id, struct ELEMENT* params, struct RAM_VALUE* result)
+{
+  struct BUILTIN* builtin = (id < NUM_BUILTINS) ? &builtins[id] : &natives[id - NUM_BUILTINS];
+
+  if (builtin->num_args >= 0) {
+    int num_args = 0;
+
+    for (struct ELEMENT* param = params; param != NULL; param = param->next)
+      num_args++;
+
+    if (num_args != builtin->num_args) {
+      if (builtin->num_args == 0)
+        output_printf("**SEMANTIC ERROR: %s() takes no arguments (line %d)\n", builtin->name, stmt->line);
+      else if (builtin->num_args == 1)
+        output_printf("**SEMANTIC ERROR: %s() takes exactly one argument (line %d)\n", builtin->name, stmt->line);
+      else if (builtin->num_args == 2)
+        output_printf("**SEMANTIC ERROR: %s() takes exactly two arguments (line %d)\n", builtin->name, stmt->line);
+      else
+        output_printf("**SEMANTIC ERROR: %s() takes exactly %d arguments (line %d)\n", builtin->name, builtin->num_args, stmt->line);
+      return false;
+    }
+  }
+
+  result->value_type = RAM_TYPE_NONE;
+  result->types.i = 0;
+
+  if (builtin->native != NULL)
+    return call_native(ctx, stmt, builtin, params, result);
+
+  return builtin->function(stmt, ctx->memory, builtin->name, params, result);
+}
+
+//
+// execute_function
+//
+// Given a function call in an assignment, calls the builtin
+// function and returns its result via the reference parameter;
+// returns true if successful and false if not (an error message
+// is output before false is returned).
+//
+// NOTE: a string, list or dict that is returned is owned by the
+// caller.
+//
+static bool execute_function(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt, struct VALUE_FUNCTION_CALL* function_call, struct RAM_VALUE* ram_value) 
+{
+  if (function_call->builtin < 0) {
+    output_printf("**EXECUTION ERROR: unexpected function (%s) in execute_function\n", function_call->function_name);
+    return false;
+  }
+
+  return call_builtin(ctx, stmt, function_call->builtin, function_call->parameter, ram_value);
+}
+
+//
+// execute_list
+//
+// Given a list literal [e1, e2, ...], creates a new list holding
+// the values of the elements and returns it via the reference 
+// parameter. Returns true if successful, false if not (an error 
+// message is output before false is returned).
+//
+// NOTE: the caller holds the one reference to the new list, and
+// must eventually let go of it (see release_value).
+//
+static bool execute_list(struct STMT* stmt, struct RAM* memory, struct VALUE_LIST* literal, struct RAM_VALUE* ram_value)
+{
+  int length = 0;
+
+  for (struct ELEMENT* e = literal->elements; e != NULL; e = e->next)
+    length++;
+
+  struct RAM_LIST* list = ram_list_create(memory, length);
+
+  if (list == NULL)
+    return out_of_memory(stmt, memory);
+
+  for (struct ELEMENT* e = literal->elements; e != NULL; e = e->next) {
+    struct RAM_VALUE item;
+
+    if (!get_element_value(stmt, memory, e, &item)) {
+      ram_list_release(memory, list);
+      return false;
+    }
+
+    if (!ram_list_append(memory, list, item)) {
+      out_of_memory(stmt, memory);
+      ram_list_release(memory, list);
+      return false;
+    }
+  }
+
+  ram_value->value_type = RAM_TYPE_LIST;
+  ram_value->types.l = list;
+
+  return true;
+}
+
+//
+// execute_dict
+//
+// Given a dict literal {k1: v1, k2: v2, ...}, creates a new dict
+// mapping the keys to the values and returns it via the reference
+// parameter. Returns true if successful, false if not (an error 
+// message is output before false is returned).
+//
+// NOTE: the caller holds the one reference to the new dict, and
+// must eventually let go of it (see release_value).
+//
+static bool execute_dict(struct STMT* stmt, struct RAM* memory, struct VALUE_DICT* literal, struct RAM_VALUE* ram_value)
+{
+  int length = 0;
+
+  for (struct ELEMENT* e = literal->keys; e != NULL; e = e->next)
+    length++;
+
+  struct RAM_DICT* dict = ram_dict_create(memory, length);
+
+  if (dict == NULL)
+    return out_of_memory(stmt, memory);
+
+  struct ELEMENT* k = literal->keys;
+  struct ELEMENT* v = literal->values;
+
+  for ( ; k != NULL; k = k->next, v = v->next) {
+    struct RAM_VALUE key;
+    struct RAM_VALUE value;
+
+    if (!get_element_value(stmt, memory, k, &key) || !check_key(stmt, &key) ||
+        !get_element_value(stmt, memory, v, &value)) {
+      ram_dict_release(memory, dict);
+      return false;
+    }
+
+    if (!ram_dict_put(memory, dict, key, value)) {
+      out_of_memory(stmt, memory);
+      ram_dict_release(memory, dict);
+      return false;
+    }
+  }
+
+  ram_value->value_type = RAM_TYPE_DICT;
+  ram_value->types.m = dict;
+
+  return true;
+}
+
+//
+// retain_value
+//
+// Adds a reference to a list or dict value, so it lives on even
+// if memory lets go of it; does nothing for other values.
+//
+static void retain_value(struct RAM_VALUE* value)
+{
+  if (value->value_type == RAM_TYPE_LIST)
+    ram_list_retain(value->types.l);
+  else if (value->value_type == RAM_TYPE_DICT)
+    ram_dict_retain(value->types.m);
+}
+
+//
+// release_value
+//
+// Lets go of a value the executor created rather than borrowed
+// from memory: a string from concatenation or input(), or a new
+// list or dict.
+//
+static void release_value(struct RAM* memory, struct RAM_VALUE* value)
+{
+  if (value->value_type == RAM_TYPE_STR)
+    free(value->types.s);
+  else if (value->value_type == RAM_TYPE_LIST)
+    ram_list_release(memory, value->types.l);
+  else if (value->value_type == RAM_TYPE_DICT)
+    ram_dict_release(memory, value->types.m);
+}
+
+//
+// write_slot
+//
+// Writes the given value to a frame slot, which keeps its own copy
+// of a string and its own reference to a list or dict, the way a
+// memory cell does.
+//
+static void write_slot(struct RAM* memory, struct RAM_VALUE* slot, struct RAM_VALUE value)
+{
+  struct RAM_VALUE old_value = *slot;
+
+  *slot = value;
+
+  if (value.value_type == RAM_TYPE_STR)
+    slot->types.s = dupString(value.types.s);
+  else
+    retain_value(slot);
+
+  release_value(memory, &old_value);
+}
+
+//
+// release_slots
+//
+// Lets go of the values in the given # of frame slots.
+//
+static void release_slots(struct RAM* memory, struct RAM_VALUE* slots, int num_slots)
+{
+  for (int i = 0; i < num_slots; i++)
+    release_value(memory, &slots[i]);
+}
+
+//
+// write_variable
+//
+// Writes the given value to the given variable --- its slot in the
+// current frame if it's local (slot >= 0) --- returning true if
+// successful and false if not. The only way a write can fail
+// is by exceeding the memory's limit (see ram_set_limit), in 
+// which case an error message is output.
+//
+static bool write_variable(struct STMT* stmt, struct RAM* memory, struct RAM_VALUE value, char* var_name, int slot)
+{
+  if (slot >= 0) {
+    write_slot(memory, &frame[slot], value);
+    return true;
+  }
+
+  if (ram_write_cell_by_id(memory, value, var_name))
+    return true;
+
+  return out_of_memory(stmt, memory);
+}
+
+//
+// write_through_pointer
+//
+// Writes the given value to the memory cell the pointer variable
+// ptr_name points to (*p = value), returning true if successful
+// and false if not. An error message is output before false is
+// returned.
+//
+static bool write_through_pointer(struct STMT* stmt, struct RAM* memory, struct RAM_VALUE value, char* ptr_name, int slot)
+{
+  const struct RAM_VALUE* cell_value = get_variable(stmt, memory, ptr_name, slot);
+
+  if (cell_value == NULL)
+    return false;
+
+  struct RAM_VALUE ptr = *cell_value;
+  int address = get_pointer_target(stmt, memory, &ptr, ptr_name);
+
+  if (address < 0)
+    return false;
+
+  if (ram_write_cell_by_addr(memory, value, address))
+    return true;
+
+  return out_of_memory(stmt, memory);
+}
+
+//
+// write_item
+//
+// Writes the given value to an item of the list or dict variable
+// name (xs[i] = value or d[k] = value), returning true if 
+// successful and false if not. An error message is output before
+// false is returned.
+//
+static bool write_item(struct STMT* stmt, struct RAM* memory, struct RAM_VALUE value, char* name, int slot, struct ELEMENT* index_element)
+{
+  const struct RAM_VALUE* cell_value = get_variable(stmt, memory, name, slot);
+
+  if (cell_value == NULL)
+    return false;
+
+  struct RAM_VALUE container = *cell_value;
+
+  if (container.value_type != RAM_TYPE_LIST && container.value_type != RAM_TYPE_DICT) {
+    output_printf("**SEMANTIC ERROR: '%s' is not a list or dict (line %d)\n", name, stmt->line);
+    return false;
+  }
+
+  struct RAM_VALUE index;
+
+  if (!get_element_value(stmt, memory, index_element, &index))
+    return false;
+
+  bool success;
+
+  if (container.value_type == RAM_TYPE_LIST) {
+    int position = get_list_index(stmt, container.types.l, &index);
+    if (position < 0)
+      return false;
+
+    success = ram_list_write(memory, container.types.l, position, value);
+  }
+  else {
+    if (!check_key(stmt, &index))
+      return false;
+
+    success = ram_dict_put(memory, container.types.m, index, value);
+  }
+
+  if (success)
+    return true;
+
+  return out_of_memory(stmt, memory);
+}
+
+//
+// execute_expr
+//
+// Evaluates the given expression, returning its value via the
+// reference parameter. A string created by concatenation is ours
+// to free, in which case *owns_value is set to true; otherwise
+// the value may borrow from memory (see get_element_value).
+// Returns true if successful and false if not (an error message
+// is output before false is returned).
+//
+static bool execute_expr(struct STMT* stmt, struct RAM* memory, struct VALUE_EXPR* expr, struct RAM_VALUE* value, bool* owns_value)
+{
+  *owns_value = false;
+
+  //
+  // we always have a LHS:
+  //
+  assert(expr->lhs != NULL);
+
+  if (!get_unary_value(stmt, memory, expr->lhs, value))  // semantic error? If so, return now:
+    return false;
+
+  //
+  // do we have a binary expression?
+  //
+  if (expr->isBinaryExpr)
+  {
+    assert(expr->rhs != NULL);  // we must have a RHS
+    assert(expr->operator != OPERATOR_NO_OP);  // we must have an operator
+
+    struct RAM_VALUE rhs_value;
+
+    if (!get_unary_value(stmt, memory, expr->rhs, &rhs_value)) {  // semantic error? If so, return now:
+      return false;
+    }
+    //
+    // perform the operation, updating value:
+    //
+    bool success = execute_typed_binary_expr(stmt, memory, expr, value, rhs_value);
+
+    if (!success) {
+      return false;
+    }
+
+    *owns_value = (value->value_type == RAM_TYPE_STR);  // concatenation
+  }
+
+  return true;
+}
+
+//
+// write_target
+//
+// Writes the given value to the target of the given assignment
+// statement: a variable x, *p or an item xs[i]. Returns true if
+// successful and false if not (an error message is output before
+// false is returned).
+//
+static bool write_target(struct STMT* stmt, struct RAM* memory, struct RAM_VALUE value)
+{
+  struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+
+  if (assign->isPtrDeref)
+    return write_through_pointer(stmt, memory, value, assign->var_name, assign->var_slot);
+  else if (assign->index != NULL)
+    return write_item(stmt, memory, value, assign->var_name, assign->var_slot, assign->index);
+  else
+    return write_variable(stmt, memory, value, assign->var_name, assign->var_slot);
+}
+
+//
+// execute_assignment
+//
+// Executes an assignment statement, returning true if 
+// successful and false if not (an error message will be
+// output before false is returned, so the caller doesn't
+// need to output anything).
+// 
+// Examples: x = 123
+//           y = x ** 2
+//           *p = y
+//           xs = [1, 2, 3]
+//           xs[i] = y
+//           d = {'a': 1}
+//           d['b'] = y
+//
+static bool execute_assignment(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt)
+{
+  struct RAM* memory = ctx->memory;
+  struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+
+  struct RAM_VALUE value;
+  bool owns_value = false;  // true => value is ours to release
+
+  if (assign->rhs->value_type == VALUE_EXPR) {
+    if (!execute_expr(stmt, memory, assign->rhs->types.expr, &value, &owns_value))
+      return false;
+  }
+  else if (assign->rhs->value_type == VALUE_LIST) {
+    if (!execute_list(stmt, memory, assign->rhs->types.list, &value))
+      return false;
+
+    owns_value = true;
+  }
+  else if (assign->rhs->value_type == VALUE_DICT) {
+    if (!execute_dict(stmt, memory, assign->rhs->types.dict, &value))
+      return false;
+
+    owns_value = true;
+  }
+  else {
+    assert(assign->rhs->value_type == VALUE_FUNCTION_CALL);
+
+    struct VALUE_FUNCTION_CALL* function_call = assign->rhs->types.function_call;
+
+    if (!execute_function(ctx, stmt, function_call, &value))
+      return false;
+
+    owns_value = (value.value_type == RAM_TYPE_STR ||   // input()
+                  value.value_type == RAM_TYPE_LIST ||  // add(), scale()
+                  value.value_type == RAM_TYPE_DICT);   // native builtins
+  }
+
+  //
+  // memory keeps its own copy of strings, and its own
+  // reference to lists and dicts:
+  //
+  bool success = write_target(stmt, memory, value);
+
+  if (owns_value)
+    release_value(memory, &value);
+
+  return success;
+}
+
+
+//
+// print_value
+//
+// Outputs the given value the way print() shows it. The items
+// of a list or dict are shown the way Python does, e.g. 
+// [1, 'two', 3.0] or {'one': 1}, so strings inside are quoted; a
+// list nested too deeply (say, one that contains itself) is shown
+// as [...].
+//
+static void print_value(struct RAM_VALUE* value, int depth)
+{
+  switch (value->value_type)
+  {
+    case RAM_TYPE_INT:
+    case RAM_TYPE_PTR:  // the address
+      output_int(value->types.i);
+      break;
+
+    case RAM_TYPE_REAL:
+      output_real(value->types.d);
+      break;
+
+    case RAM_TYPE_STR:
+      if (depth > 0) {
+        output_char('\'');
+        output_string(value->types.s);
+        output_char('\'');
+      }
+      else
+        output_string(value->types.s);
+      break;
+
+    case RAM_TYPE_BOOLEAN:
+      output_string(value->types.i ? "True" : "False");
+      break;
+
+    case RAM_TYPE_NONE:
+      output_string("None");
+      break;
+
+    case RAM_TYPE_LIST: {
+      struct RAM_LIST* list = value->types.l;
+
+      if (depth >= 16) {
+        output_string("[...]");
+        break;
+      }
+
+      output_char('[');
+      for (int i = 0; i < list->length; i++) {
+        if (i > 0)
+          output_string(", ");
+        print_value(&list->items[i], depth + 1);
+      }
+      output_char(']');
+      break;
+    }
+
+    case RAM_TYPE_DICT: {
+      struct RAM_DICT* dict = value->types.m;
+
+      if (depth >= 16) {
+        output_string("{...}");
+        break;
+      }
+
+      output_char('{');
+      for (int i = 0; i < dict->length; i++) {
+        if (i > 0)
+          output_string(", ");
+        print_value(&dict->entries[i].key, depth + 1);
+        output_string(": ");
+        print_value(&dict->entries[i].value, depth + 1);
+      }
+      output_char('}');
+      break;
+    }
+  }
+}
+
+//
+// execute_function_call
+//
+// Executes a function call statement, returning true if 
+// successful and false if not (an error message will be
+// output before false is returned, so the caller doesn't
+// need to output anything). The builtin's result, if any,
+// is discarded.
+// 
+// Examples: print()
+//           print(x)
+//           print(123)
+//           print(x, y)
+//           append(xs, x)
+//
+static bool execute_function_call(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt)
+{
+  struct RAM* memory = ctx->memory;
+  struct STMT_FUNCTION_CALL* call = stmt->types.function_call;
+
+  if (call->builtin < 0) {
+    output_printf("**EXECUTION ERROR: unexpected function (%s) in execute_function_call\n", call->function_name);
+    return false;
+  }
+
+  struct RAM_VALUE result;
+
+  if (!call_builtin(ctx, stmt, call->builtin, call->parameter, &result))
+    return false;
+
+  release_value(memory, &result);
+
+  return true;
+}
+
+//
+// execute_condition
+//
+// Given a statement, memory, and a while loop or if condition, extracts the lhs,
+// rhs, and operator of a condition. It executes the condition and returns the
+// resulting value via the reference parameter. Returns true if successful, false
+// if an error occurred.
+//
+static bool execute_condition(struct STMT* stmt, struct RAM* memory, struct VALUE_EXPR* condition, struct RAM_VALUE* value) {
+  if (!get_unary_value(stmt, memory, condition->lhs, value))
+    return false;
+
+  assert(condition->rhs != NULL);  
+  assert(condition->operator != OPERATOR_NO_OP); 
+
+  struct RAM_VALUE rhs_value;
+
+  if (!get_unary_value(stmt, memory, condition->rhs, &rhs_value)) 
+    return false;
+
+  if (!execute_typed_binary_expr(stmt, memory, condition, value, rhs_value))
+    return false;
+
+  //
+  // a condition like s1 + s2 creates a string we don't need:
+  //
+  if (value->value_type == RAM_TYPE_STR)
+    free(value->types.s);
+
+  return true;
+}
 
 //
-// execute_function_call
+// execute_for_loop
 //
-// Executes a function call statement, returning true if 
-// successful and false if not (an error message will be
-// output before false is returned, so the caller doesn't
-// need to output anything).
-// 
-// Examples: print()
-//           print(x)
-//           print(123)
+// Executes one step of a for loop: assigns the next item of the
+// list (or key of the dict) to the loop variable and returns the
+// loop body via the reference parameter, or the statement after
+// the loop once the list is exhausted. Returns true if successful and false if not
+// (an error message is output before false is returned).
 //
-static bool execute_function_call(struct STMT* stmt, struct RAM* memory)
+// The body links back to the loop, so a for loop is reached both
+// when it starts and after each pass through its body; it has
+// started if its iterator is on top of the context's stack, above
+// the loops underway when the current function was called (the
+// same loop may be underway in a recursive call further down).
+//
+static bool execute_for_loop(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt, struct STMT** next)
 {
-  struct STMT_FUNCTION_CALL* call = stmt->types.function_call;
+  struct STMT_FOR_LOOP* for_loop = stmt->types.for_loop;
+  struct RAM* memory = ctx->memory;
+
+  int first = (ctx->num_frames == 0) ? 0 : ctx->frames[ctx->num_frames - 1].num_iterators;
+
+  if (ctx->num_iterators == first || ctx->iterators[ctx->num_iterators - 1].loop != stmt) {
+    //
+    // starting the loop:
+    //
+    struct RAM_VALUE value;
+
+    if (!get_element_value(stmt, memory, for_loop->iterable, &value))
+      return false;
+
+    if (value.value_type != RAM_TYPE_LIST && value.value_type != RAM_TYPE_DICT) {
+      output_printf("**SEMANTIC ERROR: '%s' is not a list or dict (line %d)\n", for_loop->iterable->element_value, stmt->line);
+      return false;
+    }
+
+    if (ctx->num_iterators == ctx->iterators_capacity) {
+      int capacity = (ctx->iterators_capacity == 0) ? 4 : 2 * ctx->iterators_capacity;
+      struct EXECUTE_ITERATOR* iterators = (struct EXECUTE_ITERATOR*)realloc(ctx->iterators, sizeof(struct EXECUTE_ITERATOR) * capacity);
+
+      if (iterators == NULL) {
+        output_printf("**EXECUTION ERROR: out of memory (line %d)\n", stmt->line);
+        return false;
+      }
+
+      ctx->iterators = iterators;
+      ctx->iterators_capacity = capacity;
+    }
+
+    struct EXECUTE_ITERATOR* iterator = &ctx->iterators[ctx->num_iterators];
+
+    iterator->loop = stmt;
+    iterator->iterable = value;
+    iterator->position = 0;
+
+    retain_value(&iterator->iterable);
+    ctx->num_iterators++;
+  }
+
+  struct EXECUTE_ITERATOR* iterator = &ctx->iterators[ctx->num_iterators - 1];
+  struct RAM_VALUE* iterable = &iterator->iterable;
 
   //
-  // for now we are assuming it's a call to print:
+  // the body may add to the list or dict, so check the length
+  // every time:
   //
-  char* function_name = call->function_name;
+  int length = (iterable->value_type == RAM_TYPE_LIST) ? iterable->types.l->length : iterable->types.m->length;
+
+  if (iterator->position >= length) {
+    release_value(memory, iterable);
+    ctx->num_iterators--;
+
+    *next = for_loop->next_stmt;
+    return true;
+  }
+
+  struct RAM_VALUE item;
+
+  if (iterable->value_type == RAM_TYPE_LIST)
+    item = iterable->types.l->items[iterator->position];
+  else
+    item = iterable->types.m->entries[iterator->position].key;
+
+  iterator->position++;
+
+  *next = for_loop->loop_body;
+
+  return write_variable(stmt, memory, item, for_loop->var_name, for_loop->var_slot);
+}
+
+//
+// call_function
+//
+// Calls the given user-defined function from the given statement
+// (an assignment or function call statement), with the given
+// arguments: a frame for the function's locals is pushed, the
+// arguments are copied to the parameters' slots, and the first
+// statement of the body is returned via next. Returns true if
+// successful and false if not (an error message is output before
+// false is returned).
+//
+// The frames and slots are reused from call to call, so once
+// they've grown deep enough a call allocates nothing.
+//
+static bool call_function(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt, struct STMT_FUNCTION_DEF* function, struct ELEMENT* args, struct STMT** next)
+{
+  struct RAM* memory = ctx->memory;
+  int num_args = 0;
+
+  for (struct ELEMENT* arg = args; arg != NULL; arg = arg->next)
+    num_args++;
+
+  if (num_args != function->num_params) {
+    output_printf("**SEMANTIC ERROR: %s() takes %d argument(s) but %d were given (line %d)\n", function->function_name, function->num_params, num_args, stmt->line);
+    return false;
+  }
+
+  if (ctx->num_frames == MAX_CALL_DEPTH) {
+    output_printf("**EXECUTION ERROR: maximum recursion depth exceeded (line %d)\n", stmt->line);
+    return false;
+  }
 
-  if (strcmp(function_name, "print") == 0){
-    if (call->parameter == NULL) {
-      printf("\n");
+  if (ctx->num_frames == ctx->frames_capacity) {
+    int capacity = (ctx->frames_capacity == 0) ? 16 : 2 * ctx->frames_capacity;
+    struct EXECUTE_FRAME* frames = (struct EXECUTE_FRAME*)realloc(ctx->frames, sizeof(struct EXECUTE_FRAME) * capacity);
+
+    if (frames == NULL) {
+      output_printf("**EXECUTION ERROR: out of memory (line %d)\n", stmt->line);
+      return false;
     }
-    else {
-      //
-      // we have a parameter, which type of parameter?
-      // Note that a parameter is a simple element, i.e.
-      // identifier or literal (or True, False, None):
-      //
-      char* element_value = call->parameter->element_value;
 
-      if (call->parameter->element_type == ELEMENT_STR_LITERAL) {
-        printf("%s\n", element_value);
-      }
-      else {
-        //
-        // right now we are assuming ints or variables containing
-        // ints, so call our get_element function to obtain the
-        // integer value:
-        struct RAM_VALUE ram_value;
-        struct RAM_VALUE* value = get_element_value(stmt, memory, call->parameter, &ram_value);
-
-        if (value == NULL)
-          return false;
+    ctx->frames = frames;
+    ctx->frames_capacity = capacity;
+  }
 
-        int element_type = call->parameter->element_type;
-        if (element_type == ELEMENT_IDENTIFIER) 
-          value = ram_read_cell_by_id(memory, call->parameter->element_value);
-        if (value->value_type == RAM_TYPE_INT) 
-          printf("%d\n", value->types.i);
-        else if (value->value_type == RAM_TYPE_REAL) 
-          printf("%lf\n", value->types.d);
-        else if (value->value_type == RAM_TYPE_STR) 
-          printf("%s\n", value->types.s);
-        else if (value->value_type == RAM_TYPE_BOOLEAN) 
-          printf("%s\n",value->types.i?"True":"False");
-      }
-    }//else
+  if (ctx->num_slots + function->num_locals > ctx->slots_capacity) {
+    int capacity = (ctx->slots_capacity == 0) ? 64 : 2 * ctx->slots_capacity;
+
+    while (capacity < ctx->num_slots + function->num_locals)
+      capacity *= 2;
+
+    struct RAM_VALUE* slots = (struct RAM_VALUE*)realloc(ctx->slots, sizeof(struct RAM_VALUE) * capacity);
+
+    if (slots == NULL) {
+      output_printf("**EXECUTION ERROR: out of memory (line %d)\n", stmt->line);
+      return false;
+    }
+
+    ctx->slots = slots;
+    ctx->slots_capacity = capacity;
+
+    //
+    // the caller's frame may have moved:
+    //
+    if (ctx->num_frames > 0)
+      frame = ctx->slots + ctx->frames[ctx->num_frames - 1].base;
   }
-  else return false;
 
+  int base = ctx->num_slots;
+  struct RAM_VALUE* slots = ctx->slots + base;
+
+  for (int i = 0; i < function->num_locals; i++) {
+    slots[i].value_type = UNASSIGNED;
+    slots[i].types.i = 0;
+  }
+
+  //
+  // the arguments are evaluated in the caller's frame:
+  //
+  struct ELEMENT* param = function->parameters;
+
+  for (struct ELEMENT* arg = args; arg != NULL; arg = arg->next, param = param->next) {
+    struct RAM_VALUE value;
+
+    if (!get_element_value(stmt, memory, arg, &value)) {
+      release_slots(memory, slots, function->num_locals);
+      return false;
+    }
+
+    write_slot(memory, &slots[param->slot], value);
+  }
+
+  struct EXECUTE_FRAME* callee = &ctx->frames[ctx->num_frames++];
+
+  callee->function = function;
+  callee->call = stmt;
+  callee->base = base;
+  callee->num_iterators = ctx->num_iterators;
+
+  ctx->num_slots += function->num_locals;
+  frame = slots;
+
+  *next = function->body;
   return true;
 }
 
 //
-// execute_condition
+// return_from_function
 //
-// Given a statement, memory, and a while loop condition, extracts the lhs, rhs,
-// and operator of a condition. It executes the condition and returns NULL if
-// the condition is no longer true.
+// Returns the given value from the innermost function call, 
+// taking ownership of the value: the function's frame is popped,
+// along with any for loops it left underway, and the value is
+// written to the target of the call if it was an assignment. The
+// statement after the call is returned via next. Returns true if
+// successful and false if not (an error message is output before
+// false is returned).
 //
-static struct RAM_VALUE* execute_condition(struct STMT* stmt, struct RAM* memory, struct VALUE_EXPR* condition, struct RAM_VALUE* value) {
-  value = get_unary_value(stmt, memory, condition->lhs);
-  
-  if (value == NULL)  
-    return NULL;
+static bool return_from_function(struct EXECUTE_CONTEXT* ctx, struct RAM_VALUE result, struct STMT** next)
+{
+  struct RAM* memory = ctx->memory;
+  struct EXECUTE_FRAME* callee = &ctx->frames[--ctx->num_frames];
 
-  assert(condition->rhs != NULL);  
-  assert(condition->operator != OPERATOR_NO_OP); 
+  release_slots(memory, ctx->slots + callee->base, ctx->num_slots - callee->base);
+  ctx->num_slots = callee->base;
 
-  struct RAM_VALUE* rhs_value = get_unary_value(stmt, memory, condition->rhs);
+  while (ctx->num_iterators > callee->num_iterators)
+    release_value(memory, &ctx->iterators[--ctx->num_iterators].iterable);
 
-  if (rhs_value == NULL) 
-    return NULL;
+  frame = (ctx->num_frames == 0) ? NULL : ctx->slots + ctx->frames[ctx->num_frames - 1].base;
 
-  bool success = execute_binary_expr(stmt, value, condition->operator, *rhs_value);
-  if (!success)
-    return NULL;
+  struct STMT* call = callee->call;
+  bool success = true;
+
+  if (call->stmt_type == STMT_ASSIGNMENT) {
+    *next = call->types.assignment->next_stmt;
+    success = write_target(call, memory, result);
+  }
+  else {
+    *next = call->types.function_call->next_stmt;
+  }
+
+  release_value(memory, &result);
 
-  return value;
+  return success;
 }
 
 //
-// execute_while_loop
-// 
-// Executes a while loop, returning true if 
-// successful and false if not (an error message will be
-// output before false is returned, so the caller doesn't
-// need to output anything).
+// execute_return
 //
-// Example:
-// while //condition:
-// {
-//  //code
-// }
-//
-static bool execute_while_loop(struct STMT* stmt, struct RAM* memory) {
-  struct STMT_WHILE_LOOP* while_loop = stmt->types.while_loop;
-  struct VALUE_EXPR* condition = while_loop->condition;
-  
-  struct STMT* body = while_loop->loop_body;
-  struct RAM_VALUE value; 
-  struct RAM_VALUE* ram_value = execute_condition(stmt, memory, condition, &value);
-
-  while ((ram_value != NULL) && ram_value->types.i) {
-    body = while_loop->loop_body;
-    while (body->types.while_loop->condition != condition)
-    {
-      if (body->stmt_type == STMT_ASSIGNMENT) {
-        bool success = execute_assignment(body, memory);
-        if (!success)
-          return false;
-        
-        body = body->types.assignment->next_stmt;
-      }
-      else if (body->stmt_type == STMT_FUNCTION_CALL) {
-        bool success = execute_function_call(body, memory);
-        if (!success)
-          return false;
-        
-        body = body->types.function_call->next_stmt;
-      }
-      else if (body->stmt_type == STMT_WHILE_LOOP) {
-        bool success = execute_while_loop(body, memory);
-        if (!success)
-          return false;
+// Executes a return statement, returning from the function with
+// the value of its expression (None if there is none), and 
+// returns the statement after the call via next. Returns true if
+// successful and false if not (an error message is output before
+// false is returned).
+//
+static bool execute_return(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt, struct STMT** next)
+{
+  struct VALUE_EXPR* expr = stmt->types.return_stmt->value;
+  struct RAM_VALUE result;
 
-        body = body->types.while_loop->next_stmt;
-      }
-      else if (body->stmt_type == STMT_PASS)
-        body = body->types.pass->next_stmt;
-      else 
-        return false;
+  if (expr == NULL) {
+    result.value_type = RAM_TYPE_NONE;
+    result.types.i = 0;
+  }
+  else {
+    bool owns_value;
+
+    if (!execute_expr(stmt, ctx->memory, expr, &result, &owns_value))
+      return false;
+
+    //
+    // the value may borrow from the frame that's about to go, 
+    // so we need our own copy or reference:
+    //
+    if (!owns_value) {
+      if (result.value_type == RAM_TYPE_STR)
+        result.types.s = dupString(result.types.s);
+      else
+        retain_value(&result);
     }
-    ram_value = execute_condition(stmt, memory, condition, &value);
   }
-  if (ram_value == NULL) 
-    return false;
 
-  return true;
+  return return_from_function(ctx, result, next);
+}
+
+//
+// execute_stmt
+//
+// Executes the given statement and returns, via the reference
+// parameter, the statement to execute next (NULL at the end of
+// the program). Returns true if successful and false if not (an
+// error message will be output before false is returned).
+//
+// Loops and conditionals don't recurse: the program graph links
+// the last statement of a loop body back to its loop, and the
+// end of each if/else path to the statement after the if. So a
+// while loop just tests its condition and picks either the body
+// or the statement after the loop, and the caller's single
+// dispatch loop does the rest --- no matter how deep the nesting.
+// Calls of user-defined functions work the same way: a call
+// pushes a frame and continues with the function's body, and a
+// return pops it and continues after the call.
+//
+static bool execute_stmt(struct EXECUTE_CONTEXT* ctx, struct STMT* stmt, struct STMT** next)
+{
+  struct RAM* memory = ctx->memory;
+
+  switch (stmt->stmt_type)
+  {
+    case STMT_ASSIGNMENT: {
+      struct VALUE* rhs = stmt->types.assignment->rhs;
+
+      if (rhs->value_type == VALUE_FUNCTION_CALL && rhs->types.function_call->function != NULL)
+        return call_function(ctx, stmt, rhs->types.function_call->function, rhs->types.function_call->parameter, next);
+
+      *next = stmt->types.assignment->next_stmt;
+      return execute_assignment(ctx, stmt);
+    }
+
+    case STMT_FUNCTION_CALL: {
+      struct STMT_FUNCTION_CALL* call = stmt->types.function_call;
+
+      if (call->function != NULL)
+        return call_function(ctx, stmt, call->function, call->parameter, next);
+
+      *next = call->next_stmt;
+      return execute_function_call(ctx, stmt);
+    }
+
+    case STMT_WHILE_LOOP: {
+      struct STMT_WHILE_LOOP* while_loop = stmt->types.while_loop;
+      struct RAM_VALUE value;
+
+      if (!execute_condition(stmt, memory, while_loop->condition, &value))
+        return false;
+
+      *next = value.types.i ? while_loop->loop_body : while_loop->next_stmt;
+      return true;
+    }
+
+    case STMT_FOR_LOOP:
+      return execute_for_loop(ctx, stmt, next);
+
+    case STMT_IF_THEN_ELSE: {
+      struct STMT_IF_THEN_ELSE* if_then_else = stmt->types.if_then_else;
+      struct RAM_VALUE value;
+
+      if (!execute_condition(stmt, memory, if_then_else->condition, &value))
+        return false;
+
+      *next = value.types.i ? if_then_else->true_path : if_then_else->false_path;
+      return true;
+    }
+
+    case STMT_PASS:
+      //
+      // nothing to do!
+      //
+      *next = stmt->types.pass->next_stmt;
+      return true;
+
+    case STMT_FUNCTION_DEF:
+      //
+      // nothing to do either, since calls were linked to their 
+      // functions when the program graph was built:
+      //
+      *next = stmt->types.function_def->next_stmt;
+      return true;
+
+    case STMT_RETURN:
+      return execute_return(ctx, stmt, next);
+
+    default:
+      output_printf("**EXECUTION ERROR: unexpected statement type (%d) in execute_stmt\n", stmt->stmt_type);
+      return false;
+  }
 }
 
 //
@@ -587,55 +2301,221 @@ static bool execute_while_loop(struct STMT* stmt, struct RAM* memory) {
 // an error message is output, execution stops,
 // and the function returns.
 //
-void execute(struct STMT* program, struct RAM* memory)
+void execute(struct STMT* program, struct RAM* memory, void* native_data)
 {
-  struct STMT* stmt = program;
+  struct EXECUTE_CONTEXT* ctx = execute_init(program, memory, native_data);
 
-  //
-  // traverse through the program statements:
-  //
-  while (stmt != NULL) {
+  while (execute_step(ctx, LLONG_MAX) == EXECUTE_RUNNING)
+    ;
 
-    if (stmt->stmt_type == STMT_ASSIGNMENT) {
+  execute_destroy(ctx);
+}
 
-      bool success = execute_assignment(stmt, memory);
+//
+// execute_prepare
+//
+// Resolves the calls of builtin functions in the given program,
+// and seals the table of builtins; see execute.h.
+//
+void execute_prepare(struct STMT* program)
+{
+  atomic_store(&natives_sealed, true);
 
-      if (!success)
-        return;
+  resolve_builtins(program, NULL);
+}
 
-      stmt = stmt->types.assignment->next_stmt;  // advance
-    }
-    else if (stmt->stmt_type == STMT_FUNCTION_CALL) {
+//
+// execute_init
+//
+// Returns a pointer to a dynamically-allocated execution context
+// for running the given program against the given memory, 
+// positioned at the first statement.
+//
+struct EXECUTE_CONTEXT* execute_init(struct STMT* program, struct RAM* memory, void* native_data)
+{
+  struct EXECUTE_CONTEXT* ctx = (struct EXECUTE_CONTEXT*)malloc(sizeof(struct EXECUTE_CONTEXT));
+  if (ctx == NULL) {
+    output_printf("**EXECUTION ERROR: out of memory (execute_init)\n");
+    return NULL;
+  }
 
-      bool success = execute_function_call(stmt, memory);
+  ctx->program = program;
+  ctx->memory = memory;
+  ctx->next_stmt = program;
+  ctx->steps = 0;
+  ctx->status = (program == NULL) ? EXECUTE_DONE : EXECUTE_RUNNING;
+  ctx->jit = jit_enabled ? jit_init(memory) : NULL;
+  ctx->native_data = native_data;
 
-      if (!success)
-        return;
+  ctx->iterators = NULL;
+  ctx->num_iterators = 0;
+  ctx->iterators_capacity = 0;
 
-      stmt = stmt->types.function_call->next_stmt;
-    }
-    else if (stmt->stmt_type == STMT_WHILE_LOOP) {
-      bool success = execute_while_loop(stmt, memory);
+  ctx->frames = NULL;
+  ctx->num_frames = 0;
+  ctx->frames_capacity = 0;
 
-      if (!success)
-        return;
+  ctx->slots = NULL;
+  ctx->num_slots = 0;
+  ctx->slots_capacity = 0;
 
-      stmt = stmt->types.while_loop->next_stmt;
-    }
-    else {
-      assert(stmt->stmt_type == STMT_PASS);
+  return ctx;
+}
+
+//
+// execute_step
+//
+// Executes at most max_steps statements, resuming where the
+// previous call left off, and returns the resulting status.
+//
+int execute_step(struct EXECUTE_CONTEXT* ctx, long long max_steps)
+{
+  if (ctx == NULL)
+    return EXECUTE_ERROR;
+
+  if (ctx->status != EXECUTE_RUNNING)
+    return ctx->status;
+
+  struct STMT* stmt = ctx->next_stmt;
+  long long    steps = 0;
+
+  frame = (ctx->num_frames == 0) ? NULL : ctx->slots + ctx->frames[ctx->num_frames - 1].base;
+
+  //
+  // traverse through the program statements, until we 
+  // finish or run out of budget:
+  //
+  while (steps < max_steps) {
+    if (stmt == NULL) {
+      if (ctx->num_frames == 0)  // end of the program
+        break;
 
       //
-      // nothing to do!
+      // end of a function body, which returns None:
       //
+      struct RAM_VALUE none;
+      none.value_type = RAM_TYPE_NONE;
+      none.types.i = 0;
+
+      if (!return_from_function(ctx, none, &stmt)) {
+        ctx->status = EXECUTE_ERROR;
+        break;
+      }
+
+      continue;
+    }
+
+    //
+    // hot while loops may run natively:
+    //
+    if (ctx->jit != NULL && stmt->stmt_type == STMT_WHILE_LOOP) {
+      long long jit_steps;
+      int result = jit_run_loop(ctx->jit, stmt, max_steps - steps, &jit_steps);
+
+      steps += jit_steps;
+
+      if (result == JIT_LOOP_DONE) {
+        stmt = stmt->types.while_loop->next_stmt;
+        continue;
+      }
+      else if (result == JIT_OUT_OF_STEPS) {
+        continue;  // resume at the top of the loop
+      }
+    }
+
+    steps++;
 
-      stmt = stmt->types.pass->next_stmt;
+    if (!execute_stmt(ctx, stmt, &stmt)) {
+      ctx->status = EXECUTE_ERROR;
+      break;
     }
   }//while
-  
+
+  ctx->next_stmt = stmt;
+  ctx->steps += steps;
+
+  if (ctx->status == EXECUTE_RUNNING && stmt == NULL && ctx->num_frames == 0)
+    ctx->status = EXECUTE_DONE;
+
   //
-  // done:
+  // done? Then make sure the output is out:
   //
-  
-  return;
-}
\ No newline at end of file
+  if (ctx->status != EXECUTE_RUNNING)
+    output_flush();
+
+  return ctx->status;
+}
+
+//
+// execute_destroy
+//
+// Frees the given execution context.
+//
+void execute_destroy(struct EXECUTE_CONTEXT* ctx)
+{
+  if (ctx == NULL)
+    return;
+
+  jit_destroy(ctx->jit);
+
+  for (int i = 0; i < ctx->num_iterators; i++)
+    release_value(ctx->memory, &ctx->iterators[i].iterable);
+
+  release_slots(ctx->memory, ctx->slots, ctx->num_slots);
+
+  free(ctx->iterators);
+  free(ctx->frames);
+  free(ctx->slots);
+  free(ctx);
+}
+
+//
+// execute_set_jit
+//
+// Turns the JIT on or off for contexts created from now on.
+//
+void execute_set_jit(bool enabled)
+{
+  jit_enabled = enabled;
+}
+
+//
+// execute_register
+//
+// Adds a native builtin function; see execute.h.
+//
+bool execute_register(char* name, int num_args, EXECUTE_NATIVE function)
+{
+  if (atomic_load(&natives_sealed))
+    return false;
+
+  if (name == NULL || function == NULL || find_builtin(name) >= 0)
+    return false;
+
+  if (num_args < -1 || num_args > EXECUTE_MAX_ARGS)
+    return false;
+
+  if (num_natives == natives_capacity) {
+    int capacity = (natives_capacity == 0) ? 4 : 2 * natives_capacity;
+    struct BUILTIN* grown = (struct BUILTIN*)realloc(natives, capacity * sizeof(struct BUILTIN));
+
+    if (grown == NULL)
+      return false;
+
+    natives = grown;
+    natives_capacity = capacity;
+  }
+
+  char* copy = dupString(name);
+
+  if (copy == NULL)
+    return false;
+
+  natives[num_natives].name = copy;
+  natives[num_natives].num_args = num_args;
+  natives[num_natives].function = NULL;
+  natives[num_natives].native = function;
+  num_natives++;
+
+  return true;
+}
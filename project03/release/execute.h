@@ -10,8 +10,92 @@
 
 #pragma once
 
+#include <stdbool.h>  // true, false
+
 #include "programgraph.h"
 #include "ram.h"
+#include "jit.h"
+
+//
+// Execution context for running a program a few statements at a
+// time (see execute_step):
+//
+enum EXECUTE_STATUS
+{
+  EXECUTE_RUNNING = 0,  // more statements to execute
+  EXECUTE_DONE,         // ran to completion
+  EXECUTE_ERROR         // stopped by a semantic error
+};
+
+//
+// A for loop that is underway: the loop, the list or dict it
+// iterates over (the context holds a reference to it, so the
+// loop carries on even if the variable is reassigned), and where
+// it is in the list or the dict's entries. Nested loops form a
+// stack.
+//
+struct EXECUTE_ITERATOR
+{
+  struct STMT*     loop;      // the for loop
+  struct RAM_VALUE iterable;  // list or dict being iterated over
+  int              position;  // index of the next item or entry
+};
+
+//
+// A call of a user-defined function that is underway: the call
+// (an assignment or a function call statement, resumed when the
+// function returns), and where its frame starts in the context's
+// slots. The frames of nested and recursive calls form a stack,
+// and so do their slots; both are reused from call to call, so a
+// call allocates nothing once the stacks are deep enough.
+//
+struct EXECUTE_FRAME
+{
+  struct STMT_FUNCTION_DEF* function;  // function being executed
+  struct STMT* call;                   // where it was called from
+  int base;                            // its first slot
+  int num_iterators;                   // for loops underway at the call
+};
+
+struct EXECUTE_CONTEXT
+{
+  struct STMT* program;    // program being executed
+  struct RAM*  memory;     // memory the program runs against
+  struct STMT* next_stmt;  // where to resume, NULL when finished
+  long long    steps;      // total # of statements executed so far
+  int          status;     // enum EXECUTE_STATUS
+  struct JIT*  jit;        // compiled loops, NULL => interpret only
+  void*        native_data;  // the embedder's, for native builtins
+
+  struct EXECUTE_ITERATOR* iterators;  // for loops underway, innermost last
+  int num_iterators;
+  int iterators_capacity;
+
+  struct EXECUTE_FRAME* frames;  // calls underway, innermost last
+  int num_frames;
+  int frames_capacity;
+
+  struct RAM_VALUE* slots;  // local variables of the calls underway
+  int num_slots;
+  int slots_capacity;
+};
+
+//
+// A native builtin function, added by an embedder with 
+// execute_register: given the values of the arguments, it returns
+// its result via the reference parameter, which is None to start
+// with, and returns true if successful. data is the native data
+// of the execution (see execute_init), e.g. state that the program
+// shares with others, NULL if none was given. On an error it outputs
+// a message (line is the line # of the call) and returns false,
+// which stops execution. The arguments are borrowed; a string,
+// list or dict that is returned must be new, or retained (see
+// ram.h), since the caller takes ownership of it.
+//
+typedef bool (*EXECUTE_NATIVE)(struct RAM* memory, void* data, struct RAM_VALUE* args, int num_args, struct RAM_VALUE* result, int line);
+
+#define EXECUTE_MAX_ARGS 16  // most arguments a native builtin gets
+
 
 //
 // Public functions:
@@ -20,10 +104,92 @@
 //
 // execute
 //
-// Given a nuPython program graph and a memory, 
-// executes the statements in the program graph.
+// Given a nuPython program graph, prepared (see execute_prepare),
+// a memory, and the native data for native builtins (see
+// execute_init), executes the statements in the program graph.
 // If a semantic error occurs (e.g. type error),
 // and error message is output, execution stops,
 // and the function returns.
 //
-void execute(struct STMT* program, struct RAM* memory);
+void execute(struct STMT* program, struct RAM* memory, void* native_data);
+
+//
+// execute_prepare
+//
+// Resolves the calls of builtin functions in the given program to
+// the builtins, which is what lets a call find its builtin without
+// a search by name. A program must be prepared once, after it has
+// been optimized and before it is executed; the program graph is
+// not changed after that, so it can then be executed by several
+// threads at once. Native builtins must be registered before the
+// first program is prepared (see execute_register).
+//
+void execute_prepare(struct STMT* program);
+
+//
+// execute_init
+//
+// Returns a pointer to a dynamically-allocated execution context
+// for running the given program, already prepared, against the
+// given memory, positioned at the first statement. Nothing is
+// executed until execute_step() is called. native_data is passed
+// to the native builtins the program calls (see EXECUTE_NATIVE),
+// NULL if they need none. The context does not take ownership of
+// the program, the memory or the native data.
+//
+struct EXECUTE_CONTEXT* execute_init(struct STMT* program, struct RAM* memory, void* native_data);
+
+//
+// execute_step
+//
+// Executes at most max_steps statements of the program, starting
+// where the previous call left off, and returns the status of the
+// context: EXECUTE_RUNNING if the budget ran out before the program
+// finished, EXECUTE_DONE if it finished, EXECUTE_ERROR if a semantic
+// error occurred (the error message has already been output). Each
+// statement executed counts as one step, including each test of a
+// while loop condition. Once the status is DONE or ERROR, further 
+// calls do nothing.
+//
+// Example: time-slicing a program 1000 statements at a time
+//
+//   struct EXECUTE_CONTEXT* ctx = execute_init(program, memory, NULL);
+//   while (execute_step(ctx, 1000) == EXECUTE_RUNNING)
+//     ...  // run something else, or give up
+//   execute_destroy(ctx);
+//
+int execute_step(struct EXECUTE_CONTEXT* ctx, long long max_steps);
+
+//
+// execute_destroy
+//
+// Frees the given execution context, letting go of the lists
+// and dicts of any for loops and function calls still underway 
+// (e.g. after an error); the memory must not have
+// been destroyed yet. The program and the variables in memory
+// are not affected.
+//
+void execute_destroy(struct EXECUTE_CONTEXT* ctx);
+
+//
+// execute_set_jit
+//
+// Turns the JIT for hot while loops (see jit.h) on or off for
+// execution contexts created after the call. The JIT is on by 
+// default on platforms that support it; turning it off runs
+// everything in the interpreter.
+//
+void execute_set_jit(bool enabled);
+
+//
+// execute_register
+//
+// Adds a native builtin function with the given name, which
+// programs then call like print() or len(). num_args is the #
+// of arguments it takes, -1 => any # up to EXECUTE_MAX_ARGS. The
+// name is copied. Returns true if successful, false if the name is
+// already a builtin, num_args is out of range, or a program has
+// already been prepared: the builtins can't change once programs
+// may be running.
+//
+bool execute_register(char* name, int num_args, EXECUTE_NATIVE function);
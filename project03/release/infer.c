@@ -0,0 +1,608 @@
+/*infer.c*/
+
+//
+// Static type inference for nuPython programs; see infer.h.
+//
+// The types a variable may have are a set, stored as a bit mask
+// with one bit per RAM type plus a bit for "not assigned yet". A
+// state holds one mask per variable. Sets only ever grow as the
+// analysis goes around a loop, so each loop settles after a few
+// passes.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>   // strcmp, memcpy, memset
+
+#include "programgraph.h"
+#include "ram.h"
+#include "util.h"     // struct NameSet
+#include "infer.h"
+#include "output.h"
+
+
+//
+// type sets:
+//
+#define T(type)  (1u << (type))  // just the given RAM type
+#define T_NUMBER (T(RAM_TYPE_INT) | T(RAM_TYPE_REAL))
+#define T_ANY    0xFFu           // any RAM type
+#define T_UNSET  0x100u          // not assigned (yet)
+
+typedef unsigned short TYPES;
+
+//
+// The variables of the program, numbered in the order they are
+// found:
+//
+struct INFER
+{
+  struct NameSet vars;
+
+  int    errors;      // # of errors reported
+  bool   report;      // report errors? (not while a loop settles)
+};
+
+//
+// Result types of the builtin functions:
+//
+static struct
+{
+  char* name;
+  TYPES types;
+} builtins[] =
+{
+  { "input", T(RAM_TYPE_STR) },
+  { "int",   T(RAM_TYPE_INT) },
+  { "float", T(RAM_TYPE_REAL) },
+  { "alloc", T(RAM_TYPE_PTR) },
+  { "len",   T(RAM_TYPE_INT) },
+  { "sum",   T_NUMBER },
+  { "min",   T_NUMBER },
+  { "max",   T_NUMBER },
+  { "dot",   T_NUMBER },
+  { "add",   T(RAM_TYPE_LIST) },
+  { "scale", T(RAM_TYPE_LIST) }
+};
+
+#define NUM_BUILTINS ((int)(sizeof(builtins) / sizeof(builtins[0])))
+
+
+//
+// Private functions:
+//
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**INFER ERROR\n");
+  printf("**INFER ERROR: %s\n", msg);
+  printf("**INFER ERROR\n");
+
+  exit(-123);
+}
+
+//
+// find_var
+//
+// Returns the # of the variable with the given name, which must
+// have been numbered.
+//
+static int find_var(struct INFER* inf, char* name)
+{
+  return nameSetFind(&inf->vars, name, false);
+}
+
+//
+// next_stmt
+//
+// Returns the statement that follows the given one in the
+// program graph, or after the loop for a loop.
+//
+static struct STMT* next_stmt(struct STMT* stmt)
+{
+  switch (stmt->stmt_type)
+  {
+    case STMT_ASSIGNMENT:    return stmt->types.assignment->next_stmt;
+    case STMT_FUNCTION_CALL: return stmt->types.function_call->next_stmt;
+    case STMT_WHILE_LOOP:    return stmt->types.while_loop->next_stmt;
+    case STMT_FOR_LOOP:      return stmt->types.for_loop->next_stmt;
+    case STMT_PASS:          return stmt->types.pass->next_stmt;
+    case STMT_FUNCTION_DEF:  return stmt->types.function_def->next_stmt;
+    default:                 return NULL;
+  }
+}
+
+//
+// only_type
+//
+// Returns the one RAM type in the set, or -1 if the set holds
+// more types than one (or none).
+//
+static int only_type(TYPES types)
+{
+  for (int type = RAM_TYPE_INT; type <= RAM_TYPE_DICT; type++) {
+    if (types == T(type))
+      return type;
+  }
+
+  return -1;
+}
+
+//
+// error
+//
+// Reports a type error at the given statement, unless errors are
+// not being reported right now.
+//
+static void error(struct INFER* inf, struct STMT* stmt, char* message)
+{
+  if (!inf->report)
+    return;
+
+  printf("**SEMANTIC ERROR: %s (line %d)\n", message, stmt->line);
+
+  inf->errors++;
+}
+
+//
+// variable_types
+//
+// Returns the types the named variable may have when read; if it
+// is never assigned before this point, an error is reported.
+//
+static TYPES variable_types(struct INFER* inf, TYPES* state, struct STMT* stmt, char* name)
+{
+  TYPES types = state[find_var(inf, name)];
+
+  if (types == T_UNSET && inf->report) {
+    printf("**SEMANTIC ERROR: name '%s' is not defined (line %d)\n", name, stmt->line);
+    inf->errors++;
+  }
+
+  return types & T_ANY;
+}
+
+//
+// element_types
+//
+// Returns the types the given element may have: a variable's
+// types, or a literal's type.
+//
+static TYPES element_types(struct INFER* inf, TYPES* state, struct STMT* stmt, struct ELEMENT* element)
+{
+  switch (element->element_type)
+  {
+    case ELEMENT_IDENTIFIER:   return variable_types(inf, state, stmt, element->element_value);
+    case ELEMENT_INT_LITERAL:  return T(RAM_TYPE_INT);
+    case ELEMENT_REAL_LITERAL: return T(RAM_TYPE_REAL);
+    case ELEMENT_STR_LITERAL:  return T(RAM_TYPE_STR);
+    case ELEMENT_TRUE:
+    case ELEMENT_FALSE:        return T(RAM_TYPE_BOOLEAN);
+    case ELEMENT_NONE:         return T(RAM_TYPE_NONE);
+    default:                   return T_ANY;
+  }
+}
+
+//
+// check_elements
+//
+// Checks that the variables in a chain of elements (e.g. the
+// parameters of a function call) are defined.
+//
+static void check_elements(struct INFER* inf, TYPES* state, struct STMT* stmt, struct ELEMENT* element)
+{
+  for ( ; element != NULL; element = element->next)
+    element_types(inf, state, stmt, element);
+}
+
+//
+// unary_types
+//
+// Returns the types the given unary expression may have.
+//
+static TYPES unary_types(struct INFER* inf, TYPES* state, struct STMT* stmt, struct UNARY_EXPR* unary)
+{
+  TYPES types = element_types(inf, state, stmt, unary->element);
+
+  switch (unary->expr_type)
+  {
+    case UNARY_ELEMENT:
+      return types;
+
+    case UNARY_ADDRESS_OF:
+      return T(RAM_TYPE_PTR);
+
+    case UNARY_PTR_DEREF:
+      return T_ANY;
+
+    case UNARY_INDEX:
+      check_elements(inf, state, stmt, unary->index);
+      return T_ANY;
+
+    case UNARY_PLUS:
+    case UNARY_MINUS:
+      if (types != 0 && (types & T_NUMBER) == 0)
+        error(inf, stmt, "invalid operand types");
+
+      return types & T_NUMBER;
+
+    default:
+      return T_ANY;
+  }
+}
+
+//
+// operation_type
+//
+// Returns the type of lhs op rhs for values of the given types,
+// following execute_binary_expr: -1 if the operand types are
+// invalid, -2 if the operation fails for some other reason.
+//
+static int operation_type(int lhs, int operator, int rhs)
+{
+  bool relational = (operator >= OPERATOR_EQUAL && operator <= OPERATOR_GTE);
+  bool arithmetic = (operator <= OPERATOR_DIV);
+
+  if (operator == OPERATOR_IN)
+    return RAM_TYPE_BOOLEAN;
+
+  if ((lhs == RAM_TYPE_INT || lhs == RAM_TYPE_REAL) && (rhs == RAM_TYPE_INT || rhs == RAM_TYPE_REAL)) {
+    if (relational)
+      return RAM_TYPE_BOOLEAN;
+    else if (!arithmetic)
+      return -2;
+    else if (lhs == RAM_TYPE_INT && rhs == RAM_TYPE_INT)
+      return RAM_TYPE_INT;
+    else
+      return RAM_TYPE_REAL;
+  }
+
+  if (lhs == RAM_TYPE_STR && rhs == RAM_TYPE_STR) {
+    if (relational)
+      return RAM_TYPE_BOOLEAN;
+    else if (operator == OPERATOR_PLUS)
+      return RAM_TYPE_STR;
+    else
+      return -2;
+  }
+
+  if (lhs == RAM_TYPE_PTR && rhs == RAM_TYPE_PTR) {
+    if (relational)
+      return RAM_TYPE_BOOLEAN;
+    else if (operator == OPERATOR_MINUS)
+      return RAM_TYPE_INT;
+    else
+      return -1;
+  }
+
+  if ((lhs == RAM_TYPE_PTR && rhs == RAM_TYPE_INT && (operator == OPERATOR_PLUS || operator == OPERATOR_MINUS)) ||
+      (lhs == RAM_TYPE_INT && rhs == RAM_TYPE_PTR && operator == OPERATOR_PLUS))
+    return RAM_TYPE_PTR;
+
+  return -1;
+}
+
+//
+// expr_types
+//
+// Returns the types the given expression may have, annotating it
+// with the types of its operands.
+//
+static TYPES expr_types(struct INFER* inf, TYPES* state, struct STMT* stmt, struct VALUE_EXPR* expr)
+{
+  TYPES lhs = unary_types(inf, state, stmt, expr->lhs);
+
+  expr->lhs_type = only_type(lhs);
+
+  if (!expr->isBinaryExpr)
+    return lhs;
+
+  TYPES rhs = unary_types(inf, state, stmt, expr->rhs);
+
+  expr->rhs_type = only_type(rhs);
+
+  //
+  // the result could be any of the results for the possible
+  // operand types:
+  //
+  TYPES result = 0;
+  bool invalid = (lhs != 0 && rhs != 0);  // every combination invalid?
+
+  for (int l = RAM_TYPE_INT; l <= RAM_TYPE_DICT; l++) {
+    for (int r = RAM_TYPE_INT; r <= RAM_TYPE_DICT; r++) {
+      if ((lhs & T(l)) == 0 || (rhs & T(r)) == 0)
+        continue;
+
+      int type = operation_type(l, expr->operator, r);
+
+      if (type >= 0)
+        result |= T(type);
+
+      if (type != -1)
+        invalid = false;
+    }
+  }
+
+  if (invalid)
+    error(inf, stmt, "invalid operand types");
+
+  return result;
+}
+
+//
+// call_types
+//
+// Returns the types the given function call may return.
+//
+static TYPES call_types(struct INFER* inf, TYPES* state, struct STMT* stmt, struct VALUE_FUNCTION_CALL* call)
+{
+  check_elements(inf, state, stmt, call->parameter);
+
+  if (call->function != NULL)  // user-defined
+    return T_ANY;
+
+  for (int i = 0; i < NUM_BUILTINS; i++) {
+    if (strcmp(builtins[i].name, call->function_name) == 0)
+      return builtins[i].types;
+  }
+
+  return T_ANY;
+}
+
+//
+// infer_call
+//
+// Updates the state for a call of a user-defined function, which
+// may write any variable through a pointer.
+//
+static void infer_call(struct INFER* inf, TYPES* state)
+{
+  for (int v = 0; v < inf->vars.num_names; v++)
+    state[v] |= T_ANY;
+}
+
+static void infer_block(struct INFER* inf, TYPES* state, struct STMT* stmt, struct STMT* stop);
+
+//
+// infer_assignment
+//
+// Updates the state for the given assignment.
+//
+static void infer_assignment(struct INFER* inf, TYPES* state, struct STMT* stmt)
+{
+  struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+  struct VALUE* rhs = assign->rhs;
+  TYPES types;
+
+  if (rhs->value_type == VALUE_EXPR)
+    types = expr_types(inf, state, stmt, rhs->types.expr);
+  else if (rhs->value_type == VALUE_FUNCTION_CALL) {
+    types = call_types(inf, state, stmt, rhs->types.function_call);
+
+    if (rhs->types.function_call->function != NULL)
+      infer_call(inf, state);
+  }
+  else if (rhs->value_type == VALUE_LIST) {
+    check_elements(inf, state, stmt, rhs->types.list->elements);
+    types = T(RAM_TYPE_LIST);
+  }
+  else {
+    check_elements(inf, state, stmt, rhs->types.dict->keys);
+    check_elements(inf, state, stmt, rhs->types.dict->values);
+    types = T(RAM_TYPE_DICT);
+  }
+
+  if (assign->isPtrDeref) {
+    //
+    // *p = value could write any variable:
+    //
+    variable_types(inf, state, stmt, assign->var_name);
+
+    for (int v = 0; v < inf->vars.num_names; v++)
+      state[v] |= types;
+  }
+  else if (assign->index != NULL) {
+    //
+    // xs[i] = value changes an item, not the variable:
+    //
+    variable_types(inf, state, stmt, assign->var_name);
+    check_elements(inf, state, stmt, assign->index);
+  }
+  else {
+    state[find_var(inf, assign->var_name)] = types;
+  }
+}
+
+//
+// infer_loop
+//
+// Updates the state for the given while or for loop: the state
+// on entry is the state before the loop, the state on return is
+// the state after it. The body is analyzed over and over, each
+// time starting from everything seen at the top of the loop so
+// far, until the top of the loop stops changing; then once more
+// to report errors, now that the state is complete.
+//
+static void infer_loop(struct INFER* inf, TYPES* state, struct STMT* loop)
+{
+  size_t bytes = inf->vars.num_names * sizeof(TYPES);
+
+  TYPES* top = (TYPES*)malloc(bytes + sizeof(TYPES));   // state at the top of the loop
+  TYPES* body = (TYPES*)malloc(bytes + sizeof(TYPES));  // state going through the body
+
+  if (top == NULL || body == NULL)
+    panic("out of memory (infer_loop)");
+
+  memcpy(top, state, bytes);
+
+  bool report = inf->report;
+  bool settled = false;
+
+  inf->report = false;
+
+  for (;;) {
+    memcpy(body, top, bytes);
+
+    if (loop->stmt_type == STMT_WHILE_LOOP) {
+      expr_types(inf, body, loop, loop->types.while_loop->condition);
+      infer_block(inf, body, loop->types.while_loop->loop_body, loop);
+    }
+    else {
+      struct STMT_FOR_LOOP* for_loop = loop->types.for_loop;
+      TYPES iterable = element_types(inf, body, loop, for_loop->iterable);
+      TYPES item = 0;
+
+      if (iterable & T(RAM_TYPE_LIST))
+        item |= T_ANY;
+      if (iterable & T(RAM_TYPE_DICT))
+        item |= T(RAM_TYPE_INT) | T(RAM_TYPE_STR);
+
+      body[find_var(inf, for_loop->var_name)] = item;
+
+      infer_block(inf, body, for_loop->loop_body, loop);
+    }
+
+    if (settled)
+      break;
+
+    //
+    // the end of the body leads back to the top:
+    //
+    bool changed = false;
+
+    for (int v = 0; v < inf->vars.num_names; v++) {
+      if ((top[v] | body[v]) != top[v]) {
+        top[v] |= body[v];
+        changed = true;
+      }
+    }
+
+    if (!changed) {
+      //
+      // that pass started from the complete state, so the
+      // annotations are final; one more pass reports errors:
+      //
+      if (!report)
+        break;
+
+      settled = true;
+      inf->report = true;
+    }
+  }
+
+  //
+  // the loop ends at the top, when the condition is false or the
+  // items run out:
+  //
+  memcpy(state, top, bytes);
+
+  free(top);
+  free(body);
+}
+
+//
+// infer_block
+//
+// Updates the state for the given block of statements, up to the
+// given stop statement (the loop a body links back to).
+//
+static void infer_block(struct INFER* inf, TYPES* state, struct STMT* stmt, struct STMT* stop)
+{
+  for ( ; stmt != NULL && stmt != stop; stmt = next_stmt(stmt)) {
+    switch (stmt->stmt_type)
+    {
+      case STMT_ASSIGNMENT:
+        infer_assignment(inf, state, stmt);
+        break;
+
+      case STMT_FUNCTION_CALL:
+        check_elements(inf, state, stmt, stmt->types.function_call->parameter);
+
+        if (stmt->types.function_call->function != NULL)
+          infer_call(inf, state);
+        break;
+
+      case STMT_WHILE_LOOP:
+      case STMT_FOR_LOOP:
+        infer_loop(inf, state, stmt);
+        break;
+
+      case STMT_PASS:
+      case STMT_FUNCTION_DEF:  // the body is checked at run time
+        break;
+
+      default:
+        //
+        // not supported (if statements): leave the rest of the
+        // program unannotated, to be checked at run time:
+        //
+        return;
+    }
+  }
+}
+
+
+//
+// Public functions:
+//
+
+//
+// infer_types
+//
+// Infers the types in the program and annotates its expressions,
+// returning the # of type errors.
+//
+int infer_types(struct STMT* program)
+{
+  return infer_types_in(program, NULL);
+}
+
+//
+// infer_types_in
+//
+// Infers the types of the variables in the given program, which
+// runs against the given memory; see infer.h.
+//
+int infer_types_in(struct STMT* program, struct RAM* memory)
+{
+  struct INFER inf;
+
+  memset(&inf.vars, 0, sizeof(inf.vars));
+  inf.errors = 0;
+  inf.report = true;
+
+  programgraph_variables(program, &inf.vars, NULL, NULL);
+
+  //
+  // at the start, no variable has been assigned, unless it's
+  // already in memory:
+  //
+  TYPES* state = (TYPES*)malloc((inf.vars.num_names + 1) * sizeof(TYPES));
+  if (state == NULL)
+    panic("out of memory (infer_types)");
+
+  for (int v = 0; v < inf.vars.num_names; v++) {
+    const struct RAM_VALUE* value = (memory == NULL) ? NULL : ram_peek_cell_by_id(memory, inf.vars.names[v]);
+
+    state[v] = (value == NULL) ? T_UNSET : T(value->value_type);
+  }
+
+  infer_block(&inf, state, program, NULL);
+
+  free(state);
+  nameSetFree(&inf.vars);
+
+  return inf.errors;
+}
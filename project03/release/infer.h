@@ -0,0 +1,52 @@
+/*infer.h*/
+
+//
+// Static type inference for nuPython programs. Before execution,
+// a dataflow pass over the program graph works out which types
+// each variable may have at each statement, going around while
+// and for loops (their back edges) until nothing changes. Binary
+// expressions whose operand types are then known for certain are
+// annotated with those types (see VALUE_EXPR in programgraph.h),
+// so the executor can use a type-specialized operation without
+// checking tags. Expressions that can only fail, such as 'a' + 1
+// or a read of a variable that is never assigned, are reported
+// as semantic errors before anything runs.
+//
+// The analysis is conservative: a value read from a list, a dict
+// or through a pointer, the variable of a for loop, and the result
+// of a function defined with def, may have any type; a write
+// through a pointer, or a call of such a function, may change the
+// type of any variable. An error is only reported when every way
+// of reaching the expression fails. The bodies of functions are
+// left to be checked at run time.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include "programgraph.h"
+#include "ram.h"
+
+
+//
+// infer_types
+//
+// Infers the types of the variables in the given program and
+// annotates its expressions. Type errors are output in the same
+// form the executor uses ("**SEMANTIC ERROR: ..."), and the # of
+// errors is returned; if it's 0, the program may be executed.
+//
+int infer_types(struct STMT* program);
+
+//
+// infer_types_in
+//
+// Like infer_types, for a program that runs against a memory that
+// may already hold variables, e.g. the next entry of an interactive
+// session: a variable in memory starts out with the type of its
+// value, rather than unassigned.
+//
+int infer_types_in(struct STMT* program, struct RAM* memory);
@@ -0,0 +1,175 @@
+/*input.c*/
+
+//
+// Buffered input for the nuPython executor (see input.h). The
+// buffer holds the unread input between start and end; a line
+// handed out is NUL-terminated in place, and a line that runs
+// past the end is moved to the front of the buffer, which grows
+// if the line still doesn't fit.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>   // memchr, memmove, strlen
+#include <limits.h>   // INT_MAX
+
+#include "input.h"
+#include "output.h"
+
+
+#define INPUT_BUFFER_SIZE (64 * 1024)  // to start with
+
+static char*  buffer = NULL;
+static size_t capacity = 0;
+static size_t start = 0;  // first unread char
+static size_t end = 0;    // one past the last char read
+static bool   at_eof = false;
+
+static int mode = INPUT_INTERACTIVE;
+
+
+//
+// Private functions:
+//
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**INPUT ERROR: %s\n", msg);
+  exit(-1);
+}
+
+//
+// fill
+//
+// Reads more input into the buffer after what's unread, making
+// room first. Returns false at the end of the input.
+//
+static bool fill(void)
+{
+  if (at_eof)
+    return false;
+
+  //
+  // move what's unread to the front, and if the buffer is full of
+  // one line, make it bigger (+1 leaves room for the NUL):
+  //
+  if (start > 0) {
+    memmove(buffer, buffer + start, end - start);
+    end -= start;
+    start = 0;
+  }
+
+  if (end + 1 >= capacity) {
+    size_t bigger = (capacity == 0) ? INPUT_BUFFER_SIZE : 2 * capacity;
+    char* grown = (char*)realloc(buffer, bigger);
+
+    if (grown == NULL)
+      panic("out of memory (input_line)");
+
+    buffer = grown;
+    capacity = bigger;
+  }
+
+  size_t room = capacity - end - 1;
+  size_t n;
+
+  if (mode == INPUT_BATCH)
+    n = fread(buffer + end, 1, room, stdin);
+  else {
+    int size = (room >= INT_MAX) ? INT_MAX : (int)room + 1;
+
+    if (fgets(buffer + end, size, stdin) != NULL)
+      n = strlen(buffer + end);  // stops after the newline, if any
+    else
+      n = 0;
+  }
+
+  if (n == 0) {
+    at_eof = true;
+    return false;
+  }
+
+  end += n;
+  return true;
+}
+
+
+//
+// Public functions:
+//
+
+//
+// input_init
+//
+// Sets the mode for subsequent input.
+//
+void input_init(int new_mode)
+{
+  mode = new_mode;
+}
+
+//
+// input_prompts
+//
+// Returns true if prompts should be output.
+//
+bool input_prompts(void)
+{
+  return mode == INPUT_INTERACTIVE;
+}
+
+//
+// input_line
+//
+// Reads the next line of input; see input.h.
+//
+char* input_line(size_t* length)
+{
+  char* newline = NULL;
+  size_t scanned = 0;  // chars already searched for a newline
+
+  for (;;) {
+    if (start + scanned < end)
+      newline = memchr(buffer + start + scanned, '\n', end - start - scanned);
+
+    if (newline != NULL)
+      break;
+
+    scanned = end - start;
+
+    if (!fill()) {
+      if (end == start)
+        return NULL;
+
+      newline = buffer + end;  // the last line has no newline
+      break;
+    }
+  }
+
+  char* line = buffer + start;
+  size_t n = newline - line;
+
+  start += n;
+  if (start < end)  // skip the newline
+    start++;
+
+  if (n > 0 && line[n - 1] == '\r')
+    n--;
+
+  line[n] = '\0';  // there's always room, see fill()
+  *length = n;
+
+  return line;
+}
@@ -0,0 +1,64 @@
+/*input.h*/
+
+//
+// Buffered input for the nuPython executor's input(). Lines are
+// read from stdin into one large buffer and handed out as views
+// into it, so lines of any length come back whole and a script
+// fed a large file doesn't pay for a read per line.
+//
+// Input goes through stdio, so it picks up where the scanner left
+// off when the program itself was read from stdin.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include <stddef.h>   // size_t
+#include <stdbool.h>  // true, false
+
+
+//
+// How is stdin read?
+//
+enum INPUT_MODES
+{
+  INPUT_INTERACTIVE = 0,  // a line at a time, prompts shown
+  INPUT_BATCH             // in large blocks, prompts suppressed
+};
+
+
+//
+// Public functions:
+//
+
+//
+// input_init
+//
+// Sets the mode for subsequent input. Interactive mode, the
+// default, never asks stdin for more than the line it needs, so
+// it's right for a keyboard. Batch mode reads ahead as far as
+// the buffer goes, and is meant for input redirected from a file
+// or a pipe; no prompts are output then, since nobody sees them.
+//
+void input_init(int mode);
+
+//
+// input_prompts
+//
+// Returns true if prompts should be output before reading input,
+// false if not.
+//
+bool input_prompts(void);
+
+//
+// input_line
+//
+// Reads the next line of input, returning it without its end of
+// line chars ("\n" or "\r\n") and its length via length. Returns
+// NULL at the end of the input. The line lives in the input
+// buffer and is only valid until the next call.
+//
+char* input_line(size_t* length);
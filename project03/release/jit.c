@@ -0,0 +1,1079 @@
+/*jit.c*/
+
+//
+// Tracing JIT for hot nuPython while loops. Once a while loop has
+// run a few iterations in the interpreter, its body is compiled to
+// x86-64 machine code specialized for the types of the variables
+// it touches. See jit.h for the details.
+//
+// The compiled code mirrors execute.c operation for operation: all
+// arithmetic is done in doubles (ints are converted with cvtsi2sd
+// and truncated back with cvttsd2si, exactly like the C casts in
+// execute_binary_expr), ** and % call pow and fmod, and print()
+// goes through the same output routines. Variables live in their
+// RAM cells the whole time, so memory is always up to date.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#define _DEFAULT_SOURCE  // MAP_ANONYMOUS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <stdint.h>   // int32_t, uint64_t, uintptr_t
+#include <stddef.h>   // offsetof
+#include <string.h>   // memcpy, memset
+#include <math.h>     // pow, fmod
+
+#if defined(__x86_64__)
+#include <sys/mman.h> // mmap, mprotect
+#endif
+
+#include "jit.h"
+#include "output.h"
+
+
+//
+// # of times the interpreter runs a loop's condition before the
+// loop is considered hot and we try to compile it:
+//
+#define JIT_HOT_ITERATIONS 8
+
+//
+// max # of distinct variables a compiled loop can touch:
+//
+#define JIT_MAX_VARS 64
+
+enum JIT_LOOP_STATES
+{
+  LOOP_COUNTING = 0,  // not hot yet
+  LOOP_COMPILED,      // native code available
+  LOOP_REJECTED       // can't be compiled, leave it to the interpreter
+};
+
+//
+// signature of the generated code; returns one of JIT_RESULTS:
+//
+typedef int (*JIT_CODE)(struct RAM_VALUE* values, long long max_iterations, long long* iterations);
+
+struct JIT_LOOP
+{
+  struct STMT* loop;    // while loop stmt, NULL => empty slot
+  int    state;         // enum JIT_LOOP_STATES
+  int    visits;        // # of times the interpreter ran it
+  int    body_length;   // # of stmts in the loop body
+  void*  code;          // executable buffer
+  size_t code_size;
+};
+
+struct JIT
+{
+  struct RAM* memory;
+  struct JIT_LOOP* loops;  // hash table keyed by while loop stmt
+  int num_loops;
+  int capacity;            // always a power of 2
+};
+
+//
+// what the trace knows about the variables in a loop:
+//
+struct TRACE
+{
+  struct RAM* memory;
+  int num_vars;
+  int addrs[JIT_MAX_VARS];        // RAM address of each var
+  int entry_types[JIT_MAX_VARS];  // type on entry to the loop
+  int types[JIT_MAX_VARS];        // type at the current point of the body
+  bool stored[JIT_MAX_VARS];      // assigned somewhere in the body?
+  bool is_base[JIT_MAX_VARS];     // a pointer that is dereferenced (*p)?
+  int targets[JIT_MAX_VARS];      // if so, the address it points to
+};
+
+//
+// growable buffer the machine code is emitted into:
+//
+struct CODE
+{
+  unsigned char* bytes;
+  size_t size;
+  size_t capacity;
+  bool   failed;  // out of memory
+};
+
+
+#if defined(__x86_64__)
+
+//
+// Private functions:
+//
+
+//
+// emit
+//
+// Appends n bytes of machine code.
+//
+static void emit(struct CODE* code, const void* bytes, size_t n)
+{
+  if (code->size + n > code->capacity) {
+    size_t capacity = (code->capacity == 0) ? 1024 : code->capacity * 2;
+    while (capacity < code->size + n)
+      capacity *= 2;
+
+    unsigned char* grown = (unsigned char*)realloc(code->bytes, capacity);
+    if (grown == NULL) {
+      code->failed = true;
+      return;
+    }
+
+    code->bytes = grown;
+    code->capacity = capacity;
+  }
+
+  memcpy(code->bytes + code->size, bytes, n);
+  code->size += n;
+}
+
+static void emit_byte(struct CODE* code, unsigned char b)
+{
+  emit(code, &b, 1);
+}
+
+static void emit_bytes2(struct CODE* code, unsigned char b1, unsigned char b2)
+{
+  unsigned char bytes[] = { b1, b2 };
+  emit(code, bytes, sizeof(bytes));
+}
+
+static void emit_int32(struct CODE* code, int32_t value)
+{
+  emit(code, &value, sizeof(value));
+}
+
+static void emit_int64(struct CODE* code, uint64_t value)
+{
+  emit(code, &value, sizeof(value));
+}
+
+//
+// emit_jump
+//
+// Emits a jump with the given opcode bytes and a rel32 to be
+// patched later; returns the position of the rel32.
+//
+static size_t emit_jump(struct CODE* code, const unsigned char* opcode, size_t n)
+{
+  emit(code, opcode, n);
+
+  size_t at = code->size;
+  emit_int32(code, 0);
+
+  return at;
+}
+
+//
+// patch_jump
+//
+// Points the rel32 at the given position to the target position.
+//
+static void patch_jump(struct CODE* code, size_t at, size_t target)
+{
+  if (code->failed)
+    return;
+
+  int32_t rel = (int32_t)(target - (at + 4));
+  memcpy(code->bytes + at, &rel, sizeof(rel));
+}
+
+//
+// cell_payload / cell_tag
+//
+// Displacement from the start of the values array (held in rbx)
+// to the payload / type of the cell at the given address.
+//
+static int32_t cell_payload(int address)
+{
+  return (int32_t)(address * sizeof(struct RAM_VALUE) + offsetof(struct RAM_VALUE, types));
+}
+
+static int32_t cell_tag(int address)
+{
+  return (int32_t)(address * sizeof(struct RAM_VALUE) + offsetof(struct RAM_VALUE, value_type));
+}
+
+//
+// emit_rbx_operand
+//
+// Emits "prefix opcode modrm disp32" for an instruction whose
+// memory operand is [rbx + disp] and whose reg field is reg.
+//
+static void emit_rbx_operand(struct CODE* code, const unsigned char* opcode, size_t n, int reg, int32_t disp)
+{
+  emit(code, opcode, n);
+  emit_byte(code, (unsigned char)(0x80 | (reg << 3) | 3));
+  emit_int32(code, disp);
+}
+
+//
+// emit_call
+//
+// Emits a call to the given C function; the stack is 16-byte
+// aligned throughout the generated code.
+//
+static void emit_call(struct CODE* code, void (*function)(void))
+{
+  emit_bytes2(code, 0x48, 0xB8);  // mov rax, imm64
+  emit_int64(code, (uint64_t)(uintptr_t)function);
+  emit_bytes2(code, 0xFF, 0xD0);  // call rax
+}
+
+//
+// emit_load_double
+//
+// Loads the double bit pattern of d into xmm register N.
+//
+static void emit_load_double(struct CODE* code, int xmm, double d)
+{
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+
+  emit_bytes2(code, 0x48, 0xB8);  // mov rax, imm64
+  emit_int64(code, bits);
+
+  unsigned char movq[] = { 0x66, 0x48, 0x0F, 0x6E, (unsigned char)(0xC0 | (xmm << 3)) };
+  emit(code, movq, sizeof(movq));  // movq xmmN, rax
+}
+
+//
+// find_var
+//
+// Returns the index of the variable with the given address in
+// the trace, adding it if necessary; returns -1 if the trace is
+// full.
+//
+static int find_var(struct TRACE* trace, int address)
+{
+  for (int i = 0; i < trace->num_vars; i++) {
+    if (trace->addrs[i] == address)
+      return i;
+  }
+
+  if (trace->num_vars == JIT_MAX_VARS)
+    return -1;
+
+  int i = trace->num_vars;
+  int type = trace->memory->values[address].value_type;
+
+  trace->addrs[i] = address;
+  trace->entry_types[i] = type;
+  trace->types[i] = type;
+  trace->stored[i] = false;
+  trace->is_base[i] = false;
+  trace->targets[i] = -1;
+  trace->num_vars++;
+
+  return i;
+}
+
+//
+// element_type
+//
+// Returns the RAM type the given element has at this point in
+// the trace, or -1 if it can't be traced. For identifiers the
+// trace index is returned via var (else var is -1).
+//
+static int element_type(struct TRACE* trace, struct ELEMENT* element, int* var)
+{
+  *var = -1;
+
+  switch (element->element_type)
+  {
+    case ELEMENT_INT_LITERAL:
+      return RAM_TYPE_INT;
+
+    case ELEMENT_REAL_LITERAL:
+      return RAM_TYPE_REAL;
+
+    case ELEMENT_STR_LITERAL:
+      return RAM_TYPE_STR;
+
+    case ELEMENT_TRUE:
+    case ELEMENT_FALSE:
+      return RAM_TYPE_BOOLEAN;
+
+    case ELEMENT_IDENTIFIER: {
+      if (element->slot >= 0)
+        return -1;  // a local, in a frame rather than memory
+
+      int address = ram_get_addr(trace->memory, element->element_value);
+      if (address < 0)
+        return -1;
+
+      *var = find_var(trace, address);
+      if (*var < 0)
+        return -1;
+
+      return trace->types[*var];
+    }
+
+    default:
+      return -1;
+  }
+}
+
+//
+// deref_var
+//
+// For *p, returns the trace index of the cell p points to, or -1
+// if it can't be traced. The body may not assign p (this is
+// checked once the whole body has been traced), so the cell is
+// the same on every iteration: its bounds are checked here, once,
+// and the entry guard makes sure p still points to it. The
+// dereference then costs no more than a variable access.
+//
+static int deref_var(struct TRACE* trace, struct ELEMENT* element)
+{
+  int base;
+
+  if (element->element_type != ELEMENT_IDENTIFIER)
+    return -1;
+  if (element_type(trace, element, &base) != RAM_TYPE_PTR)
+    return -1;
+
+  int target = trace->memory->values[trace->addrs[base]].types.i;
+
+  if (target < 0 || target >= trace->memory->num_values)
+    return -1;
+
+  trace->is_base[base] = true;
+  trace->targets[base] = target;
+
+  return find_var(trace, target);
+}
+
+//
+// unary_type
+//
+// Like element_type, for a unary expression: either a plain
+// element or a pointer dereference.
+//
+static int unary_type(struct TRACE* trace, struct UNARY_EXPR* unary, int* var)
+{
+  *var = -1;
+
+  if (unary->expr_type == UNARY_ELEMENT)
+    return element_type(trace, unary->element, var);
+
+  if (unary->expr_type == UNARY_PTR_DEREF) {
+    *var = deref_var(trace, unary->element);
+    return (*var < 0) ? -1 : trace->types[*var];
+  }
+
+  return -1;
+}
+
+//
+// is_numeric / is_relational
+//
+static bool is_numeric(int type)
+{
+  return type == RAM_TYPE_INT || type == RAM_TYPE_REAL;
+}
+
+static bool is_relational(int operator)
+{
+  return operator >= OPERATOR_EQUAL && operator <= OPERATOR_GTE;
+}
+
+//
+// emit_load_operand
+//
+// Loads the numeric value of the given element into xmm register
+// N as a double, converting ints the way execute_binary_expr does.
+//
+static void emit_load_operand(struct CODE* code, struct TRACE* trace, struct ELEMENT* element, int type, int var, int xmm)
+{
+  if (var >= 0) {
+    if (type == RAM_TYPE_INT) {
+      unsigned char cvtsi2sd[] = { 0xF2, 0x0F, 0x2A };
+      emit_rbx_operand(code, cvtsi2sd, sizeof(cvtsi2sd), xmm, cell_payload(trace->addrs[var]));
+    }
+    else {
+      unsigned char movsd[] = { 0xF2, 0x0F, 0x10 };
+      emit_rbx_operand(code, movsd, sizeof(movsd), xmm, cell_payload(trace->addrs[var]));
+    }
+  }
+  else if (type == RAM_TYPE_INT) {
+    emit_load_double(code, xmm, (double)element->literal.i);
+  }
+  else {
+    emit_load_double(code, xmm, element->literal.d);
+  }
+}
+
+//
+// emit_relational
+//
+// Given operands in xmm0 and xmm1, leaves the result of the
+// relational operator in al (0 or 1), with the same NaN behavior
+// as the C comparison operators.
+//
+static void emit_relational(struct CODE* code, int operator)
+{
+  unsigned char ucomisd_01[] = { 0x66, 0x0F, 0x2E, 0xC1 };  // ucomisd xmm0, xmm1
+  unsigned char ucomisd_10[] = { 0x66, 0x0F, 0x2E, 0xC8 };  // ucomisd xmm1, xmm0
+
+  switch (operator)
+  {
+    case OPERATOR_LT:   // xmm1 > xmm0
+      emit(code, ucomisd_10, sizeof(ucomisd_10));
+      emit_bytes2(code, 0x0F, 0x97); emit_byte(code, 0xC0);  // seta al
+      break;
+
+    case OPERATOR_LTE:  // xmm1 >= xmm0
+      emit(code, ucomisd_10, sizeof(ucomisd_10));
+      emit_bytes2(code, 0x0F, 0x93); emit_byte(code, 0xC0);  // setae al
+      break;
+
+    case OPERATOR_GT:
+      emit(code, ucomisd_01, sizeof(ucomisd_01));
+      emit_bytes2(code, 0x0F, 0x97); emit_byte(code, 0xC0);  // seta al
+      break;
+
+    case OPERATOR_GTE:
+      emit(code, ucomisd_01, sizeof(ucomisd_01));
+      emit_bytes2(code, 0x0F, 0x93); emit_byte(code, 0xC0);  // setae al
+      break;
+
+    case OPERATOR_EQUAL:  // equal and ordered
+      emit(code, ucomisd_01, sizeof(ucomisd_01));
+      emit_bytes2(code, 0x0F, 0x94); emit_byte(code, 0xC0);  // sete al
+      emit_bytes2(code, 0x0F, 0x9B); emit_byte(code, 0xC1);  // setnp cl
+      emit_bytes2(code, 0x20, 0xC8);                         // and al, cl
+      break;
+
+    default:  // OPERATOR_NOT_EQUAL: not equal or unordered
+      emit(code, ucomisd_01, sizeof(ucomisd_01));
+      emit_bytes2(code, 0x0F, 0x95); emit_byte(code, 0xC0);  // setne al
+      emit_bytes2(code, 0x0F, 0x9A); emit_byte(code, 0xC1);  // setp cl
+      emit_bytes2(code, 0x08, 0xC8);                         // or al, cl
+      break;
+  }
+}
+
+//
+// emit_store_tag
+//
+// Sets the type of the given variable's cell.
+//
+static void emit_store_tag(struct CODE* code, struct TRACE* trace, int var, int type)
+{
+  unsigned char mov_imm[] = { 0xC7 };  // mov dword [rbx+disp], imm32
+  emit_rbx_operand(code, mov_imm, sizeof(mov_imm), 0, cell_tag(trace->addrs[var]));
+  emit_int32(code, type);
+}
+
+//
+// trace_assignment
+//
+// Emits code for an assignment in the loop body and updates the
+// types in the trace. Returns false if the assignment can't be
+// compiled.
+//
+static bool trace_assignment(struct CODE* code, struct TRACE* trace, struct STMT* stmt)
+{
+  struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+
+  if (assign->rhs->value_type != VALUE_EXPR || assign->index != NULL || assign->var_slot >= 0)
+    return false;
+
+  struct VALUE_EXPR* expr = assign->rhs->types.expr;
+
+  int lhs_var;
+  int lhs_type = unary_type(trace, expr->lhs, &lhs_var);
+  int result_type;
+
+  if (!expr->isBinaryExpr) {
+    //
+    // x = y, x = 123, x = True, ...
+    //
+    if (!is_numeric(lhs_type) && lhs_type != RAM_TYPE_BOOLEAN)
+      return false;
+
+    result_type = lhs_type;
+  }
+  else {
+    int rhs_var;
+    int rhs_type = unary_type(trace, expr->rhs, &rhs_var);
+
+    if (!is_numeric(lhs_type) || !is_numeric(rhs_type))
+      return false;
+
+    if (is_relational(expr->operator))
+      result_type = RAM_TYPE_BOOLEAN;
+    else if (expr->operator <= OPERATOR_DIV)
+      result_type = (lhs_type == RAM_TYPE_INT && rhs_type == RAM_TYPE_INT) ? RAM_TYPE_INT : RAM_TYPE_REAL;
+    else
+      return false;  // is, in
+
+    emit_load_operand(code, trace, expr->lhs->element, lhs_type, lhs_var, 0);
+    emit_load_operand(code, trace, expr->rhs->element, rhs_type, rhs_var, 1);
+
+    switch (expr->operator)
+    {
+      case OPERATOR_PLUS:     { unsigned char op[] = { 0xF2, 0x0F, 0x58, 0xC1 }; emit(code, op, sizeof(op)); break; }
+      case OPERATOR_MINUS:    { unsigned char op[] = { 0xF2, 0x0F, 0x5C, 0xC1 }; emit(code, op, sizeof(op)); break; }
+      case OPERATOR_ASTERISK: { unsigned char op[] = { 0xF2, 0x0F, 0x59, 0xC1 }; emit(code, op, sizeof(op)); break; }
+      case OPERATOR_DIV:      { unsigned char op[] = { 0xF2, 0x0F, 0x5E, 0xC1 }; emit(code, op, sizeof(op)); break; }
+      case OPERATOR_POWER:    emit_call(code, (void (*)(void))pow); break;
+      case OPERATOR_MOD:      emit_call(code, (void (*)(void))fmod); break;
+      default:                emit_relational(code, expr->operator); break;
+    }
+  }
+
+  //
+  // now store the result, to x or *p:
+  //
+  int dst;
+
+  if (assign->isPtrDeref) {
+    struct ELEMENT ptr = { .element_type = ELEMENT_IDENTIFIER, .element_value = assign->var_name, .slot = -1, .next = NULL };
+    dst = deref_var(trace, &ptr);
+  }
+  else {
+    int dst_address = ram_get_addr(trace->memory, assign->var_name);
+    if (dst_address < 0)
+      return false;
+
+    dst = find_var(trace, dst_address);
+  }
+
+  if (dst < 0)
+    return false;
+
+  int32_t payload = cell_payload(trace->addrs[dst]);
+
+  if (expr->isBinaryExpr) {
+    if (result_type == RAM_TYPE_BOOLEAN) {
+      unsigned char movzx[] = { 0x0F, 0xB6, 0xC0 };  // movzx eax, al
+      emit(code, movzx, sizeof(movzx));
+      unsigned char mov[] = { 0x89 };                // mov [rbx+disp], eax
+      emit_rbx_operand(code, mov, sizeof(mov), 0, payload);
+    }
+    else if (result_type == RAM_TYPE_INT) {
+      unsigned char cvttsd2si[] = { 0xF2, 0x0F, 0x2C, 0xC0 };  // cvttsd2si eax, xmm0
+      emit(code, cvttsd2si, sizeof(cvttsd2si));
+      unsigned char mov[] = { 0x89 };
+      emit_rbx_operand(code, mov, sizeof(mov), 0, payload);
+    }
+    else {
+      unsigned char movsd[] = { 0xF2, 0x0F, 0x11 };  // movsd [rbx+disp], xmm0
+      emit_rbx_operand(code, movsd, sizeof(movsd), 0, payload);
+    }
+  }
+  else if (lhs_var >= 0) {
+    //
+    // copy the payload of another variable:
+    //
+    if (result_type == RAM_TYPE_REAL) {
+      unsigned char load[] = { 0x48, 0x8B };   // mov rax, [rbx+disp]
+      emit_rbx_operand(code, load, sizeof(load), 0, cell_payload(trace->addrs[lhs_var]));
+      unsigned char store[] = { 0x48, 0x89 };  // mov [rbx+disp], rax
+      emit_rbx_operand(code, store, sizeof(store), 0, payload);
+    }
+    else {
+      unsigned char load[] = { 0x8B };   // mov eax, [rbx+disp]
+      emit_rbx_operand(code, load, sizeof(load), 0, cell_payload(trace->addrs[lhs_var]));
+      unsigned char store[] = { 0x89 };  // mov [rbx+disp], eax
+      emit_rbx_operand(code, store, sizeof(store), 0, payload);
+    }
+  }
+  else if (result_type == RAM_TYPE_REAL) {
+    double d = expr->lhs->element->literal.d;
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+
+    emit_bytes2(code, 0x48, 0xB8);  // mov rax, imm64
+    emit_int64(code, bits);
+    unsigned char store[] = { 0x48, 0x89 };
+    emit_rbx_operand(code, store, sizeof(store), 0, payload);
+  }
+  else {
+    int i;
+    if (result_type == RAM_TYPE_INT)
+      i = expr->lhs->element->literal.i;
+    else
+      i = (expr->lhs->element->element_type == ELEMENT_TRUE);
+
+    unsigned char mov_imm[] = { 0xC7 };  // mov dword [rbx+disp], imm32
+    emit_rbx_operand(code, mov_imm, sizeof(mov_imm), 0, payload);
+    emit_int32(code, i);
+  }
+
+  emit_store_tag(code, trace, dst, result_type);
+  trace->types[dst] = result_type;
+  trace->stored[dst] = true;
+
+  return true;
+}
+
+//
+// trace_print
+//
+// Emits code for a call to print() in the loop body, producing
+// exactly what execute_function_call would. Returns false if the
+// call can't be compiled.
+//
+static bool trace_print(struct CODE* code, struct TRACE* trace, struct STMT* stmt)
+{
+  static const char* true_line = "True\n";
+  static const char* false_line = "False\n";
+
+  struct STMT_FUNCTION_CALL* call = stmt->types.function_call;
+
+  if (call->function != NULL || strcmp(call->function_name, "print") != 0)
+    return false;  // not the builtin print()
+
+  if (call->parameter != NULL && call->parameter->next != NULL)
+    return false;  // print(x, y)
+
+  if (call->parameter != NULL) {
+    struct ELEMENT* element = call->parameter;
+    int var;
+    int type = element_type(trace, element, &var);
+
+    if (type == RAM_TYPE_STR && var < 0) {
+      emit_bytes2(code, 0x48, 0xBF);  // mov rdi, imm64
+      emit_int64(code, (uint64_t)(uintptr_t)element->element_value);
+      emit_call(code, (void (*)(void))output_string);
+    }
+    else if (type == RAM_TYPE_BOOLEAN) {
+      if (var < 0) {
+        emit_bytes2(code, 0x48, 0xBF);  // mov rdi, imm64
+        emit_int64(code, (uint64_t)(uintptr_t)(element->element_type == ELEMENT_TRUE ? true_line : false_line));
+      }
+      else {
+        emit_bytes2(code, 0x48, 0xBF);  // mov rdi, imm64
+        emit_int64(code, (uint64_t)(uintptr_t)true_line);
+        emit_bytes2(code, 0x48, 0xBE);  // mov rsi, imm64
+        emit_int64(code, (uint64_t)(uintptr_t)false_line);
+        unsigned char load[] = { 0x8B };  // mov eax, [rbx+disp]
+        emit_rbx_operand(code, load, sizeof(load), 0, cell_payload(trace->addrs[var]));
+        emit_bytes2(code, 0x85, 0xC0);    // test eax, eax
+        unsigned char cmovz[] = { 0x48, 0x0F, 0x44, 0xFE };  // cmovz rdi, rsi
+        emit(code, cmovz, sizeof(cmovz));
+      }
+      emit_call(code, (void (*)(void))output_string);
+      return true;  // the string includes the newline
+    }
+    else if (type == RAM_TYPE_INT) {
+      if (var >= 0) {
+        unsigned char load[] = { 0x8B };  // mov edi, [rbx+disp]
+        emit_rbx_operand(code, load, sizeof(load), 7, cell_payload(trace->addrs[var]));
+      }
+      else {
+        emit_byte(code, 0xBF);  // mov edi, imm32
+        emit_int32(code, element->literal.i);
+      }
+      emit_call(code, (void (*)(void))output_int);
+    }
+    else if (type == RAM_TYPE_REAL) {
+      if (var >= 0) {
+        unsigned char movsd[] = { 0xF2, 0x0F, 0x10 };  // movsd xmm0, [rbx+disp]
+        emit_rbx_operand(code, movsd, sizeof(movsd), 0, cell_payload(trace->addrs[var]));
+      }
+      else {
+        emit_load_double(code, 0, element->literal.d);
+      }
+      emit_call(code, (void (*)(void))output_real);
+    }
+    else {
+      return false;
+    }
+  }
+
+  emit_byte(code, 0xBF);  // mov edi, '\n'
+  emit_int32(code, '\n');
+  emit_call(code, (void (*)(void))output_char);
+
+  return true;
+}
+
+//
+// compile_loop
+//
+// Traces the body of the given while loop against the current
+// contents of memory and, if the whole body can be compiled,
+// stores executable code for it in the loop. Returns true if
+// successful, false if not.
+//
+// Generated code:
+//
+//        push callee-saved regs; rbx = values, r13 = max iterations,
+//        r14 = &iterations, r15 = 0
+//        guard: type of each var == type seen when tracing, and each
+//               dereferenced pointer == address seen when tracing,
+//               else return JIT_NOT_RUN
+//   top: condition, false => return JIT_LOOP_DONE
+//        r15 >= r13 => return JIT_OUT_OF_STEPS
+//        body
+//        r15++, jmp top
+//
+static bool compile_loop(struct JIT* jit, struct JIT_LOOP* jit_loop)
+{
+  struct STMT_WHILE_LOOP* while_loop = jit_loop->loop->types.while_loop;
+  struct VALUE_EXPR* condition = while_loop->condition;
+
+  struct TRACE trace;
+  trace.memory = jit->memory;
+  trace.num_vars = 0;
+
+  struct CODE body = { NULL, 0, 0, false };
+  struct CODE code = { NULL, 0, 0, false };
+  bool success = false;
+
+  //
+  // the condition must be a relational test on numbers:
+  //
+  if (!condition->isBinaryExpr || !is_relational(condition->operator))
+    goto done;
+
+  int lhs_var, rhs_var;
+  int lhs_type = unary_type(&trace, condition->lhs, &lhs_var);
+  int rhs_type = unary_type(&trace, condition->rhs, &rhs_var);
+
+  if (!is_numeric(lhs_type) || !is_numeric(rhs_type))
+    goto done;
+
+  //
+  // trace the body, which the program graph links back to the loop:
+  //
+  int body_length = 0;
+  struct STMT* stmt = while_loop->loop_body;
+
+  while (stmt != jit_loop->loop) {
+    if (stmt == NULL)
+      goto done;
+
+    body_length++;
+
+    if (stmt->stmt_type == STMT_ASSIGNMENT) {
+      if (!trace_assignment(&body, &trace, stmt))
+        goto done;
+      stmt = stmt->types.assignment->next_stmt;
+    }
+    else if (stmt->stmt_type == STMT_FUNCTION_CALL) {
+      if (!trace_print(&body, &trace, stmt))
+        goto done;
+      stmt = stmt->types.function_call->next_stmt;
+    }
+    else if (stmt->stmt_type == STMT_PASS) {
+      stmt = stmt->types.pass->next_stmt;
+    }
+    else {
+      goto done;  // nested loops are compiled on their own
+    }
+  }
+
+  //
+  // the types have to be the same at the end of the body as they
+  // were on entry, otherwise the next iteration would need a
+  // different trace:
+  //
+  for (int i = 0; i < trace.num_vars; i++) {
+    if (trace.types[i] != trace.entry_types[i])
+      goto done;
+  }
+
+  //
+  // and dereferenced pointers have to stay put:
+  //
+  for (int i = 0; i < trace.num_vars; i++) {
+    if (trace.is_base[i] && trace.stored[i])
+      goto done;
+  }
+
+  //
+  // prologue: 5 pushes keep the stack 16-byte aligned for calls
+  //
+  emit_byte(&code, 0x53);                             // push rbx
+  emit_bytes2(&code, 0x41, 0x54);                     // push r12
+  emit_bytes2(&code, 0x41, 0x55);                     // push r13
+  emit_bytes2(&code, 0x41, 0x56);                     // push r14
+  emit_bytes2(&code, 0x41, 0x57);                     // push r15
+  emit_bytes2(&code, 0x48, 0x89); emit_byte(&code, 0xFB);  // mov rbx, rdi
+  emit_bytes2(&code, 0x49, 0x89); emit_byte(&code, 0xF5);  // mov r13, rsi
+  emit_bytes2(&code, 0x49, 0x89); emit_byte(&code, 0xD6);  // mov r14, rdx
+  emit_bytes2(&code, 0x45, 0x31); emit_byte(&code, 0xFF);  // xor r15d, r15d
+
+  //
+  // type guards, and pointer guards (the bounds checks for *p,
+  // hoisted out of the loop):
+  //
+  size_t guard_jumps[2 * JIT_MAX_VARS];
+  int num_guards = 0;
+
+  for (int i = 0; i < trace.num_vars; i++) {
+    unsigned char cmp[] = { 0x81 };  // cmp dword [rbx+disp], imm32
+    unsigned char jne[] = { 0x0F, 0x85 };
+
+    emit_rbx_operand(&code, cmp, sizeof(cmp), 7, cell_tag(trace.addrs[i]));
+    emit_int32(&code, trace.entry_types[i]);
+    guard_jumps[num_guards++] = emit_jump(&code, jne, sizeof(jne));
+
+    if (trace.is_base[i]) {
+      emit_rbx_operand(&code, cmp, sizeof(cmp), 7, cell_payload(trace.addrs[i]));
+      emit_int32(&code, trace.targets[i]);
+      guard_jumps[num_guards++] = emit_jump(&code, jne, sizeof(jne));
+    }
+  }
+
+  //
+  // top of loop: condition (types on entry == types at the end):
+  //
+  size_t top = code.size;
+
+  emit_load_operand(&code, &trace, condition->lhs->element, lhs_type, lhs_var, 0);
+  emit_load_operand(&code, &trace, condition->rhs->element, rhs_type, rhs_var, 1);
+  emit_relational(&code, condition->operator);
+  emit_bytes2(&code, 0x84, 0xC0);  // test al, al
+
+  unsigned char jz[] = { 0x0F, 0x84 };
+  size_t exit_done = emit_jump(&code, jz, sizeof(jz));
+
+  unsigned char cmp_budget[] = { 0x4D, 0x39, 0xEF };  // cmp r15, r13
+  emit(&code, cmp_budget, sizeof(cmp_budget));
+  unsigned char jae[] = { 0x0F, 0x83 };
+  size_t exit_budget = emit_jump(&code, jae, sizeof(jae));
+
+  emit(&code, body.bytes, body.size);
+
+  unsigned char inc[] = { 0x49, 0xFF, 0xC7 };  // inc r15
+  emit(&code, inc, sizeof(inc));
+  unsigned char jmp[] = { 0xE9 };
+  patch_jump(&code, emit_jump(&code, jmp, sizeof(jmp)), top);
+
+  //
+  // exits: store the iteration count and return the result
+  //
+  int results[] = { JIT_LOOP_DONE, JIT_OUT_OF_STEPS, JIT_NOT_RUN };
+  size_t* jumps[] = { &exit_done, &exit_budget, NULL };
+
+  for (int r = 0; r < 3; r++) {
+    if (jumps[r] != NULL)
+      patch_jump(&code, *jumps[r], code.size);
+    else {
+      for (int i = 0; i < num_guards; i++)
+        patch_jump(&code, guard_jumps[i], code.size);
+    }
+
+    unsigned char store[] = { 0x4D, 0x89, 0x3E };  // mov [r14], r15
+    emit(&code, store, sizeof(store));
+    emit_byte(&code, 0xB8);                         // mov eax, imm32
+    emit_int32(&code, results[r]);
+    emit_bytes2(&code, 0x41, 0x5F);                 // pop r15
+    emit_bytes2(&code, 0x41, 0x5E);                 // pop r14
+    emit_bytes2(&code, 0x41, 0x5D);                 // pop r13
+    emit_bytes2(&code, 0x41, 0x5C);                 // pop r12
+    emit_byte(&code, 0x5B);                         // pop rbx
+    emit_byte(&code, 0xC3);                         // ret
+  }
+
+  if (body.failed || code.failed)
+    goto done;
+
+  //
+  // copy into an executable buffer (writable, then executable):
+  //
+  void* buffer = mmap(NULL, code.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffer == MAP_FAILED)
+    goto done;
+
+  memcpy(buffer, code.bytes, code.size);
+
+  if (mprotect(buffer, code.size, PROT_READ | PROT_EXEC) != 0) {
+    munmap(buffer, code.size);
+    goto done;
+  }
+
+  jit_loop->code = buffer;
+  jit_loop->code_size = code.size;
+  jit_loop->body_length = body_length;
+  success = true;
+
+done:
+  free(body.bytes);
+  free(code.bytes);
+
+  return success;
+}
+
+//
+// lookup_loop
+//
+// Returns the entry for the given while loop, adding it if
+// necessary. Returns NULL if out of memory.
+//
+static struct JIT_LOOP* lookup_loop(struct JIT* jit, struct STMT* loop)
+{
+  //
+  // keep the table at most half full:
+  //
+  if (2 * (jit->num_loops + 1) > jit->capacity) {
+    int capacity = jit->capacity * 2;
+    struct JIT_LOOP* loops = (struct JIT_LOOP*)calloc(capacity, sizeof(struct JIT_LOOP));
+    if (loops == NULL)
+      return NULL;
+
+    for (int i = 0; i < jit->capacity; i++) {
+      if (jit->loops[i].loop == NULL)
+        continue;
+
+      size_t h = ((uintptr_t)jit->loops[i].loop >> 4) & (capacity - 1);
+      while (loops[h].loop != NULL)
+        h = (h + 1) & (capacity - 1);
+
+      loops[h] = jit->loops[i];
+    }
+
+    free(jit->loops);
+    jit->loops = loops;
+    jit->capacity = capacity;
+  }
+
+  size_t h = ((uintptr_t)loop >> 4) & (jit->capacity - 1);
+
+  while (jit->loops[h].loop != NULL) {
+    if (jit->loops[h].loop == loop)
+      return &jit->loops[h];
+
+    h = (h + 1) & (jit->capacity - 1);
+  }
+
+  jit->loops[h].loop = loop;
+  jit->num_loops++;
+
+  return &jit->loops[h];
+}
+
+
+//
+// Public functions:
+//
+
+//
+// jit_init
+//
+// Returns a pointer to a dynamically-allocated JIT for executing
+// loops against the given memory.
+//
+struct JIT* jit_init(struct RAM* memory)
+{
+  struct JIT* jit = (struct JIT*)malloc(sizeof(struct JIT));
+  if (jit == NULL)
+    return NULL;
+
+  jit->memory = memory;
+  jit->num_loops = 0;
+  jit->capacity = 16;
+  jit->loops = (struct JIT_LOOP*)calloc(jit->capacity, sizeof(struct JIT_LOOP));
+
+  if (jit->loops == NULL) {
+    free(jit);
+    return NULL;
+  }
+
+  return jit;
+}
+
+//
+// jit_destroy
+//
+// Frees the JIT and all its compiled code.
+//
+void jit_destroy(struct JIT* jit)
+{
+  if (jit == NULL)
+    return;
+
+  for (int i = 0; i < jit->capacity; i++) {
+    if (jit->loops[i].code != NULL)
+      munmap(jit->loops[i].code, jit->loops[i].code_size);
+  }
+
+  free(jit->loops);
+  free(jit);
+}
+
+//
+// jit_run_loop
+//
+// Runs the given while loop natively if it's hot and compiled,
+// for at most max_steps statements.
+//
+int jit_run_loop(struct JIT* jit, struct STMT* loop, long long max_steps, long long* steps)
+{
+  *steps = 0;
+
+  struct JIT_LOOP* jit_loop = lookup_loop(jit, loop);
+  if (jit_loop == NULL)
+    return JIT_NOT_RUN;
+
+  if (jit_loop->state == LOOP_COUNTING) {
+    jit_loop->visits++;
+
+    if (jit_loop->visits < JIT_HOT_ITERATIONS)
+      return JIT_NOT_RUN;
+
+    jit_loop->state = compile_loop(jit, jit_loop) ? LOOP_COMPILED : LOOP_REJECTED;
+  }
+
+  if (jit_loop->state != LOOP_COMPILED)
+    return JIT_NOT_RUN;
+
+  //
+  // each iteration costs the condition + the body, and we need
+  // room for the final test of the condition:
+  //
+  long long per_iteration = 1 + jit_loop->body_length;
+  long long max_iterations = (max_steps - 1) / per_iteration;
+
+  if (max_iterations <= 0)
+    return JIT_NOT_RUN;
+
+  long long iterations = 0;
+  JIT_CODE code = (JIT_CODE)jit_loop->code;
+
+  int result = code(jit->memory->values, max_iterations, &iterations);
+
+  if (result == JIT_LOOP_DONE)
+    *steps = iterations * per_iteration + 1;
+  else if (result == JIT_OUT_OF_STEPS)
+    *steps = iterations * per_iteration;
+
+  return result;
+}
+
+#else
+
+//
+// No JIT on other platforms:
+//
+struct JIT* jit_init(struct RAM* memory)
+{
+  return NULL;
+}
+
+void jit_destroy(struct JIT* jit)
+{
+}
+
+int jit_run_loop(struct JIT* jit, struct STMT* loop, long long max_steps, long long* steps)
+{
+  *steps = 0;
+  return JIT_NOT_RUN;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*jit.h*/
+
+//
+// Tracing JIT for hot nuPython while loops. Once a while loop has
+// run a few iterations in the interpreter, its body is compiled to
+// x86-64 machine code specialized for the types of the variables
+// it touches (e.g. int counters, real accumulators). The compiled
+// loop checks those types each time it is entered, and falls back
+// to the interpreter if they have changed.
+//
+// Only loops whose bodies are straight-line numeric code are
+// compiled: assignments of int/real expressions, relational
+// expressions, print() and pass. Variables may also be accessed
+// through pointers (*p) as long as the loop doesn't change p.
+// Everything else, including loops that use the local variables
+// of a function, is left to the interpreter. Results match
+// execute.c exactly, since the machine code performs the same
+// double-precision operations and conversions as the interpreter.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include "programgraph.h"
+#include "ram.h"
+
+
+//
+// Result of asking the JIT to run a loop:
+//
+enum JIT_RESULTS
+{
+  JIT_NOT_RUN = 0,     // not compiled (yet), or a type guard failed
+  JIT_LOOP_DONE,       // ran until the loop condition was false
+  JIT_OUT_OF_STEPS     // stopped at the top of the loop, budget used up
+};
+
+struct JIT;  // compiled loops for one program and memory
+
+
+//
+// Public functions:
+//
+
+//
+// jit_init
+//
+// Returns a pointer to a dynamically-allocated JIT for executing
+// loops against the given memory, or NULL if the JIT is not
+// available on this platform.
+//
+struct JIT* jit_init(struct RAM* memory);
+
+//
+// jit_destroy
+//
+// Frees the JIT and all its compiled code.
+//
+void jit_destroy(struct JIT* jit);
+
+//
+// jit_run_loop
+//
+// Called each time the interpreter reaches the given while loop.
+// If the loop is hot and has been compiled, runs it natively for
+// at most max_steps statements (counted the same way execute_step
+// counts them) and returns JIT_LOOP_DONE or JIT_OUT_OF_STEPS, with
+// the # of statements executed returned via steps. Otherwise,
+// returns JIT_NOT_RUN and the interpreter should execute the loop
+// statement as usual.
+//
+int jit_run_loop(struct JIT* jit, struct STMT* loop, long long max_steps, long long* steps);
@@ -17,7 +17,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>  // true, false
-#include <string.h>   // strcspn
+#include <string.h>   // strcspn, strcmp
 
 #include "token.h"    // token defs
 #include "scanner.h" 
@@ -25,34 +25,124 @@
 #include "programgraph.h"
 #include "ram.h"
 #include "execute.h"
+#include "output.h"
+#include "input.h"
+#include "infer.h"
+#include "optimize.h"
+#include "repl.h"
+#include "shared.h"
+
+
+#define SHARED_CELLS 256  // of the program's shared RAM
 
 
 //
 // main
 //
-// usage: program.exe [filename.py]
+// usage: program.exe [-nojit] [-noopt] [-verbose] [-batch] [-limit N] [-repl | filename.py]
 // 
 // If a filename is given, the file is opened and serves as
 // input to the scanner. If a filename is not given, then 
 // input is taken from the keyboard until $ is input.
 //
+// Options:
+//   -nojit    execute everything in the interpreter (no JIT)
+//   -noopt    execute the program graph as built (no optimizer)
+//   -verbose  also output what the optimizer removed or moved
+//   -batch    input() reads stdin in large blocks, without
+//             prompts, for input redirected from a file
+//   -limit N  the program's memory may use at most N bytes; going
+//             over is an execution error (see ram_set_limit)
+//   -repl     run an interactive session instead, executing each
+//             statement as it's entered (see repl.h)
+//
+// Programs get a shared RAM of their own for the builtins
+// shared_get() etc. (see shared.h).
+//
 int main(int argc, char* argv[])
 {
   FILE* input = NULL;
   bool  keyboardInput = false;
+  bool  verbose = false;
+  bool  optimizing = true;
+  bool  interactive = false;
+  long long limit = 0;  // bytes, 0 => no limit
+
+  //
+  // options come before the filename:
+  //
+  int arg = 1;
+
+  while (arg < argc && argv[arg][0] == '-') {
+    if (strcmp(argv[arg], "-nojit") == 0)
+      execute_set_jit(false);
+    else if (strcmp(argv[arg], "-noopt") == 0)
+      optimizing = false;
+    else if (strcmp(argv[arg], "-verbose") == 0)
+      verbose = true;
+    else if (strcmp(argv[arg], "-batch") == 0)
+      input_init(INPUT_BATCH);
+    else if (strcmp(argv[arg], "-repl") == 0)
+      interactive = true;
+    else if (strcmp(argv[arg], "-limit") == 0) {
+      arg++;
+
+      if (arg >= argc || atoll(argv[arg]) <= 0) {
+        printf("**ERROR: -limit needs a positive # of bytes.\n");
+        return 0;
+      }
+
+      limit = atoll(argv[arg]);
+    }
+    else {
+      printf("**ERROR: unknown option '%s'.\n", argv[arg]);
+      return 0;
+    }
+
+    arg++;
+  }
+
+  //
+  // the shared RAM, whose builtins must be registered before the
+  // first program is prepared:
+  //
+  struct SHARED_RAM* shared = shared_create(SHARED_CELLS);
+
+  if (shared == NULL || !shared_register()) {
+    printf("**ERROR: unable to create the shared RAM.\n");
+    return 0;
+  }
+
+  if (interactive) {
+    //
+    // one memory for the whole session, printed at the end:
+    //
+    struct RAM* memory = ram_init();
+    ram_set_limit(memory, limit);
+
+    output_init(OUTPUT_FLUSH_LINE, 0);
+
+    repl_run(memory, shared);
+
+    printf("**done\n");
+    ram_print(memory);
 
-  if (argc < 2) {
+    shared_destroy(shared);
+    return 0;
+  }
+
+  if (arg >= argc) {
     //
-    // no args, just the program name:
+    // no filename:
     //
     input = stdin;
     keyboardInput = true;
   }
   else {
     //
-    // assume 2nd arg is a nuPython file:
+    // assume next arg is a nuPython file:
     //
-    char* filename = argv[1];
+    char* filename = argv[arg];
 
     input = fopen(filename, "r");
 
@@ -93,20 +183,66 @@ int main(int argc, char* argv[])
 
     struct STMT* program = programgraph_build(tokens);
 
-    programgraph_print(program);
+    if (program != NULL)
+      programgraph_print(program);
 
     //
-    // now execute the program:
+    // infer types, which also catches type errors before
+    // anything runs:
     //
-    printf("**executing...\n");
+    if (program == NULL)
+    {
+      //
+      // program has a semantic error found while building the
+      // graph (e.g. an int literal out of range), error msg
+      // already output:
+      //
+    }
+    else if (infer_types(program) > 0)
+    {
+      //
+      // program has type errors, error msgs already output:
+      //
+    }
+    else
+    {
+      //
+      // remove or move what can't change the program's output:
+      //
+      struct OPTIMIZE_STATS stats;
 
-    struct RAM* memory = ram_init();
+      if (optimizing)
+        program = optimize(program, &stats);
 
-    execute(program, memory);
+      if (verbose && optimizing)
+        printf("**optimized: removed %d pass, %d unreachable, %d dead store statements; moved %d out of loops\n",
+          stats.passes, stats.unreachable, stats.dead_stores, stats.hoisted);
 
-    printf("**done\n");
+      //
+      // now execute the program:
+      //
+      printf("**executing...\n");
 
-    ram_print(memory);
+      execute_prepare(program);
+
+      struct RAM* memory = ram_init();
+      ram_set_limit(memory, limit);
+
+      //
+      // interactive sessions see each line as it's printed, 
+      // otherwise output is buffered until execution ends:
+      //
+      if (keyboardInput)
+        output_init(OUTPUT_FLUSH_LINE, 0);
+      else
+        output_init(OUTPUT_FLUSH_AT_EXIT, 0);
+
+      execute(program, memory, shared);
+
+      printf("**done\n");
+
+      ram_print(memory);
+    }
   }
 
   //
@@ -115,5 +251,7 @@ int main(int argc, char* argv[])
   if (!keyboardInput)
     fclose(input);
 
+  shared_destroy(shared);
+
   return 0;
 }
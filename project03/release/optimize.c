@@ -0,0 +1,996 @@
+/*optimize.c*/
+
+//
+// Optimization pass over nuPython program graphs; see optimize.h.
+//
+// A block of statements (the program, or a loop body) is linked
+// in one direction only, so each block is first gathered into an
+// array, going forward to work out which variables are surely
+// assigned at each statement. Liveness then goes backward over the
+// array, and finally the statements that stay are linked together
+// again. Sets of variables are bit sets, one bit per variable.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>   // strcmp, memcpy, memset
+
+#include "programgraph.h"
+#include "ram.h"
+#include "util.h"     // dupString, struct NameSet
+#include "optimize.h"
+#include "output.h"
+
+
+typedef unsigned long long WORD;  // 64 variables of a set
+
+#define WORD_BITS 64
+
+//
+// The variables of the program, numbered in the order they are
+// found:
+//
+struct OPTIMIZER
+{
+  struct NameSet vars;  // names are copies
+
+  int    num_words;   // # of WORDs in a set of variables
+  bool   pointers;    // does the program use & or *?
+  bool   calls;       // does it call functions defined with def?
+
+  struct OPTIMIZE_STATS stats;
+};
+
+//
+// What happens to a statement of a block:
+//
+enum FATES
+{
+  FATE_KEEP = 0,
+  FATE_PASS,         // a pass, removed
+  FATE_UNREACHABLE,  // a loop that never runs, removed
+  FATE_DEAD_STORE    // an assignment nobody reads, removed
+};
+
+struct ENTRY
+{
+  struct STMT* stmt;
+  int   fate;      // enum FATES
+  bool  safe;      // can't fail, and has no effect but its assignment?
+  WORD* defined;   // loops: variables surely assigned when the body starts
+};
+
+
+//
+// Private functions:
+//
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**OPTIMIZE ERROR\n");
+  printf("**OPTIMIZE ERROR: %s\n", msg);
+  printf("**OPTIMIZE ERROR\n");
+
+  exit(-123);
+}
+
+//
+// find_var
+//
+// Returns the # of the variable with the given name, which must
+// have been numbered.
+//
+static int find_var(struct OPTIMIZER* opt, char* name)
+{
+  return nameSetFind(&opt->vars, name, false);
+}
+
+//
+// next_link
+//
+// Returns a pointer to the given statement's next_stmt field, where
+// the statement that follows it is linked in (after the loop, for a
+// loop); NULL for an if statement, which isn't supported.
+//
+static struct STMT** next_link(struct STMT* stmt)
+{
+  switch (stmt->stmt_type)
+  {
+    case STMT_ASSIGNMENT:    return &stmt->types.assignment->next_stmt;
+    case STMT_FUNCTION_CALL: return &stmt->types.function_call->next_stmt;
+    case STMT_WHILE_LOOP:    return &stmt->types.while_loop->next_stmt;
+    case STMT_FOR_LOOP:      return &stmt->types.for_loop->next_stmt;
+    case STMT_PASS:          return &stmt->types.pass->next_stmt;
+    case STMT_FUNCTION_DEF:  return &stmt->types.function_def->next_stmt;
+    default:                 return NULL;
+  }
+}
+
+//
+// Sets of variables:
+//
+static WORD* set_alloc(struct OPTIMIZER* opt)
+{
+  WORD* set = (WORD*)malloc(opt->num_words * sizeof(WORD));
+  if (set == NULL)
+    panic("out of memory (set_alloc)");
+
+  return set;
+}
+
+static WORD* set_copy(struct OPTIMIZER* opt, WORD* set)
+{
+  WORD* copy = set_alloc(opt);
+
+  memcpy(copy, set, opt->num_words * sizeof(WORD));
+
+  return copy;
+}
+
+static void set_fill(struct OPTIMIZER* opt, WORD* set, bool all)
+{
+  memset(set, all ? 0xFF : 0, opt->num_words * sizeof(WORD));
+}
+
+static bool set_has(WORD* set, int var)
+{
+  return (set[var / WORD_BITS] >> (var % WORD_BITS)) & 1;
+}
+
+static void set_add(WORD* set, int var)
+{
+  set[var / WORD_BITS] |= 1ull << (var % WORD_BITS);
+}
+
+static void set_remove(WORD* set, int var)
+{
+  set[var / WORD_BITS] &= ~(1ull << (var % WORD_BITS));
+}
+
+//
+// add_reads
+//
+// Adds the variables in a chain of elements, or in an expression,
+// to the given set.
+//
+static void add_reads(struct OPTIMIZER* opt, WORD* set, struct ELEMENT* element)
+{
+  for ( ; element != NULL; element = element->next) {
+    if (element->element_type == ELEMENT_IDENTIFIER)
+      set_add(set, find_var(opt, element->element_value));
+  }
+}
+
+static void add_expr_reads(struct OPTIMIZER* opt, WORD* set, struct VALUE_EXPR* expr)
+{
+  add_reads(opt, set, expr->lhs->element);
+  add_reads(opt, set, expr->lhs->index);
+
+  if (expr->isBinaryExpr) {
+    add_reads(opt, set, expr->rhs->element);
+    add_reads(opt, set, expr->rhs->index);
+  }
+}
+
+//
+// safe_element
+//
+// Can reading the given element fail? A literal can't, nor can a
+// variable that is surely assigned by now.
+//
+static bool safe_element(struct OPTIMIZER* opt, WORD* defined, struct ELEMENT* element)
+{
+  if (element->element_type != ELEMENT_IDENTIFIER)
+    return true;
+
+  return set_has(defined, find_var(opt, element->element_value));
+}
+
+//
+// safe_expr
+//
+// Is the given expression safe to evaluate --- it can't fail, and
+// it doesn't allocate memory, which could exceed the memory's
+// limit? Either a number, boolean or None, or a numeric operation
+// (not is or in) on operands known to be numbers.
+//
+static bool safe_expr(struct OPTIMIZER* opt, WORD* defined, struct VALUE_EXPR* expr)
+{
+  if (expr->lhs->expr_type != UNARY_ELEMENT || !safe_element(opt, defined, expr->lhs->element))
+    return false;
+
+  int lhs_type = expr->lhs_type;
+
+  if (!expr->isBinaryExpr)
+    return lhs_type == RAM_TYPE_INT || lhs_type == RAM_TYPE_REAL ||
+           lhs_type == RAM_TYPE_BOOLEAN || lhs_type == RAM_TYPE_NONE;
+
+  if (expr->rhs->expr_type != UNARY_ELEMENT || !safe_element(opt, defined, expr->rhs->element))
+    return false;
+
+  int rhs_type = expr->rhs_type;
+
+  return (lhs_type == RAM_TYPE_INT || lhs_type == RAM_TYPE_REAL) &&
+         (rhs_type == RAM_TYPE_INT || rhs_type == RAM_TYPE_REAL) &&
+         expr->operator <= OPERATOR_GTE;
+}
+
+//
+// safe_stmt
+//
+// Is the given assignment or function call safe to execute --- it
+// can't fail, and has no effect but to assign its variable? Either
+// an assignment of a safe expression to a variable that is surely
+// assigned already, or a print() of literals and such variables.
+//
+static bool safe_stmt(struct OPTIMIZER* opt, WORD* defined, struct STMT* stmt)
+{
+  if (stmt->stmt_type == STMT_ASSIGNMENT) {
+    struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+
+    if (assign->isPtrDeref || assign->index != NULL || assign->rhs->value_type != VALUE_EXPR)
+      return false;
+
+    return set_has(defined, find_var(opt, assign->var_name)) &&
+           safe_expr(opt, defined, assign->rhs->types.expr);
+  }
+
+  if (stmt->stmt_type == STMT_FUNCTION_CALL) {
+    struct STMT_FUNCTION_CALL* call = stmt->types.function_call;
+
+    if (call->function != NULL || strcmp(call->function_name, "print") != 0)
+      return false;
+
+    for (struct ELEMENT* param = call->parameter; param != NULL; param = param->next) {
+      if (!safe_element(opt, defined, param))
+        return false;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+//
+// note_assigned
+//
+// Adds the variables surely assigned once the given assignment or
+// function call has executed to the given set: a statement only
+// goes on if the variables it reads have values.
+//
+static void note_assigned(struct OPTIMIZER* opt, WORD* assigned, struct STMT* stmt)
+{
+  if (stmt->stmt_type == STMT_ASSIGNMENT) {
+    struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+
+    if (assign->rhs->value_type == VALUE_EXPR)
+      add_expr_reads(opt, assigned, assign->rhs->types.expr);
+
+    add_reads(opt, assigned, assign->index);
+    set_add(assigned, find_var(opt, assign->var_name));
+  }
+  else if (stmt->stmt_type == STMT_FUNCTION_CALL) {
+    add_reads(opt, assigned, stmt->types.function_call->parameter);
+  }
+}
+
+//
+// never_true
+//
+// Is the given loop condition a comparison of two number literals
+// that is false, e.g. 1 > 2? The comparison is done on doubles, as
+// execute_binary_expr does.
+//
+static bool never_true(struct VALUE_EXPR* condition)
+{
+  struct UNARY_EXPR* lhs = condition->lhs;
+  struct UNARY_EXPR* rhs = condition->rhs;
+
+  if (!condition->isBinaryExpr || lhs->expr_type != UNARY_ELEMENT || rhs->expr_type != UNARY_ELEMENT)
+    return false;
+
+  int l = lhs->element->element_type;
+  int r = rhs->element->element_type;
+
+  if ((l != ELEMENT_INT_LITERAL && l != ELEMENT_REAL_LITERAL) ||
+      (r != ELEMENT_INT_LITERAL && r != ELEMENT_REAL_LITERAL))
+    return false;
+
+  double left = (l == ELEMENT_INT_LITERAL) ? lhs->element->literal.i : lhs->element->literal.d;
+  double right = (r == ELEMENT_INT_LITERAL) ? rhs->element->literal.i : rhs->element->literal.d;
+
+  switch (condition->operator)
+  {
+    case OPERATOR_EQUAL:     return !(left == right);
+    case OPERATOR_NOT_EQUAL: return !(left != right);
+    case OPERATOR_LT:        return !(left < right);
+    case OPERATOR_LTE:       return !(left <= right);
+    case OPERATOR_GT:        return !(left > right);
+    case OPERATOR_GTE:       return !(left >= right);
+    default:                 return false;
+  }
+}
+
+//
+// count_block
+//
+// Returns the # of statements in the given block, counting the
+// bodies of loops too.
+//
+static int count_block(struct STMT* stmt, struct STMT* stop)
+{
+  int count = 0;
+
+  for ( ; stmt != NULL && stmt != stop; stmt = *next_link(stmt)) {
+    count++;
+
+    if (stmt->stmt_type == STMT_WHILE_LOOP)
+      count += count_block(stmt->types.while_loop->loop_body, stmt);
+    else if (stmt->stmt_type == STMT_FOR_LOOP)
+      count += count_block(stmt->types.for_loop->loop_body, stmt);
+  }
+
+  return count;
+}
+
+static void optimize_block(struct OPTIMIZER* opt, struct STMT** link, struct STMT* stop, WORD* defined, WORD* live, bool remove);
+
+//
+// optimize_while
+//
+// Works out liveness for the given while loop, optimizing its body
+// if remove is true: on entry live holds the variables live after
+// the loop, on return those live at the top of the loop. The body
+// is analyzed over and over, each time with everything found live
+// at the top so far, until the top stops changing.
+//
+static void optimize_while(struct OPTIMIZER* opt, struct ENTRY* entry, WORD* live, bool remove)
+{
+  struct STMT* loop = entry->stmt;
+  struct STMT_WHILE_LOOP* while_loop = loop->types.while_loop;
+
+  WORD* body = set_alloc(opt);
+
+  if (!entry->safe) {
+    //
+    // the condition could fail, so everything is live there:
+    //
+    set_fill(opt, live, true);
+    set_fill(opt, body, true);
+
+    optimize_block(opt, &while_loop->loop_body, loop, entry->defined, body, remove);
+
+    free(body);
+    return;
+  }
+
+  //
+  // the top leads to the condition, and then to the body or to
+  // after the loop:
+  //
+  add_expr_reads(opt, live, while_loop->condition);
+
+  for (;;) {
+    memcpy(body, live, opt->num_words * sizeof(WORD));
+
+    optimize_block(opt, &while_loop->loop_body, loop, entry->defined, body, false);
+
+    bool changed = false;
+
+    for (int w = 0; w < opt->num_words; w++) {
+      if ((live[w] | body[w]) != live[w]) {
+        live[w] |= body[w];
+        changed = true;
+      }
+    }
+
+    if (!changed)
+      break;
+  }
+
+  if (remove) {
+    memcpy(body, live, opt->num_words * sizeof(WORD));
+
+    optimize_block(opt, &while_loop->loop_body, loop, entry->defined, body, true);
+  }
+
+  free(body);
+}
+
+//
+// optimize_block
+//
+// Optimizes the block of statements linked in at *link, up to the
+// given stop statement (the loop a body links back to, or NULL for
+// the program); defined holds the variables surely assigned at the
+// start of the block. On entry live holds the variables live at the
+// end of the block, on return those live at its start. Statements
+// are only removed if remove is true; otherwise this is just one
+// step of settling a loop.
+//
+static void optimize_block(struct OPTIMIZER* opt, struct STMT** link, struct STMT* stop, WORD* defined, WORD* live, bool remove)
+{
+  int n = 0;
+  int capacity = 16;
+  struct ENTRY* entries = (struct ENTRY*)malloc(capacity * sizeof(struct ENTRY));
+  WORD* assigned = set_copy(opt, defined);
+
+  if (entries == NULL)
+    panic("out of memory (optimize_block)");
+
+  //
+  // forward: what's surely assigned at each statement? A statement
+  // that reads or assigns a variable only goes on if the variable
+  // has a value; a loop body may not run at all:
+  //
+  for (struct STMT* stmt = *link; stmt != NULL && stmt != stop; stmt = *next_link(stmt)) {
+    if (n == capacity) {
+      capacity *= 2;
+      entries = (struct ENTRY*)realloc(entries, capacity * sizeof(struct ENTRY));
+      if (entries == NULL)
+        panic("out of memory (optimize_block)");
+    }
+
+    struct ENTRY* entry = &entries[n++];
+
+    entry->stmt = stmt;
+    entry->fate = FATE_KEEP;
+    entry->safe = false;
+    entry->defined = NULL;
+
+    if (stmt->stmt_type == STMT_PASS) {
+      entry->fate = FATE_PASS;
+    }
+    else if (stmt->stmt_type == STMT_ASSIGNMENT || stmt->stmt_type == STMT_FUNCTION_CALL) {
+      entry->safe = safe_stmt(opt, assigned, stmt);
+      note_assigned(opt, assigned, stmt);
+    }
+    else if (stmt->stmt_type == STMT_WHILE_LOOP) {
+      struct VALUE_EXPR* condition = stmt->types.while_loop->condition;
+
+      if (never_true(condition)) {
+        entry->fate = FATE_UNREACHABLE;
+        continue;
+      }
+
+      entry->safe = safe_expr(opt, assigned, condition);
+
+      add_expr_reads(opt, assigned, condition);
+      entry->defined = set_copy(opt, assigned);
+    }
+    else if (stmt->stmt_type == STMT_FOR_LOOP) {
+      struct STMT_FOR_LOOP* for_loop = stmt->types.for_loop;
+
+      add_reads(opt, assigned, for_loop->iterable);
+      entry->defined = set_copy(opt, assigned);
+      set_add(entry->defined, find_var(opt, for_loop->var_name));
+    }
+    else if (stmt->stmt_type == STMT_FUNCTION_DEF) {
+      continue;  // runs nothing
+    }
+    else {
+      n--;    // if statements are not supported, so stop here and
+      break;  // leave the rest of the block as it is
+    }
+  }
+
+  //
+  // backward: what's live before each statement? A statement that
+  // might fail makes everything live, since the memory is printed
+  // when execution stops:
+  //
+  for (int i = n - 1; i >= 0; i--) {
+    struct ENTRY* entry = &entries[i];
+    struct STMT* stmt = entry->stmt;
+
+    if (entry->fate != FATE_KEEP)
+      continue;
+
+    if (stmt->stmt_type == STMT_ASSIGNMENT) {
+      struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+
+      if (!entry->safe) {
+        set_fill(opt, live, true);
+        continue;
+      }
+
+      int var = find_var(opt, assign->var_name);
+
+      if (!set_has(live, var) && !opt->pointers) {
+        entry->fate = FATE_DEAD_STORE;
+        continue;
+      }
+
+      set_remove(live, var);
+      add_expr_reads(opt, live, assign->rhs->types.expr);
+    }
+    else if (stmt->stmt_type == STMT_FUNCTION_CALL) {
+      if (entry->safe)
+        add_reads(opt, live, stmt->types.function_call->parameter);
+      else
+        set_fill(opt, live, true);
+    }
+    else if (stmt->stmt_type == STMT_WHILE_LOOP) {
+      optimize_while(opt, entry, live, remove);
+    }
+    else if (stmt->stmt_type == STMT_FOR_LOOP) {
+      //
+      // a for loop could fail (the iterable might not be a list),
+      // so everything is live at its top:
+      //
+      set_fill(opt, live, true);
+
+      WORD* body = set_copy(opt, live);
+
+      optimize_block(opt, &stmt->types.for_loop->loop_body, stmt, entry->defined, body, remove);
+
+      free(body);
+    }
+    else if (stmt->stmt_type != STMT_FUNCTION_DEF) {
+      set_fill(opt, live, true);
+    }
+  }
+
+  if (remove) {
+    //
+    // a loop body can't be empty, so it keeps its last statement
+    // if need be:
+    //
+    int kept = 0;
+
+    for (int i = 0; i < n; i++) {
+      if (entries[i].fate == FATE_KEEP)
+        kept++;
+    }
+
+    if (kept == 0 && stop != NULL && n > 0)
+      entries[n - 1].fate = FATE_KEEP;
+
+    //
+    // link up the statements that stay, and free the others:
+    //
+    struct STMT* end = (n > 0) ? *next_link(entries[n - 1].stmt) : *link;
+    struct STMT** next = link;
+
+    for (int i = 0; i < n; i++) {
+      struct ENTRY* entry = &entries[i];
+      struct STMT* stmt = entry->stmt;
+
+      if (entry->fate == FATE_KEEP) {
+        *next = stmt;
+        next = next_link(stmt);
+        continue;
+      }
+
+      if (entry->fate == FATE_PASS)
+        opt->stats.passes++;
+      else if (entry->fate == FATE_UNREACHABLE)
+        opt->stats.unreachable += count_block(stmt, *next_link(stmt));
+      else
+        opt->stats.dead_stores++;
+
+      *next_link(stmt) = NULL;
+      programgraph_destroy(stmt);
+    }
+
+    *next = end;
+  }
+
+  for (int i = 0; i < n; i++)
+    free(entries[i].defined);
+
+  free(entries);
+  free(assigned);
+}
+
+
+//
+// add_stmt_reads
+//
+// Adds the variables the given statement reads to the given set,
+// including those read in the body of a loop.
+//
+static void add_stmt_reads(struct OPTIMIZER* opt, WORD* set, struct STMT* stmt)
+{
+  if (stmt->stmt_type == STMT_ASSIGNMENT) {
+    struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+    struct VALUE* rhs = assign->rhs;
+
+    if (assign->isPtrDeref || assign->index != NULL)
+      set_add(set, find_var(opt, assign->var_name));
+
+    add_reads(opt, set, assign->index);
+
+    if (rhs->value_type == VALUE_EXPR)
+      add_expr_reads(opt, set, rhs->types.expr);
+    else if (rhs->value_type == VALUE_FUNCTION_CALL)
+      add_reads(opt, set, rhs->types.function_call->parameter);
+    else if (rhs->value_type == VALUE_LIST)
+      add_reads(opt, set, rhs->types.list->elements);
+    else if (rhs->value_type == VALUE_DICT) {
+      add_reads(opt, set, rhs->types.dict->keys);
+      add_reads(opt, set, rhs->types.dict->values);
+    }
+  }
+  else if (stmt->stmt_type == STMT_FUNCTION_CALL) {
+    add_reads(opt, set, stmt->types.function_call->parameter);
+  }
+  else if (stmt->stmt_type == STMT_WHILE_LOOP) {
+    add_expr_reads(opt, set, stmt->types.while_loop->condition);
+
+    for (struct STMT* s = stmt->types.while_loop->loop_body; s != stmt; s = *next_link(s))
+      add_stmt_reads(opt, set, s);
+  }
+  else if (stmt->stmt_type == STMT_FOR_LOOP) {
+    add_reads(opt, set, stmt->types.for_loop->iterable);
+
+    for (struct STMT* s = stmt->types.for_loop->loop_body; s != stmt; s = *next_link(s))
+      add_stmt_reads(opt, set, s);
+  }
+}
+
+//
+// count_writes
+//
+// Counts the statements in the given block (a loop body, with the
+// bodies of its loops) that assign each variable.
+//
+static void count_writes(struct OPTIMIZER* opt, struct STMT* stmt, struct STMT* stop, int* writes)
+{
+  for ( ; stmt != stop; stmt = *next_link(stmt)) {
+    if (stmt->stmt_type == STMT_ASSIGNMENT)
+      writes[find_var(opt, stmt->types.assignment->var_name)]++;
+    else if (stmt->stmt_type == STMT_WHILE_LOOP)
+      count_writes(opt, stmt->types.while_loop->loop_body, stmt, writes);
+    else if (stmt->stmt_type == STMT_FOR_LOOP) {
+      writes[find_var(opt, stmt->types.for_loop->var_name)]++;
+      count_writes(opt, stmt->types.for_loop->loop_body, stmt, writes);
+    }
+  }
+}
+
+//
+// invariant
+//
+// Can the given statement of a loop body be moved in front of the
+// loop? It must be an assignment that can't fail, the only one to
+// assign its variable in the loop, of a safe expression whose
+// variables the loop doesn't assign. The variable must not be read
+// by the condition or before the statement, which would see the
+// value from before the loop the first time around. And it must be
+// assigned already, unless nothing stays in the body before the
+// statement, or moving it would change the order variables are
+// created in.
+//
+static bool invariant(struct OPTIMIZER* opt, struct STMT* stmt, WORD* defined, int* writes, WORD* read, bool first)
+{
+  if (stmt->stmt_type != STMT_ASSIGNMENT)
+    return false;
+
+  struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+
+  if (assign->isPtrDeref || assign->index != NULL || assign->rhs->value_type != VALUE_EXPR)
+    return false;
+
+  struct VALUE_EXPR* expr = assign->rhs->types.expr;
+  int var = find_var(opt, assign->var_name);
+
+  if (writes[var] != 1 || set_has(read, var) || (!first && !set_has(defined, var)) ||
+      !safe_expr(opt, defined, expr))
+    return false;
+
+  struct ELEMENT* lhs = expr->lhs->element;
+  struct ELEMENT* rhs = expr->isBinaryExpr ? expr->rhs->element : NULL;
+
+  if (lhs->element_type == ELEMENT_IDENTIFIER && writes[find_var(opt, lhs->element_value)] > 0)
+    return false;
+
+  if (rhs != NULL && rhs->element_type == ELEMENT_IDENTIFIER && writes[find_var(opt, rhs->element_value)] > 0)
+    return false;
+
+  return true;
+}
+
+//
+// copy_elements / copy_unary / copy_expr
+//
+// Returns a copy of a chain of elements, a unary expression, or an
+// expression, allocated the way programgraph_build does, so that
+// programgraph_destroy frees it.
+//
+static struct ELEMENT* copy_elements(struct ELEMENT* element)
+{
+  if (element == NULL)
+    return NULL;
+
+  struct ELEMENT* copy = (struct ELEMENT*)malloc(sizeof(struct ELEMENT));
+  if (copy == NULL)
+    panic("out of memory (copy_elements)");
+
+  copy->element_type = element->element_type;
+  copy->element_value = (element->element_value == NULL) ? NULL : dupString(element->element_value);
+  copy->slot = element->slot;
+  copy->literal = element->literal;
+  copy->next = copy_elements(element->next);
+
+  return copy;
+}
+
+static struct UNARY_EXPR* copy_unary(struct UNARY_EXPR* unary)
+{
+  if (unary == NULL)
+    return NULL;
+
+  struct UNARY_EXPR* copy = (struct UNARY_EXPR*)malloc(sizeof(struct UNARY_EXPR));
+  if (copy == NULL)
+    panic("out of memory (copy_unary)");
+
+  copy->expr_type = unary->expr_type;
+  copy->element = copy_elements(unary->element);
+  copy->index = copy_elements(unary->index);
+
+  return copy;
+}
+
+static struct VALUE_EXPR* copy_expr(struct VALUE_EXPR* expr)
+{
+  struct VALUE_EXPR* copy = (struct VALUE_EXPR*)malloc(sizeof(struct VALUE_EXPR));
+  if (copy == NULL)
+    panic("out of memory (copy_expr)");
+
+  *copy = *expr;
+  copy->lhs = copy_unary(expr->lhs);
+  copy->rhs = copy_unary(expr->rhs);
+
+  return copy;
+}
+
+//
+// hoist_loop
+//
+// Moves the invariant assignments of the while loop linked in at
+// *link in front of it; defined holds the variables surely assigned
+// once the condition has been evaluated, and on return also those
+// assigned by the statements moved, for the body. The body is scanned from
+// the top, up to the first statement that might fail, since until
+// then nothing can tell the assignments have already happened.
+//
+// The graph has no if statements, so the assignments go into a new
+// loop with the same condition, which runs them once and then the
+// original loop, whose end leads back to the new loop's condition:
+//
+//   while c:              while c:
+//   { ...                 { x = a * b
+//     x = a * b     =>      while c:
+//     ...                   { ... }
+//   }                     }
+//
+// The condition is false the second time around, since nothing in
+// between assigns its variables. So the assignments run only if
+// the loop runs, as they did before.
+//
+static void hoist_loop(struct OPTIMIZER* opt, struct STMT** link, WORD* defined)
+{
+  struct STMT* loop = *link;
+  struct STMT_WHILE_LOOP* while_loop = loop->types.while_loop;
+
+  int* writes = (int*)calloc(opt->vars.num_names + 1, sizeof(int));
+  WORD* read = set_alloc(opt);
+  WORD* assigned = defined;
+
+  if (writes == NULL)
+    panic("out of memory (hoist_loop)");
+
+  count_writes(opt, while_loop->loop_body, loop, writes);
+
+  set_fill(opt, read, false);
+  add_expr_reads(opt, read, while_loop->condition);
+
+  struct STMT* hoisted = NULL;
+  struct STMT** hoisted_end = &hoisted;
+  struct STMT** body_link = &while_loop->loop_body;
+  int num_hoisted = 0;
+  int num_kept = 0;
+
+  while (*body_link != loop) {
+    struct STMT* stmt = *body_link;
+    struct STMT* next = *next_link(stmt);
+
+    //
+    // a body can't be empty, so the last statement stays if
+    // nothing else does:
+    //
+    if (invariant(opt, stmt, assigned, writes, read, num_kept == 0) && (next != loop || num_kept > 0)) {
+      *body_link = next;
+
+      *hoisted_end = stmt;
+      hoisted_end = next_link(stmt);
+      num_hoisted++;
+
+      //
+      // the variable now has the same value every time around:
+      //
+      int var = find_var(opt, stmt->types.assignment->var_name);
+
+      writes[var] = 0;
+      set_add(assigned, var);
+      continue;
+    }
+
+    add_stmt_reads(opt, read, stmt);
+
+    if (!safe_stmt(opt, assigned, stmt) && stmt->stmt_type != STMT_PASS)
+      break;
+
+    note_assigned(opt, assigned, stmt);
+
+    body_link = next_link(stmt);
+    num_kept++;
+  }
+
+  if (num_hoisted > 0) {
+    struct STMT* guard = (struct STMT*)malloc(sizeof(struct STMT));
+    if (guard == NULL)
+      panic("out of memory (hoist_loop)");
+
+    guard->stmt_type = STMT_WHILE_LOOP;
+    guard->line = loop->line;
+    guard->types.while_loop = (struct STMT_WHILE_LOOP*)malloc(sizeof(struct STMT_WHILE_LOOP));
+    if (guard->types.while_loop == NULL)
+      panic("out of memory (hoist_loop)");
+
+    guard->types.while_loop->condition = copy_expr(while_loop->condition);
+    guard->types.while_loop->loop_body = hoisted;
+    guard->types.while_loop->next_stmt = while_loop->next_stmt;
+
+    *hoisted_end = loop;
+    while_loop->next_stmt = guard;
+    *link = guard;
+
+    opt->stats.hoisted += num_hoisted;
+  }
+
+  free(writes);
+  free(read);
+}
+
+//
+// hoist_block
+//
+// Moves invariant assignments out of the while loops in the block
+// of statements linked in at *link, up to the given stop statement,
+// and out of the loops nested in them; defined holds the variables
+// surely assigned at the start of the block.
+//
+static void hoist_block(struct OPTIMIZER* opt, struct STMT** link, struct STMT* stop, WORD* defined)
+{
+  WORD* assigned = set_copy(opt, defined);
+
+  for ( ; *link != NULL && *link != stop; link = next_link(*link)) {
+    struct STMT* stmt = *link;
+
+    if (stmt->stmt_type == STMT_ASSIGNMENT || stmt->stmt_type == STMT_FUNCTION_CALL) {
+      note_assigned(opt, assigned, stmt);
+    }
+    else if (stmt->stmt_type == STMT_WHILE_LOOP) {
+      add_expr_reads(opt, assigned, stmt->types.while_loop->condition);
+
+      //
+      // this loop, then the loops in its body; *link is now the
+      // new loop in front of it, if any:
+      //
+      WORD* body = set_copy(opt, assigned);
+
+      hoist_loop(opt, link, body);
+      hoist_block(opt, &stmt->types.while_loop->loop_body, stmt, body);
+
+      free(body);
+    }
+    else if (stmt->stmt_type == STMT_FOR_LOOP) {
+      struct STMT_FOR_LOOP* for_loop = stmt->types.for_loop;
+      WORD* body = set_copy(opt, assigned);
+
+      add_reads(opt, body, for_loop->iterable);
+      set_add(body, find_var(opt, for_loop->var_name));
+
+      hoist_block(opt, &for_loop->loop_body, stmt, body);
+
+      add_reads(opt, assigned, for_loop->iterable);
+      free(body);
+    }
+    else if (stmt->stmt_type != STMT_PASS && stmt->stmt_type != STMT_FUNCTION_DEF) {
+      break;  // if statements are not supported
+    }
+  }
+
+  free(assigned);
+}
+
+
+//
+// Public functions:
+//
+
+//
+// optimize
+//
+// Optimizes the program and returns it. Removing a dead store can
+// make another one dead (x = 1; y = x; y = 2; x = 3), so that pass
+// repeats until a round removes no more; then invariant assignments
+// are moved out of loops.
+//
+struct STMT* optimize(struct STMT* program, struct OPTIMIZE_STATS* stats)
+{
+  struct OPTIMIZER opt;
+
+  memset(&opt.vars, 0, sizeof(opt.vars));
+  memset(&opt.stats, 0, sizeof(opt.stats));
+
+  programgraph_variables(program, &opt.vars, &opt.pointers, &opt.calls);
+
+  //
+  // the names are copied, since the statements they come from may
+  // be removed:
+  //
+  for (int v = 0; v < opt.vars.num_names; v++)
+    opt.vars.names[v] = dupString(opt.vars.names[v]);
+
+  opt.num_words = (opt.vars.num_names + WORD_BITS - 1) / WORD_BITS;
+
+  if (opt.num_words == 0)
+    opt.num_words = 1;
+
+  WORD* defined = set_alloc(&opt);
+  WORD* live = set_alloc(&opt);
+
+  int dead_stores;
+
+  do {
+    dead_stores = opt.stats.dead_stores;
+
+    //
+    // nothing is assigned at the start, and everything is live at
+    // the end, when the memory is printed:
+    //
+    set_fill(&opt, defined, false);
+    set_fill(&opt, live, true);
+
+    optimize_block(&opt, &program, NULL, defined, live, true);
+  } while (opt.stats.dead_stores > dead_stores);
+
+  //
+  // through a pointer, a loop could assign any variable, and so
+  // could a function it calls:
+  //
+  if (!opt.pointers && !opt.calls) {
+    set_fill(&opt, defined, false);
+
+    hoist_block(&opt, &program, NULL, defined);
+  }
+
+  if (stats != NULL)
+    *stats = opt.stats;
+
+  free(defined);
+  free(live);
+
+  for (int v = 0; v < opt.vars.num_names; v++)
+    free(opt.vars.names[v]);
+
+  nameSetFree(&opt.vars);
+
+  return program;
+}
@@ -0,0 +1,69 @@
+/*optimize.h*/
+
+//
+// Optimization pass over nuPython program graphs. It removes
+// statements that can't change what a program does:
+//
+//   - pass statements (a loop body keeps one statement, since a
+//     body can't be empty);
+//   - while loops whose condition compares two number literals
+//     and is false, e.g. while 1 > 2: { ... }, together with
+//     their bodies;
+//   - dead stores, assignments like x = y * 2 where x is always
+//     assigned again before its value is read.
+//
+// It also moves loop-invariant assignments, like x = y * 2 in a
+// while loop that assigns neither x nor y anywhere else, in front
+// of the loop, so they run once instead of every time around.
+//
+// Dead stores are found with a liveness analysis that goes around
+// loops until nothing changes. Every variable is live at the end
+// of the program, since the memory is printed then, and also at
+// any statement that might fail, since execution stops there and
+// the memory is printed too. Only assignments that can't fail and
+// have no other effect are removed: a variable (already assigned)
+// set to a number, boolean or None, or to a numeric expression
+// whose operand types infer_types has worked out. The same goes for
+// the assignments moved out of loops, except that one at the top
+// of a body may also assign a new variable; nothing before them in
+// the body may fail. A program that uses pointers keeps all
+// of its assignments where they are, and a program that calls
+// functions defined with def keeps them in its loops. Function
+// bodies are not optimized.
+//
+// The program prints the same output and ends with the same
+// memory; only the memory in the middle of execution may differ,
+// e.g. between calls to execute_step.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include "programgraph.h"
+
+
+//
+// # of statements removed, by reason, and moved:
+//
+struct OPTIMIZE_STATS
+{
+  int passes;       // pass statements
+  int unreachable;  // loops that never run, and their bodies
+  int dead_stores;  // assignments whose value is never read
+  int hoisted;      // invariant assignments moved out of loops
+};
+
+
+//
+// optimize
+//
+// Optimizes the given program, which should have been annotated
+// by infer_types first, and returns it; the first statement may
+// have been removed or replaced, so the result replaces the
+// program. The removed statements are freed. If stats is not
+// NULL, the # of statements removed and moved is returned there.
+//
+struct STMT* optimize(struct STMT* program, struct OPTIMIZE_STATS* stats);
@@ -0,0 +1,345 @@
+/*output.c*/
+
+//
+// Buffered output for the nuPython executor. Output produced by
+// print() and friends is collected in a large user-space buffer
+// and written to stdout according to a flush policy, instead of
+// going through printf one value at a time.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <stdarg.h>   // va_list
+#include <string.h>   // strlen, memcpy
+#include <math.h>     // fabs, floor, fma, fmod, signbit
+#include <stdatomic.h> // atomic_flag
+
+#include "output.h"
+
+
+//
+// the buffer and its policy; each thread has its own buffer and
+// policy so executors running on different threads don't
+// interfere:
+//
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+static _Thread_local char   buffer[OUTPUT_BUFFER_SIZE];
+static _Thread_local size_t used = 0;
+
+static _Thread_local int    flush_policy = OUTPUT_FLUSH_AT_EXIT;
+static _Thread_local size_t flush_threshold = OUTPUT_BUFFER_SIZE;
+
+//
+// the buffer of the thread that calls exit() is flushed by an
+// atexit handler, registered the first time anything is buffered:
+//
+static atomic_flag        registered = ATOMIC_FLAG_INIT;
+static _Thread_local bool checked = false;
+
+
+//
+// Private functions:
+//
+
+//
+// flush_at_exit
+//
+// The atexit handler: writes what the exiting thread buffered.
+//
+static void flush_at_exit(void)
+{
+  output_flush();
+}
+
+//
+// check_registered
+//
+// Registers flush_at_exit, once per process; called before the
+// buffer goes from empty to not.
+//
+static void check_registered(void)
+{
+  if (!checked) {
+    if (!atomic_flag_test_and_set(&registered))
+      atexit(flush_at_exit);
+
+    checked = true;
+  }
+}
+
+//
+// write_bytes
+//
+// Appends n bytes to the buffer, flushing as the buffer fills
+// up. Very large writes bypass the buffer altogether.
+//
+static void write_bytes(const char* bytes, size_t n)
+{
+  if (n > OUTPUT_BUFFER_SIZE - used) {
+    output_flush();
+
+    if (n >= OUTPUT_BUFFER_SIZE) {
+      fwrite(bytes, 1, n, stdout);
+      return;
+    }
+  }
+
+  if (used == 0)
+    check_registered();
+
+  memcpy(buffer + used, bytes, n);
+  used += n;
+}
+
+//
+// check_policy
+//
+// Called after each logical write to apply the flush policy;
+// ended_line is true if the write ended with a newline.
+//
+static void check_policy(bool ended_line)
+{
+  if (flush_policy == OUTPUT_FLUSH_LINE && ended_line)
+    output_flush();
+  else if (flush_policy == OUTPUT_FLUSH_SIZE && used >= flush_threshold)
+    output_flush();
+}
+
+//
+// format_uint
+//
+// Formats the given unsigned value into the end of the given
+// buffer, returning a pointer to the first digit. The buffer
+// must hold at least 20 chars.
+//
+static char* format_uint(unsigned long long value, char* end)
+{
+  char* p = end;
+
+  do {
+    *--p = (char)('0' + (value % 10));
+    value /= 10;
+  } while (value != 0);
+
+  return p;
+}
+
+
+//
+// Public functions:
+//
+
+//
+// output_init
+//
+// Sets the flush policy for subsequent output of the calling
+// thread; other threads keep their own, OUTPUT_FLUSH_AT_EXIT
+// unless they call this too. For the policy OUTPUT_FLUSH_SIZE,
+// the buffer is flushed once it holds at least threshold bytes;
+// the threshold is ignored for the other policies. Any output
+// already buffered is flushed first.
+//
+void output_init(int policy, size_t threshold)
+{
+  output_flush();
+
+  flush_policy = policy;
+
+  if (threshold == 0 || threshold > OUTPUT_BUFFER_SIZE)
+    threshold = OUTPUT_BUFFER_SIZE;
+
+  flush_threshold = threshold;
+}
+
+//
+// output_flush
+//
+// Writes any buffered output to stdout. The buffer of the thread
+// that calls exit() (or returns from main) is flushed then, but
+// other threads must flush their own before they end.
+//
+void output_flush(void)
+{
+  if (used > 0) {
+    fwrite(buffer, 1, used, stdout);
+    used = 0;
+  }
+
+  fflush(stdout);
+}
+
+//
+// output_string
+//
+// Appends the given C string to the output.
+//
+void output_string(const char* s)
+{
+  size_t n = strlen(s);
+
+  write_bytes(s, n);
+  check_policy(n > 0 && s[n - 1] == '\n');
+}
+
+//
+// output_char
+//
+// Appends a single character to the output.
+//
+void output_char(char c)
+{
+  if (used == OUTPUT_BUFFER_SIZE)
+    output_flush();
+
+  if (used == 0)
+    check_registered();
+
+  buffer[used++] = c;
+  check_policy(c == '\n');
+}
+
+//
+// output_int
+//
+// Appends an integer to the output, formatted like printf("%d").
+//
+void output_int(int i)
+{
+  char digits[24];
+  char* end = digits + sizeof(digits);
+
+  //
+  // negate as unsigned so INT_MIN works too:
+  //
+  unsigned long long magnitude = (i < 0) ? 0ULL - (unsigned long long)i : (unsigned long long)i;
+
+  char* p = format_uint(magnitude, end);
+
+  if (i < 0)
+    *--p = '-';
+
+  write_bytes(p, end - p);
+  check_policy(false);
+}
+
+//
+// output_real
+//
+// Appends a real to the output, formatted like printf("%lf"),
+// i.e. with exactly 6 digits after the decimal point. Values up
+// to 1e19, whose integer part fits in 64 bits, are formatted
+// directly; values near a rounding tie are settled exactly with
+// fma, rounding an exact tie to even as printf does. Only larger
+// values are handed to snprintf.
+//
+void output_real(double d)
+{
+  if (isnan(d)) {
+    output_string(signbit(d) ? "-nan" : "nan");
+    return;
+  }
+
+  if (isinf(d)) {
+    output_string(d < 0 ? "-inf" : "inf");
+    return;
+  }
+
+  if (fabs(d) >= 1e19) {
+    output_printf("%lf", d);
+    return;
+  }
+
+  double magnitude = fabs(d);
+  unsigned long long whole = (unsigned long long)magnitude;
+  double fraction = magnitude - (double)whole;  // exact
+
+  //
+  // scaling introduces an error of at most ~1e-10, so only a
+  // remainder near .5 needs a closer look, where fma computes 
+  // fraction * 1e6 - (floored + .5) with a single rounding, so 
+  // its sign is exact:
+  //
+  double scaled = fraction * 1000000.0;
+  double floored = floor(scaled);
+  double remainder = scaled - floored;
+  bool round_up = (remainder > 0.5);
+
+  if (fabs(remainder - 0.5) < 1e-6) {
+    double error = fma(fraction, 1000000.0, -(floored + 0.5));
+
+    if (error == 0.0)
+      round_up = (fmod(floored, 2.0) != 0.0);  // tie => even
+    else
+      round_up = (error > 0.0);
+  }
+
+  unsigned long long micros = (unsigned long long)floored;
+  if (round_up)
+    micros++;
+
+  if (micros == 1000000) {
+    whole++;
+    micros = 0;
+  }
+
+  char digits[48];
+  char* end = digits + sizeof(digits);
+  char* p = end;
+
+  for (int i = 0; i < 6; i++) {
+    *--p = (char)('0' + (micros % 10));
+    micros /= 10;
+  }
+  *--p = '.';
+
+  p = format_uint(whole, p);
+
+  if (signbit(d))
+    *--p = '-';
+
+  write_bytes(p, end - p);
+  check_policy(false);
+}
+
+//
+// output_printf
+//
+// Appends printf-style formatted output. Meant for error
+// messages and other infrequent output; use the functions
+// above on hot paths.
+//
+void output_printf(const char* format, ...)
+{
+  char  local[512];
+  char* s = local;
+
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(local, sizeof(local), format, args);
+  va_end(args);
+
+  if (n < 0)
+    return;
+
+  if ((size_t)n >= sizeof(local)) {
+    s = (char*)malloc(n + 1);
+    if (s == NULL)
+      return;
+
+    va_start(args, format);
+    vsnprintf(s, n + 1, format, args);
+    va_end(args);
+  }
+
+  write_bytes(s, n);
+  check_policy(n > 0 && s[n - 1] == '\n');
+
+  if (s != local)
+    free(s);
+}
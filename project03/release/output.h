@@ -0,0 +1,90 @@
+/*output.h*/
+
+//
+// Buffered output for the nuPython executor. Output produced by
+// print() and friends is collected in a large user-space buffer
+// and written to stdout according to a flush policy, instead of
+// going through printf one value at a time.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include <stddef.h>   // size_t
+
+
+//
+// When is the output buffer written to stdout?
+//
+enum OUTPUT_FLUSH_POLICIES
+{
+  OUTPUT_FLUSH_AT_EXIT = 0,  // only when full, or when output_flush() is called
+  OUTPUT_FLUSH_LINE,         // after every newline (interactive use)
+  OUTPUT_FLUSH_SIZE          // once the buffer holds at least N bytes
+};
+
+
+//
+// Public functions:
+//
+
+//
+// output_init
+//
+// Sets the flush policy for subsequent output of the calling
+// thread; other threads keep their own, OUTPUT_FLUSH_AT_EXIT
+// unless they call this too. For the policy OUTPUT_FLUSH_SIZE,
+// the buffer is flushed once it holds at least threshold bytes;
+// the threshold is ignored for the other policies. Any output
+// already buffered is flushed first.
+//
+void output_init(int policy, size_t threshold);
+
+//
+// output_flush
+//
+// Writes any buffered output to stdout. The buffer of the thread
+// that calls exit() (or returns from main) is flushed then, but
+// other threads must flush their own before they end.
+//
+void output_flush(void);
+
+//
+// output_string
+//
+// Appends the given C string to the output.
+//
+void output_string(const char* s);
+
+//
+// output_char
+//
+// Appends a single character to the output.
+//
+void output_char(char c);
+
+//
+// output_int
+//
+// Appends an integer to the output, formatted like printf("%d").
+//
+void output_int(int i);
+
+//
+// output_real
+//
+// Appends a real to the output, formatted like printf("%lf").
+//
+void output_real(double d);
+
+//
+// output_printf
+//
+// Appends printf-style formatted output. Meant for error
+// messages and other infrequent output; use the functions
+// above on hot paths.
+//
+void output_printf(const char* format, ...);
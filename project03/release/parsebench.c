@@ -0,0 +1,403 @@
+/*parsebench.c*/
+
+//
+// Front-end benchmark: generates synthetic nuPython programs of
+// 10K statements and up, by factors of 10, and times the two
+// phases in compiler.o, parser_parse and programgraph_build, on
+// each. Along with the time, each phase reports the peak memory
+// (resident set) during the phase, and the heap it leaves in use,
+// i.e. what the tokens and the program graph take up:
+//
+//   ./parsebench.out [max # of statements, default 100000]
+//
+// Memory grows linearly, so 1M statements needs 10x what 100K
+// does: the lists shape, the largest, peaks at ~1.1 GB for 100K
+// (tokens plus graph) and so ~11 GB for 1M; the others need a
+// fifth of that or less. The programs come in several shapes,
+// each stressing something else:
+//
+//   identifiers  x123 = x122 * 3, every variable a new name
+//   nesting      while loops nested 32 deep, over and over
+//   lists        list literals of 64 identifiers and literals
+//   calls        print() of 16 args, and the defs they call
+//
+// Each shape and size runs in a child process, which reports back
+// through a pipe, so peak memory is measured from a clean start and
+// a run that crashes or runs out of memory is reported as such
+// instead of ending the benchmark. Scaling should be linear: a
+// phase whose time or heap grows more than 15x from one size to
+// the next (10x) is flagged.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#define _XOPEN_SOURCE 700  // clock_gettime, fork, getrusage
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>      // true, false
+#include <string.h>       // memset
+#include <time.h>         // clock_gettime
+#include <unistd.h>       // fork, pipe
+#include <sys/wait.h>     // waitpid
+#include <sys/resource.h> // getrusage
+#ifdef __GLIBC__
+#include <malloc.h>       // mallinfo2
+#endif
+
+#include "parser.h"
+#include "programgraph.h"
+#include "tokenqueue.h"
+
+
+#define NESTING_DEPTH 32  // of the nesting shape
+#define LIST_LENGTH   64  // of the lists shape
+#define NUM_ARGS      16  // of the calls shape
+
+//
+// A phase's cost:
+//
+struct COST
+{
+  double seconds;
+  long   peak_kb;  // peak resident set during the phase
+  long   live_kb;  // rise in the heap in use
+};
+
+//
+// What a child reports for one program:
+//
+struct RESULT
+{
+  bool        ok;
+  bool        phase_peaks;  // false => peaks are the process's so far
+  long        bytes;        // of program text
+  struct COST parse;
+  struct COST build;
+};
+
+
+//
+// Private functions:
+//
+
+//
+// now
+//
+// Returns the current time in seconds, from a monotonic clock.
+//
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//
+// reset_peak
+//
+// Resets the peak resident set of this process to what it is now,
+// so the next peak_kb is the peak from here on. Linux only; returns
+// false if the peak can't be reset, in which case peak_kb is the
+// peak of the process so far.
+//
+static bool reset_peak(void)
+{
+  FILE* clear_refs = fopen("/proc/self/clear_refs", "w");
+  if (clear_refs == NULL)
+    return false;
+
+  bool ok = (fputs("5", clear_refs) >= 0);
+
+  return (fclose(clear_refs) == 0) && ok;
+}
+
+//
+// peak_kb
+//
+// Returns the peak resident set of this process since the last
+// reset_peak, in KB.
+//
+static long peak_kb(void)
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_maxrss;  // KB on Linux
+}
+
+//
+// live_kb
+//
+// Returns the heap in use right now, in KB, or 0 if the C library
+// can't tell us.
+//
+static long live_kb(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 info = mallinfo2();
+
+  return (long)((info.uordblks + info.hblkhd) / 1024);
+#else
+  return 0;
+#endif
+}
+
+//
+// Generating the programs: each writes n statements to the given
+// file, counting every statement, including loops and defs.
+//
+
+static void generate_identifiers(FILE* out, long n)
+{
+  fprintf(out, "x0 = 1\n");
+
+  for (long i = 1; i < n; i++)
+    fprintf(out, "x%ld = x%ld * 3\n", i, i - 1);
+}
+
+static void generate_nesting(FILE* out, long n)
+{
+  fprintf(out, "i = 0\n");
+
+  long count = 1;
+
+  while (count < n) {
+    int depth = 0;
+
+    //
+    // as deep as we can go, leaving room for the body:
+    //
+    while (depth < NESTING_DEPTH && count + depth + 1 < n) {
+      fprintf(out, "while i < %d:\n{\n", depth);
+      depth++;
+    }
+
+    fprintf(out, "i = i + 1\n");
+    count += depth + 1;
+
+    for (int d = 0; d < depth; d++)
+      fprintf(out, "}\n");
+  }
+}
+
+static void generate_lists(FILE* out, long n)
+{
+  fprintf(out, "a = 1\n");
+
+  for (long i = 1; i < n; i++) {
+    fprintf(out, "xs%ld = [", i);
+
+    for (int k = 0; k < LIST_LENGTH; k++)
+      fprintf(out, (k % 2 == 0) ? "%s%d" : "%sa", (k == 0) ? "" : ", ", k);
+
+    fprintf(out, "]\n");
+  }
+}
+
+static void generate_calls(FILE* out, long n)
+{
+  fprintf(out, "a = 1\n");
+
+  long count = 1;
+
+  for (long f = 0; count < n; f++) {
+    //
+    // a def every 100 statements, called by the ones after it:
+    //
+    if (f % 100 == 0 && count + 3 <= n) {
+      fprintf(out, "def f%ld(p, q):\n{\n  r = p + q\n  return r\n}\n", f);
+      count += 3;
+      continue;
+    }
+
+    if (f % 2 == 0) {
+      fprintf(out, "b = f%ld(a, a)\n", f - f % 100);
+    }
+    else {
+      fprintf(out, "print(");
+      for (int k = 0; k < NUM_ARGS; k++)
+        fprintf(out, (k % 2 == 0) ? "%sa" : "%s'%d'", (k == 0) ? "" : ", ", k);
+      fprintf(out, ")\n");
+    }
+
+    count++;
+  }
+}
+
+static struct
+{
+  char* name;
+  void (*generate)(FILE* out, long n);
+} shapes[] =
+{
+  { "identifiers", generate_identifiers },
+  { "nesting",     generate_nesting },
+  { "lists",       generate_lists },
+  { "calls",       generate_calls }
+};
+
+#define NUM_SHAPES ((int)(sizeof(shapes) / sizeof(shapes[0])))
+
+//
+// measure
+//
+// Generates a program of the given shape and size, then parses it
+// and builds its program graph, measuring both phases. Runs in the
+// child process.
+//
+static struct RESULT measure(int shape, long n)
+{
+  struct RESULT result;
+  memset(&result, 0, sizeof(result));
+
+  FILE* input = tmpfile();
+  if (input == NULL)
+    return result;
+
+  shapes[shape].generate(input, n);
+  result.bytes = ftell(input);
+  rewind(input);
+
+  result.phase_peaks = reset_peak();
+
+  long before = live_kb();
+  double start = now();
+
+  struct TokenQueue* tokens = parser_parse(input);
+
+  result.parse.seconds = now() - start;
+  result.parse.peak_kb = peak_kb();
+  result.parse.live_kb = live_kb() - before;
+
+  fclose(input);
+
+  if (tokens == NULL)
+    return result;
+
+  result.phase_peaks = reset_peak() && result.phase_peaks;
+
+  before = live_kb();
+  start = now();
+
+  struct STMT* program = programgraph_build(tokens);
+
+  result.build.seconds = now() - start;
+  result.build.peak_kb = peak_kb();
+  result.build.live_kb = live_kb() - before;
+
+  result.ok = (program != NULL);
+
+  programgraph_destroy(program);
+  tokenqueue_destroy(tokens);
+
+  return result;
+}
+
+//
+// run
+//
+// Measures a program of the given shape and size in a child
+// process, returning what it reports; ok is false if it failed.
+//
+static struct RESULT run(int shape, long n)
+{
+  struct RESULT result;
+  memset(&result, 0, sizeof(result));
+
+  int fds[2];
+  if (pipe(fds) != 0)
+    return result;
+
+  fflush(stdout);
+
+  pid_t pid = fork();
+
+  if (pid == 0) {
+    close(fds[0]);
+
+    struct RESULT measured = measure(shape, n);
+
+    if (write(fds[1], &measured, sizeof(measured)) != sizeof(measured))
+      _exit(1);
+
+    _exit(0);
+  }
+
+  close(fds[1]);
+
+  if (pid > 0) {
+    if (read(fds[0], &result, sizeof(result)) != sizeof(result))
+      result.ok = false;
+
+    waitpid(pid, NULL, 0);
+  }
+
+  close(fds[0]);
+
+  return result;
+}
+
+//
+// report
+//
+// Outputs a phase's cost, flagging it if it grew well beyond linear
+// since the previous (10x smaller) size.
+//
+static void report(char* phase, struct COST* cost, struct COST* previous)
+{
+  bool cliff = previous != NULL &&
+    ((previous->seconds > 0.01 && cost->seconds > 10.0 * previous->seconds * 1.5) ||
+     (previous->live_kb > 1024 && cost->live_kb > 10 * previous->live_kb * 3 / 2));
+
+  printf("  %s %8.3f s, peak %8.1f MB, live %8.1f MB%s\n", phase, cost->seconds,
+    cost->peak_kb / 1024.0, cost->live_kb / 1024.0, cliff ? " (**SUPERLINEAR**)" : "");
+}
+
+
+//
+// main
+//
+// usage: parsebench.out [max # of statements]
+//
+int main(int argc, char* argv[])
+{
+  long max = (argc > 1) ? atol(argv[1]) : 100000;
+  bool phase_peaks = true;
+
+  parser_init();
+
+  for (int shape = 0; shape < NUM_SHAPES; shape++) {
+    struct RESULT previous;
+    bool have_previous = false;
+
+    for (long n = 10000; n <= max; n *= 10) {
+      struct RESULT result = run(shape, n);
+
+      printf("%s, %ld stmts: ", shapes[shape].name, n);
+
+      if (!result.ok) {
+        printf("**FAILED (crashed, out of memory, or a syntax error)\n");
+        break;
+      }
+
+      printf("%.1f MB of text\n", result.bytes / (1024.0 * 1024.0));
+      report("parse", &result.parse, have_previous ? &previous.parse : NULL);
+      report("build", &result.build, have_previous ? &previous.build : NULL);
+
+      phase_peaks = phase_peaks && result.phase_peaks;
+
+      previous = result;
+      have_previous = true;
+    }
+  }
+
+  if (!phase_peaks)
+    printf("(couldn't reset the peak resident set between phases, so a\n"
+           " phase's peak is the process's peak up to its end)\n");
+
+  return 0;
+}
@@ -0,0 +1,1016 @@
+/*parser.c*/
+
+//
+// Recursive-descent parsing functions for nuPython programming language.
+// The parser is responsible for checking if the input follows the syntax
+// ("grammar") rules of nuPython. If successful, a copy of the tokens is
+// returned so the program can be analyzed and executed.
+//
+// Prof. Joe Hummel
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>
+#include <assert.h>
+
+#include "token.h"
+#include "tokenqueue.h"
+#include "scanner.h"
+#include "parser.h"
+#include "output.h"
+
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**PARSER ERROR\n");
+  printf("**PARSER ERROR: %s\n", msg);
+  printf("**PARSER ERROR\n");
+
+  exit(-123);
+}
+
+//
+// errorMsg
+//
+// Outputs a standard syntax error message.
+//
+static void errorMsg(char* expecting, char* value, struct Token found)
+{
+  printf("**SYNTAX ERROR: expecting %s, found '%s' @ (%d, %d)\n", expecting, value, found.line, found.col);
+}
+
+//
+// match
+//
+// Checks the current token to see if it matches the expected
+// token. If so, the token is stepped over and true is returned.
+// If not, an error message is output and false is returned.
+//
+static bool match(struct TokenQueue* tokens, int expectedID, char* expectedValue)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+  char* curValue = tokenqueue_peekValue(tokens);
+
+  if (curToken.id != expectedID)  // no match:
+  {
+    errorMsg(expectedValue, curValue, curToken);
+    return false;
+  }
+
+  //
+  // we have a match, step over the current token so we can move
+  // on to the next one; the tokens are parsed through a view of
+  // the queue (see parser_parse), so the token is not freed:
+  //
+  tokens->head = tokens->head->next;
+
+  if (tokens->head == NULL)
+    tokens->tail = NULL;
+
+  return true;
+}
+
+
+//
+// how many bodies { ... } deep are we, and are we inside a def?
+//
+static int  parser_depth = 0;
+static bool parser_inFunction = false;
+
+
+//
+// Forward declarations:
+//
+static bool parser_body(struct TokenQueue* tokens);
+static bool parser_else(struct TokenQueue* tokens);
+
+
+//
+// parser_isOperator
+//
+// Returns true if the given token denotes a binary operator,
+// false if not.
+//
+bool parser_isOperator(int tokenID)
+{
+  switch (tokenID)
+  {
+    case nuPy_PLUS:
+    case nuPy_MINUS:
+    case nuPy_ASTERISK:
+    case nuPy_POWER:
+    case nuPy_PERCENT:
+    case nuPy_SLASH:
+    case nuPy_EQUALEQUAL:
+    case nuPy_NOTEQUAL:
+    case nuPy_LT:
+    case nuPy_LTE:
+    case nuPy_GT:
+    case nuPy_GTE:
+    case nuPy_KEYW_IN:
+    case nuPy_KEYW_IS:
+      return true;
+
+    default:
+      break;
+  }
+
+  return false;
+}
+
+//
+// parser_isExprStart
+//
+// Returns true if the given token can start an expression,
+// false if not.
+//
+bool parser_isExprStart(int tokenID)
+{
+  switch (tokenID)
+  {
+    case nuPy_ASTERISK:
+    case nuPy_AMPERSAND:
+    case nuPy_PLUS:
+    case nuPy_MINUS:
+    case nuPy_IDENTIFIER:
+    case nuPy_INT_LITERAL:
+    case nuPy_REAL_LITERAL:
+    case nuPy_STR_LITERAL:
+    case nuPy_KEYW_TRUE:
+    case nuPy_KEYW_FALSE:
+    case nuPy_KEYW_NONE:
+      return true;
+
+    default:
+      break;
+  }
+
+  return false;
+}
+
+//
+// <op> ::= '+' | '-' | '*' | '**' | '%' | '/' |
+//          '==' | '!=' | '<' | '<=' | '>' | '>=' |
+//          'in' | 'is'
+//
+static bool parser_op(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+  char* value = tokenqueue_peekValue(tokens);
+
+  if (parser_isOperator(curToken.id))
+  {
+    match(tokens, curToken.id, value);
+
+    return true;
+  }
+  else
+  {
+    errorMsg("binary operator such as + or <", value, curToken);
+    return false;
+  }
+}
+
+//
+// parser_isElement
+//
+// Returns true if the token denotes the start of an element,
+// false if not.
+//
+static bool parser_isElement(int tokenID)
+{
+  switch (tokenID)
+  {
+    case nuPy_IDENTIFIER:
+    case nuPy_INT_LITERAL:
+    case nuPy_REAL_LITERAL:
+    case nuPy_STR_LITERAL:
+    case nuPy_KEYW_TRUE:
+    case nuPy_KEYW_FALSE:
+    case nuPy_KEYW_NONE:
+      return true;
+
+    default:
+      break;
+  }
+
+  return false;
+}
+
+//
+// <element> ::= IDENTIFIER | INT_LITERAL | REAL_LITERAL | STR_LITERAL
+//               | True | False | None
+//
+static bool parser_element(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+  char* value = tokenqueue_peekValue(tokens);
+
+  if (parser_isElement(curToken.id))
+  {
+    match(tokens, curToken.id, value);
+    return true;
+  }
+  else
+  {
+    errorMsg("a value such as x, 123, or 'a string'", value, curToken);
+    return false;
+  }
+}
+
+//
+// <elements> ::= <element> [',' <elements>]
+//
+static bool parser_elements(struct TokenQueue* tokens)
+{
+  if (!parser_element(tokens))
+    return false;
+
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  while (curToken.id == nuPy_COMMA)
+  {
+    match(tokens, nuPy_COMMA, ",");
+
+    if (!parser_element(tokens))
+      return false;
+
+    curToken = tokenqueue_peekToken(tokens);
+  }
+
+  return true;
+}
+
+//
+// <index> ::= '[' <element> ']'
+//
+static bool parser_index(struct TokenQueue* tokens)
+{
+  if (!match(tokens, nuPy_LEFT_BRACKET, "["))
+    return false;
+
+  if (!parser_element(tokens))
+    return false;
+
+  if (!match(tokens, nuPy_RIGHT_BRACKET, "]"))
+    return false;
+
+  return true;
+}
+
+//
+// <unary_expr> ::= '*' IDENTIFIER
+//                | '&' IDENTIFIER
+//                | '+' [IDENTIFIER | INT_LITERAL | REAL_LITERAL]
+//                | '-' [IDENTIFIER | INT_LITERAL | REAL_LITERAL]
+//                | IDENTIFIER <index>
+//                | <element>
+//
+static bool parser_unary_expr(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+  char* value = tokenqueue_peekValue(tokens);
+
+  if (curToken.id == nuPy_ASTERISK)
+  {
+    match(tokens, nuPy_ASTERISK, "*");
+
+    if (!match(tokens, nuPy_IDENTIFIER, "identifier"))
+      return false;
+
+    return true;
+  }
+  else if (curToken.id == nuPy_AMPERSAND)
+  {
+    match(tokens, nuPy_AMPERSAND, "&");
+
+    if (!match(tokens, nuPy_IDENTIFIER, "identifier"))
+      return false;
+
+    return true;
+  }
+  else if (curToken.id == nuPy_PLUS)
+  {
+    match(tokens, nuPy_PLUS, "+");
+
+    curToken = tokenqueue_peekToken(tokens);
+    value = tokenqueue_peekValue(tokens);
+
+    if (curToken.id == nuPy_IDENTIFIER ||
+      curToken.id == nuPy_INT_LITERAL ||
+      curToken.id == nuPy_REAL_LITERAL)
+    {
+      match(tokens, curToken.id, value);
+      return true;
+    }
+    else
+    {
+      errorMsg("identifer or numeric literal", value, curToken);
+      return false;
+    }
+  }
+  else if (curToken.id == nuPy_MINUS)
+  {
+    match(tokens, nuPy_MINUS, "-");
+
+    curToken = tokenqueue_peekToken(tokens);
+    value = tokenqueue_peekValue(tokens);
+
+    if (curToken.id == nuPy_IDENTIFIER ||
+      curToken.id == nuPy_INT_LITERAL ||
+      curToken.id == nuPy_REAL_LITERAL)
+    {
+      match(tokens, curToken.id, value);
+      return true;
+    }
+    else
+    {
+      errorMsg("identifer or numeric literal", value, curToken);
+      return false;
+    }
+  }
+  else if (curToken.id == nuPy_IDENTIFIER &&
+    tokenqueue_peek2Token(tokens).id == nuPy_LEFT_BRACKET)
+  {
+    match(tokens, nuPy_IDENTIFIER, value);
+
+    return parser_index(tokens);
+  }
+  else
+  {
+    return parser_element(tokens);
+  }
+}
+
+//
+// <expr> ::= <unary_expr> [<op> <unary_expr>]
+//
+static bool parser_expr(struct TokenQueue* tokens)
+{
+  if (!parser_unary_expr(tokens))
+    return false;
+
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  if (parser_isOperator(curToken.id))
+  {
+    if (!parser_op(tokens))
+      return false;
+
+    if (!parser_unary_expr(tokens))
+      return false;
+  }
+
+  return true;
+}
+
+//
+// <function_call> ::= IDENTIFIER '(' [<elements>] ')'
+//
+static bool parser_function_call(struct TokenQueue* tokens)
+{
+  if (!match(tokens, nuPy_IDENTIFIER, "identifier"))
+    return false;
+  if (!match(tokens, nuPy_LEFT_PAREN, "("))
+    return false;
+
+  //
+  // optional elements:
+  //
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  if (parser_isElement(curToken.id))
+  {
+    if (!parser_elements(tokens))
+      return false;
+  }
+
+  if (!match(tokens, nuPy_RIGHT_PAREN, ")"))
+    return false;
+
+  return true;
+}
+
+//
+// <list> ::= '[' [<elements>] ']'
+//
+static bool parser_list(struct TokenQueue* tokens)
+{
+  if (!match(tokens, nuPy_LEFT_BRACKET, "["))
+    return false;
+
+  //
+  // optional elements:
+  //
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  if (parser_isElement(curToken.id))
+  {
+    if (!parser_elements(tokens))
+      return false;
+  }
+
+  if (!match(tokens, nuPy_RIGHT_BRACKET, "]"))
+    return false;
+
+  return true;
+}
+
+//
+// <dict> ::= '{' [<entries>] '}'
+//
+// <entries> ::= <element> ':' <element> [',' <entries>]
+//
+static bool parser_dict(struct TokenQueue* tokens)
+{
+  if (!match(tokens, nuPy_LEFT_BRACE, "{"))
+    return false;
+
+  //
+  // optional entries:
+  //
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  while (parser_isElement(curToken.id))
+  {
+    if (!parser_element(tokens))
+      return false;
+
+    if (!match(tokens, nuPy_COLON, ":"))
+      return false;
+
+    if (!parser_element(tokens))
+      return false;
+
+    curToken = tokenqueue_peekToken(tokens);
+
+    if (curToken.id != nuPy_COMMA)
+      break;
+
+    match(tokens, nuPy_COMMA, ",");
+
+    curToken = tokenqueue_peekToken(tokens);
+
+    if (!parser_isElement(curToken.id))
+    {
+      errorMsg("a value such as x, 123, or 'a string'", tokenqueue_peekValue(tokens), curToken);
+      return false;
+    }
+  }
+
+  if (!match(tokens, nuPy_RIGHT_BRACE, "}"))
+    return false;
+
+  return true;
+}
+
+//
+// <value> ::= <expr> | <function_call> | <list> | <dict>
+//
+static bool parser_value(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  if (curToken.id == nuPy_LEFT_BRACKET)
+  {
+    return parser_list(tokens);
+  }
+  else if (curToken.id == nuPy_LEFT_BRACE)
+  {
+    return parser_dict(tokens);
+  }
+  else if (curToken.id == nuPy_IDENTIFIER)
+  {
+    //
+    // function call or expression? Look ahead one more token:
+    //
+    struct Token nextToken = tokenqueue_peek2Token(tokens);
+
+    if (nextToken.id == nuPy_LEFT_PAREN)
+      return parser_function_call(tokens);
+    else
+      return parser_expr(tokens);
+  }
+  else
+  {
+    //
+    // must be an expression:
+    //
+    return parser_expr(tokens);
+  }
+}
+
+//
+// <else> ::= 'elif' <expr> ':' <body> [<else>]
+//          | 'else' ':' <body>
+//
+static bool parser_else(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+  char* value = tokenqueue_peekValue(tokens);
+
+  if (curToken.id == nuPy_KEYW_ELIF)
+  {
+    match(tokens, nuPy_KEYW_ELIF, "elif");
+
+    if (!parser_expr(tokens))
+      return false;
+
+    if (!match(tokens, nuPy_COLON, ":"))
+      return false;
+
+    if (!parser_body(tokens))
+      return false;
+
+    //
+    // optional else:
+    //
+    curToken = tokenqueue_peekToken(tokens);
+
+    if (curToken.id == nuPy_KEYW_ELIF || curToken.id == nuPy_KEYW_ELSE)
+      return parser_else(tokens);
+
+    return true;
+  }
+  else if (curToken.id == nuPy_KEYW_ELSE)
+  {
+    match(tokens, nuPy_KEYW_ELSE, "else");
+
+    if (!match(tokens, nuPy_COLON, ":"))
+      return false;
+
+    if (!parser_body(tokens))
+      return false;
+
+    return true;
+  }
+  else
+  {
+    errorMsg("elif or else", value, curToken);
+    return false;
+  }
+}
+
+//
+// <assignment> ::= ['*'] IDENTIFIER '=' <value>
+//                | IDENTIFIER <index> '=' <value>
+//
+static bool parser_assignment(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+  bool isPtrDeref = (curToken.id == nuPy_ASTERISK);
+
+  if (isPtrDeref)
+    match(tokens, nuPy_ASTERISK, "*");
+
+  if (!match(tokens, nuPy_IDENTIFIER, "identifier"))
+    return false;
+
+  //
+  // xs[i] = ... ?
+  //
+  curToken = tokenqueue_peekToken(tokens);
+
+  if (!isPtrDeref && curToken.id == nuPy_LEFT_BRACKET)
+  {
+    if (!parser_index(tokens))
+      return false;
+  }
+
+  if (!match(tokens, nuPy_EQUAL, "="))
+    return false;
+
+  return parser_value(tokens);
+}
+
+//
+// <if_then_else> ::= 'if' <expr> ':' <body> [<else>]
+//
+static bool parser_if(struct TokenQueue* tokens)
+{
+  if (!match(tokens, nuPy_KEYW_IF, "if"))
+    return false;
+
+  if (!parser_expr(tokens))
+    return false;
+
+  if (!match(tokens, nuPy_COLON, ":"))
+    return false;
+
+  if (!parser_body(tokens))
+    return false;
+
+  //
+  // optional else:
+  //
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  if (curToken.id == nuPy_KEYW_ELIF || curToken.id == nuPy_KEYW_ELSE)
+    return parser_else(tokens);
+
+  return true;
+}
+
+//
+// <while_loop> ::= 'while' <expr> ':' <body>
+//
+static bool parser_while(struct TokenQueue* tokens)
+{
+  if (!match(tokens, nuPy_KEYW_WHILE, "while"))
+    return false;
+
+  if (!parser_expr(tokens))
+    return false;
+
+  if (!match(tokens, nuPy_COLON, ":"))
+    return false;
+
+  if (!parser_body(tokens))
+    return false;
+
+  return true;
+}
+
+//
+// <for_loop> ::= 'for' IDENTIFIER 'in' <element> ':' <body>
+//
+static bool parser_for(struct TokenQueue* tokens)
+{
+  if (!match(tokens, nuPy_KEYW_FOR, "for"))
+    return false;
+
+  if (!match(tokens, nuPy_IDENTIFIER, "identifier"))
+    return false;
+
+  if (!match(tokens, nuPy_KEYW_IN, "in"))
+    return false;
+
+  if (!parser_element(tokens))
+    return false;
+
+  if (!match(tokens, nuPy_COLON, ":"))
+    return false;
+
+  if (!parser_body(tokens))
+    return false;
+
+  return true;
+}
+
+//
+// <def> ::= 'def' IDENTIFIER '(' [<params>] ')' ':' <body>
+//
+// <params> ::= IDENTIFIER [',' <params>]
+//
+// Functions are defined at the top level only.
+//
+static bool parser_def(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  if (parser_depth > 0)
+  {
+    printf("**SYNTAX ERROR: functions must be defined at the top level @ (%d, %d)\n", curToken.line, curToken.col);
+    return false;
+  }
+
+  if (!match(tokens, nuPy_KEYW_DEF, "def"))
+    return false;
+
+  if (!match(tokens, nuPy_IDENTIFIER, "identifier"))
+    return false;
+
+  if (!match(tokens, nuPy_LEFT_PAREN, "("))
+    return false;
+
+  //
+  // optional parameters:
+  //
+  curToken = tokenqueue_peekToken(tokens);
+
+  if (curToken.id == nuPy_IDENTIFIER)
+  {
+    match(tokens, nuPy_IDENTIFIER, "identifier");
+
+    curToken = tokenqueue_peekToken(tokens);
+
+    while (curToken.id == nuPy_COMMA)
+    {
+      match(tokens, nuPy_COMMA, ",");
+
+      if (!match(tokens, nuPy_IDENTIFIER, "identifier"))
+        return false;
+
+      curToken = tokenqueue_peekToken(tokens);
+    }
+  }
+
+  if (!match(tokens, nuPy_RIGHT_PAREN, ")"))
+    return false;
+
+  if (!match(tokens, nuPy_COLON, ":"))
+    return false;
+
+  parser_inFunction = true;
+
+  bool result = parser_body(tokens);
+
+  parser_inFunction = false;
+
+  return result;
+}
+
+//
+// <return> ::= 'return' [<expr>]
+//
+// The value, if any, starts on the same line as the return, 
+// as in Python.
+//
+static bool parser_return(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  if (!parser_inFunction)
+  {
+    printf("**SYNTAX ERROR: 'return' outside function @ (%d, %d)\n", curToken.line, curToken.col);
+    return false;
+  }
+
+  if (!match(tokens, nuPy_KEYW_RETURN, "return"))
+    return false;
+
+  struct Token nextToken = tokenqueue_peekToken(tokens);
+
+  if (nextToken.line == curToken.line && parser_isExprStart(nextToken.id))
+    return parser_expr(tokens);
+
+  return true;
+}
+
+//
+// parser_isStmt
+//
+// Returns true if the token denotes the start of a stmt,
+// false if not.
+//
+static bool parser_isStmt(int tokenID)
+{
+  switch (tokenID)
+  {
+    case nuPy_ASTERISK:
+    case nuPy_IDENTIFIER:
+    case nuPy_KEYW_DEF:
+    case nuPy_KEYW_FOR:
+    case nuPy_KEYW_IF:
+    case nuPy_KEYW_PASS:
+    case nuPy_KEYW_RETURN:
+    case nuPy_KEYW_WHILE:
+      return true;
+
+    default:
+      break;
+  }
+
+  return false;
+}
+
+//
+// <stmt> ::= <assignment>
+//          | <function_call>
+//          | <if_then_else>
+//          | <while_loop>
+//          | <for_loop>
+//          | <def>
+//          | <return>
+//          | 'pass'
+//
+static bool parser_stmt(struct TokenQueue* tokens)
+{
+  struct Token curToken = tokenqueue_peekToken(tokens);
+  char* value = tokenqueue_peekValue(tokens);
+
+  if (curToken.id == nuPy_IDENTIFIER)
+  {
+    //
+    // assignment or function call? Look ahead one more token:
+    //
+    struct Token nextToken = tokenqueue_peek2Token(tokens);
+
+    if (nextToken.id == nuPy_EQUAL || nextToken.id == nuPy_LEFT_BRACKET)
+      return parser_assignment(tokens);
+    else if (nextToken.id == nuPy_LEFT_PAREN)
+      return parser_function_call(tokens);
+    else
+    {
+      errorMsg("assignment or function call", value, curToken);
+      return false;
+    }
+  }
+  else if (curToken.id == nuPy_ASTERISK)
+  {
+    return parser_assignment(tokens);
+  }
+  else if (curToken.id == nuPy_KEYW_IF)
+  {
+    return parser_if(tokens);
+  }
+  else if (curToken.id == nuPy_KEYW_WHILE)
+  {
+    return parser_while(tokens);
+  }
+  else if (curToken.id == nuPy_KEYW_FOR)
+  {
+    return parser_for(tokens);
+  }
+  else if (curToken.id == nuPy_KEYW_DEF)
+  {
+    return parser_def(tokens);
+  }
+  else if (curToken.id == nuPy_KEYW_RETURN)
+  {
+    return parser_return(tokens);
+  }
+  else if (curToken.id == nuPy_KEYW_PASS)
+  {
+    return match(tokens, nuPy_KEYW_PASS, "pass");
+  }
+  else
+  {
+    errorMsg("start of a statement (eg if or while)", value, curToken);
+    return false;
+  }
+}
+
+//
+// <stmts> ::= <stmt> [<stmts>]
+//
+static bool parser_stmts(struct TokenQueue* tokens)
+{
+  if (!parser_stmt(tokens))
+    return false;
+
+  //
+  // more stmts? Loop rather than recurse so long programs
+  // don't overflow the stack:
+  //
+  struct Token curToken = tokenqueue_peekToken(tokens);
+
+  while (parser_isStmt(curToken.id))
+  {
+    if (!parser_stmt(tokens))
+      return false;
+
+    curToken = tokenqueue_peekToken(tokens);
+  }
+
+  return true;
+}
+
+//
+// <body> ::= '{' <stmts> '}'
+//
+static bool parser_body(struct TokenQueue* tokens)
+{
+  if (!match(tokens, nuPy_LEFT_BRACE, "{"))
+    return false;
+
+  parser_depth++;
+
+  bool result = parser_stmts(tokens);
+
+  parser_depth--;
+
+  if (!result)
+    return false;
+
+  if (!match(tokens, nuPy_RIGHT_BRACE, "}"))
+    return false;
+
+  return true;
+}
+
+//
+// <program> ::= <stmts> EOS
+//
+static bool parser_program(struct TokenQueue* tokens)
+{
+  if (!parser_stmts(tokens))
+    return false;
+
+  if (!match(tokens, nuPy_EOS, "$"))
+    return false;
+
+  return true;
+}
+
+
+//
+// Public functions:
+//
+
+//
+// parser_init
+//
+// Call this once before you start calling parser_parse().
+//
+void parser_init(void)
+{
+  //
+  // nothing to initialize at the moment:
+  //
+}
+
+//
+// parser_parse
+//
+// Given an input stream, uses the scanner to obtain the tokens
+// and then checks the syntax of the input against the BNF rules
+// for the subset of Python we are supporting.
+//
+// Returns NULL if a syntax error was found; in this case
+// an error message was output. Returns a pointer to a list
+// of tokens -- a Token Queue -- if no syntax errors were
+// detected. This queue contains the complete input in token
+// form for analysis and execution.
+//
+// NOTE: it is the callers responsibility to free the resources
+// used by the Token Queue.
+//
+struct TokenQueue* parser_parse(FILE* input)
+{
+  if (input == NULL)
+    panic("input stream is NULL (parser_parse)");
+
+  //
+  // First, input all the tokens from the input stream into
+  // a token queue:
+  //
+  int  lineNumber;
+  int  colNumber;
+  char value[256];
+
+  struct Token token;
+  struct TokenQueue* tokens;
+
+  scanner_init(&lineNumber, &colNumber, value);
+
+  token = scanner_nextToken(input, &lineNumber, &colNumber, value);
+  tokens = tokenqueue_create();
+
+  while (token.id != nuPy_EOS)
+  {
+    tokenqueue_enqueue(tokens, token, value);
+
+    token = scanner_nextToken(input, &lineNumber, &colNumber, value);
+  }
+
+  //
+  // enqueue the EOS token as well:
+  //
+  tokenqueue_enqueue(tokens, token, value);
+
+  //
+  // Now parse the tokens to see if the syntax is correct.
+  // Parsing steps through the tokens, so we parse a view of
+  // the queue --- a copy of its head and tail --- and keep
+  // the queue itself, untouched, to return to the caller:
+  //
+  struct TokenQueue view = *tokens;
+
+  parser_depth = 0;
+  parser_inFunction = false;
+
+  bool result = parser_program(&view);
+
+  //
+  // if reading from the keyboard, discard the rest of the
+  // input line so the next read starts fresh:
+  //
+  if (result && input == stdin)
+  {
+    int c = fgetc(stdin);
+    while (c != '\n' && c != EOF)
+      c = fgetc(stdin);
+  }
+
+  if (result)
+  {
+    return tokens;
+  }
+  else
+  {
+    tokenqueue_destroy(tokens);
+    return NULL;
+  }
+}
@@ -44,3 +44,20 @@ void parser_init(void);
 // used by the Token Queue.
 //
 struct TokenQueue* parser_parse(FILE* input);
+
+//
+// parser_isOperator
+//
+// Returns true if the given token id denotes a binary operator
+// such as + or <, false if not.
+//
+bool parser_isOperator(int tokenID);
+
+//
+// parser_isExprStart
+//
+// Returns true if the given token id can start an expression,
+// e.g. an identifier, a literal, or a unary operator such as -,
+// false if not.
+//
+bool parser_isExprStart(int tokenID);
@@ -0,0 +1,1804 @@
+/*programgraph.c*/
+
+//
+// Project: program graph data structure for nuPython
+//
+// Prof. Joe Hummel
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>
+#include <assert.h>
+
+#include "token.h"
+#include "tokenqueue.h"
+#include "parser.h"
+#include "programgraph.h"
+#include "util.h"
+#include "convert.h"
+#include "output.h"
+
+
+//
+// # of semantic errors found while building the graph:
+//
+static int pg_errors = 0;
+
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**PROGRAMGRAPH ERROR\n");
+  printf("**PROGRAMGRAPH ERROR: %s\n", msg);
+  printf("**PROGRAMGRAPH ERROR\n");
+
+  exit(-123);
+}
+
+
+//
+// Building the graph:
+//
+
+//
+// pg_literal_error
+//
+// Outputs an error for a literal that's out of range, e.g. an int
+// literal that doesn't fit in 32 bits, which stops the graph from
+// being built.
+//
+static void pg_literal_error(struct TokenNode* cur, char* kind)
+{
+  printf("**SEMANTIC ERROR: %s literal %s is out of range (line %d)\n", kind, cur->value, cur->token.line);
+
+  pg_errors++;
+}
+
+//
+// pg_build_element
+//
+// Given a token denoting an element (identifier or literal),
+// builds and returns the corresponding ELEMENT.
+//
+static struct ELEMENT* pg_build_element(struct TokenNode* cur)
+{
+  struct ELEMENT* element = (struct ELEMENT*)malloc(sizeof(struct ELEMENT));
+  if (element == NULL)
+    panic("out of memory (pg_build_element)");
+
+  element->element_value = dupString(cur->value);
+  element->slot = -1;
+  element->literal.d = 0.0;
+  element->next = NULL;
+
+  switch (cur->token.id)
+  {
+    case nuPy_IDENTIFIER:
+      element->element_type = ELEMENT_IDENTIFIER;
+      break;
+
+    case nuPy_INT_LITERAL:
+      element->element_type = ELEMENT_INT_LITERAL;
+      if (!convert_int(cur->value, &element->literal.i))
+        pg_literal_error(cur, "int");
+      break;
+
+    case nuPy_REAL_LITERAL:
+      element->element_type = ELEMENT_REAL_LITERAL;
+      if (!convert_real(cur->value, &element->literal.d))
+        pg_literal_error(cur, "real");
+      break;
+
+    case nuPy_STR_LITERAL:
+      element->element_type = ELEMENT_STR_LITERAL;
+      break;
+
+    case nuPy_KEYW_TRUE:
+      element->element_type = ELEMENT_TRUE;
+      break;
+
+    case nuPy_KEYW_FALSE:
+      element->element_type = ELEMENT_FALSE;
+      break;
+
+    case nuPy_KEYW_NONE:
+      element->element_type = ELEMENT_NONE;
+      break;
+
+    default:
+      panic("unknown element type (pg_build_element)");
+  }
+
+  return element;
+}
+
+//
+// pg_build_elements
+//
+// Builds the comma-separated elements starting at *cur, up to
+// the given stop token (')' or ']'), linking them via next.
+// Returns the first element, or NULL if there are none, and
+// advances *cur past the stop token.
+//
+static struct ELEMENT* pg_build_elements(struct TokenNode** cur, int stop_token)
+{
+  struct ELEMENT* first = NULL;
+  struct ELEMENT** next = &first;
+
+  while ((*cur)->token.id != stop_token)
+  {
+    if ((*cur)->token.id == nuPy_COMMA)
+      (*cur) = (*cur)->next;
+
+    *next = pg_build_element(*cur);
+    next = &(*next)->next;
+
+    (*cur) = (*cur)->next;
+  }
+
+  (*cur) = (*cur)->next;
+
+  return first;
+}
+
+//
+// pg_build_index
+//
+// Given *cur at the '[' of an index, builds the element
+// denoting the index and advances *cur past the ']'.
+//
+static struct ELEMENT* pg_build_index(struct TokenNode** cur)
+{
+  assert((*cur)->token.id == nuPy_LEFT_BRACKET);
+  (*cur) = (*cur)->next;
+
+  struct ELEMENT* index = pg_build_element(*cur);
+  (*cur) = (*cur)->next;
+
+  assert((*cur)->token.id == nuPy_RIGHT_BRACKET);
+  (*cur) = (*cur)->next;
+
+  return index;
+}
+
+//
+// pg_build_unary_expr
+//
+// Builds a UNARY_EXPR from the tokens starting at *cur, and
+// advances *cur past the tokens consumed.
+//
+static struct UNARY_EXPR* pg_build_unary_expr(struct TokenNode** cur)
+{
+  struct UNARY_EXPR* unary = (struct UNARY_EXPR*)malloc(sizeof(struct UNARY_EXPR));
+  if (unary == NULL)
+    panic("out of memory (pg_build_unary_expr)");
+
+  unary->index = NULL;
+
+  if ((*cur)->token.id == nuPy_ASTERISK)
+  {
+    unary->expr_type = UNARY_PTR_DEREF;
+    (*cur) = (*cur)->next;
+  }
+  else if ((*cur)->token.id == nuPy_AMPERSAND)
+  {
+    unary->expr_type = UNARY_ADDRESS_OF;
+    (*cur) = (*cur)->next;
+  }
+  else if ((*cur)->token.id == nuPy_PLUS)
+  {
+    unary->expr_type = UNARY_PLUS;
+    (*cur) = (*cur)->next;
+  }
+  else if ((*cur)->token.id == nuPy_MINUS)
+  {
+    unary->expr_type = UNARY_MINUS;
+    (*cur) = (*cur)->next;
+  }
+  else if ((*cur)->token.id == nuPy_IDENTIFIER && (*cur)->next->token.id == nuPy_LEFT_BRACKET)
+  {
+    unary->expr_type = UNARY_INDEX;
+    unary->element = pg_build_element(*cur);
+    (*cur) = (*cur)->next;
+
+    unary->index = pg_build_index(cur);
+
+    return unary;
+  }
+  else
+  {
+    unary->expr_type = UNARY_ELEMENT;
+  }
+
+  unary->element = pg_build_element(*cur);
+  (*cur) = (*cur)->next;
+
+  return unary;
+}
+
+//
+// pg_build_expr
+//
+// Builds a VALUE_EXPR from the tokens starting at *cur, and
+// advances *cur past the tokens consumed.
+//
+static struct VALUE_EXPR* pg_build_expr(struct TokenNode** cur)
+{
+  struct VALUE_EXPR* expr = (struct VALUE_EXPR*)malloc(sizeof(struct VALUE_EXPR));
+  if (expr == NULL)
+    panic("out of memory (pg_build_expr)");
+
+  expr->lhs = NULL;
+  expr->isBinaryExpr = false;
+  expr->operator = OPERATOR_NO_OP;
+  expr->rhs = NULL;
+  expr->lhs_type = -1;
+  expr->rhs_type = -1;
+
+  expr->lhs = pg_build_unary_expr(cur);
+
+  if (parser_isOperator((*cur)->token.id))
+  {
+    expr->isBinaryExpr = true;
+
+    switch ((*cur)->token.id)
+    {
+      case nuPy_PLUS:
+        expr->operator = OPERATOR_PLUS;
+        break;
+      case nuPy_MINUS:
+        expr->operator = OPERATOR_MINUS;
+        break;
+      case nuPy_ASTERISK:
+        expr->operator = OPERATOR_ASTERISK;
+        break;
+      case nuPy_POWER:
+        expr->operator = OPERATOR_POWER;
+        break;
+      case nuPy_PERCENT:
+        expr->operator = OPERATOR_MOD;
+        break;
+      case nuPy_SLASH:
+        expr->operator = OPERATOR_DIV;
+        break;
+      case nuPy_EQUALEQUAL:
+        expr->operator = OPERATOR_EQUAL;
+        break;
+      case nuPy_NOTEQUAL:
+        expr->operator = OPERATOR_NOT_EQUAL;
+        break;
+      case nuPy_LT:
+        expr->operator = OPERATOR_LT;
+        break;
+      case nuPy_LTE:
+        expr->operator = OPERATOR_LTE;
+        break;
+      case nuPy_GT:
+        expr->operator = OPERATOR_GT;
+        break;
+      case nuPy_GTE:
+        expr->operator = OPERATOR_GTE;
+        break;
+      case nuPy_KEYW_IS:
+        expr->operator = OPERATOR_IS;
+        break;
+      case nuPy_KEYW_IN:
+        expr->operator = OPERATOR_IN;
+        break;
+      default:
+        panic("unknown operator (pg_build_expr)");
+    }
+
+    (*cur) = (*cur)->next;
+
+    expr->rhs = pg_build_unary_expr(cur);
+  }
+
+  return expr;
+}
+
+//
+// pg_build_value
+//
+// Builds a VALUE (function call, list, dict or expression) from the tokens
+// starting at *cur, and advances *cur past the tokens consumed.
+//
+static struct VALUE* pg_build_value(struct TokenNode** cur)
+{
+  struct VALUE* value = (struct VALUE*)malloc(sizeof(struct VALUE));
+  if (value == NULL)
+    panic("out of memory (pg_build_value)");
+
+  if ((*cur)->token.id == nuPy_IDENTIFIER && (*cur)->next->token.id == nuPy_LEFT_PAREN)
+  {
+    //
+    // function call:
+    //
+    char* function_name = (*cur)->value;
+
+    (*cur) = (*cur)->next;
+    assert((*cur)->token.id == nuPy_LEFT_PAREN);
+    (*cur) = (*cur)->next;
+
+    value->value_type = VALUE_FUNCTION_CALL;
+    value->types.function_call = (struct VALUE_FUNCTION_CALL*)malloc(sizeof(struct VALUE_FUNCTION_CALL));
+    if (value->types.function_call == NULL)
+      panic("out of memory (pg_build_value)");
+
+    value->types.function_call->function_name = dupString(function_name);
+    value->types.function_call->parameter = pg_build_elements(cur, nuPy_RIGHT_PAREN);
+    value->types.function_call->function = NULL;
+    value->types.function_call->builtin = -1;
+  }
+  else if ((*cur)->token.id == nuPy_LEFT_BRACKET)
+  {
+    //
+    // list:
+    //
+    (*cur) = (*cur)->next;
+
+    value->value_type = VALUE_LIST;
+    value->types.list = (struct VALUE_LIST*)malloc(sizeof(struct VALUE_LIST));
+    if (value->types.list == NULL)
+      panic("out of memory (pg_build_value)");
+
+    value->types.list->elements = pg_build_elements(cur, nuPy_RIGHT_BRACKET);
+  }
+  else if ((*cur)->token.id == nuPy_LEFT_BRACE)
+  {
+    //
+    // dict:
+    //
+    (*cur) = (*cur)->next;
+
+    value->value_type = VALUE_DICT;
+    value->types.dict = (struct VALUE_DICT*)malloc(sizeof(struct VALUE_DICT));
+    if (value->types.dict == NULL)
+      panic("out of memory (pg_build_value)");
+
+    struct ELEMENT** key = &value->types.dict->keys;
+    struct ELEMENT** val = &value->types.dict->values;
+
+    while ((*cur)->token.id != nuPy_RIGHT_BRACE)
+    {
+      if ((*cur)->token.id == nuPy_COMMA)
+        (*cur) = (*cur)->next;
+
+      *key = pg_build_element(*cur);
+      key = &(*key)->next;
+      (*cur) = (*cur)->next;
+
+      assert((*cur)->token.id == nuPy_COLON);
+      (*cur) = (*cur)->next;
+
+      *val = pg_build_element(*cur);
+      val = &(*val)->next;
+      (*cur) = (*cur)->next;
+    }
+
+    *key = NULL;
+    *val = NULL;
+
+    (*cur) = (*cur)->next;
+  }
+  else
+  {
+    //
+    // expression:
+    //
+    value->value_type = VALUE_EXPR;
+    value->types.expr = pg_build_expr(cur);
+  }
+
+  return value;
+}
+
+//
+// pg_alloc_stmt
+//
+// Allocates a new STMT of the given type, along with the
+// struct for that type of stmt (all fields NULL), and links
+// the STMT into the graph via *link. The token is used for
+// the stmt's line #.
+//
+static struct STMT* pg_alloc_stmt(struct STMT** link, int stmt_type, struct TokenNode* token)
+{
+  if (stmt_type < STMT_ASSIGNMENT || stmt_type > STMT_RETURN)
+    panic("unexpected stmt_type (pg_alloc_stmt)");
+
+  struct STMT* stmt = (struct STMT*)malloc(sizeof(struct STMT));
+  if (stmt == NULL)
+    panic("out of memory (pg_alloc_stmt)");
+
+  stmt->stmt_type = stmt_type;
+  stmt->line = token->token.line;
+
+  if (stmt_type == STMT_ASSIGNMENT)
+  {
+    stmt->types.assignment = (struct STMT_ASSIGNMENT*)malloc(sizeof(struct STMT_ASSIGNMENT));
+    if (stmt->types.assignment == NULL)
+      panic("out of memory (pg_alloc_stmt)");
+
+    stmt->types.assignment->var_name = NULL;
+    stmt->types.assignment->var_slot = -1;
+    stmt->types.assignment->isPtrDeref = false;
+    stmt->types.assignment->index = NULL;
+    stmt->types.assignment->rhs = NULL;
+    stmt->types.assignment->next_stmt = NULL;
+  }
+  else if (stmt_type == STMT_FUNCTION_CALL)
+  {
+    stmt->types.function_call = (struct STMT_FUNCTION_CALL*)malloc(sizeof(struct STMT_FUNCTION_CALL));
+    if (stmt->types.function_call == NULL)
+      panic("out of memory (pg_alloc_stmt)");
+
+    stmt->types.function_call->function_name = NULL;
+    stmt->types.function_call->parameter = NULL;
+    stmt->types.function_call->function = NULL;
+    stmt->types.function_call->builtin = -1;
+    stmt->types.function_call->next_stmt = NULL;
+  }
+  else if (stmt_type == STMT_IF_THEN_ELSE)
+  {
+    panic("if statements are not yet supported");
+  }
+  else if (stmt_type == STMT_WHILE_LOOP)
+  {
+    stmt->types.while_loop = (struct STMT_WHILE_LOOP*)malloc(sizeof(struct STMT_WHILE_LOOP));
+    if (stmt->types.while_loop == NULL)
+      panic("out of memory (pg_alloc_stmt)");
+
+    stmt->types.while_loop->condition = NULL;
+    stmt->types.while_loop->loop_body = NULL;
+    stmt->types.while_loop->next_stmt = NULL;
+  }
+  else if (stmt_type == STMT_PASS)
+  {
+    stmt->types.pass = (struct STMT_PASS*)malloc(sizeof(struct STMT_PASS));
+    if (stmt->types.pass == NULL)
+      panic("out of memory (pg_alloc_stmt)");
+
+    stmt->types.pass->next_stmt = NULL;
+  }
+  else if (stmt_type == STMT_FOR_LOOP)
+  {
+    stmt->types.for_loop = (struct STMT_FOR_LOOP*)malloc(sizeof(struct STMT_FOR_LOOP));
+    if (stmt->types.for_loop == NULL)
+      panic("out of memory (pg_alloc_stmt)");
+
+    stmt->types.for_loop->var_name = NULL;
+    stmt->types.for_loop->var_slot = -1;
+    stmt->types.for_loop->iterable = NULL;
+    stmt->types.for_loop->loop_body = NULL;
+    stmt->types.for_loop->next_stmt = NULL;
+  }
+  else if (stmt_type == STMT_FUNCTION_DEF)
+  {
+    stmt->types.function_def = (struct STMT_FUNCTION_DEF*)malloc(sizeof(struct STMT_FUNCTION_DEF));
+    if (stmt->types.function_def == NULL)
+      panic("out of memory (pg_alloc_stmt)");
+
+    stmt->types.function_def->function_name = NULL;
+    stmt->types.function_def->parameters = NULL;
+    stmt->types.function_def->num_params = 0;
+    stmt->types.function_def->num_locals = 0;
+    stmt->types.function_def->body = NULL;
+    stmt->types.function_def->next_stmt = NULL;
+  }
+  else if (stmt_type == STMT_RETURN)
+  {
+    stmt->types.return_stmt = (struct STMT_RETURN*)malloc(sizeof(struct STMT_RETURN));
+    if (stmt->types.return_stmt == NULL)
+      panic("out of memory (pg_alloc_stmt)");
+
+    stmt->types.return_stmt->value = NULL;
+    stmt->types.return_stmt->next_stmt = NULL;
+  }
+  else
+  {
+    panic("unexpected statement?! (pg_alloc_stmt)");
+  }
+
+  *link = stmt;
+
+  return stmt;
+}
+
+//
+// pg_next_link
+//
+// Returns a pointer to the given stmt's next_stmt field, i.e.
+// where the stmt that follows it is linked in. For a loop this
+// is the stmt after the loop, since the body links back to the
+// loop itself.
+//
+static struct STMT** pg_next_link(struct STMT* stmt)
+{
+  if (stmt->stmt_type == STMT_ASSIGNMENT)
+    return &stmt->types.assignment->next_stmt;
+  else if (stmt->stmt_type == STMT_FUNCTION_CALL)
+    return &stmt->types.function_call->next_stmt;
+  else if (stmt->stmt_type == STMT_IF_THEN_ELSE)
+    panic("if statements are not yet supported (programgraph_build)");
+  else if (stmt->stmt_type == STMT_WHILE_LOOP)
+    return &stmt->types.while_loop->next_stmt;
+  else if (stmt->stmt_type == STMT_FOR_LOOP)
+    return &stmt->types.for_loop->next_stmt;
+  else if (stmt->stmt_type == STMT_FUNCTION_DEF)
+    return &stmt->types.function_def->next_stmt;
+  else if (stmt->stmt_type == STMT_RETURN)
+    return &stmt->types.return_stmt->next_stmt;
+
+  assert(stmt->stmt_type == STMT_PASS);
+  return &stmt->types.pass->next_stmt;
+}
+
+//
+// pg_link_back
+//
+// The last stmt in a loop body loops back to the loop stmt,
+// so find the last stmt and link it back.
+//
+// NOTE: nested loops are skipped over via their next_stmt,
+// since their bodies already link back to themselves.
+//
+static void pg_link_back(struct STMT* body, struct STMT* loop)
+{
+  assert(body != NULL);
+
+  struct STMT* last = body;
+  struct STMT* s = *pg_next_link(last);
+
+  while (s != NULL)
+  {
+    last = s;
+    s = *pg_next_link(last);
+  }
+
+  *pg_next_link(last) = loop;
+}
+
+//
+// pg_build_body
+//
+// Builds the stmts starting at cur, up to the given stop token
+// (EOS for the program, '}' for a loop body), and links them
+// together starting at *link. Returns a pointer to the stop
+// token.
+//
+static struct TokenNode* pg_build_body(struct STMT** link, struct TokenNode* cur, int stop_token)
+{
+  if (stop_token != nuPy_EOS && stop_token != nuPy_RIGHT_BRACE)
+    panic("invalid stop_token?! (pg_build_body)");
+
+  struct STMT** next = link;
+
+  while (cur->token.id != stop_token)
+  {
+    struct STMT* stmt;
+
+    if (cur->token.id == nuPy_KEYW_PASS)
+    {
+      //
+      // pass
+      //
+      stmt = pg_alloc_stmt(next, STMT_PASS, cur);
+
+      struct STMT_PASS* pass = stmt->types.pass;
+
+      next = &pass->next_stmt;
+
+      cur = cur->next;
+    }
+    else if (cur->token.id == nuPy_IDENTIFIER || cur->token.id == nuPy_ASTERISK)
+    {
+      bool isPtrDeref = (cur->token.id == nuPy_ASTERISK);
+
+      if (isPtrDeref) {
+        cur = cur->next;
+        assert(cur->token.id == nuPy_IDENTIFIER);
+      }
+
+      //
+      // function call or assignment?
+      //
+      char* name = cur->value;
+      struct TokenNode* start = cur;
+
+      cur = cur->next;
+
+      if (cur->token.id == nuPy_LEFT_PAREN)
+      {
+        //
+        // function call:
+        //
+        cur = cur->next;
+
+        stmt = pg_alloc_stmt(next, STMT_FUNCTION_CALL, start);
+
+        struct STMT_FUNCTION_CALL* call = stmt->types.function_call;
+
+        call->function_name = dupString(name);
+
+        next = &call->next_stmt;
+
+        //
+        // optional parameters:
+        //
+        call->parameter = pg_build_elements(&cur, nuPy_RIGHT_PAREN);
+      }
+      else
+      {
+        //
+        // assignment:
+        //
+        struct ELEMENT* index = NULL;
+
+        if (cur->token.id == nuPy_LEFT_BRACKET)
+          index = pg_build_index(&cur);
+
+        assert(cur->token.id == nuPy_EQUAL);
+
+        cur = cur->next;
+
+        stmt = pg_alloc_stmt(next, STMT_ASSIGNMENT, start);
+
+        struct STMT_ASSIGNMENT* assignment = stmt->types.assignment;
+
+        assignment->var_name = dupString(name);
+        assignment->isPtrDeref = isPtrDeref;
+        assignment->index = index;
+
+        next = &assignment->next_stmt;
+
+        assignment->rhs = pg_build_value(&cur);
+      }
+    }
+    else if (cur->token.id == nuPy_KEYW_IF)
+    {
+      panic("if statements are not yet supported (programgraph_build)");
+    }
+    else if (cur->token.id == nuPy_KEYW_WHILE)
+    {
+      //
+      // while loop:
+      //
+      cur = cur->next;
+
+      stmt = pg_alloc_stmt(next, STMT_WHILE_LOOP, cur);
+
+      struct STMT_WHILE_LOOP* loop = stmt->types.while_loop;
+
+      loop->condition = pg_build_expr(&cur);
+
+      assert(cur->token.id == nuPy_COLON);
+
+      cur = cur->next;
+
+      //
+      // loop body:
+      //
+      assert(cur->token.id == nuPy_LEFT_BRACE);
+
+      cur = cur->next;
+
+      cur = pg_build_body(&loop->loop_body, cur, nuPy_RIGHT_BRACE);
+
+      assert(cur->token.id == nuPy_RIGHT_BRACE);
+
+      cur = cur->next;
+
+      pg_link_back(loop->loop_body, stmt);
+
+      //
+      // and the stmt after the loop follows the loop itself:
+      //
+      next = &loop->next_stmt;
+    }
+    else if (cur->token.id == nuPy_KEYW_FOR)
+    {
+      //
+      // for loop:
+      //
+      cur = cur->next;
+
+      stmt = pg_alloc_stmt(next, STMT_FOR_LOOP, cur);
+
+      struct STMT_FOR_LOOP* loop = stmt->types.for_loop;
+
+      assert(cur->token.id == nuPy_IDENTIFIER);
+
+      loop->var_name = dupString(cur->value);
+
+      cur = cur->next;
+
+      assert(cur->token.id == nuPy_KEYW_IN);
+
+      cur = cur->next;
+
+      loop->iterable = pg_build_element(cur);
+
+      cur = cur->next;
+
+      assert(cur->token.id == nuPy_COLON);
+
+      cur = cur->next;
+
+      //
+      // loop body:
+      //
+      assert(cur->token.id == nuPy_LEFT_BRACE);
+
+      cur = cur->next;
+
+      cur = pg_build_body(&loop->loop_body, cur, nuPy_RIGHT_BRACE);
+
+      assert(cur->token.id == nuPy_RIGHT_BRACE);
+
+      cur = cur->next;
+
+      pg_link_back(loop->loop_body, stmt);
+
+      next = &loop->next_stmt;
+    }
+    else if (cur->token.id == nuPy_KEYW_DEF)
+    {
+      //
+      // function definition:
+      //
+      stmt = pg_alloc_stmt(next, STMT_FUNCTION_DEF, cur);
+
+      struct STMT_FUNCTION_DEF* def = stmt->types.function_def;
+
+      cur = cur->next;
+
+      assert(cur->token.id == nuPy_IDENTIFIER);
+
+      def->function_name = dupString(cur->value);
+
+      cur = cur->next;
+
+      assert(cur->token.id == nuPy_LEFT_PAREN);
+
+      cur = cur->next;
+
+      def->parameters = pg_build_elements(&cur, nuPy_RIGHT_PAREN);
+
+      for (struct ELEMENT* param = def->parameters; param != NULL; param = param->next)
+        def->num_params++;
+
+      assert(cur->token.id == nuPy_COLON);
+
+      cur = cur->next;
+
+      //
+      // function body, which ends with NULL rather than linking
+      // back:
+      //
+      assert(cur->token.id == nuPy_LEFT_BRACE);
+
+      cur = cur->next;
+
+      cur = pg_build_body(&def->body, cur, nuPy_RIGHT_BRACE);
+
+      assert(cur->token.id == nuPy_RIGHT_BRACE);
+
+      cur = cur->next;
+
+      next = &def->next_stmt;
+    }
+    else if (cur->token.id == nuPy_KEYW_RETURN)
+    {
+      //
+      // return, with a value if an expression follows on the
+      // same line:
+      //
+      stmt = pg_alloc_stmt(next, STMT_RETURN, cur);
+
+      struct STMT_RETURN* ret = stmt->types.return_stmt;
+
+      int line = cur->token.line;
+
+      cur = cur->next;
+
+      if (cur->token.line == line && parser_isExprStart(cur->token.id))
+        ret->value = pg_build_expr(&cur);
+
+      next = &ret->next_stmt;
+    }
+    else
+    {
+      panic("unexpected statement?! (pg_build_body)");
+    }
+  }
+
+  return cur;
+}
+
+
+//
+// Resolving functions and local variables:
+//
+
+//
+// The functions defined in the program, and the local variables
+// of the function being resolved, numbered by slot:
+//
+struct PG_SCOPE
+{
+  struct NameSet             function_names;
+  struct STMT_FUNCTION_DEF** functions;  // by number in function_names
+
+  struct NameSet             locals;     // num_names 0 => at the top level
+};
+
+//
+// pg_add_function
+//
+// Adds the given function to the scope. If a function is defined
+// more than once, the last definition counts.
+//
+static void pg_add_function(struct PG_SCOPE* scope, struct STMT_FUNCTION_DEF* def)
+{
+  int capacity = scope->function_names.capacity;
+  int i = nameSetFind(&scope->function_names, def->function_name, true);
+
+  if (scope->function_names.capacity != capacity)  // grew:
+  {
+    scope->functions = (struct STMT_FUNCTION_DEF**)realloc(scope->functions, scope->function_names.capacity * sizeof(struct STMT_FUNCTION_DEF*));
+    if (scope->functions == NULL)
+      panic("out of memory (pg_add_function)");
+  }
+
+  scope->functions[i] = def;
+}
+
+//
+// pg_find_function
+//
+// Returns the definition of the function with the given name,
+// or NULL if there is none (e.g. a builtin such as print).
+//
+static struct STMT_FUNCTION_DEF* pg_find_function(struct PG_SCOPE* scope, char* name)
+{
+  int i = nameSetFind(&scope->function_names, name, false);
+
+  return (i < 0) ? NULL : scope->functions[i];
+}
+
+//
+// pg_find_local
+//
+// Returns the slot of the local variable with the given name,
+// or -1 if the name is not local.
+//
+static int pg_find_local(struct PG_SCOPE* scope, char* name)
+{
+  return nameSetFind(&scope->locals, name, false);
+}
+
+//
+// pg_add_local
+//
+// Gives the named variable the next slot, unless it has one.
+//
+static void pg_add_local(struct PG_SCOPE* scope, char* name)
+{
+  nameSetFind(&scope->locals, name, true);
+}
+
+//
+// pg_collect_locals
+//
+// Adds the variables the stmts starting at cur assign --- x in
+// x = ... and in for x in ... --- to the locals, stopping when the
+// given stmt is reached. *p = ... and xs[i] = ... don't assign
+// p or xs.
+//
+static void pg_collect_locals(struct PG_SCOPE* scope, struct STMT* cur, struct STMT* stop)
+{
+  for ( ; cur != stop; cur = *pg_next_link(cur))
+  {
+    if (cur->stmt_type == STMT_ASSIGNMENT)
+    {
+      struct STMT_ASSIGNMENT* assignment = cur->types.assignment;
+
+      if (!assignment->isPtrDeref && assignment->index == NULL)
+        pg_add_local(scope, assignment->var_name);
+    }
+    else if (cur->stmt_type == STMT_WHILE_LOOP)
+    {
+      pg_collect_locals(scope, cur->types.while_loop->loop_body, cur);
+    }
+    else if (cur->stmt_type == STMT_FOR_LOOP)
+    {
+      pg_add_local(scope, cur->types.for_loop->var_name);
+      pg_collect_locals(scope, cur->types.for_loop->loop_body, cur);
+    }
+  }
+}
+
+//
+// pg_resolve_elements / pg_resolve_unary_expr / pg_resolve_expr
+//
+// Sets the slot of each identifier that names a local.
+//
+static void pg_resolve_elements(struct PG_SCOPE* scope, struct ELEMENT* element)
+{
+  for ( ; element != NULL; element = element->next)
+  {
+    if (element->element_type == ELEMENT_IDENTIFIER)
+      element->slot = pg_find_local(scope, element->element_value);
+  }
+}
+
+static void pg_resolve_unary_expr(struct PG_SCOPE* scope, struct UNARY_EXPR* unary)
+{
+  if (unary == NULL)
+    return;
+
+  pg_resolve_elements(scope, unary->element);
+  pg_resolve_elements(scope, unary->index);
+}
+
+static void pg_resolve_expr(struct PG_SCOPE* scope, struct VALUE_EXPR* expr)
+{
+  if (expr == NULL)
+    return;
+
+  pg_resolve_unary_expr(scope, expr->lhs);
+  pg_resolve_unary_expr(scope, expr->rhs);
+}
+
+static void pg_resolve_body(struct PG_SCOPE* scope, struct STMT* cur, struct STMT* stop);
+
+//
+// pg_resolve_function
+//
+// Numbers the locals of the given function, parameters first,
+// and resolves its body.
+//
+static void pg_resolve_function(struct PG_SCOPE* scope, struct STMT_FUNCTION_DEF* def)
+{
+  nameSetClear(&scope->locals);
+
+  for (struct ELEMENT* param = def->parameters; param != NULL; param = param->next)
+  {
+    pg_add_local(scope, param->element_value);
+    param->slot = pg_find_local(scope, param->element_value);
+  }
+
+  pg_collect_locals(scope, def->body, NULL);
+
+  def->num_locals = scope->locals.num_names;
+
+  pg_resolve_body(scope, def->body, NULL);
+
+  nameSetClear(&scope->locals);
+}
+
+//
+// pg_resolve_body
+//
+// Resolves the stmts starting at cur, stopping when the given
+// stmt is reached: calls to user-defined functions are linked to
+// their definitions, and in a function body the uses of locals
+// to their slots.
+//
+static void pg_resolve_body(struct PG_SCOPE* scope, struct STMT* cur, struct STMT* stop)
+{
+  for ( ; cur != stop; cur = *pg_next_link(cur))
+  {
+    if (cur->stmt_type == STMT_ASSIGNMENT)
+    {
+      struct STMT_ASSIGNMENT* assignment = cur->types.assignment;
+      struct VALUE* rhs = assignment->rhs;
+
+      assignment->var_slot = pg_find_local(scope, assignment->var_name);
+
+      pg_resolve_elements(scope, assignment->index);
+
+      if (rhs->value_type == VALUE_FUNCTION_CALL)
+      {
+        rhs->types.function_call->function = pg_find_function(scope, rhs->types.function_call->function_name);
+        pg_resolve_elements(scope, rhs->types.function_call->parameter);
+      }
+      else if (rhs->value_type == VALUE_EXPR)
+        pg_resolve_expr(scope, rhs->types.expr);
+      else if (rhs->value_type == VALUE_LIST)
+        pg_resolve_elements(scope, rhs->types.list->elements);
+      else if (rhs->value_type == VALUE_DICT)
+      {
+        pg_resolve_elements(scope, rhs->types.dict->keys);
+        pg_resolve_elements(scope, rhs->types.dict->values);
+      }
+    }
+    else if (cur->stmt_type == STMT_FUNCTION_CALL)
+    {
+      struct STMT_FUNCTION_CALL* call = cur->types.function_call;
+
+      call->function = pg_find_function(scope, call->function_name);
+      pg_resolve_elements(scope, call->parameter);
+    }
+    else if (cur->stmt_type == STMT_WHILE_LOOP)
+    {
+      pg_resolve_expr(scope, cur->types.while_loop->condition);
+      pg_resolve_body(scope, cur->types.while_loop->loop_body, cur);
+    }
+    else if (cur->stmt_type == STMT_FOR_LOOP)
+    {
+      struct STMT_FOR_LOOP* loop = cur->types.for_loop;
+
+      loop->var_slot = pg_find_local(scope, loop->var_name);
+      pg_resolve_elements(scope, loop->iterable);
+      pg_resolve_body(scope, loop->loop_body, cur);
+    }
+    else if (cur->stmt_type == STMT_FUNCTION_DEF)
+    {
+      pg_resolve_function(scope, cur->types.function_def);
+    }
+    else if (cur->stmt_type == STMT_RETURN)
+    {
+      pg_resolve_expr(scope, cur->types.return_stmt->value);
+    }
+  }
+}
+
+//
+// pg_resolve
+//
+// Resolves the program's calls to user-defined functions, and the
+// local variables of each function. Functions are defined at the
+// top level, so that's where to look for them; the given functions,
+// defined before the program, are found too, unless the program
+// defines one with the same name.
+//
+static void pg_resolve(struct STMT* program, struct STMT_FUNCTION_DEF** functions, int num_functions)
+{
+  struct PG_SCOPE scope;
+  memset(&scope, 0, sizeof(scope));
+
+  for (int i = 0; i < num_functions; i++)
+    pg_add_function(&scope, functions[i]);
+
+  for (struct STMT* cur = program; cur != NULL; cur = *pg_next_link(cur))
+  {
+    if (cur->stmt_type == STMT_FUNCTION_DEF)
+      pg_add_function(&scope, cur->types.function_def);
+  }
+
+  //
+  // no functions? Then there's nothing to resolve:
+  //
+  if (scope.function_names.num_names > 0)
+    pg_resolve_body(&scope, program, NULL);
+
+  nameSetFree(&scope.function_names);
+  free(scope.functions);
+  nameSetFree(&scope.locals);
+}
+
+
+//
+// Destroying the graph:
+//
+
+static void pg_destroy_element(struct ELEMENT* element)
+{
+  //
+  // NULL is okay, since elements are optional; the rest
+  // of the parameters or list items follow via next:
+  //
+  while (element != NULL)
+  {
+    struct ELEMENT* next = element->next;
+
+    free(element->element_value);
+    free(element);
+
+    element = next;
+  }
+}
+
+static void pg_destroy_unary_expr(struct UNARY_EXPR* unary)
+{
+  assert(unary != NULL);
+
+  pg_destroy_element(unary->element);
+  pg_destroy_element(unary->index);
+
+  free(unary);
+}
+
+static void pg_destroy_expr(struct VALUE_EXPR* expr)
+{
+  assert(expr != NULL);
+  assert(expr->lhs != NULL);
+
+  pg_destroy_unary_expr(expr->lhs);
+
+  if (expr->rhs != NULL)
+    pg_destroy_unary_expr(expr->rhs);
+
+  free(expr);
+}
+
+static void pg_destroy_value(struct VALUE* value)
+{
+  assert(value != NULL);
+
+  if (value->value_type == VALUE_FUNCTION_CALL)
+  {
+    struct VALUE_FUNCTION_CALL* call = value->types.function_call;
+
+    free(call->function_name);
+    pg_destroy_element(call->parameter);
+
+    free(call);
+  }
+  else if (value->value_type == VALUE_EXPR)
+  {
+    struct VALUE_EXPR* expr = value->types.expr;
+
+    pg_destroy_expr(expr);
+  }
+  else if (value->value_type == VALUE_LIST)
+  {
+    struct VALUE_LIST* list = value->types.list;
+
+    pg_destroy_element(list->elements);
+
+    free(list);
+  }
+  else if (value->value_type == VALUE_DICT)
+  {
+    struct VALUE_DICT* dict = value->types.dict;
+
+    pg_destroy_element(dict->keys);
+    pg_destroy_element(dict->values);
+
+    free(dict);
+  }
+  else
+    panic("unknown type of value?! (pg_destroy_value)");
+
+  free(value);
+}
+
+//
+// pg_destroy_body
+//
+// Frees the stmts starting at cur, stopping when the given stmt
+// is reached (the enclosing loop, or NULL at the end of the
+// program).
+//
+static void pg_destroy_body(struct STMT* cur, struct STMT* stop)
+{
+  while (cur != stop)
+  {
+    struct STMT* next;
+
+    if (cur->stmt_type == STMT_ASSIGNMENT)
+    {
+      struct STMT_ASSIGNMENT* assignment = cur->types.assignment;
+
+      free(assignment->var_name);
+
+      pg_destroy_element(assignment->index);
+
+      pg_destroy_value(assignment->rhs);
+
+      next = assignment->next_stmt;
+
+      free(assignment);
+      free(cur);
+
+      cur = next;
+    }
+    else if (cur->stmt_type == STMT_FUNCTION_CALL)
+    {
+      struct STMT_FUNCTION_CALL* call = cur->types.function_call;
+
+      free(call->function_name);
+
+      pg_destroy_element(call->parameter);
+
+      next = call->next_stmt;
+
+      free(call);
+      free(cur);
+
+      cur = next;
+    }
+    else if (cur->stmt_type == STMT_IF_THEN_ELSE)
+    {
+      printf("<<if statements are not yet supported>>");
+    }
+    else if (cur->stmt_type == STMT_WHILE_LOOP)
+    {
+      struct STMT_WHILE_LOOP* loop = cur->types.while_loop;
+
+      pg_destroy_expr(loop->condition);
+
+      pg_destroy_body(loop->loop_body, cur);
+
+      next = loop->next_stmt;
+
+      free(loop);
+      free(cur);
+
+      cur = next;
+    }
+    else if (cur->stmt_type == STMT_FOR_LOOP)
+    {
+      struct STMT_FOR_LOOP* loop = cur->types.for_loop;
+
+      free(loop->var_name);
+
+      pg_destroy_element(loop->iterable);
+
+      pg_destroy_body(loop->loop_body, cur);
+
+      next = loop->next_stmt;
+
+      free(loop);
+      free(cur);
+
+      cur = next;
+    }
+    else if (cur->stmt_type == STMT_PASS)
+    {
+      struct STMT_PASS* pass = cur->types.pass;
+
+      next = pass->next_stmt;
+
+      free(pass);
+      free(cur);
+
+      cur = next;
+    }
+    else if (cur->stmt_type == STMT_FUNCTION_DEF)
+    {
+      struct STMT_FUNCTION_DEF* def = cur->types.function_def;
+
+      free(def->function_name);
+
+      pg_destroy_element(def->parameters);
+
+      pg_destroy_body(def->body, NULL);
+
+      next = def->next_stmt;
+
+      free(def);
+      free(cur);
+
+      cur = next;
+    }
+    else if (cur->stmt_type == STMT_RETURN)
+    {
+      struct STMT_RETURN* ret = cur->types.return_stmt;
+
+      if (ret->value != NULL)
+        pg_destroy_expr(ret->value);
+
+      next = ret->next_stmt;
+
+      free(ret);
+      free(cur);
+
+      cur = next;
+    }
+    else
+    {
+      panic("unknown type of statement?! (programgraph_destroy)");
+    }
+  }
+}
+
+
+//
+// Printing the graph:
+//
+
+static void pg_print_element(struct ELEMENT* element)
+{
+  if (element == NULL)  // optional, so this is okay:
+    return;
+
+  if (element->element_type == ELEMENT_STR_LITERAL)
+    printf("'%s'", element->element_value);
+  else
+    printf("%s", element->element_value);
+}
+
+static void pg_print_elements(struct ELEMENT* element)
+{
+  while (element != NULL)
+  {
+    pg_print_element(element);
+
+    if (element->next != NULL)
+      printf(", ");
+
+    element = element->next;
+  }
+}
+
+static void pg_print_unary_expr(struct UNARY_EXPR* unary)
+{
+  switch (unary->expr_type)
+  {
+    case UNARY_PTR_DEREF:
+      printf("*");
+      break;
+
+    case UNARY_ADDRESS_OF:
+      printf("&");
+      break;
+
+    case UNARY_PLUS:
+      printf("+");
+      break;
+
+    case UNARY_MINUS:
+      printf("-");
+      break;
+
+    default:
+      break;
+  }
+
+  pg_print_element(unary->element);
+
+  if (unary->expr_type == UNARY_INDEX)
+  {
+    printf("[");
+    pg_print_element(unary->index);
+    printf("]");
+  }
+}
+
+static void pg_print_expr(struct VALUE_EXPR* expr)
+{
+  pg_print_unary_expr(expr->lhs);
+
+  if (expr->isBinaryExpr)
+  {
+    switch (expr->operator)
+    {
+      case OPERATOR_PLUS:
+        printf(" + ");
+        break;
+      case OPERATOR_MINUS:
+        printf(" - ");
+        break;
+      case OPERATOR_ASTERISK:
+        printf(" * ");
+        break;
+      case OPERATOR_POWER:
+        printf(" ** ");
+        break;
+      case OPERATOR_MOD:
+        printf(" %% ");
+        break;
+      case OPERATOR_DIV:
+        printf(" / ");
+        break;
+      case OPERATOR_EQUAL:
+        printf(" == ");
+        break;
+      case OPERATOR_NOT_EQUAL:
+        printf(" != ");
+        break;
+      case OPERATOR_LT:
+        printf(" < ");
+        break;
+      case OPERATOR_LTE:
+        printf(" <= ");
+        break;
+      case OPERATOR_GT:
+        printf(" > ");
+        break;
+      case OPERATOR_GTE:
+        printf(" >= ");
+        break;
+      case OPERATOR_IS:
+        printf(" is ");
+        break;
+      case OPERATOR_IN:
+        printf(" in ");
+        break;
+      default:
+        panic("unknown operator (pg_print_expr)");
+    }
+
+    pg_print_unary_expr(expr->rhs);
+  }
+}
+
+static void pg_print_value(struct VALUE* value)
+{
+  if (value->value_type == VALUE_EXPR)
+  {
+    pg_print_expr(value->types.expr);
+  }
+  else if (value->value_type == VALUE_LIST)
+  {
+    printf("[");
+
+    pg_print_elements(value->types.list->elements);
+
+    printf("]");
+  }
+  else if (value->value_type == VALUE_DICT)
+  {
+    struct ELEMENT* key = value->types.dict->keys;
+    struct ELEMENT* val = value->types.dict->values;
+
+    printf("{");
+
+    while (key != NULL)
+    {
+      pg_print_element(key);
+      printf(": ");
+      pg_print_element(val);
+
+      if (key->next != NULL)
+        printf(", ");
+
+      key = key->next;
+      val = val->next;
+    }
+
+    printf("}");
+  }
+  else
+  {
+    assert(value->value_type == VALUE_FUNCTION_CALL);
+
+    printf("%s(", value->types.function_call->function_name);
+
+    pg_print_elements(value->types.function_call->parameter);
+
+    printf(")");
+  }
+}
+
+//
+// pg_print_body
+//
+// Prints the stmts starting at cur, indented by the given #
+// of spaces, stopping when the given stmt is reached.
+//
+static void pg_print_body(int indent, struct STMT* cur, struct STMT* stop)
+{
+  while (cur != stop)
+  {
+    for (int i = 0; i < indent; i++)
+      printf(" ");
+
+    if (cur->stmt_type == STMT_ASSIGNMENT)
+    {
+      if (cur->types.assignment->isPtrDeref)
+        printf("*");
+
+      printf("%s", cur->types.assignment->var_name);
+
+      if (cur->types.assignment->index != NULL)
+      {
+        printf("[");
+        pg_print_element(cur->types.assignment->index);
+        printf("]");
+      }
+
+      printf(" = ");
+
+      pg_print_value(cur->types.assignment->rhs);
+
+      printf("\n");
+
+      cur = cur->types.assignment->next_stmt;
+    }
+    else if (cur->stmt_type == STMT_FUNCTION_CALL)
+    {
+      printf("%s(", cur->types.function_call->function_name);
+
+      pg_print_elements(cur->types.function_call->parameter);
+
+      printf(")\n");
+
+      cur = cur->types.function_call->next_stmt;
+    }
+    else if (cur->stmt_type == STMT_IF_THEN_ELSE)
+    {
+      panic("if statements are not yet supported (programgraph_print)");
+    }
+    else if (cur->stmt_type == STMT_WHILE_LOOP)
+    {
+      printf("while ");
+      pg_print_expr(cur->types.while_loop->condition);
+      printf(":\n");
+
+      for (int i = 0; i < indent; i++)
+        printf(" ");
+
+      printf("{\n");
+
+      pg_print_body(indent + 2, cur->types.while_loop->loop_body, cur);
+
+      for (int i = 0; i < indent; i++)
+        printf(" ");
+
+      printf("}\n");
+
+      cur = cur->types.while_loop->next_stmt;
+    }
+    else if (cur->stmt_type == STMT_FOR_LOOP)
+    {
+      printf("for %s in ", cur->types.for_loop->var_name);
+      pg_print_element(cur->types.for_loop->iterable);
+      printf(":\n");
+
+      for (int i = 0; i < indent; i++)
+        printf(" ");
+
+      printf("{\n");
+
+      pg_print_body(indent + 2, cur->types.for_loop->loop_body, cur);
+
+      for (int i = 0; i < indent; i++)
+        printf(" ");
+
+      printf("}\n");
+
+      cur = cur->types.for_loop->next_stmt;
+    }
+    else if (cur->stmt_type == STMT_PASS)
+    {
+      printf("pass\n");
+
+      cur = cur->types.pass->next_stmt;
+    }
+    else if (cur->stmt_type == STMT_FUNCTION_DEF)
+    {
+      printf("def %s(", cur->types.function_def->function_name);
+      pg_print_elements(cur->types.function_def->parameters);
+      printf("):\n");
+
+      for (int i = 0; i < indent; i++)
+        printf(" ");
+
+      printf("{\n");
+
+      pg_print_body(indent + 2, cur->types.function_def->body, NULL);
+
+      for (int i = 0; i < indent; i++)
+        printf(" ");
+
+      printf("}\n");
+
+      cur = cur->types.function_def->next_stmt;
+    }
+    else if (cur->stmt_type == STMT_RETURN)
+    {
+      printf("return");
+
+      if (cur->types.return_stmt->value != NULL)
+      {
+        printf(" ");
+        pg_print_expr(cur->types.return_stmt->value);
+      }
+
+      printf("\n");
+
+      cur = cur->types.return_stmt->next_stmt;
+    }
+    else
+    {
+      panic("unknown type of statement?! (programgraph_print)");
+    }
+  }
+}
+
+
+//
+// Numbering the variables:
+//
+
+//
+// What the walk below finds, besides the variables:
+//
+struct PG_VARS
+{
+  struct NameSet* vars;
+  bool pointers;  // & or * seen?
+  bool calls;     // call to a function defined with def seen?
+};
+
+//
+// pg_vars_elements / pg_vars_unary / pg_vars_block
+//
+// Numbers the variables named in a chain of elements, a unary
+// expression, or a block of statements (up to the given stop
+// statement, the loop a body links back to). The walk of a block
+// ends at an if or return statement; the bodies of functions
+// defined with def are left out.
+//
+static void pg_vars_elements(struct PG_VARS* pv, struct ELEMENT* element)
+{
+  for ( ; element != NULL; element = element->next) {
+    if (element->element_type == ELEMENT_IDENTIFIER)
+      nameSetFind(pv->vars, element->element_value, true);
+  }
+}
+
+static void pg_vars_unary(struct PG_VARS* pv, struct UNARY_EXPR* unary)
+{
+  if (unary == NULL)
+    return;
+
+  if (unary->expr_type == UNARY_ADDRESS_OF || unary->expr_type == UNARY_PTR_DEREF)
+    pv->pointers = true;
+
+  pg_vars_elements(pv, unary->element);
+  pg_vars_elements(pv, unary->index);
+}
+
+static void pg_vars_block(struct PG_VARS* pv, struct STMT* stmt, struct STMT* stop)
+{
+  for ( ; stmt != NULL && stmt != stop; stmt = *pg_next_link(stmt)) {
+    if (stmt->stmt_type == STMT_ASSIGNMENT) {
+      struct STMT_ASSIGNMENT* assign = stmt->types.assignment;
+      struct VALUE* rhs = assign->rhs;
+
+      if (assign->isPtrDeref)
+        pv->pointers = true;
+
+      nameSetFind(pv->vars, assign->var_name, true);
+      pg_vars_elements(pv, assign->index);
+
+      if (rhs->value_type == VALUE_EXPR) {
+        pg_vars_unary(pv, rhs->types.expr->lhs);
+        pg_vars_unary(pv, rhs->types.expr->rhs);
+      }
+      else if (rhs->value_type == VALUE_FUNCTION_CALL) {
+        if (rhs->types.function_call->function != NULL)
+          pv->calls = true;
+
+        pg_vars_elements(pv, rhs->types.function_call->parameter);
+      }
+      else if (rhs->value_type == VALUE_LIST)
+        pg_vars_elements(pv, rhs->types.list->elements);
+      else if (rhs->value_type == VALUE_DICT) {
+        pg_vars_elements(pv, rhs->types.dict->keys);
+        pg_vars_elements(pv, rhs->types.dict->values);
+      }
+    }
+    else if (stmt->stmt_type == STMT_FUNCTION_CALL) {
+      if (stmt->types.function_call->function != NULL)
+        pv->calls = true;
+
+      pg_vars_elements(pv, stmt->types.function_call->parameter);
+    }
+    else if (stmt->stmt_type == STMT_WHILE_LOOP) {
+      pg_vars_unary(pv, stmt->types.while_loop->condition->lhs);
+      pg_vars_unary(pv, stmt->types.while_loop->condition->rhs);
+      pg_vars_block(pv, stmt->types.while_loop->loop_body, stmt);
+    }
+    else if (stmt->stmt_type == STMT_FOR_LOOP) {
+      nameSetFind(pv->vars, stmt->types.for_loop->var_name, true);
+      pg_vars_elements(pv, stmt->types.for_loop->iterable);
+      pg_vars_block(pv, stmt->types.for_loop->loop_body, stmt);
+    }
+    else if (stmt->stmt_type != STMT_PASS && stmt->stmt_type != STMT_FUNCTION_DEF) {
+      return;  // if or return: the walk of this block ends here
+    }
+  }
+}
+
+
+//
+// Public functions:
+//
+
+//
+// programgraph_build
+//
+// Given a legal nuPython program in the form of a list
+// of tokens, builds and returns a program graph
+// representing the nuPython program.
+//
+struct STMT* programgraph_build(struct TokenQueue* tokens)
+{
+  return programgraph_build_more(tokens, NULL, 0);
+}
+
+//
+// programgraph_build_more
+//
+// Builds the program graph for a program that continues an
+// earlier one, whose functions are given.
+//
+struct STMT* programgraph_build_more(struct TokenQueue* tokens, struct STMT_FUNCTION_DEF** functions, int num_functions)
+{
+  if (tokens == NULL)
+    panic("tokens is NULL (programgraph_build)");
+
+  //
+  // the program is a body of stmts ending with EOS:
+  //
+  struct STMT* program = NULL;
+
+  struct TokenNode* cur = tokens->head;
+
+  pg_errors = 0;
+
+  cur = pg_build_body(&program, cur, nuPy_EOS);
+
+  if (cur->token.id != nuPy_EOS)
+    panic("expecting $ at the end of the program tokens?! (programgraph_build)");
+
+  if (pg_errors > 0) {  // already output
+    programgraph_destroy(program);
+    return NULL;
+  }
+
+  pg_resolve(program, functions, num_functions);
+
+  //
+  // success:
+  //
+  return program;
+}
+
+//
+// programgraph_variables
+//
+// Numbers the variables of the given program into the given set.
+//
+void programgraph_variables(struct STMT* program, struct NameSet* vars, bool* pointers, bool* calls)
+{
+  struct PG_VARS pv = { vars, false, false };
+
+  pg_vars_block(&pv, program, NULL);
+
+  if (pointers != NULL)
+    *pointers = pv.pointers;
+  if (calls != NULL)
+    *calls = pv.calls;
+}
+
+//
+// programgraph_destroy
+//
+// Frees all the memory with in given program graph.
+//
+void programgraph_destroy(struct STMT* program)
+{
+  pg_destroy_body(program, NULL);
+}
+
+//
+// programgraph_print
+//
+// Prints the contents of the program graph to the console.
+//
+void programgraph_print(struct STMT* program)
+{
+  printf("**PROGRAM GRAPH PRINT**\n");
+
+  pg_print_body(0, program, NULL);
+
+  printf("$\n");
+  printf("**END PRINT**\n");
+}
@@ -12,6 +12,7 @@
 
 #include <stdbool.h>     // true, false
 #include "tokenqueue.h"
+#include "util.h"        // struct NameSet
 
 
 //
@@ -27,7 +28,10 @@ enum STMT_TYPES
   STMT_FUNCTION_CALL,
   STMT_IF_THEN_ELSE,
   STMT_WHILE_LOOP,
-  STMT_PASS
+  STMT_PASS,
+  STMT_FOR_LOOP,
+  STMT_FUNCTION_DEF,
+  STMT_RETURN
 };
 
 struct STMT
@@ -48,6 +52,9 @@ struct STMT
     struct STMT_IF_THEN_ELSE* if_then_else;
     struct STMT_WHILE_LOOP* while_loop;
     struct STMT_PASS* pass;
+    struct STMT_FOR_LOOP* for_loop;
+    struct STMT_FUNCTION_DEF* function_def;
+    struct STMT_RETURN* return_stmt;
   } types;
 };
 
@@ -56,9 +63,13 @@ struct STMT_ASSIGNMENT
   // 
   // Examples:  x = 123 
   //           *p = x + y
+  //           xs[i] = x
+  //           d[k] = x
   //
   char* var_name;
+  int   var_slot;     // frame slot if var_name is local, -1 if not
   bool  isPtrDeref;
+  struct ELEMENT* index;  // optional => could be NULL
   struct VALUE* rhs;  // rhs = "right-hand side"
 
   struct STMT* next_stmt;
@@ -69,9 +80,13 @@ struct STMT_FUNCTION_CALL
   //
   // Examples: print()
   //           print("the output is")
+  //           append(xs, x)
   //
   char* function_name;
-  struct ELEMENT* parameter;  // optional => could be NULL
+  struct ELEMENT* parameter;  // optional => could be NULL, more via next
+
+  struct STMT_FUNCTION_DEF* function;  // user-defined function, NULL => builtin
+  int   builtin;  // id of the builtin, resolved by execute_prepare; -1 => unknown
 
   struct STMT* next_stmt;
 };
@@ -110,6 +125,50 @@ struct STMT_PASS
   struct STMT* next_stmt;
 };
 
+struct STMT_FOR_LOOP
+{
+  //
+  // Example: for x in xs:
+  //          { ... }
+  //
+  char* var_name;           // loop variable
+  int   var_slot;           // frame slot if var_name is local, -1 if not
+  struct ELEMENT* iterable; // list (or dict's keys) to iterate over
+  struct STMT* loop_body;   // loop body, once per item
+  struct STMT* next_stmt;   // next stmt after the loop is over
+};
+
+struct STMT_FUNCTION_DEF
+{
+  //
+  // Example: def f(x, y):
+  //          { ... }
+  //
+  // Functions are defined at the top level only. The parameters,
+  // and the variables the body assigns, are local: they live in
+  // the function's frame, slots 0 .. num_locals-1 with the
+  // parameters first, and programgraph_build resolves each use to
+  // its slot. The body is not linked back to the def; it ends with
+  // NULL, and running off the end returns None.
+  //
+  char* function_name;
+  struct ELEMENT* parameters;  // identifiers via next, NULL => none
+  int   num_params;
+  int   num_locals;            // parameters included
+  struct STMT* body;
+  struct STMT* next_stmt;      // next stmt after the def
+};
+
+struct STMT_RETURN
+{
+  //
+  // Examples: return
+  //           return x * y
+  //
+  struct VALUE_EXPR* value;  // optional => NULL returns None
+  struct STMT* next_stmt;    // never executed
+};
+
 
 //
 // nuPython values / expressions:
@@ -117,7 +176,9 @@ struct STMT_PASS
 enum VALUE_TYPES
 {
   VALUE_FUNCTION_CALL = 0,
-  VALUE_EXPR
+  VALUE_EXPR,
+  VALUE_LIST,
+  VALUE_DICT
 };
 
 struct VALUE
@@ -134,13 +195,37 @@ struct VALUE
   {
     struct VALUE_FUNCTION_CALL* function_call;
     struct VALUE_EXPR* expr;
+    struct VALUE_LIST* list;
+    struct VALUE_DICT* dict;
   } types;
 };
 
 struct VALUE_FUNCTION_CALL
 {
   char* function_name;
-  struct ELEMENT* parameter;  // optional => could be NULL
+  struct ELEMENT* parameter;  // optional => could be NULL, more via next
+
+  struct STMT_FUNCTION_DEF* function;  // user-defined function, NULL => builtin
+  int   builtin;  // id of the builtin, resolved by execute_prepare; -1 => unknown
+};
+
+struct VALUE_LIST
+{
+  //
+  // Examples: []
+  //           [1, x, 'three']
+  //
+  struct ELEMENT* elements;  // linked via next, NULL => empty list
+};
+
+struct VALUE_DICT
+{
+  //
+  // Examples: {}
+  //           {'one': 1, 2: x}
+  //
+  struct ELEMENT* keys;    // linked via next, NULL => empty dict
+  struct ELEMENT* values;  // values[i] goes with keys[i]
 };
 
 struct VALUE_EXPR
@@ -151,6 +236,14 @@ struct VALUE_EXPR
 
   int    operator;        // enum OPERATORS
   struct UNARY_EXPR* rhs; // optional => could be NULL
+
+  //
+  // types of the operands' values, if known before execution
+  // (see infer.h): an enum RAM_VALUE_TYPES, or -1 if the type is
+  // unknown and must be checked at run time:
+  //
+  int    lhs_type;
+  int    rhs_type;
 };
 
 enum UNARY_EXPR_TYPES
@@ -159,7 +252,8 @@ enum UNARY_EXPR_TYPES
   UNARY_ADDRESS_OF,
   UNARY_PLUS,
   UNARY_MINUS,
-  UNARY_ELEMENT
+  UNARY_ELEMENT,
+  UNARY_INDEX
 };
 
 struct UNARY_EXPR
@@ -173,6 +267,11 @@ struct UNARY_EXPR
   // underlying element (identifier or literal):
   //
   struct ELEMENT* element;
+
+  //
+  // for xs[i] or d[k], the index i or key k (NULL otherwise):
+  //
+  struct ELEMENT* index;
 };
 
 
@@ -201,6 +300,27 @@ struct ELEMENT
   // underlying element (identifier or literal):
   //
   char* element_value;  // e.g. "x" or "123" or "3.14" or "this is a string"
+
+  //
+  // for an identifier in a function body that names a local
+  // variable, its slot in the function's frame; -1 otherwise:
+  //
+  int slot;
+
+  //
+  // for an int or real literal, its value, converted once when
+  // the graph is built (see convert.h):
+  //
+  union
+  {
+    int    i;  // ELEMENT_INT_LITERAL
+    double d;  // ELEMENT_REAL_LITERAL
+  } literal;
+
+  //
+  // next parameter of a function call or item of a list literal:
+  //
+  struct ELEMENT* next;  // NULL => last one
 };
 
 
@@ -240,8 +360,13 @@ enum OPERATORS
 // to work with than the raw tokens. 
 //
 // Returns NULL if an error occurs and the program graph
-// could not be built.
+// could not be built: an int literal that doesn't fit in 32 bits
+// is a semantic error, output when the graph is built.
 // 
+// Calls to functions defined with def are resolved to their
+// definitions, wherever the def is in the program, and the local
+// variables of each function to their frame slots.
+//
 // NOTE: the program graph may contain semantic errors, 
 // e.g. type errors or calls to functions that don't exist.
 // Semantic errors need to be detected during execution 
@@ -250,6 +375,31 @@ enum OPERATORS
 //
 struct STMT* programgraph_build(struct TokenQueue* tokens);
 
+//
+// programgraph_build_more
+//
+// Like programgraph_build, for a program that continues one built
+// earlier, e.g. the next entry of an interactive session: calls
+// are also resolved to the given functions, defined earlier, 
+// unless this program defines a function with the same name. The
+// earlier program graph is not looked at again, and must outlive
+// this one.
+//
+struct STMT* programgraph_build_more(struct TokenQueue* tokens, struct STMT_FUNCTION_DEF** functions, int num_functions);
+
+//
+// programgraph_variables
+//
+// Numbers the variables of the given program into the given set,
+// in the order they are found: those assigned or read by its
+// statements and loops, up to an if or return statement, but not
+// the locals of functions defined with def. The names are not
+// copied. If pointers / calls are not NULL, they are set to
+// whether the program uses & or *, and whether it calls functions
+// defined with def.
+//
+void programgraph_variables(struct STMT* program, struct NameSet* vars, bool* pointers, bool* calls);
+
 //
 // programgraph_destroy
 //
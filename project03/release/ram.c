@@ -0,0 +1,1351 @@
+/*ram.c*/
+
+//
+// Random access memory (RAM) for nuPython
+//
+// Clarissa Shieh
+// Based on Solution by Prof. Joe Hummel
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>   // strcmp, strlen
+#include <limits.h>   // INT_MAX
+#include <stddef.h>   // offsetof
+
+#include "ram.h"
+#include "util.h"
+#include "output.h"
+
+
+//
+// # of bytes per memory cell: its value plus a pointer to
+// its identifier:
+//
+#define CELL_BYTES ((long long)(sizeof(struct RAM_VALUE) + sizeof(char*)))
+
+//
+// # of bytes for a list with room for n items:
+//
+#define LIST_BYTES(n) ((long long)sizeof(struct RAM_LIST) + (long long)sizeof(struct RAM_VALUE) * (n))
+
+//
+// # of bytes for a dict with room for n entries, and an index
+// with m slots:
+//
+#define DICT_BYTES(n, m) ((long long)sizeof(struct RAM_DICT) + (long long)sizeof(struct RAM_DICT_ENTRY) * (n) + (long long)sizeof(int) * (m))
+
+//
+// An interned string, with the # of dict entries using it as
+// their key; the strings table points at s:
+//
+struct INTERNED
+{
+  int  refs;
+  char s[];
+};
+
+#define INTERNED_OF(string) ((struct INTERNED*)((string) - offsetof(struct INTERNED, s)))
+
+//
+// lists nested deeper than this are printed as [...], which
+// also stops a list that contains itself:
+//
+#define MAX_PRINT_DEPTH 16
+
+
+//
+// Private functions:
+//
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**RAM ERROR\n");
+  printf("**RAM ERROR: %s\n", msg);
+  printf("**RAM ERROR\n");
+
+  exit(-123);
+}
+
+//
+// find_slot
+//
+// Returns the slot in the index where the given identifier is,
+// or the empty slot where it would go.
+//
+static int find_slot(struct RAM* memory, const char* identifier)
+{
+  int mask = memory->index_capacity - 1;
+  int slot = (int)(hashString(identifier) & (unsigned int)mask);
+
+  while (memory->index[slot] >= 0) {
+    if (strcmp(memory->identifiers[memory->index[slot]], identifier) == 0)
+      break;
+
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+//
+// find_identifier
+//
+// Returns the address of the cell holding the given identifier,
+// or -1 if the identifier is not in memory.
+//
+static int find_identifier(struct RAM* memory, char* identifier)
+{
+  return memory->index[find_slot(memory, identifier)];
+}
+
+//
+// add_identifier
+//
+// Adds the given address to the index, under its identifier,
+// growing the index so it stays at most half full.
+//
+static void add_identifier(struct RAM* memory, int address)
+{
+  if (2 * (memory->num_identifiers + 1) > memory->index_capacity) {
+    free(memory->index);
+
+    memory->index_capacity *= 2;
+    memory->index = (int*)malloc(sizeof(int) * memory->index_capacity);
+    if (memory->index == NULL)
+      panic("out of memory (add_identifier)");
+
+    for (int i = 0; i < memory->index_capacity; i++)
+      memory->index[i] = -1;
+
+    for (int i = 0; i < memory->num_values; i++) {
+      if (memory->identifiers[i] != NULL)
+        memory->index[find_slot(memory, memory->identifiers[i])] = i;
+    }
+  }
+
+  memory->index[find_slot(memory, memory->identifiers[address])] = address;
+  memory->num_identifiers++;
+}
+
+//
+// value_bytes
+//
+// Returns the # of bytes the given value owns outside its
+// cell --- the payload of a string, 0 for everything else.
+// (A list is shared, so its bytes are accounted for when it
+// is created and grows, not by the cells referring to it.)
+//
+static long long value_bytes(struct RAM_VALUE* value)
+{
+  if (value->value_type == RAM_TYPE_STR)
+    return (long long)strlen(value->types.s) + 1;
+
+  return 0;
+}
+
+//
+// within_limit
+//
+// Returns true if delta more bytes can be used without exceeding
+// the memory's limit (if any), false if not.
+//
+static bool within_limit(struct RAM* memory, long long delta)
+{
+  if (memory->bytes_limit == 0 || delta <= 0)
+    return true;
+
+  return memory->bytes_in_use + delta <= memory->bytes_limit;
+}
+
+//
+// account_bytes
+//
+// Records that delta more bytes are in use (or fewer, if delta
+// is negative), updating the high-water mark.
+//
+static void account_bytes(struct RAM* memory, long long delta)
+{
+  memory->bytes_in_use += delta;
+
+  if (memory->bytes_in_use > memory->bytes_peak)
+    memory->bytes_peak = memory->bytes_in_use;
+}
+
+//
+// find_string
+//
+// Returns the slot in the interned strings where the given
+// string is, or the empty slot where it would go.
+//
+static int find_string(struct RAM* memory, const char* s, unsigned int hash)
+{
+  int mask = memory->strings_capacity - 1;
+  int slot = (int)(hash & (unsigned int)mask);
+
+  while (memory->strings[slot] != NULL) {
+    if (strcmp(memory->strings[slot], s) == 0)
+      break;
+
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+//
+// intern_string
+//
+// Returns the interned copy of the given string, with a reference
+// added for the dict entry that takes it as its key, adding it
+// (and accounting for its bytes) if it isn't interned yet. The set
+// of interned strings is kept at most half full.
+//
+static char* intern_string(struct RAM* memory, const char* s)
+{
+  unsigned int hash = hashString(s);
+  int slot = find_string(memory, s, hash);
+
+  if (memory->strings[slot] != NULL) {
+    INTERNED_OF(memory->strings[slot])->refs++;
+    return memory->strings[slot];
+  }
+
+  if (2 * (memory->num_strings + 1) > memory->strings_capacity) {
+    char** old_strings = memory->strings;
+    int old_capacity = memory->strings_capacity;
+
+    memory->strings_capacity *= 2;
+    memory->strings = (char**)malloc(sizeof(char*) * memory->strings_capacity);
+    if (memory->strings == NULL)
+      panic("out of memory (intern_string)");
+
+    for (int i = 0; i < memory->strings_capacity; i++)
+      memory->strings[i] = NULL;
+
+    for (int i = 0; i < old_capacity; i++) {
+      if (old_strings[i] != NULL)
+        memory->strings[find_string(memory, old_strings[i], hashString(old_strings[i]))] = old_strings[i];
+    }
+
+    free(old_strings);
+
+    slot = find_string(memory, s, hash);
+  }
+
+  size_t length = strlen(s);
+  struct INTERNED* interned = (struct INTERNED*)malloc(sizeof(struct INTERNED) + length + 1);
+  if (interned == NULL)
+    panic("out of memory (intern_string)");
+
+  interned->refs = 1;
+  memcpy(interned->s, s, length + 1);
+
+  memory->strings[slot] = interned->s;
+  memory->num_strings++;
+
+  account_bytes(memory, (long long)length + 1);
+
+  return memory->strings[slot];
+}
+
+//
+// release_string
+//
+// Drops the reference of a dict entry to its interned key,
+// freeing the string (and accounting for it) once no entry uses
+// it. The string is removed from the set by shifting back the
+// strings after it that probed past its slot, so no probe
+// sequence is broken.
+//
+static void release_string(struct RAM* memory, char* s)
+{
+  struct INTERNED* interned = INTERNED_OF(s);
+
+  interned->refs--;
+
+  if (interned->refs > 0)
+    return;
+
+  int mask = memory->strings_capacity - 1;
+  int slot = find_string(memory, s, hashString(s));
+  int next = (slot + 1) & mask;
+
+  while (memory->strings[next] != NULL) {
+    int home = (int)(hashString(memory->strings[next]) & (unsigned int)mask);
+
+    //
+    // the string at next can move back to slot if its home is
+    // not in (slot, next], cyclically:
+    //
+    if ((next > slot) ? (home <= slot || home > next) : (home <= slot && home > next)) {
+      memory->strings[slot] = memory->strings[next];
+      slot = next;
+    }
+
+    next = (next + 1) & mask;
+  }
+
+  memory->strings[slot] = NULL;
+  memory->num_strings--;
+
+  account_bytes(memory, -((long long)strlen(s) + 1));
+
+  free(interned);
+}
+
+//
+// hash_key
+//
+// Returns the hash code of a dict key, an int or a string.
+//
+static unsigned int hash_key(struct RAM_VALUE* key)
+{
+  if (key->value_type == RAM_TYPE_STR)
+    return hashString(key->types.s);
+
+  return (unsigned int)key->types.i * 2654435761u;  // Knuth's multiplicative hash
+}
+
+//
+// find_entry
+//
+// Returns the slot in the dict's index where the given key is,
+// or the empty slot where it would go. A string key must have
+// been interned, since keys are compared by pointer.
+//
+static int find_entry(struct RAM_DICT* dict, struct RAM_VALUE* key, unsigned int hash)
+{
+  int mask = dict->index_capacity - 1;
+  int slot = (int)(hash & (unsigned int)mask);
+
+  while (dict->index[slot] >= 0) {
+    struct RAM_DICT_ENTRY* entry = &dict->entries[dict->index[slot]];
+
+    if (entry->hash == hash && entry->key.value_type == key->value_type) {
+      if (key->value_type == RAM_TYPE_STR ? entry->key.types.s == key->types.s : entry->key.types.i == key->types.i)
+        break;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+//
+// index_capacity_for
+//
+// Returns the # of index slots a dict with n entries needs, so
+// the index is at most half full.
+//
+static int index_capacity_for(int n)
+{
+  int capacity = 8;
+
+  while (capacity < 2 * n)
+    capacity *= 2;
+
+  return capacity;
+}
+
+//
+// acquire_value
+//
+// Called once a value has been stored in a cell, list item or
+// dict entry: a string is duplicated, so the cell owns its own
+// copy, and a list or dict gains a reference.
+//
+static void acquire_value(struct RAM_VALUE* value)
+{
+  if (value->value_type == RAM_TYPE_STR)
+    value->types.s = dupString(value->types.s);
+  else if (value->value_type == RAM_TYPE_LIST)
+    ram_list_retain(value->types.l);
+  else if (value->value_type == RAM_TYPE_DICT)
+    ram_dict_retain(value->types.m);
+}
+
+//
+// drop_value
+//
+// The opposite of acquire_value, called when a value is removed
+// from a cell, list item or dict entry: a string is freed and a
+// list or dict loses a reference. The bytes of the string are NOT accounted for,
+// that's up to the caller.
+//
+static void drop_value(struct RAM* memory, struct RAM_VALUE* value)
+{
+  if (value->value_type == RAM_TYPE_STR)
+    free(value->types.s);
+  else if (value->value_type == RAM_TYPE_LIST)
+    ram_list_release(memory, value->types.l);
+  else if (value->value_type == RAM_TYPE_DICT)
+    ram_dict_release(memory, value->types.m);
+}
+
+//
+// print_value
+//
+// Prints the given value the way it appears inside a list or
+// dict, e.g. 123 or 'abc' or [1, 2] or {'a': 1}.
+//
+static void print_value(struct RAM_VALUE* value, int depth)
+{
+  switch (value->value_type)
+  {
+    case RAM_TYPE_INT:
+    case RAM_TYPE_PTR:
+      printf("%d", value->types.i);
+      break;
+
+    case RAM_TYPE_REAL:
+      printf("%lf", value->types.d);
+      break;
+
+    case RAM_TYPE_STR:
+      printf("'%s'", value->types.s);
+      break;
+
+    case RAM_TYPE_BOOLEAN:
+      printf(value->types.i ? "True" : "False");
+      break;
+
+    case RAM_TYPE_NONE:
+      printf("None");
+      break;
+
+    case RAM_TYPE_LIST: {
+      struct RAM_LIST* list = value->types.l;
+
+      if (depth >= MAX_PRINT_DEPTH) {
+        printf("[...]");
+        break;
+      }
+
+      printf("[");
+      for (int i = 0; i < list->length; i++) {
+        if (i > 0)
+          printf(", ");
+        print_value(&list->items[i], depth + 1);
+      }
+      printf("]");
+      break;
+    }
+
+    case RAM_TYPE_DICT: {
+      struct RAM_DICT* dict = value->types.m;
+
+      if (depth >= MAX_PRINT_DEPTH) {
+        printf("{...}");
+        break;
+      }
+
+      printf("{");
+      for (int i = 0; i < dict->length; i++) {
+        if (i > 0)
+          printf(", ");
+        print_value(&dict->entries[i].key, depth + 1);
+        printf(": ");
+        print_value(&dict->entries[i].value, depth + 1);
+      }
+      printf("}");
+      break;
+    }
+
+    default:
+      panic("unknown ram value type?! (print_value)");
+  }
+}
+
+//
+// ensure_capacity
+//
+// Makes sure memory has room for n more cells, doubling its
+// capacity as needed, and returns the # of bytes this adds. If
+// check_only is true, memory is left as is and the # of bytes
+// that would be added is returned.
+//
+static long long ensure_capacity(struct RAM* memory, int n, bool check_only)
+{
+  long long capacity = memory->capacity;
+
+  while (memory->num_values + (long long)n > capacity)
+    capacity *= 2;
+
+  if (capacity > INT_MAX)
+    capacity = INT_MAX;
+
+  long long grow = CELL_BYTES * (long long)(capacity - memory->capacity);
+
+  if (check_only || capacity == memory->capacity)
+    return grow;
+
+  memory->values = (struct RAM_VALUE*)realloc(memory->values, sizeof(struct RAM_VALUE) * capacity);
+  memory->identifiers = (char**)realloc(memory->identifiers, sizeof(char*) * capacity);
+  if (memory->values == NULL || memory->identifiers == NULL)
+    panic("out of memory (ensure_capacity)");
+
+  for (int i = memory->capacity; i < capacity; i++) {
+    memory->identifiers[i] = NULL;
+    memory->values[i].value_type = RAM_TYPE_NONE;
+  }
+
+  memory->capacity = (int)capacity;
+
+  return grow;
+}
+
+
+//
+// Public functions:
+//
+
+//
+// ram_init
+//
+// Returns a pointer to a dynamically-allocated memory
+// for storing nuPython variables and their values. All
+// memory cells are initialized to the value None.
+//
+struct RAM* ram_init(void)
+{
+  struct RAM* memory = (struct RAM*)malloc(sizeof(struct RAM));
+  if (memory == NULL)
+    panic("out of memory (ram_init)");
+
+  memory->num_values = 0;
+  memory->capacity = 4;
+
+  memory->values = (struct RAM_VALUE*)malloc(sizeof(struct RAM_VALUE) * memory->capacity);
+  memory->identifiers = (char**)malloc(sizeof(char*) * memory->capacity);
+  if (memory->values == NULL || memory->identifiers == NULL)
+    panic("out of memory (ram_init)");
+
+  for (int i = 0; i < memory->capacity; i++) {
+    memory->identifiers[i] = NULL;
+    memory->values[i].value_type = RAM_TYPE_NONE;
+  }
+
+  memory->num_identifiers = 0;
+  memory->index_capacity = 8;
+  memory->index = (int*)malloc(sizeof(int) * memory->index_capacity);
+  if (memory->index == NULL)
+    panic("out of memory (ram_init)");
+
+  for (int i = 0; i < memory->index_capacity; i++)
+    memory->index[i] = -1;
+
+  memory->num_strings = 0;
+  memory->strings_capacity = 8;
+  memory->strings = (char**)malloc(sizeof(char*) * memory->strings_capacity);
+  if (memory->strings == NULL)
+    panic("out of memory (ram_init)");
+
+  for (int i = 0; i < memory->strings_capacity; i++)
+    memory->strings[i] = NULL;
+
+  memory->bytes_in_use = sizeof(struct RAM) + CELL_BYTES * memory->capacity;
+  memory->bytes_peak = memory->bytes_in_use;
+  memory->bytes_limit = 0;
+
+  return memory;
+}
+
+//
+// ram_destroy
+//
+// Frees the dynamically-allocated memory associated with
+// the given memory. After the call returns, you cannot
+// use the memory.
+//
+void ram_destroy(struct RAM* memory)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_destroy)");
+
+  for (int i = 0; i < memory->num_values; i++) {
+    free(memory->identifiers[i]);
+
+    drop_value(memory, &memory->values[i]);
+  }
+
+  //
+  // the interned strings go last, since dicts refer to them; what
+  // is left is the keys of dicts never freed (e.g. a dict that
+  // contains itself):
+  //
+  for (int i = 0; i < memory->strings_capacity; i++) {
+    if (memory->strings[i] != NULL)
+      free(INTERNED_OF(memory->strings[i]));
+  }
+
+  free(memory->strings);
+  free(memory->values);
+  free(memory->identifiers);
+  free(memory->index);
+  free(memory);
+}
+
+//
+// ram_get_addr
+//
+// If the given identifier (e.g. "x") has been written to
+// memory, returns the address of this value --- an integer
+// in the range 0..N-1 where N is the number of values currently
+// stored in memory. Returns -1 if no such identifier exists
+// in memory.
+//
+int ram_get_addr(struct RAM* memory, char* identifier)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_get_addr)");
+
+  return find_identifier(memory, identifier);
+}
+
+//
+// ram_read_cell_by_addr
+//
+// Given a memory address (an integer in the range 0..N-1),
+// returns a COPY of the value contained in that memory cell.
+// Returns NULL if the address is not valid.
+//
+struct RAM_VALUE* ram_read_cell_by_addr(struct RAM* memory, int address)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_read_cell_by_addr)");
+
+  if (address < 0 || address >= memory->num_values)
+    return NULL;
+
+  struct RAM_VALUE* value = (struct RAM_VALUE*)malloc(sizeof(struct RAM_VALUE));
+  if (value == NULL)
+    panic("out of memory (ram_read_cell_by_id)");
+
+  *value = memory->values[address];
+
+  if (value->value_type == RAM_TYPE_STR)
+    value->types.s = dupString(value->types.s);
+
+  return value;
+}
+
+//
+// ram_read_cell_by_id
+//
+// If the given identifier (e.g. "x") has been written to
+// memory, returns a COPY of the value contained in memory.
+// Returns NULL if no such identifier exists in memory.
+//
+struct RAM_VALUE* ram_read_cell_by_id(struct RAM* memory, char* identifier)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_read_cell_by_id)");
+  if (identifier == NULL)
+    panic("identifier ptr is null (ram_read_cell_by_id)");
+
+  int address = find_identifier(memory, identifier);
+
+  return ram_read_cell_by_addr(memory, address);
+}
+
+//
+// ram_peek_cell_by_addr
+//
+// Given a memory address (an integer in the range 0..N-1),
+// returns a pointer to the value in that memory cell, without
+// copying. Returns NULL if the address is not valid.
+//
+const struct RAM_VALUE* ram_peek_cell_by_addr(struct RAM* memory, int address)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_peek_cell_by_addr)");
+
+  if (address < 0 || address >= memory->num_values)
+    return NULL;
+
+  return &memory->values[address];
+}
+
+//
+// ram_peek_cell_by_id
+//
+// If the given identifier (e.g. "x") has been written to
+// memory, returns a pointer to its value, without copying.
+// Returns NULL if no such identifier exists in memory.
+//
+const struct RAM_VALUE* ram_peek_cell_by_id(struct RAM* memory, char* identifier)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_peek_cell_by_id)");
+  if (identifier == NULL)
+    panic("identifier ptr is null (ram_peek_cell_by_id)");
+
+  int address = find_identifier(memory, identifier);
+
+  return ram_peek_cell_by_addr(memory, address);
+}
+
+//
+// ram_free_value
+//
+// Frees the memory value returned by ram_read_cell_by_id and
+// ram_read_cell_by_addr.
+//
+void ram_free_value(struct RAM_VALUE* value)
+{
+  if (value == NULL)
+    return;
+
+  if (value->value_type == RAM_TYPE_STR)
+    free(value->types.s);
+
+  free(value);
+}
+
+//
+// ram_write_cell_by_addr
+//
+// Writes the given value to the memory cell at the given
+// address. If a value already exists at this address, that
+// value is overwritten by this new value. Returns true if
+// the value was successfully written, false if not (the
+// memory address is invalid, or the write would exceed the
+// memory limit).
+//
+bool ram_write_cell_by_addr(struct RAM* memory, struct RAM_VALUE value, int address)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_write_cell_by_addr)");
+
+  if (address < 0 || address >= memory->num_values)
+    return false;
+
+  struct RAM_VALUE* cell_value = &memory->values[address];
+  long long delta = value_bytes(&value) - value_bytes(cell_value);
+
+  if (!within_limit(memory, delta))
+    return false;
+
+  account_bytes(memory, delta);
+
+  //
+  // acquire the new value before dropping the old one, in case
+  // they are one and the same (or the old is a list holding the
+  // new):
+  //
+  struct RAM_VALUE old_value = *cell_value;
+
+  *cell_value = value;
+  acquire_value(cell_value);
+
+  drop_value(memory, &old_value);
+
+  return true;
+}
+
+//
+// ram_write_cell_by_id
+//
+// Writes the given value to a memory cell named by the given
+// identifier. If a memory cell already exists with this name,
+// the existing value is overwritten by this new value. Returns
+// true if successful, false if the write would exceed the
+// memory limit.
+//
+bool ram_write_cell_by_id(struct RAM* memory, struct RAM_VALUE value, char* identifier)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_write_cell_by_id)");
+  if (identifier == NULL)
+    panic("identifier ptr is null (ram_write_cell_by_id)");
+
+  int address = find_identifier(memory, identifier);
+
+  if (address < 0) {
+    //
+    // new variable, make sure we have room (and that the
+    // new variable fits within the limit):
+    //
+    long long grow = ensure_capacity(memory, 1, true);
+    long long name = (long long)strlen(identifier) + 1;
+
+    if (!within_limit(memory, grow + name + value_bytes(&value)))
+      return false;
+
+    //
+    // the value itself is accounted for by ram_write_cell_by_addr:
+    //
+    account_bytes(memory, grow + name);
+    ensure_capacity(memory, 1, false);
+
+    address = memory->num_values;
+    memory->num_values++;
+
+    memory->identifiers[address] = dupString(identifier);
+    add_identifier(memory, address);
+  }
+
+  return ram_write_cell_by_addr(memory, value, address);
+}
+
+//
+// ram_alloc_cells
+//
+// Allocates n consecutive heap cells, each initialized to None,
+// and returns the address of the first one. Returns
+// RAM_ALLOC_INVALID if n is not positive or too many, and
+// RAM_ALLOC_LIMIT if the cells would exceed the memory limit.
+//
+int ram_alloc_cells(struct RAM* memory, int n)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_alloc_cells)");
+
+  if (n <= 0 || n > INT_MAX - memory->num_values)
+    return RAM_ALLOC_INVALID;
+
+  long long grow = ensure_capacity(memory, n, true);
+
+  if (!within_limit(memory, grow))
+    return RAM_ALLOC_LIMIT;
+
+  account_bytes(memory, grow);
+  ensure_capacity(memory, n, false);
+
+  int address = memory->num_values;
+  memory->num_values += n;
+
+  return address;
+}
+
+//
+// ram_list_create
+//
+// Returns a new, empty list with room for the given # of items,
+// or NULL if it would exceed the memory limit. The caller holds
+// the one reference to the list.
+//
+struct RAM_LIST* ram_list_create(struct RAM* memory, int capacity)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_list_create)");
+
+  if (capacity < 0)
+    capacity = 0;
+
+  if (!within_limit(memory, LIST_BYTES(capacity)))
+    return NULL;
+
+  struct RAM_LIST* list = (struct RAM_LIST*)malloc(sizeof(struct RAM_LIST));
+  if (list == NULL)
+    panic("out of memory (ram_list_create)");
+
+  list->items = NULL;
+  if (capacity > 0) {
+    list->items = (struct RAM_VALUE*)malloc(sizeof(struct RAM_VALUE) * capacity);
+    if (list->items == NULL)
+      panic("out of memory (ram_list_create)");
+  }
+
+  list->length = 0;
+  list->capacity = capacity;
+  list->refs = 1;
+
+  account_bytes(memory, LIST_BYTES(capacity));
+
+  return list;
+}
+
+//
+// ram_list_append
+//
+// Appends the given value to the end of the list, doubling the
+// list's capacity as needed. Returns true if successful, false
+// if the list would exceed the memory limit.
+//
+bool ram_list_append(struct RAM* memory, struct RAM_LIST* list, struct RAM_VALUE value)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_list_append)");
+  if (list == NULL)
+    panic("list ptr is null (ram_list_append)");
+
+  long long bytes = value_bytes(&value);
+
+  if (list->length == list->capacity) {
+    if (list->capacity > INT_MAX / 2)
+      return false;
+
+    int capacity = (list->capacity == 0) ? 4 : 2 * list->capacity;
+    long long grow = LIST_BYTES(capacity) - LIST_BYTES(list->capacity);
+
+    if (!within_limit(memory, grow + bytes))
+      return false;
+
+    list->items = (struct RAM_VALUE*)realloc(list->items, sizeof(struct RAM_VALUE) * capacity);
+    if (list->items == NULL)
+      panic("out of memory (ram_list_append)");
+
+    list->capacity = capacity;
+
+    account_bytes(memory, grow);
+  }
+  else if (!within_limit(memory, bytes))
+    return false;
+
+  account_bytes(memory, bytes);
+
+  list->items[list->length] = value;
+  acquire_value(&list->items[list->length]);
+
+  list->length++;
+
+  return true;
+}
+
+//
+// ram_list_write
+//
+// Overwrites the item at the given index with the given value.
+// Returns true if successful, false if the index is not valid
+// or the write would exceed the memory limit.
+//
+bool ram_list_write(struct RAM* memory, struct RAM_LIST* list, int index, struct RAM_VALUE value)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_list_write)");
+  if (list == NULL)
+    panic("list ptr is null (ram_list_write)");
+
+  if (index < 0 || index >= list->length)
+    return false;
+
+  struct RAM_VALUE* item = &list->items[index];
+  long long delta = value_bytes(&value) - value_bytes(item);
+
+  if (!within_limit(memory, delta))
+    return false;
+
+  account_bytes(memory, delta);
+
+  struct RAM_VALUE old_value = *item;
+
+  *item = value;
+  acquire_value(item);
+
+  drop_value(memory, &old_value);
+
+  return true;
+}
+
+//
+// ram_list_peek
+//
+// Returns a pointer to the item at the given index, without
+// copying, or NULL if the index is not valid.
+//
+const struct RAM_VALUE* ram_list_peek(struct RAM_LIST* list, int index)
+{
+  if (list == NULL)
+    panic("list ptr is null (ram_list_peek)");
+
+  if (index < 0 || index >= list->length)
+    return NULL;
+
+  return &list->items[index];
+}
+
+//
+// ram_list_retain
+//
+// Adds a reference to the given list.
+//
+void ram_list_retain(struct RAM_LIST* list)
+{
+  if (list == NULL)
+    panic("list ptr is null (ram_list_retain)");
+
+  list->refs++;
+}
+
+//
+// ram_list_release
+//
+// Drops a reference to the given list, freeing the list and its
+// items when the last reference is dropped.
+//
+void ram_list_release(struct RAM* memory, struct RAM_LIST* list)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_list_release)");
+  if (list == NULL)
+    panic("list ptr is null (ram_list_release)");
+
+  list->refs--;
+
+  if (list->refs > 0)
+    return;
+
+  for (int i = 0; i < list->length; i++) {
+    account_bytes(memory, -value_bytes(&list->items[i]));
+    drop_value(memory, &list->items[i]);
+  }
+
+  account_bytes(memory, -LIST_BYTES(list->capacity));
+
+  free(list->items);
+  free(list);
+}
+
+//
+// ram_dict_create
+//
+// Returns a new, empty dict with room for the given # of
+// entries, or NULL if it would exceed the memory limit. The 
+// caller holds the one reference to the dict.
+//
+struct RAM_DICT* ram_dict_create(struct RAM* memory, int capacity)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_dict_create)");
+
+  if (capacity < 0)
+    capacity = 0;
+
+  int index_capacity = index_capacity_for(capacity);
+
+  if (!within_limit(memory, DICT_BYTES(capacity, index_capacity)))
+    return NULL;
+
+  struct RAM_DICT* dict = (struct RAM_DICT*)malloc(sizeof(struct RAM_DICT));
+  if (dict == NULL)
+    panic("out of memory (ram_dict_create)");
+
+  dict->entries = NULL;
+  if (capacity > 0) {
+    dict->entries = (struct RAM_DICT_ENTRY*)malloc(sizeof(struct RAM_DICT_ENTRY) * capacity);
+    if (dict->entries == NULL)
+      panic("out of memory (ram_dict_create)");
+  }
+
+  dict->index = (int*)malloc(sizeof(int) * index_capacity);
+  if (dict->index == NULL)
+    panic("out of memory (ram_dict_create)");
+
+  for (int i = 0; i < index_capacity; i++)
+    dict->index[i] = -1;
+
+  dict->length = 0;
+  dict->capacity = capacity;
+  dict->index_capacity = index_capacity;
+  dict->refs = 1;
+
+  account_bytes(memory, DICT_BYTES(capacity, index_capacity));
+
+  return dict;
+}
+
+//
+// ram_dict_put
+//
+// Maps the given key to the given value, adding an entry or 
+// overwriting an existing one. Returns true if successful, false
+// if the dict would exceed the memory limit.
+//
+bool ram_dict_put(struct RAM* memory, struct RAM_DICT* dict, struct RAM_VALUE key, struct RAM_VALUE value)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_dict_put)");
+  if (dict == NULL)
+    panic("dict ptr is null (ram_dict_put)");
+  if (key.value_type != RAM_TYPE_INT && key.value_type != RAM_TYPE_STR)
+    panic("invalid key type (ram_dict_put)");
+
+  unsigned int hash = hash_key(&key);
+  long long bytes = value_bytes(&value);
+
+  //
+  // a string that isn't interned yet can't be a key already:
+  //
+  bool interned = true;
+  bool is_new = true;
+  int slot = -1;
+
+  if (key.value_type == RAM_TYPE_STR) {
+    int s = find_string(memory, key.types.s, hash);
+
+    if (memory->strings[s] != NULL)
+      key.types.s = memory->strings[s];
+    else {
+      interned = false;
+      bytes += (long long)strlen(key.types.s) + 1;
+    }
+  }
+
+  if (interned) {
+    slot = find_entry(dict, &key, hash);
+    is_new = (dict->index[slot] < 0);
+  }
+
+  if (!is_new) {
+    //
+    // overwrite the value, as in ram_list_write:
+    //
+    struct RAM_VALUE* entry_value = &dict->entries[dict->index[slot]].value;
+    long long delta = value_bytes(&value) - value_bytes(entry_value);
+
+    if (!within_limit(memory, delta))
+      return false;
+
+    account_bytes(memory, delta);
+
+    struct RAM_VALUE old_value = *entry_value;
+
+    *entry_value = value;
+    acquire_value(entry_value);
+
+    drop_value(memory, &old_value);
+
+    return true;
+  }
+
+  //
+  // new entry, make sure there's room:
+  //
+  int capacity = dict->capacity;
+  int index_capacity = dict->index_capacity;
+
+  if (dict->length == dict->capacity) {
+    if (dict->capacity > INT_MAX / 4)
+      return false;
+
+    capacity = (dict->capacity == 0) ? 4 : 2 * dict->capacity;
+  }
+
+  if (2 * (dict->length + 1) > dict->index_capacity)
+    index_capacity = 2 * dict->index_capacity;
+
+  long long grow = DICT_BYTES(capacity, index_capacity) - DICT_BYTES(dict->capacity, dict->index_capacity);
+
+  if (!within_limit(memory, grow + bytes))
+    return false;
+
+  account_bytes(memory, grow + value_bytes(&value));
+
+  if (key.value_type == RAM_TYPE_STR)
+    key.types.s = intern_string(memory, key.types.s);  // accounts for the key, references it
+
+  if (capacity != dict->capacity) {
+    dict->entries = (struct RAM_DICT_ENTRY*)realloc(dict->entries, sizeof(struct RAM_DICT_ENTRY) * capacity);
+    if (dict->entries == NULL)
+      panic("out of memory (ram_dict_put)");
+
+    dict->capacity = capacity;
+  }
+
+  if (index_capacity != dict->index_capacity) {
+    free(dict->index);
+
+    dict->index_capacity = index_capacity;
+    dict->index = (int*)malloc(sizeof(int) * index_capacity);
+    if (dict->index == NULL)
+      panic("out of memory (ram_dict_put)");
+
+    for (int i = 0; i < index_capacity; i++)
+      dict->index[i] = -1;
+
+    for (int i = 0; i < dict->length; i++)
+      dict->index[find_entry(dict, &dict->entries[i].key, dict->entries[i].hash)] = i;
+  }
+
+  struct RAM_DICT_ENTRY* entry = &dict->entries[dict->length];
+
+  entry->key = key;
+  entry->value = value;
+  entry->hash = hash;
+  acquire_value(&entry->value);
+
+  dict->index[find_entry(dict, &key, hash)] = dict->length;
+  dict->length++;
+
+  return true;
+}
+
+//
+// ram_dict_get
+//
+// Returns a pointer to the value the given key maps to, without
+// copying, or NULL if the key is not in the dict.
+//
+const struct RAM_VALUE* ram_dict_get(struct RAM* memory, struct RAM_DICT* dict, struct RAM_VALUE key)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_dict_get)");
+  if (dict == NULL)
+    panic("dict ptr is null (ram_dict_get)");
+
+  if (key.value_type != RAM_TYPE_INT && key.value_type != RAM_TYPE_STR)
+    return NULL;
+
+  unsigned int hash = hash_key(&key);
+
+  if (key.value_type == RAM_TYPE_STR) {
+    key.types.s = memory->strings[find_string(memory, key.types.s, hash)];
+
+    if (key.types.s == NULL)  // not interned => not a key
+      return NULL;
+  }
+
+  int entry = dict->index[find_entry(dict, &key, hash)];
+
+  if (entry < 0)
+    return NULL;
+
+  return &dict->entries[entry].value;
+}
+
+//
+// ram_dict_retain
+//
+// Adds a reference to the given dict.
+//
+void ram_dict_retain(struct RAM_DICT* dict)
+{
+  if (dict == NULL)
+    panic("dict ptr is null (ram_dict_retain)");
+
+  dict->refs++;
+}
+
+//
+// ram_dict_release
+//
+// Drops a reference to the given dict, freeing the dict and its
+// values when the last reference is dropped, and letting go of
+// its string keys.
+//
+void ram_dict_release(struct RAM* memory, struct RAM_DICT* dict)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_dict_release)");
+  if (dict == NULL)
+    panic("dict ptr is null (ram_dict_release)");
+
+  dict->refs--;
+
+  if (dict->refs > 0)
+    return;
+
+  for (int i = 0; i < dict->length; i++) {
+    account_bytes(memory, -value_bytes(&dict->entries[i].value));
+    drop_value(memory, &dict->entries[i].value);
+
+    if (dict->entries[i].key.value_type == RAM_TYPE_STR)
+      release_string(memory, dict->entries[i].key.types.s);
+  }
+
+  account_bytes(memory, -DICT_BYTES(dict->capacity, dict->index_capacity));
+
+  free(dict->entries);
+  free(dict->index);
+  free(dict);
+}
+
+//
+// ram_set_limit
+//
+// Sets the maximum # of bytes the memory may use; 0 means
+// no limit.
+//
+void ram_set_limit(struct RAM* memory, long long max_bytes)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_set_limit)");
+
+  memory->bytes_limit = (max_bytes > 0) ? max_bytes : 0;
+}
+
+//
+// ram_print
+//
+// Prints the contents of RAM to the console, for debugging.
+//
+void ram_print(struct RAM* memory)
+{
+  if (memory == NULL)
+    panic("memory ptr is null (ram_print)");
+
+  printf("**MEMORY PRINT**\n");
+
+  printf("Capacity: %d\n", memory->capacity);
+  printf("Num values: %d\n", memory->num_values);
+  printf("Contents:\n");
+
+  for (int i = 0; i < memory->num_values; i++) {
+    struct RAM_VALUE* value = &memory->values[i];
+
+    if (memory->identifiers[i] != NULL)
+      printf(" %d: %s, ", i, memory->identifiers[i]);
+    else
+      printf(" %d: <heap>, ", i);
+
+    switch (value->value_type)
+    {
+      case RAM_TYPE_INT:
+        printf("int, %d", value->types.i);
+        break;
+
+      case RAM_TYPE_REAL:
+        printf("real, %lf", value->types.d);
+        break;
+
+      case RAM_TYPE_STR:
+        printf("str, '%s'", value->types.s);
+        break;
+
+      case RAM_TYPE_PTR:
+        printf("ptr, %d", value->types.i);
+        break;
+
+      case RAM_TYPE_BOOLEAN:
+        if (value->types.i == 0)
+          printf("boolean, False");
+        else
+          printf("boolean, True");
+        break;
+
+      case RAM_TYPE_NONE:
+        printf("none, None");
+        break;
+
+      case RAM_TYPE_LIST:
+        printf("list, ");
+        print_value(value, 0);
+        break;
+
+      case RAM_TYPE_DICT:
+        printf("dict, ");
+        print_value(value, 0);
+        break;
+
+      default:
+        panic("unknown ram value type?! (ram_print)");
+    }
+
+    printf("\n");
+  }
+
+  printf("**END PRINT**\n");
+}
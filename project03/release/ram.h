@@ -23,7 +23,9 @@ enum RAM_VALUE_TYPES
   RAM_TYPE_STR,
   RAM_TYPE_PTR,
   RAM_TYPE_BOOLEAN,
-  RAM_TYPE_NONE
+  RAM_TYPE_NONE,
+  RAM_TYPE_LIST,
+  RAM_TYPE_DICT
 };
 
 struct RAM_VALUE
@@ -41,20 +43,101 @@ struct RAM_VALUE
     int    i; // INT, PTR, BOOLEAN
     double d; // REAL
     char*  s; // STR 
+    struct RAM_LIST* l; // LIST
+    struct RAM_DICT* m; // DICT
   } types;
 };
 
-struct RAM_CELL
+//
+// A list is a growable, contiguous array of values, so indexing
+// is O(1) and appending is amortized O(1) (the capacity doubles
+// as needed). The items are stored unboxed, as values and not
+// pointers to values, and own their strings just like memory
+// cells do.
+//
+// Lists are shared, not copied: xs = ys makes both variables
+// refer to the same list. A list is freed when the last cell
+// (or list item) referring to it lets go. NOTE: this means a
+// list that contains itself is never freed.
+//
+struct RAM_LIST
 {
-  char* identifier;  // variable name for this memory cell
+  struct RAM_VALUE* items;  // array of items
+  int length;    // # of items in the list
+  int capacity;  // # of items there is room for
+  int refs;      // # of references to the list
+};
+
+//
+// A dict maps keys --- ints or strings --- to values. It is a
+// flat hash table in two parts: the entries, stored densely in
+// insertion order (which is the order a for loop visits the
+// keys), and an open-addressing index of entry #s, probed
+// linearly and kept at most half full. Each entry caches the
+// hash of its key, so growing the index never rehashes keys.
+//
+// String keys are interned: each distinct key string is stored
+// once in memory, no matter how many dicts use it, and keys are
+// compared by pointer. An interned string counts the entries that
+// use it, and is freed when the last of them is.
+//
+// Like lists, dicts are shared and reference counted.
+//
+struct RAM_DICT_ENTRY
+{
+  struct RAM_VALUE key;    // INT, or STR (interned)
   struct RAM_VALUE value;
+  unsigned int     hash;   // hash of the key
 };
 
+struct RAM_DICT
+{
+  struct RAM_DICT_ENTRY* entries;  // array of entries, in insertion order
+  int length;          // # of entries in the dict
+  int capacity;        // # of entries there is room for
+  int* index;          // entry #s, -1 => empty slot
+  int index_capacity;  // always a power of 2
+  int refs;            // # of references to the dict
+};
+
+//
+// Memory is laid out as a structure of arrays: the values are
+// stored densely, 16 bytes apiece (4 per cache line), and the
+// identifiers are kept in a separate array that is only needed
+// to look up addresses. The value of the variable at address
+// i is values[i], and its name is identifiers[i].
+//
+_Static_assert(sizeof(struct RAM_VALUE) == 16, "RAM values should be 16 bytes");
+
 struct RAM
 {
-  struct RAM_CELL* cells;  // array of memory cells
+  struct RAM_VALUE* values;  // array of values (hot)
+  char** identifiers;        // array of variable names (cold), NULL => heap cell
   int num_values;  // # of values currently stored in memory
   int capacity;    // total # of cells available in memory
+
+  //
+  // hash table mapping identifiers to addresses, so looking up a
+  // variable doesn't depend on how many cells are in use:
+  //
+  int* index;          // addresses, -1 => empty slot
+  int index_capacity;  // always a power of 2
+  int num_identifiers; // # of variables (cells with an identifier)
+
+  //
+  // interned strings, for dict keys (an open-addressing hash set):
+  //
+  char** strings;        // NULL => empty slot
+  int strings_capacity;  // always a power of 2
+  int num_strings;
+
+  //
+  // memory accounting, in bytes: the RAM itself and its cells,
+  // plus the identifiers and string values they own:
+  //
+  long long bytes_in_use;  // # of bytes currently in use
+  long long bytes_peak;    // high-water mark of bytes_in_use
+  long long bytes_limit;   // max # of bytes allowed, 0 => no limit
 };
 
 
@@ -105,6 +188,8 @@ int ram_get_addr(struct RAM* memory, char* identifier);
 // NOTE: this function allocates memory for the value that
 // is returned. The caller takes ownership of the copy and 
 // must eventually free this memory via ram_free_value().
+// A list or dict is not copied, the copy refers to the one in
+// memory.
 //
 // NOTE: a variable has to be written to memory before its
 // address becomes valid. Once a variable is written to memory,
@@ -125,6 +210,32 @@ struct RAM_VALUE* ram_read_cell_by_addr(struct RAM* memory, int address);
 //
 struct RAM_VALUE* ram_read_cell_by_id(struct RAM* memory, char* identifier);
 
+//
+// ram_peek_cell_by_addr
+//
+// Given a memory address (an integer in the range 0..N-1),
+// returns a pointer to the value contained in that memory cell
+// --- NOT a copy, nothing is allocated and nothing needs to be 
+// freed. Returns NULL if the address is not valid.
+//
+// NOTE: the value is borrowed from memory and must not be
+// modified. It remains valid until the next write to that cell,
+// or until a new variable is written to memory (which may move
+// the values). Copy the value if it needs to live longer.
+//
+const struct RAM_VALUE* ram_peek_cell_by_addr(struct RAM* memory, int address);
+
+//
+// ram_peek_cell_by_id
+//
+// If the given identifier (e.g. "x") has been written to 
+// memory, returns a pointer to the value contained in memory
+// --- NOT a copy, see ram_peek_cell_by_addr for how long the 
+// pointer remains valid. Returns NULL if no such identifier
+// exists in memory.
+//
+const struct RAM_VALUE* ram_peek_cell_by_id(struct RAM* memory, char* identifier);
+
 //
 // ram_free_value
 //
@@ -140,10 +251,12 @@ void ram_free_value(struct RAM_VALUE* value);
 // address. If a value already exists at this address, that
 // value is overwritten by this new value. Returns true if 
 // the value was successfully written, false if not (which 
-// implies the memory address is invalid).
+// implies the memory address is invalid, or that writing
+// the value would exceed the memory limit).
 // 
 // NOTE: if the value being written is a string, it will
-// be duplicated and stored.
+// be duplicated and stored. If it is a list or dict, the cell
+// adds a reference to it.
 // 
 // NOTE: a variable has to be written to memory before its
 // address becomes valid. Once a variable is written to memory,
@@ -157,10 +270,12 @@ bool ram_write_cell_by_addr(struct RAM* memory, struct RAM_VALUE value, int addr
 // Writes the given value to a memory cell named by the given
 // identifier. If a memory cell already exists with this name,
 // the existing value is overwritten by this new value. Returns
-// true since this operation always succeeds.
+// true if successful, false if the write would exceed the
+// memory limit (see ram_set_limit).
 // 
 // NOTE: if the value being written is a string, it will
-// be duplicated and stored.
+// be duplicated and stored. If it is a list or dict, the cell
+// adds a reference to it.
 // 
 // NOTE: a variable has to be written to memory before its
 // address becomes valid. Once a variable is written to memory,
@@ -168,6 +283,128 @@ bool ram_write_cell_by_addr(struct RAM* memory, struct RAM_VALUE value, int addr
 //
 bool ram_write_cell_by_id(struct RAM* memory, struct RAM_VALUE value, char* identifier);
 
+//
+// ram_alloc_cells
+//
+// Allocates n consecutive cells on the heap, i.e. cells that
+// have no identifier and are reached only through pointers
+// (RAM_TYPE_PTR values holding their address). Each cell is
+// initialized to None. Returns the address of the first cell,
+// RAM_ALLOC_INVALID if n is not positive or there can't be that
+// many cells, or RAM_ALLOC_LIMIT if the cells would exceed the
+// memory limit. Heap cells are never freed, and like variables
+// their addresses never change.
+//
+#define RAM_ALLOC_INVALID -1
+#define RAM_ALLOC_LIMIT   -2
+
+int ram_alloc_cells(struct RAM* memory, int n);
+
+//
+// ram_list_create
+//
+// Returns a pointer to a new, empty list with room for the given
+// # of items, or NULL if the list would exceed the memory limit.
+// The caller holds the one reference to the list, and must
+// eventually let go of it via ram_list_release(); writing the
+// list to memory adds a reference of its own.
+//
+struct RAM_LIST* ram_list_create(struct RAM* memory, int capacity);
+
+//
+// ram_list_append
+//
+// Appends the given value to the end of the list, growing the
+// list as needed. Returns true if successful, false if the list
+// would exceed the memory limit (the list is left unchanged).
+//
+// NOTE: like writes to memory, a string value is duplicated and
+// a list or dict value gains a reference.
+//
+bool ram_list_append(struct RAM* memory, struct RAM_LIST* list, struct RAM_VALUE value);
+
+//
+// ram_list_write
+//
+// Overwrites the item at the given index (0..length-1) with the
+// given value. Returns true if successful, false if the index is
+// not valid or the write would exceed the memory limit.
+//
+bool ram_list_write(struct RAM* memory, struct RAM_LIST* list, int index, struct RAM_VALUE value);
+
+//
+// ram_list_peek
+//
+// Returns a pointer to the item at the given index (0..length-1)
+// --- NOT a copy --- or NULL if the index is not valid. The item
+// remains valid until it is overwritten, or until the list grows
+// (which may move the items).
+//
+const struct RAM_VALUE* ram_list_peek(struct RAM_LIST* list, int index);
+
+//
+// ram_list_retain / ram_list_release
+//
+// Adds or drops a reference to the given list; dropping the
+// last reference frees the list and its items.
+//
+void ram_list_retain(struct RAM_LIST* list);
+void ram_list_release(struct RAM* memory, struct RAM_LIST* list);
+
+//
+// ram_dict_create
+//
+// Returns a pointer to a new, empty dict with room for the given
+// # of entries, or NULL if the dict would exceed the memory limit.
+// As with ram_list_create, the caller holds the one reference to
+// the dict and must eventually let go via ram_dict_release().
+//
+struct RAM_DICT* ram_dict_create(struct RAM* memory, int capacity);
+
+//
+// ram_dict_put
+//
+// Maps the given key (an int or a string) to the given value, 
+// adding an entry or overwriting the value of an existing one.
+// Returns true if successful, false if the dict would exceed the
+// memory limit (the dict is left unchanged).
+//
+// NOTE: like writes to memory, a string value is duplicated and
+// a list or dict value gains a reference. The key is interned.
+//
+bool ram_dict_put(struct RAM* memory, struct RAM_DICT* dict, struct RAM_VALUE key, struct RAM_VALUE value);
+
+//
+// ram_dict_get
+//
+// Returns a pointer to the value the given key maps to --- NOT a
+// copy --- or NULL if the key is not in the dict (or is not an
+// int or a string). The value remains valid until it is 
+// overwritten, or until the dict grows.
+//
+const struct RAM_VALUE* ram_dict_get(struct RAM* memory, struct RAM_DICT* dict, struct RAM_VALUE key);
+
+//
+// ram_dict_retain / ram_dict_release
+//
+// Adds or drops a reference to the given dict; dropping the
+// last reference frees the dict and its values.
+//
+void ram_dict_retain(struct RAM_DICT* dict);
+void ram_dict_release(struct RAM* memory, struct RAM_DICT* dict);
+
+//
+// ram_set_limit
+//
+// Sets the maximum # of bytes the given memory may use, counting
+// its cells, identifiers, string values, lists and dicts; pass 0
+// for no limit (the default). Writes that would exceed the limit
+// fail and leave memory unchanged. The current usage and its
+// high-water mark are available in memory->bytes_in_use and
+// bytes_peak.
+//
+void ram_set_limit(struct RAM* memory, long long max_bytes);
+
 //
 // ram_print
 //
@@ -0,0 +1,308 @@
+/*repl.c*/
+
+//
+// Interactive nuPython sessions (see repl.h).
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#define _POSIX_C_SOURCE 200809L  // fmemopen
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>   // memcpy, strcmp
+
+#include "parser.h"
+#include "programgraph.h"
+#include "ram.h"
+#include "execute.h"
+#include "output.h"
+#include "input.h"
+#include "infer.h"
+#include "optimize.h"
+#include "repl.h"
+
+
+//
+// The session: the text of the entry being read, and what the
+// entries so far have left behind --- the functions they defined,
+// and the program graphs those live in, freed when the session
+// ends. Entries that define no functions are freed once they run.
+//
+struct REPL
+{
+  char* text;  // the entry being read
+  size_t length;
+  size_t capacity;
+
+  struct STMT_FUNCTION_DEF** functions;  // defined so far, by name
+  int num_functions;
+  int functions_capacity;
+
+  struct STMT** entries;  // program graphs with functions in them
+  int num_entries;
+  int entries_capacity;
+};
+
+
+//
+// Private functions:
+//
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**REPL ERROR: %s\n", msg);
+  exit(-1);
+}
+
+//
+// prompt
+//
+// Outputs the given prompt, unless input is batched.
+//
+static void prompt(char* s)
+{
+  if (input_prompts()) {
+    output_string(s);
+    output_flush();
+  }
+}
+
+//
+// append_line
+//
+// Adds the given line, and a newline, to the entry's text.
+//
+static void append_line(struct REPL* repl, char* line, size_t length)
+{
+  if (repl->length + length + 2 > repl->capacity) {
+    size_t capacity = 2 * (repl->length + length + 2);
+    char* grown = (char*)realloc(repl->text, capacity);
+
+    if (grown == NULL)
+      panic("out of memory (append_line)");
+
+    repl->text = grown;
+    repl->capacity = capacity;
+  }
+
+  memcpy(repl->text + repl->length, line, length);
+  repl->length += length;
+  repl->text[repl->length++] = '\n';
+  repl->text[repl->length] = '\0';
+}
+
+//
+// scan_line
+//
+// Updates the # of { not closed yet, given the next line of an
+// entry, and returns true if the line ends with a : --- the header
+// of a while, for or def, whose body follows. Braces and colons in
+// strings and comments don't count.
+//
+static bool scan_line(char* line, int* depth)
+{
+  char quote = '\0';  // inside a string?
+  char last = '\0';   // last char that counts
+
+  for (char* p = line; *p != '\0'; p++) {
+    char c = *p;
+
+    if (quote != '\0') {
+      if (c == quote)
+        quote = '\0';
+      continue;
+    }
+
+    if (c == '#')
+      break;
+
+    if (c == '\'' || c == '"')
+      quote = c;
+    else if (c == '{')
+      (*depth)++;
+    else if (c == '}')
+      (*depth)--;
+
+    if (c != ' ' && c != '\t')
+      last = c;
+  }
+
+  return last == ':';
+}
+
+//
+// read_entry
+//
+// Reads the lines of the next entry into the session's text,
+// prompting for each. Returns false at the end of the session.
+//
+static bool read_entry(struct REPL* repl)
+{
+  int depth = 0;
+  bool header = false;  // waiting for a body?
+
+  repl->length = 0;
+
+  for (;;) {
+    prompt(repl->length == 0 ? ">>> " : "... ");
+
+    size_t length;
+    char* line = input_line(&length);
+
+    if (line == NULL)  // end of input, run what we have
+      return repl->length > 0;
+
+    if (repl->length == 0) {
+      if (strcmp(line, "$") == 0)
+        return false;
+
+      if (line[strspn(line, " \t")] == '\0')  // nothing yet
+        continue;
+    }
+
+    append_line(repl, line, length);
+
+    bool colon = scan_line(line, &depth);
+
+    if (line[strspn(line, " \t")] != '\0')
+      header = colon;
+
+    if (depth <= 0 && !header)
+      return true;
+  }
+}
+
+//
+// remember_functions
+//
+// Adds the functions the given program defines to the ones the
+// session knows, replacing any with the same name. Returns true
+// if there were any.
+//
+static bool remember_functions(struct REPL* repl, struct STMT* program)
+{
+  bool any = false;
+
+  for (struct STMT* cur = program; cur != NULL; ) {
+    switch (cur->stmt_type)
+    {
+      case STMT_ASSIGNMENT:    cur = cur->types.assignment->next_stmt; continue;
+      case STMT_FUNCTION_CALL: cur = cur->types.function_call->next_stmt; continue;
+      case STMT_WHILE_LOOP:    cur = cur->types.while_loop->next_stmt; continue;
+      case STMT_FOR_LOOP:      cur = cur->types.for_loop->next_stmt; continue;
+      case STMT_RETURN:        cur = cur->types.return_stmt->next_stmt; continue;
+      case STMT_PASS:          cur = cur->types.pass->next_stmt; continue;
+      case STMT_FUNCTION_DEF:  break;
+      default:                 return any;  // if statements are not supported
+    }
+
+    struct STMT_FUNCTION_DEF* def = cur->types.function_def;
+    int i = 0;
+
+    while (i < repl->num_functions && strcmp(repl->functions[i]->function_name, def->function_name) != 0)
+      i++;
+
+    if (i == repl->num_functions) {
+      if (repl->num_functions == repl->functions_capacity) {
+        repl->functions_capacity = (repl->functions_capacity == 0) ? 8 : 2 * repl->functions_capacity;
+        repl->functions = (struct STMT_FUNCTION_DEF**)realloc(repl->functions, repl->functions_capacity * sizeof(struct STMT_FUNCTION_DEF*));
+        if (repl->functions == NULL)
+          panic("out of memory (remember_functions)");
+      }
+
+      repl->num_functions++;
+    }
+
+    repl->functions[i] = def;
+    any = true;
+
+    cur = def->next_stmt;
+  }
+
+  return any;
+}
+
+//
+// run_entry
+//
+// Parses, builds, checks and executes the entry that was read.
+// Errors have been output by the time this returns.
+//
+static void run_entry(struct REPL* repl, struct RAM* memory, void* native_data)
+{
+  FILE* input = fmemopen(repl->text, repl->length, "r");
+  if (input == NULL)
+    panic("unable to read entry (fmemopen)");
+
+  struct TokenQueue* tokens = parser_parse(input);
+  fclose(input);
+
+  if (tokens == NULL)  // syntax error, already output
+    return;
+
+  struct STMT* program = programgraph_build_more(tokens, repl->functions, repl->num_functions);
+  tokenqueue_destroy(tokens);
+
+  if (infer_types_in(program, memory) > 0) {
+    programgraph_destroy(program);
+    return;
+  }
+
+  program = optimize(program, NULL);
+  execute_prepare(program);
+
+  execute(program, memory, native_data);
+  output_flush();
+
+  if (!remember_functions(repl, program)) {
+    programgraph_destroy(program);
+    return;
+  }
+
+  if (repl->num_entries == repl->entries_capacity) {
+    repl->entries_capacity = (repl->entries_capacity == 0) ? 8 : 2 * repl->entries_capacity;
+    repl->entries = (struct STMT**)realloc(repl->entries, repl->entries_capacity * sizeof(struct STMT*));
+    if (repl->entries == NULL)
+      panic("out of memory (run_entry)");
+  }
+
+  repl->entries[repl->num_entries++] = program;
+}
+
+
+//
+// Public functions:
+//
+
+//
+// repl_run
+//
+// Runs an interactive session against the given memory.
+//
+void repl_run(struct RAM* memory, void* native_data)
+{
+  struct REPL repl = { NULL, 0, 0, NULL, 0, 0, NULL, 0, 0 };
+
+  parser_init();
+
+  while (read_entry(&repl))
+    run_entry(&repl, memory, native_data);
+
+  for (int i = 0; i < repl.num_entries; i++)
+    programgraph_destroy(repl.entries[i]);
+
+  free(repl.entries);
+  free(repl.functions);
+  free(repl.text);
+}
@@ -0,0 +1,37 @@
+/*repl.h*/
+
+//
+// Interactive nuPython sessions: a read-eval-print loop that reads
+// one entry at a time --- a statement, or a while, for or def with
+// its { body } --- and runs it right away against one memory that
+// lives as long as the session. Variables assigned and functions
+// defined by one entry are there for the next.
+//
+// Each entry is parsed, built, type-checked and optimized on its
+// own: it is built against the functions defined so far (see
+// programgraph_build_more) and checked against the variables in
+// memory (see infer_types_in), so nothing entered earlier is
+// processed again. A call is resolved to the function defined at
+// the time it is entered; redefining a function affects the calls
+// entered afterwards. An error ends the entry, not the session;
+// line #s in error messages count from the start of the entry.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include "ram.h"
+
+
+//
+// repl_run
+//
+// Runs an interactive session against the given memory, reading
+// entries from stdin (see input.h) until a line with just $ or the
+// end of the input. Prompts are output unless input is batched.
+// native_data is given to the native builtins (see execute_init).
+//
+void repl_run(struct RAM* memory, void* native_data);
@@ -517,6 +517,18 @@ struct Token scanner_nextToken(FILE* input, int* lineNumber, int* colNumber, cha
 
       return T;
     }
+    else if (c == ',') {
+      T.id = nuPy_COMMA;
+      T.line = *lineNumber;
+      T.col = *colNumber;
+
+      (*colNumber)++; // advance col # past char
+
+      value[0] = (char)c;
+      value[1] = '\0';
+
+      return T;
+    }
     else if (c == '=') {
       //
       // could be = or ==, let's assume = for now:
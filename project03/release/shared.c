@@ -0,0 +1,850 @@
+/*shared.c*/
+
+//
+// Shared RAM: lock-free named cells for nuPython programs running
+// on different threads (see shared.h).
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>    // true, false
+#include <stdint.h>     // uint64_t, uintptr_t
+#include <string.h>     // strcmp, memcpy
+#include <stdatomic.h>  // atomic_load, atomic_compare_exchange_weak, ...
+
+#include "ram.h"
+#include "execute.h"
+#include "output.h"
+#include "util.h"       // dupString, hashString
+#include "shared.h"
+
+
+//
+// NaN-boxing: a boxed value has the top 12 bits set (a negative
+// NaN), a tag from 1 to 7 in the next 4 --- so the quiet bit is
+// clear, and no arithmetic produces one --- and the value in the
+// low 48 bits. Anything else is a real.
+//
+#define BOX_BASE     0xFFF0000000000000ULL
+#define PAYLOAD_MASK 0x0000FFFFFFFFFFFFULL
+#define QUIET_NAN    0x7FF8000000000000ULL
+
+enum BOX_TAGS
+{
+  TAG_REAL = 0,  // not boxed
+  TAG_INT,
+  TAG_BOOLEAN,
+  TAG_NONE,
+  TAG_PTR,
+  TAG_STR
+};
+
+#define BOX(tag, payload) (BOX_BASE | ((uint64_t)(tag) << 48) | ((uint64_t)(payload) & PAYLOAD_MASK))
+
+#define NONE_BITS BOX(TAG_NONE, 0)
+
+#define CACHE_LINE 64
+
+//
+// A cell takes up a cache line of its own, so threads hammering
+// different cells don't slow each other down:
+//
+struct SHARED_CELL
+{
+  _Atomic(char*)   name;  // NULL => empty slot
+  _Atomic uint64_t bits;  // the value, boxed
+  char pad[CACHE_LINE - sizeof(char*) - sizeof(uint64_t)];
+};
+
+//
+// A thread's place in the shared RAM: whether it's active (in the
+// middle of an operation that reads a string) and, if so, in which
+// epoch; and what it has retired, in 3 bags by the epoch it was
+// retired in. Only the thread that claimed the place touches the
+// bags.
+//
+struct SHARED_THREAD
+{
+  _Atomic bool     used;    // claimed by a thread
+  _Atomic(void*)   owner;   // the thread that claimed it (see me)
+  _Atomic bool     active;
+  _Atomic unsigned epoch;
+
+  char**   retired[3];
+  int      num_retired[3];
+  int      capacity[3];
+  unsigned retired_epoch[3];
+
+  char pad[CACHE_LINE];  // keeps the flags of neighbors apart
+};
+
+#define RETIRE_BATCH 64  // strings retired before trying to move on
+
+struct SHARED_RAM
+{
+  struct SHARED_CELL* cells;
+  int num_cells;  // always a power of 2
+
+  _Atomic unsigned global_epoch;
+  struct SHARED_THREAD threads[SHARED_MAX_THREADS];
+};
+
+//
+// the calling thread's place, in the shared RAM it last used; a
+// thread may use several shared RAMs, and finds its place in the
+// others by its id, the address of its own my_id:
+//
+static _Thread_local struct SHARED_RAM* my_shared = NULL;
+static _Thread_local int my_slot = -1;
+static _Thread_local char my_id;
+
+//
+// Results of the operations behind the builtins:
+//
+enum SHARED_RESULTS
+{
+  SHARED_OK = 0,
+  SHARED_FULL,        // no room for another name (or out of memory)
+  SHARED_NOT_NUMBER   // shared_add() of something else
+};
+
+
+//
+// Private functions:
+//
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**SHARED ERROR: %s\n", msg);
+  exit(-1);
+}
+
+//
+// tag_of
+//
+// Returns the tag of the given bits, TAG_REAL if they're a real.
+//
+static int tag_of(uint64_t bits)
+{
+  if ((bits >> 52) != 0xFFF)
+    return TAG_REAL;
+
+  int tag = (int)((bits >> 48) & 0xF);
+
+  return (tag >= TAG_INT && tag <= TAG_STR) ? tag : TAG_REAL;
+}
+
+static char* string_of(uint64_t bits)
+{
+  return (char*)(uintptr_t)(bits & PAYLOAD_MASK);
+}
+
+static double real_of(uint64_t bits)
+{
+  double d;
+  memcpy(&d, &bits, sizeof(d));
+
+  return d;
+}
+
+static uint64_t box_real(double d)
+{
+  if (d != d)  // NaN
+    return QUIET_NAN;
+
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+
+  return bits;
+}
+
+//
+// box
+//
+// Boxes the given value, copying a string. Returns false if the
+// value can't be shared, or the copy can't be made.
+//
+static bool box(struct RAM_VALUE value, uint64_t* bits)
+{
+  switch (value.value_type)
+  {
+    case RAM_TYPE_INT:     *bits = BOX(TAG_INT, (uint32_t)value.types.i); return true;
+    case RAM_TYPE_BOOLEAN: *bits = BOX(TAG_BOOLEAN, value.types.i != 0); return true;
+    case RAM_TYPE_NONE:    *bits = NONE_BITS; return true;
+    case RAM_TYPE_PTR:     *bits = BOX(TAG_PTR, (uint32_t)value.types.i); return true;
+    case RAM_TYPE_REAL:    *bits = box_real(value.types.d); return true;
+
+    case RAM_TYPE_STR: {
+      char* s = dupString(value.types.s);
+
+      if ((uintptr_t)s > PAYLOAD_MASK) {  // doesn't fit in the box
+        free(s);
+        return false;
+      }
+
+      *bits = BOX(TAG_STR, (uintptr_t)s);
+      return true;
+    }
+
+    default:
+      return false;  // lists and dicts
+  }
+}
+
+//
+// unbox
+//
+// Returns the value in the given bits, copying a string --- which
+// the caller must keep from being freed meanwhile (see enter).
+//
+static struct RAM_VALUE unbox(uint64_t bits)
+{
+  struct RAM_VALUE value;
+
+  value.types.i = (int)(uint32_t)(bits & 0xFFFFFFFFu);
+
+  switch (tag_of(bits))
+  {
+    case TAG_INT:     value.value_type = RAM_TYPE_INT; break;
+    case TAG_BOOLEAN: value.value_type = RAM_TYPE_BOOLEAN; break;
+    case TAG_PTR:     value.value_type = RAM_TYPE_PTR; break;
+
+    case TAG_NONE:
+      value.value_type = RAM_TYPE_NONE;
+      value.types.i = 0;
+      break;
+
+    case TAG_STR:
+      value.value_type = RAM_TYPE_STR;
+      value.types.s = dupString(string_of(bits));
+      break;
+
+    default:
+      value.value_type = RAM_TYPE_REAL;
+      value.types.d = real_of(bits);
+      break;
+  }
+
+  return value;
+}
+
+//
+// find_cell
+//
+// Returns the cell with the given name, adding it if add is true
+// and it isn't there yet, NULL if not found (or there's no room).
+// A thread adding a name claims an empty slot by swapping its copy
+// of the name in; a thread that loses the race for the slot checks
+// whether the winner added the same name.
+//
+static struct SHARED_CELL* find_cell(struct SHARED_RAM* shared, char* name, bool add)
+{
+  unsigned int mask = shared->num_cells - 1;
+  unsigned int slot = hashString(name) & mask;
+  char* copy = NULL;
+
+  for (int probes = 0; probes < shared->num_cells; probes++) {
+    struct SHARED_CELL* cell = &shared->cells[slot];
+    char* existing = atomic_load_explicit(&cell->name, memory_order_acquire);
+
+    if (existing == NULL) {
+      if (!add)
+        return NULL;
+
+      if (copy == NULL)
+        copy = dupString(name);
+
+      if (atomic_compare_exchange_strong_explicit(&cell->name, &existing, copy, memory_order_acq_rel, memory_order_acquire))
+        return cell;
+
+      //
+      // lost the race, existing is the winner's name:
+      //
+    }
+
+    if (strcmp(existing, name) == 0) {
+      free(copy);
+      return cell;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  free(copy);
+  return NULL;  // full
+}
+
+//
+// find_mine
+//
+// Returns the slot of the calling thread's place in the shared RAM,
+// or -1 if it hasn't claimed one.
+//
+static int find_mine(struct SHARED_RAM* shared)
+{
+  //
+  // the cached place is only ours if we still own it: the shared
+  // RAM it was in may have been destroyed, and a new one created
+  // at the same address:
+  //
+  if (my_shared == shared && atomic_load(&shared->threads[my_slot].owner) == (void*)&my_id)
+    return my_slot;
+
+  for (int slot = 0; slot < SHARED_MAX_THREADS; slot++) {
+    if (atomic_load(&shared->threads[slot].owner) == (void*)&my_id)
+      return slot;
+  }
+
+  return -1;
+}
+
+//
+// me
+//
+// Returns the calling thread's place in the shared RAM, claiming
+// one the first time.
+//
+static struct SHARED_THREAD* me(struct SHARED_RAM* shared)
+{
+  int slot = find_mine(shared);
+
+  if (slot >= 0) {
+    my_shared = shared;
+    my_slot = slot;
+    return &shared->threads[slot];
+  }
+
+  for (slot = 0; slot < SHARED_MAX_THREADS; slot++) {
+    bool unused = false;
+
+    if (atomic_compare_exchange_strong(&shared->threads[slot].used, &unused, true)) {
+      atomic_store(&shared->threads[slot].owner, (void*)&my_id);
+      my_shared = shared;
+      my_slot = slot;
+      return &shared->threads[slot];
+    }
+  }
+
+  panic("too many threads using the shared RAM");
+  return NULL;
+}
+
+//
+// free_bag
+//
+// Frees the strings in one of the thread's bags of retired strings.
+//
+static void free_bag(struct SHARED_THREAD* thread, int bag)
+{
+  for (int i = 0; i < thread->num_retired[bag]; i++)
+    free(thread->retired[bag][i]);
+
+  thread->num_retired[bag] = 0;
+}
+
+//
+// reclaim
+//
+// Frees the thread's retired strings that are safe to free in the
+// given epoch: those retired two or more epochs before it.
+//
+static void reclaim(struct SHARED_THREAD* thread, unsigned epoch)
+{
+  for (int bag = 0; bag < 3; bag++) {
+    if (thread->num_retired[bag] > 0 && epoch - thread->retired_epoch[bag] >= 2)
+      free_bag(thread, bag);
+  }
+}
+
+//
+// try_advance
+//
+// Moves the global epoch on, if every active thread is in it.
+//
+static void try_advance(struct SHARED_RAM* shared)
+{
+  unsigned epoch = atomic_load(&shared->global_epoch);
+
+  for (int slot = 0; slot < SHARED_MAX_THREADS; slot++) {
+    struct SHARED_THREAD* thread = &shared->threads[slot];
+
+    if (atomic_load(&thread->active) && atomic_load(&thread->epoch) != epoch)
+      return;  // still in an older one
+  }
+
+  atomic_compare_exchange_strong(&shared->global_epoch, &epoch, epoch + 1);
+}
+
+//
+// enter / leave_epoch
+//
+// Bracket an operation that reads a string in a cell: a string
+// retired after enter is not freed until after leave_epoch.
+//
+static struct SHARED_THREAD* enter(struct SHARED_RAM* shared)
+{
+  struct SHARED_THREAD* thread = me(shared);
+  unsigned epoch = atomic_load(&shared->global_epoch);
+
+  atomic_store(&thread->epoch, epoch);
+  atomic_store(&thread->active, true);  // seq_cst: before any cell is read
+
+  reclaim(thread, epoch);
+
+  return thread;
+}
+
+static void leave_epoch(struct SHARED_THREAD* thread)
+{
+  atomic_store_explicit(&thread->active, false, memory_order_release);
+}
+
+//
+// retire
+//
+// Hands over a string that has been removed from its cell, to be
+// freed once no thread can be reading it.
+//
+static void retire(struct SHARED_RAM* shared, char* s)
+{
+  struct SHARED_THREAD* thread = me(shared);
+  unsigned epoch = atomic_load(&shared->global_epoch);
+  int bag = epoch % 3;
+
+  reclaim(thread, epoch);  // empties the bag if it's from 3 epochs ago
+
+  if (thread->num_retired[bag] == thread->capacity[bag]) {
+    int capacity = (thread->capacity[bag] == 0) ? RETIRE_BATCH : 2 * thread->capacity[bag];
+    char** grown = (char**)realloc(thread->retired[bag], capacity * sizeof(char*));
+
+    if (grown == NULL)
+      panic("out of memory (retire)");
+
+    thread->retired[bag] = grown;
+    thread->capacity[bag] = capacity;
+  }
+
+  thread->retired[bag][thread->num_retired[bag]++] = s;
+  thread->retired_epoch[bag] = epoch;
+
+  if (thread->num_retired[bag] % RETIRE_BATCH == 0)
+    try_advance(shared);
+}
+
+//
+// equals
+//
+// Does the value in the given bits equal the given value, as ==
+// compares them? A string in the bits must be kept from being
+// freed meanwhile.
+//
+static bool equals(uint64_t bits, struct RAM_VALUE value)
+{
+  int tag = tag_of(bits);
+
+  if ((tag == TAG_INT || tag == TAG_REAL) &&
+      (value.value_type == RAM_TYPE_INT || value.value_type == RAM_TYPE_REAL)) {
+    double x = (tag == TAG_INT) ? (double)(int)(uint32_t)bits : real_of(bits);
+    double y = (value.value_type == RAM_TYPE_INT) ? (double)value.types.i : value.types.d;
+
+    if (tag == TAG_INT && value.value_type == RAM_TYPE_INT)
+      return (int)(uint32_t)bits == value.types.i;
+
+    return x == y;
+  }
+
+  switch (value.value_type)
+  {
+    case RAM_TYPE_BOOLEAN: return tag == TAG_BOOLEAN && (int)(bits & 1) == (value.types.i != 0);
+    case RAM_TYPE_NONE:    return tag == TAG_NONE;
+    case RAM_TYPE_PTR:     return tag == TAG_PTR && (int)(uint32_t)bits == value.types.i;
+    case RAM_TYPE_STR:     return tag == TAG_STR && strcmp(string_of(bits), value.types.s) == 0;
+    default:               return false;
+  }
+}
+
+//
+// add_value
+//
+// Adds delta to the named cell, as shared_add does.
+//
+static int add_value(struct SHARED_RAM* shared, char* name, struct RAM_VALUE delta, struct RAM_VALUE* result)
+{
+  if (delta.value_type != RAM_TYPE_INT && delta.value_type != RAM_TYPE_REAL)
+    return SHARED_NOT_NUMBER;
+
+  struct SHARED_CELL* cell = find_cell(shared, name, true);
+  if (cell == NULL)
+    return SHARED_FULL;
+
+  uint64_t old = atomic_load_explicit(&cell->bits, memory_order_relaxed);
+  uint64_t sum;
+
+  do {
+    int tag = tag_of(old);
+
+    if (tag == TAG_NONE)
+      old = NONE_BITS;
+    else if (tag != TAG_INT && tag != TAG_REAL)
+      return SHARED_NOT_NUMBER;
+
+    if (tag != TAG_REAL && delta.value_type == RAM_TYPE_INT) {
+      uint32_t x = (tag == TAG_INT) ? (uint32_t)old : 0;
+
+      result->value_type = RAM_TYPE_INT;
+      result->types.i = (int)(x + (uint32_t)delta.types.i);  // wraps
+      sum = BOX(TAG_INT, (uint32_t)result->types.i);
+    }
+    else {
+      double x = (tag == TAG_REAL) ? real_of(old) : (tag == TAG_INT) ? (double)(int)(uint32_t)old : 0.0;
+      double y = (delta.value_type == RAM_TYPE_INT) ? (double)delta.types.i : delta.types.d;
+
+      result->value_type = RAM_TYPE_REAL;
+      result->types.d = x + y;
+      sum = box_real(result->types.d);
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&cell->bits, &old, sum, memory_order_acq_rel, memory_order_relaxed));
+
+  return SHARED_OK;
+}
+
+//
+// The builtins:
+//
+
+static bool check_name(char* function, struct SHARED_RAM* shared, struct RAM_VALUE* args, int line)
+{
+  if (shared == NULL) {
+    output_printf("**EXECUTION ERROR: %s() needs a shared RAM, and the program wasn't given one (line %d)\n", function, line);
+    return false;
+  }
+
+  if (args[0].value_type != RAM_TYPE_STR) {
+    output_printf("**SEMANTIC ERROR: %s() needs the name of a shared cell (line %d)\n", function, line);
+    return false;
+  }
+
+  return true;
+}
+
+static bool check_shareable(char* function, struct RAM_VALUE* value, int line)
+{
+  if (value->value_type == RAM_TYPE_LIST || value->value_type == RAM_TYPE_DICT) {
+    output_printf("**SEMANTIC ERROR: %s() can't share a list or dict (line %d)\n", function, line);
+    return false;
+  }
+
+  return true;
+}
+
+static bool full(int line)
+{
+  output_printf("**EXECUTION ERROR: shared RAM is full (line %d)\n", line);
+  return false;
+}
+
+static bool builtin_shared_get(struct RAM* memory, void* data, struct RAM_VALUE* args, int num_args, struct RAM_VALUE* result, int line)
+{
+  struct SHARED_RAM* shared = (struct SHARED_RAM*)data;
+  if (!check_name("shared_get", shared, args, line))
+    return false;
+
+  if (!shared_read(shared, args[0].types.s, result)) {
+    output_printf("**EXECUTION ERROR: out of memory (line %d)\n", line);
+    return false;
+  }
+
+  return true;
+}
+
+static bool builtin_shared_set(struct RAM* memory, void* data, struct RAM_VALUE* args, int num_args, struct RAM_VALUE* result, int line)
+{
+  struct SHARED_RAM* shared = (struct SHARED_RAM*)data;
+  if (!check_name("shared_set", shared, args, line) || !check_shareable("shared_set", &args[1], line))
+    return false;
+
+  return shared_write(shared, args[0].types.s, args[1]) || full(line);
+}
+
+static bool builtin_shared_cas(struct RAM* memory, void* data, struct RAM_VALUE* args, int num_args, struct RAM_VALUE* result, int line)
+{
+  struct SHARED_RAM* shared = (struct SHARED_RAM*)data;
+  bool swapped;
+
+  if (!check_name("shared_cas", shared, args, line) || !check_shareable("shared_cas", &args[2], line))
+    return false;
+
+  if (!shared_cas(shared, args[0].types.s, args[1], args[2], &swapped))
+    return full(line);
+
+  result->value_type = RAM_TYPE_BOOLEAN;
+  result->types.i = swapped;
+
+  return true;
+}
+
+static bool builtin_shared_add(struct RAM* memory, void* data, struct RAM_VALUE* args, int num_args, struct RAM_VALUE* result, int line)
+{
+  struct SHARED_RAM* shared = (struct SHARED_RAM*)data;
+  if (!check_name("shared_add", shared, args, line))
+    return false;
+
+  int status = add_value(shared, args[0].types.s, args[1], result);
+
+  if (status == SHARED_NOT_NUMBER) {
+    output_printf("**SEMANTIC ERROR: shared_add() needs numbers (line %d)\n", line);
+    return false;
+  }
+
+  return status == SHARED_OK || full(line);
+}
+
+
+//
+// Public functions:
+//
+
+//
+// shared_create
+//
+// Returns a new shared RAM with room for the given # of cells.
+//
+struct SHARED_RAM* shared_create(int capacity)
+{
+  struct SHARED_RAM* shared = (struct SHARED_RAM*)calloc(1, sizeof(struct SHARED_RAM));
+  if (shared == NULL)
+    return NULL;
+
+  //
+  // at most half full, so probes stay short:
+  //
+  int num_cells = 16;
+  while (num_cells < 2 * capacity)
+    num_cells *= 2;
+
+  shared->cells = (struct SHARED_CELL*)aligned_alloc(CACHE_LINE, num_cells * sizeof(struct SHARED_CELL));
+  if (shared->cells == NULL) {
+    free(shared);
+    return NULL;
+  }
+
+  shared->num_cells = num_cells;
+
+  for (int i = 0; i < num_cells; i++) {
+    atomic_init(&shared->cells[i].name, NULL);
+    atomic_init(&shared->cells[i].bits, NONE_BITS);
+  }
+
+  atomic_init(&shared->global_epoch, 0);
+
+  return shared;
+}
+
+//
+// shared_destroy
+//
+// Frees the shared RAM.
+//
+void shared_destroy(struct SHARED_RAM* shared)
+{
+  if (shared == NULL)
+    return;
+
+  for (int i = 0; i < shared->num_cells; i++) {
+    uint64_t bits = atomic_load(&shared->cells[i].bits);
+
+    if (tag_of(bits) == TAG_STR)
+      free(string_of(bits));
+
+    free(atomic_load(&shared->cells[i].name));
+  }
+
+  for (int slot = 0; slot < SHARED_MAX_THREADS; slot++) {
+    struct SHARED_THREAD* thread = &shared->threads[slot];
+
+    for (int bag = 0; bag < 3; bag++) {
+      free_bag(thread, bag);
+      free(thread->retired[bag]);
+    }
+  }
+
+  if (my_shared == shared)
+    my_shared = NULL;
+
+  free(shared->cells);
+  free(shared);
+}
+
+//
+// shared_read
+//
+// Returns the value of the named cell.
+//
+bool shared_read(struct SHARED_RAM* shared, char* name, struct RAM_VALUE* value)
+{
+  struct SHARED_CELL* cell = find_cell(shared, name, false);
+
+  if (cell == NULL) {
+    value->value_type = RAM_TYPE_NONE;
+    value->types.i = 0;
+    return true;
+  }
+
+  uint64_t bits = atomic_load_explicit(&cell->bits, memory_order_acquire);
+
+  if (tag_of(bits) != TAG_STR) {  // nothing to protect
+    *value = unbox(bits);
+    return true;
+  }
+
+  struct SHARED_THREAD* thread = enter(shared);
+
+  bits = atomic_load(&cell->bits);  // again, now that it's protected
+  *value = unbox(bits);
+
+  leave_epoch(thread);
+
+  return true;
+}
+
+//
+// shared_write
+//
+// Writes the given value to the named cell.
+//
+bool shared_write(struct SHARED_RAM* shared, char* name, struct RAM_VALUE value)
+{
+  uint64_t bits;
+
+  if (!box(value, &bits))
+    return false;
+
+  struct SHARED_CELL* cell = find_cell(shared, name, true);
+
+  if (cell == NULL) {
+    if (tag_of(bits) == TAG_STR)
+      free(string_of(bits));
+    return false;
+  }
+
+  uint64_t old = atomic_exchange(&cell->bits, bits);
+
+  if (tag_of(old) == TAG_STR)
+    retire(shared, string_of(old));
+
+  return true;
+}
+
+//
+// shared_cas
+//
+// Compares the named cell with expected and, if equal, replaces
+// it with desired, atomically.
+//
+bool shared_cas(struct SHARED_RAM* shared, char* name, struct RAM_VALUE expected, struct RAM_VALUE desired, bool* swapped)
+{
+  uint64_t bits;
+
+  if (!box(desired, &bits))
+    return false;
+
+  struct SHARED_CELL* cell = find_cell(shared, name, true);
+
+  if (cell == NULL) {
+    if (tag_of(bits) == TAG_STR)
+      free(string_of(bits));
+    return false;
+  }
+
+  //
+  // compare by value, then swap only if the cell still holds what
+  // was compared; a string can't be freed and its address reused
+  // while we're in the epoch, so the same bits mean the same value:
+  //
+  struct SHARED_THREAD* thread = enter(shared);
+  uint64_t old = atomic_load(&cell->bits);
+
+  *swapped = false;
+
+  while (equals(old, expected)) {
+    if (atomic_compare_exchange_weak(&cell->bits, &old, bits)) {
+      *swapped = true;
+      break;
+    }
+  }
+
+  leave_epoch(thread);
+
+  if (!*swapped) {
+    if (tag_of(bits) == TAG_STR)
+      free(string_of(bits));
+  }
+  else if (tag_of(old) == TAG_STR)
+    retire(shared, string_of(old));
+
+  return true;
+}
+
+//
+// shared_add
+//
+// Atomically adds delta to the named cell.
+//
+bool shared_add(struct SHARED_RAM* shared, char* name, struct RAM_VALUE delta, struct RAM_VALUE* result)
+{
+  return add_value(shared, name, delta, result) == SHARED_OK;
+}
+
+//
+// shared_leave
+//
+// Lets go of the calling thread's place in the shared RAM.
+//
+void shared_leave(struct SHARED_RAM* shared)
+{
+  int slot = find_mine(shared);
+
+  if (slot < 0)
+    return;
+
+  struct SHARED_THREAD* thread = &shared->threads[slot];
+
+  //
+  // free what can be freed now; the rest stays in the bags, for
+  // the next thread to claim the place, or shared_destroy:
+  //
+  try_advance(shared);
+  reclaim(thread, atomic_load(&shared->global_epoch));
+
+  atomic_store(&thread->owner, NULL);
+  atomic_store(&thread->used, false);
+
+  if (my_shared == shared) {
+    my_shared = NULL;
+    my_slot = -1;
+  }
+}
+
+//
+// shared_register
+//
+// Registers the builtins that use the shared RAM.
+//
+bool shared_register(void)
+{
+  return execute_register("shared_get", 1, builtin_shared_get) &&
+         execute_register("shared_set", 2, builtin_shared_set) &&
+         execute_register("shared_cas", 3, builtin_shared_cas) &&
+         execute_register("shared_add", 2, builtin_shared_add);
+}
@@ -0,0 +1,136 @@
+/*shared.h*/
+
+//
+// Shared RAM: named cells that nuPython programs running on
+// different threads, each with its own memory and executor, use to
+// cooperate --- counters, flags, a status string. Every operation
+// on a cell is atomic, and none takes a lock.
+//
+// A cell is a single 64-bit word, so it's read, written and
+// compared-and-swapped with ordinary atomic instructions. A real
+// is stored as its bits; any other value is "NaN-boxed", i.e.
+// stored as a NaN that no arithmetic produces, whose spare bits
+// hold the type and the value: an int, a boolean, None, a pointer
+// (the address), or a string (a pointer to the shared RAM's own
+// copy). A real NaN is stored as the standard quiet NaN. Lists and
+// dicts can't be shared.
+//
+// A string replaced in a cell may still be being copied by a
+// reader on another thread, so it isn't freed right away. It is
+// retired instead, and freed once every thread that was reading the
+// shared RAM at the time has finished: epoch-based reclamation,
+// where threads announce the epoch they read in, and the epoch only
+// moves on once every active thread has caught up with it. Memory
+// retired two epochs ago is safe to free.
+//
+// The cells are found by name in a hash table with a fixed # of
+// slots; names are added with compare-and-swap, and never removed.
+//
+// Programs use a shared RAM through builtins (see shared_register),
+// the one given to execute or execute_init; a process may have
+// several, e.g. one per group of threads:
+//
+//   shared_get(name)              the value, None if never set
+//   shared_set(name, value)
+//   shared_cas(name, old, new)    True if the value was old, and
+//                                 was replaced by new; old is
+//                                 compared by value, as == does
+//   shared_add(name, delta)       adds to an int or real (None
+//                                 counts as 0), returning the sum
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include <stdbool.h>  // true, false
+
+#include "ram.h"
+
+
+#define SHARED_MAX_THREADS 64  // that use one shared RAM at a time
+
+struct SHARED_RAM;  // see shared.c
+
+
+//
+// Public functions:
+//
+
+//
+// shared_create
+//
+// Returns a new shared RAM with room for the given # of cells, all
+// None, or NULL if out of memory.
+//
+struct SHARED_RAM* shared_create(int capacity);
+
+//
+// shared_destroy
+//
+// Frees the shared RAM, including retired strings. No thread may be
+// using it.
+//
+void shared_destroy(struct SHARED_RAM* shared);
+
+//
+// shared_read
+//
+// Returns the value of the named cell via value, None if it has
+// never been written. A string is a new copy, owned by the caller.
+// Returns false if out of memory.
+//
+bool shared_read(struct SHARED_RAM* shared, char* name, struct RAM_VALUE* value);
+
+//
+// shared_write
+//
+// Writes the given value to the named cell, creating the cell if
+// need be; a string is copied. Returns false if the value can't be
+// shared (a list or dict), or the shared RAM is full.
+//
+bool shared_write(struct SHARED_RAM* shared, char* name, struct RAM_VALUE value);
+
+//
+// shared_cas
+//
+// If the named cell holds a value equal to expected, replaces it
+// with desired and sets *swapped to true, otherwise sets *swapped
+// to false; atomically. Returns false if desired can't be shared,
+// or the shared RAM is full.
+//
+bool shared_cas(struct SHARED_RAM* shared, char* name, struct RAM_VALUE expected, struct RAM_VALUE desired, bool* swapped);
+
+//
+// shared_add
+//
+// Atomically adds delta, an int or a real, to the named cell, which
+// must hold an int, a real or None (counting as 0), and returns the
+// sum via result. Ints wrap around. Returns false if delta or the
+// cell is not a number, or the shared RAM is full.
+//
+bool shared_add(struct SHARED_RAM* shared, char* name, struct RAM_VALUE delta, struct RAM_VALUE* result);
+
+//
+// shared_leave
+//
+// Lets go of the calling thread's place in the shared RAM, freeing
+// what it retired once that's safe; call it before the thread
+// exits. At most SHARED_MAX_THREADS threads may use a shared RAM
+// without leaving.
+//
+void shared_leave(struct SHARED_RAM* shared);
+
+//
+// shared_register
+//
+// Registers the builtins shared_get() etc. with the executor (see
+// execute_register), once, before the first program is prepared.
+// A program's builtins use the shared RAM given as the native data
+// of its execution (see execute_init); without one, they stop it
+// with an error. Returns false if the builtins couldn't be
+// registered.
+//
+bool shared_register(void);
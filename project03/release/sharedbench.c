@@ -0,0 +1,459 @@
+/*sharedbench.c*/
+
+//
+// Shared RAM benchmark and stress test (see shared.h). Runs nuPython
+// programs on several threads at once, each with its own memory,
+// that count in the shared RAM --- with shared_add(), and with a
+// shared_get() / shared_cas() retry loop --- and checks that no
+// update is lost, also with every thread using two shared RAMs,
+// each program given its own. Then measures the operations from C, under
+// contention, against a pthread mutex doing the same, and has a
+// writer replace a shared string over and over while readers copy
+// it, to exercise the reclamation of replaced strings:
+//
+//   ./sharedbench.out [max # of threads, default 8]
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>   // true, false
+#include <string.h>    // strncmp
+#include <time.h>      // clock_gettime
+#include <stdatomic.h> // _Atomic
+#include <pthread.h>
+
+#include "parser.h"
+#include "programgraph.h"
+#include "ram.h"
+#include "execute.h"
+#include "output.h"
+#include "infer.h"
+#include "optimize.h"
+#include "shared.h"
+
+
+#define PROGRAM_ITERATIONS 20000    // of each program's loop
+#define C_ITERATIONS       1000000  // per thread, from C
+#define NUM_READERS        3        // of the shared string
+
+//
+// The programs run by the threads:
+//
+static char* add_program =
+  "i = 0\n"
+  "while i < N:\n"
+  "{\n"
+  "  shared_add('counter', 1)\n"
+  "  i = i + 1\n"
+  "}\n";
+
+static char* cas_program =
+  "no = [False]\n"  // booleans can't be compared, but can be found
+  "i = 0\n"
+  "while i < N:\n"
+  "{\n"
+  "  swapped = False\n"
+  "  while swapped in no:\n"
+  "  {\n"
+  "    old = shared_get('retried')\n"
+  "    new = old + 1\n"
+  "    swapped = shared_cas('retried', old, new)\n"
+  "  }\n"
+  "  i = i + 1\n"
+  "}\n";
+
+//
+// What a thread is given to do:
+//
+struct WORK
+{
+  struct SHARED_RAM* shared;
+  struct SHARED_RAM* other;  // run_program runs again against it
+  struct STMT* program;   // run by run_program
+  pthread_mutex_t* lock;  // used by run_locked
+  int id;
+  long long done;         // strings read, by run_reader
+  bool ok;
+};
+
+static long long locked_counter = 0;
+static _Atomic bool writing = false;
+
+
+//
+// Private functions:
+//
+
+//
+// now
+//
+// Returns the current time in seconds, from a monotonic clock.
+//
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//
+// compile
+//
+// Returns the program graph of the given nuPython source, with N
+// set to the given # of iterations, prepared for execution, NULL
+// on an error (output). The front end is not thread-safe, so this
+// runs on the main thread, before the threads start.
+//
+static struct STMT* compile(char* source, int iterations)
+{
+  char text[1024];
+  snprintf(text, sizeof(text), "N = %d\n%s", iterations, source);
+
+  FILE* input = tmpfile();
+  if (input == NULL)
+    return NULL;
+
+  fputs(text, input);
+  rewind(input);
+
+  struct TokenQueue* tokens = parser_parse(input);
+  fclose(input);
+
+  if (tokens == NULL)
+    return NULL;
+
+  struct STMT* program = programgraph_build(tokens);
+  tokenqueue_destroy(tokens);
+
+  if (program == NULL || infer_types(program) > 0) {
+    programgraph_destroy(program);
+    return NULL;
+  }
+
+  program = optimize(program, NULL);
+  execute_prepare(program);
+
+  return program;
+}
+
+//
+// run_program
+//
+// Thread: executes the program against a memory of its own and
+// the shared RAM, then again against the other one, if any. The
+// program graph is only read, so all the threads share it.
+//
+static void* run_program(void* arg)
+{
+  struct WORK* work = (struct WORK*)arg;
+  struct RAM* memory = ram_init();
+
+  execute(work->program, memory, work->shared);
+
+  if (work->other != NULL) {
+    ram_destroy(memory);
+    memory = ram_init();
+
+    execute(work->program, memory, work->other);
+    shared_leave(work->other);
+  }
+
+  output_flush();
+
+  ram_destroy(memory);
+  shared_leave(work->shared);
+
+  return NULL;
+}
+
+//
+// run_adds
+//
+// Thread: adds 1 to a cell, C_ITERATIONS times; the same cell for
+// all threads if work->id is 0, else a cell of its own.
+//
+static void* run_adds(void* arg)
+{
+  struct WORK* work = (struct WORK*)arg;
+  struct RAM_VALUE one = { .value_type = RAM_TYPE_INT, .types.i = 1 };
+  struct RAM_VALUE sum;
+  char name[32];
+
+  snprintf(name, sizeof(name), "cell%d", work->id);
+
+  for (int i = 0; i < C_ITERATIONS; i++)
+    work->ok = shared_add(work->shared, name, one, &sum) && work->ok;
+
+  shared_leave(work->shared);
+
+  return NULL;
+}
+
+//
+// run_locked
+//
+// Thread: adds 1 to a counter under a mutex, C_ITERATIONS times.
+//
+static void* run_locked(void* arg)
+{
+  struct WORK* work = (struct WORK*)arg;
+
+  for (int i = 0; i < C_ITERATIONS; i++) {
+    pthread_mutex_lock(work->lock);
+    locked_counter++;
+    pthread_mutex_unlock(work->lock);
+  }
+
+  return NULL;
+}
+
+//
+// run_writer / run_reader
+//
+// Threads: the writer replaces the string in a cell C_ITERATIONS
+// times, the readers copy it until the writer is done, checking
+// each copy is a string the writer wrote.
+//
+static void* run_writer(void* arg)
+{
+  struct WORK* work = (struct WORK*)arg;
+  char text[32];
+
+  for (int i = 0; i < C_ITERATIONS; i++) {
+    snprintf(text, sizeof(text), "status %d", i);
+
+    struct RAM_VALUE value = { .value_type = RAM_TYPE_STR, .types.s = text };
+    shared_write(work->shared, "status", value);
+  }
+
+  writing = false;
+
+  shared_leave(work->shared);
+
+  return NULL;
+}
+
+static void* run_reader(void* arg)
+{
+  struct WORK* work = (struct WORK*)arg;
+
+  work->ok = true;
+
+  for (;;) {
+    bool last = !writing;
+
+    struct RAM_VALUE value;
+    shared_read(work->shared, "status", &value);
+
+    if (value.value_type != RAM_TYPE_STR || strncmp(value.types.s, "status ", 7) != 0)
+      work->ok = false;
+    else
+      free(value.types.s);
+
+    work->done++;
+
+    if (last)
+      break;
+  }
+
+  shared_leave(work->shared);
+
+  return NULL;
+}
+
+//
+// run_threads
+//
+// Runs the given function on n threads, each with a copy of the
+// given work --- and an id of its own, 1 to n, if work->id is -1 ---
+// returning the time taken, and the work of thread 0 via first.
+//
+static double run_threads(int n, void* (*function)(void*), struct WORK* work, struct WORK* first)
+{
+  pthread_t threads[SHARED_MAX_THREADS];
+  struct WORK works[SHARED_MAX_THREADS];
+
+  double start = now();
+
+  for (int t = 0; t < n; t++) {
+    works[t] = *work;
+    works[t].id = (work->id < 0) ? t + 1 : work->id;
+
+    if (pthread_create(&threads[t], NULL, function, &works[t]) != 0) {
+      printf("**ERROR: unable to create thread\n");
+      exit(-1);
+    }
+  }
+
+  for (int t = 0; t < n; t++)
+    pthread_join(threads[t], NULL);
+
+  if (first != NULL)
+    *first = works[0];
+
+  return now() - start;
+}
+
+//
+// read_int
+//
+// Returns the int in the named cell, 0 if it's never been set, -1
+// if it's not an int.
+//
+static long long read_int(struct SHARED_RAM* shared, char* name)
+{
+  struct RAM_VALUE value;
+  shared_read(shared, name, &value);
+
+  if (value.value_type == RAM_TYPE_NONE)
+    return 0;
+
+  return (value.value_type == RAM_TYPE_INT) ? value.types.i : -1;
+}
+
+
+//
+// main
+//
+// usage: sharedbench.out [max # of threads]
+//
+int main(int argc, char* argv[])
+{
+  int max = (argc > 1) ? atoi(argv[1]) : 8;
+  bool ok = true;
+
+  if (max < 1 || max > SHARED_MAX_THREADS - 1) {
+    printf("**ERROR: 1 to %d threads\n", SHARED_MAX_THREADS - 1);
+    return -1;
+  }
+
+  struct SHARED_RAM* shared = shared_create(256);
+  struct SHARED_RAM* other = shared_create(16);
+
+  if (shared == NULL || other == NULL || !shared_register()) {
+    printf("**ERROR: unable to create the shared RAM\n");
+    return -1;
+  }
+
+  parser_init();
+
+  struct STMT* adder = compile(add_program, PROGRAM_ITERATIONS);
+  struct STMT* retrier = compile(cas_program, PROGRAM_ITERATIONS);
+
+  if (adder == NULL || retrier == NULL)
+    return -1;
+
+  //
+  // nuPython programs, every thread updating the same cells:
+  //
+  printf("nuPython, %d iterations per thread:\n", PROGRAM_ITERATIONS);
+
+  for (int n = 1; n <= max; n *= 2) {
+    struct RAM_VALUE zero = { .value_type = RAM_TYPE_INT, .types.i = 0 };
+    struct WORK work = { shared, NULL, adder, NULL, -1, 0, true };
+
+    shared_write(shared, "counter", zero);
+    shared_write(shared, "retried", zero);
+
+    double adds = run_threads(n, run_program, &work, NULL);
+
+    work.program = retrier;
+    double retries = run_threads(n, run_program, &work, NULL);
+
+    long long expected = (long long)n * PROGRAM_ITERATIONS;
+    long long counted = read_int(shared, "counter");
+    long long retried = read_int(shared, "retried");
+
+    printf("  %2d threads: shared_add %7.3f s, shared_cas %7.3f s%s\n", n, adds, retries,
+      (counted == expected && retried == expected) ? "" : " (**LOST UPDATES**)");
+
+    ok = ok && counted == expected && retried == expected;
+  }
+
+  //
+  // every thread counting in both shared RAMs, which stay apart:
+  //
+  {
+    struct RAM_VALUE zero = { .value_type = RAM_TYPE_INT, .types.i = 0 };
+    struct WORK work = { shared, other, adder, NULL, -1, 0, true };
+
+    shared_write(shared, "counter", zero);
+
+    double seconds = run_threads(max, run_program, &work, NULL);
+
+    long long expected = (long long)max * PROGRAM_ITERATIONS;
+    bool apart = read_int(shared, "counter") == expected && read_int(other, "counter") == expected;
+
+    printf("  %2d threads, 2 shared RAMs: shared_add %7.3f s%s\n", max, seconds, apart ? "" : " (**MIXED UP**)");
+
+    ok = ok && apart;
+  }
+
+  //
+  // from C, one cell for all threads, a cell per thread, and a
+  // mutex for all threads:
+  //
+  printf("C, %d adds per thread (ns per add):\n", C_ITERATIONS);
+
+  for (int n = 1; n <= max; n *= 2) {
+    struct WORK work = { shared, NULL, NULL, NULL, 0, 0, true };
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    double total = (double)n * C_ITERATIONS;
+
+    long long before = read_int(shared, "cell0");
+    double contended = run_threads(n, run_adds, &work, NULL);
+    long long after = read_int(shared, "cell0");
+
+    work.id = -1;
+    double separate = run_threads(n, run_adds, &work, NULL);
+
+    work.lock = &lock;
+    locked_counter = 0;
+    double locked = run_threads(n, run_locked, &work, NULL);
+
+    printf("  %2d threads: one cell %6.1f, own cells %6.1f, mutex %6.1f%s\n", n,
+      contended * 1e9 / total, separate * 1e9 / total, locked * 1e9 / total,
+      (after - before == (long long)total) ? "" : " (**LOST UPDATES**)");
+
+    ok = ok && after - before == (long long)total;
+  }
+
+  //
+  // a string replaced while it's being read:
+  //
+  {
+    struct WORK work = { shared, NULL, NULL, NULL, 0, 0, true };
+    struct WORK reader;
+    pthread_t writer;
+
+    struct RAM_VALUE value = { .value_type = RAM_TYPE_STR, .types.s = "status -1" };
+    shared_write(shared, "status", value);
+
+    writing = true;
+
+    pthread_create(&writer, NULL, run_writer, &work);
+    double seconds = run_threads(NUM_READERS, run_reader, &work, &reader);
+    pthread_join(writer, NULL);
+
+    printf("strings: %d writes, %lld reads by one of %d readers in %.3f s%s\n", C_ITERATIONS,
+      reader.done, NUM_READERS, seconds, reader.ok ? "" : " (**BAD READS**)");
+
+    ok = ok && reader.ok;
+  }
+
+  programgraph_destroy(adder);
+  programgraph_destroy(retrier);
+  shared_destroy(shared);
+  shared_destroy(other);
+
+  printf("%s\n", ok ? "ok" : "**FAILED");
+
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,35 @@
+#
+# JIT differential test: counters, accumulators and prints
+#
+x = 1
+y = 2.5
+while x < 50:
+{
+  print(x)
+  x = x + 1
+  x = 2 + x
+  pass
+  x = x - 1
+  y = y * 1.25
+  print(y)
+}
+print(x)
+print(y)
+
+i = 0
+total = 0
+while i <= 100:
+{
+  total = total + i
+  i = i + 1
+}
+print(total)
+
+z = 0 - 5.5
+while z <= 2.5:
+{
+  pass
+  print(z)
+  z = z + 0.25
+}
+print(z)
@@ -0,0 +1,61 @@
+#
+# JIT differential test: every arithmetic and relational operator,
+# int/real mixing, int overflow and division by zero
+#
+i = 0
+s = 0.0
+t = 7
+b = False
+while i < 5000:
+{
+  s = s + 0.1
+  t = t * 31
+  t = t % 1000003
+  p = i ** 3
+  q = s / 3
+  r = i / 7
+  m = i % 7
+  d = 10 / 0
+  e = s - i
+  b = i >= 2500
+  c = s != q
+  f = q == 0.0
+  g = i < 10
+  h = s > 100
+  k = t <= 500000
+  i = i + 1
+}
+print(i)
+print(s)
+print(t)
+print(p)
+print(q)
+print(r)
+print(m)
+print(d)
+print(e)
+print(b)
+print(c)
+print(f)
+print(g)
+print(h)
+print(k)
+
+n = 1
+while n > 0:
+{
+  n = n * 3
+}
+print(n)
+
+w = 1.0
+while w < 1000000:
+{
+  w = w * 1.1
+  print(w)
+  print(True)
+  print(12)
+  print(0.5)
+  print("step")
+  print()
+}
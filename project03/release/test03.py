@@ -0,0 +1,44 @@
+#
+# JIT differential test: loops whose variable types change between
+# runs of the loop, and loops that can't be compiled
+#
+k = 0
+x = 0
+while k < 4:
+{
+  j = 0
+  while j < 20:
+  {
+    x = x + 1
+    j = j + 1
+    print(x)
+  }
+  x = 0.5
+  k = k + 1
+}
+
+y = 1
+while y < 1000:
+{
+  y = y * 1.5
+}
+print(y)
+
+z = "a"
+n = 0
+while n < 12:
+{
+  n = n + 1
+  z = z + "b"
+  print(z)
+}
+
+flag = True
+count = 0
+while count < 15:
+{
+  print(flag)
+  flag = count < 7
+  count = count + 1
+}
+print(flag)
@@ -0,0 +1,59 @@
+#
+# JIT differential test: loops that read and write variables
+# through pointers, including a pointer that changes between
+# runs of the loop. Note that *p = ... has to follow a statement
+# that isn't an assignment, or it parses as a multiplication.
+#
+x = 0
+y = 0.5
+p = &x
+q = &y
+i = 0
+while i < 100:
+{
+  t = *p
+  t = t + i
+  pass
+  *p = t
+  u = *q
+  u = u * 1.01
+  pass
+  *q = u
+  r = *p
+  s = x == r
+  i = i + 1
+}
+print(x)
+print(y)
+print(s)
+cells = alloc(4)
+j = 0
+while j < 4:
+{
+  c = cells + j
+  pass
+  *c = j
+  k = 0
+  while k < 50:
+  {
+    v = *c
+    v = v + k
+    pass
+    *c = v
+    k = k + 1
+  }
+  w = *c
+  print(w)
+  j = j + 1
+}
+p = &y
+i = 0
+while i < 20:
+{
+  t = *p
+  t = t + 1
+  pass
+  *p = t
+  i = i + 1
+}
+print(y)
@@ -0,0 +1,53 @@
+#
+# Lists: literals, indexing, append, len() and for loops. The
+# while loop indexes a list, so the JIT has to leave it to the
+# interpreter.
+#
+xs = []
+i = 0
+while i < 10:
+{
+  sq = i * i
+  append(xs, sq)
+  i = i + 1
+}
+print(xs)
+n = len(xs)
+print(n)
+back = -1
+last = xs[back]
+print(last)
+total = 0
+for x in xs:
+{
+  total = total + x
+}
+print(total)
+ys = xs
+ys[0] = 'zero'
+first = xs[0]
+print(first)
+mixed = [1, 2.5, 'three', True, None]
+append(mixed, xs)
+print(mixed)
+count = 0
+for row in mixed:
+{
+  for c in xs:
+  {
+    count = count + 1
+  }
+}
+print(count)
+j = 0
+sum = 0
+while j < n:
+{
+  v = xs[j]
+  pass
+  j = j + 1
+}
+print(v)
+s = 'hello'
+k = len(s)
+print(s, k)
@@ -0,0 +1,53 @@
+#
+# Dicts: literals, lookups, assignment, the in operator, len()
+# and for loops over the keys. The while loop does a lookup per
+# iteration, so the JIT has to leave it to the interpreter.
+#
+ages = {'ann': 31, 'bob': 27, 7: 'seven'}
+print(ages)
+a = ages['ann']
+print(a)
+ages['cat'] = 45
+ages['bob'] = 28
+n = len(ages)
+print(n)
+k = 'cat'
+b = k in ages
+print(b)
+b = 'dan' in ages
+print(b)
+total = 0
+for name in ages:
+{
+  v = ages[name]
+  total = name
+}
+print(total)
+squares = {}
+i = 0
+while i < 100:
+{
+  sq = i * i
+  squares[i] = sq
+  i = i + 1
+}
+j = 0
+sum = 0
+while j < 100:
+{
+  v = squares[j]
+  sum = sum + v
+  j = j + 1
+}
+print(sum)
+n = len(squares)
+print(n)
+xs = [1, 2.5, 'three']
+b = 2.5 in xs
+print(b)
+b = 'four' in xs
+print(b)
+t = 'ell' in 'hello'
+print(t)
+nested = {'xs': xs, 'd': ages}
+print(nested)
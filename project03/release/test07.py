@@ -0,0 +1,63 @@
+#
+# Vectorized builtins over numeric lists: sum, min, max, dot,
+# add and scale. The lists are long enough to exercise both the
+# vector kernels and the item-by-item tails, and the results are
+# checked against while loops doing the same work.
+#
+xs = []
+ys = []
+rs = []
+i = 0
+while i < 37:
+{
+  x = i * 7
+  x = x % 23
+  x = x - 9
+  append(xs, x)
+  y = 5 - i
+  append(ys, y)
+  r = x * 0.5
+  append(rs, r)
+  i = i + 1
+}
+s = sum(xs)
+print(s)
+check = 0
+for x in xs:
+{
+  check = check + x
+}
+print(check)
+lo = min(xs)
+hi = max(xs)
+print(lo, hi)
+d = dot(xs, ys)
+print(d)
+zs = add(xs, ys)
+print(zs)
+ws = scale(xs, 3)
+print(ws)
+t = sum(rs)
+print(t)
+lo = min(rs)
+hi = max(rs)
+print(lo, hi)
+d = dot(rs, rs)
+print(d)
+hs = scale(rs, 2)
+print(hs)
+half = scale(xs, 0.5)
+same = add(half, rs)
+print(same)
+mixed = [3, 1.5, 1, 2]
+lo = min(mixed)
+hi = max(mixed)
+s = sum(mixed)
+print(lo, hi, s)
+d = dot(mixed, mixed)
+print(d)
+empty = []
+s = sum(empty)
+print(s)
+n = len(zs)
+print(n)
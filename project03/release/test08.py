@@ -0,0 +1,34 @@
+#
+# Type inference: variables whose types change around a loop's
+# back edge or through a pointer must not be treated as having
+# one type, so every operation below still gets the right answer.
+#
+x = 1
+y = 2
+i = 0
+while i < 4:
+{
+  z = x + y
+  print(z)
+  x = y * 0.5
+  i = i + 1
+}
+p = &y
+a = y + 1
+print(a)
+*p = 2.25
+b = y + 1
+print(b)
+*p = 'two'
+c = y + 'three'
+print(c)
+ks = [1, 2.5, 3]
+s = 0
+for k in ks:
+{
+  s = s + k
+  t = s < 4
+  print(s, t)
+}
+n = -x
+print(n)
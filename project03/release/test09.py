@@ -0,0 +1,45 @@
+#
+# Optimizer test: pass statements, stores that are overwritten
+# before they're read, and loops that never run
+#
+pass
+pass
+x = 0
+y = 0
+t = 0
+total = 0
+i = 0
+while i < 25:
+{
+  pass
+  t = i * 2
+  t = i + 1
+  x = t * 3
+  pass
+  pass
+  total = total + t
+  y = x
+  x = 5
+  i = i + 1
+}
+print(total, x, y)
+
+while 1 > 2:
+{
+  total = 'never'
+  print(total)
+}
+
+while 2.5 <= 2:
+{
+  pass
+}
+
+s = 'a'
+s = 'b'
+n = 0
+while n > 3:
+{
+  pass
+}
+print(s, n)
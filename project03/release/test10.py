@@ -0,0 +1,58 @@
+#
+# Optimizer test: assignments that are the same every time around
+# a loop, and some that look like it but aren't
+#
+n = 7
+scale = 2.5
+k = 0
+m = 0
+before = 0
+seen = 0
+total = 0
+i = 0
+while i < 5:
+{
+  seen = k
+  k = n * 3
+  m = k + 1
+  total = scale * n
+  i = i + 1
+  before = m
+  j = 0
+  while j < 4:
+  {
+    limit = n - 2
+    w = limit * scale
+    j = j + 1
+  }
+}
+print(seen, k, m, total, before, limit, w)
+
+count = 0
+while count > 3:
+{
+  k = n * 100
+  count = count + 1
+}
+print(k)
+
+x = 0
+y = 1
+p = 0
+while p < 3:
+{
+  x = y + 1
+  y = x * 2
+  p = p + 1
+}
+print(x, y)
+
+s = 'ab'
+t = 'x'
+q = 0
+while q < 3:
+{
+  t = s + 'c'
+  q = q + 1
+}
+print(t)
@@ -0,0 +1,97 @@
+#
+# Functions: parameters and locals live in the call's frame,
+# globals are read from memory, and recursion goes deep
+#
+def fact(n):
+{
+  r = 1
+  while n > 1:
+  {
+    r = r * n
+    n = n - 1
+  }
+  return r
+}
+
+def fib(n):
+{
+  while n < 2:
+  {
+    return n
+  }
+  m = n - 1
+  a = fib(m)
+  m = n - 2
+  b = fib(m)
+  return a + b
+}
+
+def depth(n):
+{
+  while n > 0:
+  {
+    n = n - 1
+    d = depth(n)
+    return d + 1
+  }
+  return 0
+}
+
+def greet(name):
+{
+  s = 'hello ' + name
+  print(s)
+}
+
+def total(xs):
+{
+  t = 0
+  for x in xs:
+  {
+    t = t + x
+    while t > 100:
+    {
+      return 'big'
+    }
+  }
+  return t
+}
+
+def scaled(k):
+{
+  return k * factor
+}
+
+def push(xs, v):
+{
+  append(xs, v)
+}
+
+factor = 3
+n = 5
+f = fact(n)
+print(n, f)
+g = fib(15)
+print(g)
+d = depth(5000)
+print(d)
+nothing = greet('world')
+print(nothing)
+nums = [1, 2, 3, 4]
+push(nums, 10)
+t = total(nums)
+more = [50, 60, 70]
+big = total(more)
+print(nums, t, big)
+s = scaled(7)
+factor = 0.5
+s2 = scaled(7)
+print(s, s2)
+results = [0, 0]
+results[1] = fact(6)
+ks = [3, 4]
+for k in ks:
+{
+  v = fact(k)
+  print(k, v)
+}
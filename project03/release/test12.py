@@ -0,0 +1,23 @@
+#
+# Conversions: int() and float() take the whole string, with
+# surrounding spaces, a sign and (for float) an exponent, and
+# reals print with 6 digits, rounding ties to even
+#
+a = int('42')
+b = int(' -17 ')
+c = int('+0')
+d = int('-2147483648')
+e = float('.5')
+f = float('5.')
+g = float('-1.25e2')
+h = float('6.02214076e23')
+i = float(' 1E-3 ')
+j = float('-inf')
+print(a, b, c, d)
+print(e, f, g, h, i, j)
+x = 0.0078125
+y = 0.0234375
+z = 0.00000025
+print(x, y, z)
+bad = int('12abc')
+print(bad)
@@ -0,0 +1,11 @@
+#
+# Literals are converted once, when the program graph is built:
+# an int literal that doesn't fit in 32 bits is an error, found
+# before anything runs
+#
+big = 2147483647
+small = -2147483647
+r = 0.1
+print(big, small, r)
+bad = 2147483648
+print(bad)
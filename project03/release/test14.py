@@ -0,0 +1,13 @@
+#
+# Run with -limit 2048 (see test14.options): a list that keeps
+# growing goes over the memory limit, which stops the program with
+# an error instead of using up the machine's memory
+#
+xs = []
+i = 0
+while i < 100000:
+{
+  append(xs, i)
+  i = i + 1
+}
+print(i)
@@ -0,0 +1,19 @@
+#
+# Run with -limit 65536 (see test15.options): every iteration makes
+# a one-key dict with a new, longer key. Only one small dict is live
+# at a time, so the program stays well under the limit: a key is
+# freed along with the last dict that uses it
+#
+k = 'k'
+i = 0
+while i < 2000:
+{
+  d = {}
+  d[k] = i
+  k = k + 'x'
+  i = i + 1
+}
+d = {'last': i}
+k = 'done'
+n = d['last']
+print(n)
@@ -54,6 +54,7 @@ enum TokenID
   nuPy_GTE,           // >=
   nuPy_AMPERSAND,     // &
   nuPy_COLON,         // :
+  nuPy_COMMA,         // ,
   nuPy_INT_LITERAL,   // e.g. 123 
   nuPy_REAL_LITERAL,  // e.g. 3.14 or .5 or 89.
   nuPy_STR_LITERAL,   // e.g. "hello cs211" or 'hello cs211'
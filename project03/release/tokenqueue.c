@@ -0,0 +1,241 @@
+/*tokenqueue.c*/
+
+//
+// Token Queue for nuPython
+//
+// Prof. Joe Hummel
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <string.h>
+
+#include "tokenqueue.h"
+#include "util.h"
+#include "output.h"
+
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**TOKENQUEUE ERROR\n");
+  printf("**TOKENQUEUE ERROR: %s\n", msg);
+  printf("**TOKENQUEUE ERROR\n");
+
+  exit(-123);
+}
+
+
+struct TokenQueue* tokenqueue_create(void)
+{
+  struct TokenQueue* tokens;
+
+  tokens = (struct TokenQueue*)malloc(sizeof(struct TokenQueue));
+  if (tokens == NULL)
+    panic("out of memory (tokenqueue_create)");
+
+  tokens->head = NULL;
+  tokens->tail = NULL;
+
+  return tokens;
+}
+
+void tokenqueue_destroy(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_destroy)");
+
+  struct TokenNode* cur = tokens->head;
+
+  while (cur != NULL)
+  {
+    struct TokenNode* next = cur->next;
+
+    free(cur);
+
+    cur = next;
+  }
+
+  free(tokens);
+}
+
+void tokenqueue_enqueue(struct TokenQueue* tokens, struct Token token, char* value)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_enqueue)");
+
+  //
+  // allocate a new node to hold the token and, in the same
+  // block, a copy of its value:
+  //
+  struct TokenNode* node;
+
+  node = (struct TokenNode*)malloc(sizeof(struct TokenNode) + strlen(value) + 1);
+  if (node == NULL)
+    panic("out of memory (tokenqueue_enqueue)");
+
+  node->token = token;
+  strcpy(node->value, value);
+  node->next = NULL;
+
+  //
+  // add to the end of the queue:
+  //
+  if (tokens->tail == NULL)
+  {
+    //
+    // queue is empty:
+    //
+    tokens->head = node;
+    tokens->tail = node;
+  }
+  else
+  {
+    tokens->tail->next = node;
+    tokens->tail = node;
+  }
+}
+
+void tokenqueue_dequeue(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_dequeue)");
+
+  //
+  // remove the token at the front of the queue:
+  //
+  struct TokenNode* cur = tokens->head;
+
+  if (cur == NULL)
+    panic("token queue is empty (tokenqueue_dequeue)");
+
+  tokens->head = cur->next;
+
+  if (tokens->head == NULL)  // queue is now empty:
+    tokens->tail = NULL;
+
+  free(cur);
+}
+
+bool tokenqueue_empty(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_empty)");
+
+  if (tokens->head == NULL)
+    return true;
+  else
+    return false;
+}
+
+struct Token tokenqueue_peekToken(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_peekToken)");
+
+  struct TokenNode* cur = tokens->head;
+
+  if (cur == NULL)
+    panic("token queue is empty (tokenqueue_peekToken)");
+
+  return cur->token;
+}
+
+char* tokenqueue_peekValue(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_peekValue)");
+
+  struct TokenNode* cur = tokens->head;
+
+  if (cur == NULL)
+    panic("token queue is empty (tokenqueue_peekValue)");
+
+  return cur->value;
+}
+
+struct Token tokenqueue_peek2Token(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_peek2Token)");
+
+  struct TokenNode* cur = tokens->head;
+
+  if (cur == NULL)
+    panic("token queue is empty (tokenqueue_peek2Token)");
+
+  cur = cur->next;
+
+  if (cur == NULL)
+    panic("cannot look two tokens ahead! (tokenqueue_peek2Token)");
+
+  return cur->token;
+}
+
+char* tokenqueue_peek2Value(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_peek2Value)");
+
+  struct TokenNode* cur = tokens->head;
+
+  if (cur == NULL)
+    panic("token queue is empty (tokenqueue_peek2Value)");
+
+  cur = cur->next;
+
+  if (cur == NULL)
+    panic("cannot look two tokens ahead! (tokenqueue_peek2Value)");
+
+  return cur->value;
+}
+
+void tokenqueue_print(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_print)");
+
+  printf("**TokenQueue Print**\n");
+
+  struct TokenNode* cur = tokens->head;
+
+  while (cur != NULL)
+  {
+    printf("%d@(%d,%d): '%s'\n", cur->token.id, cur->token.line, cur->token.col, cur->value);
+
+    cur = cur->next;
+  }
+
+  printf("**TokenQueue Print Done**\n");
+}
+
+struct TokenQueue* tokenqueue_duplicate(struct TokenQueue* tokens)
+{
+  if (tokens == NULL)
+    panic("tokens param is NULL (tokenqueue_duplicate)");
+
+  //
+  // create a new queue and enqueue a copy of each token:
+  //
+  struct TokenQueue* duplicate = tokenqueue_create();
+
+  struct TokenNode* cur = tokens->head;
+
+  while (cur != NULL)
+  {
+    tokenqueue_enqueue(duplicate, cur->token, cur->value);
+
+    cur = cur->next;
+  }
+
+  return duplicate;
+}
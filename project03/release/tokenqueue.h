@@ -17,8 +17,8 @@
 struct TokenNode
 {
   struct Token token;
-  char* value;
   struct TokenNode* next;
+  char value[];  // allocated with the node
 };
 
 struct TokenQueue
@@ -0,0 +1,249 @@
+/*util.c*/
+
+//
+// Utility functions for nuPython
+//
+// Prof. Joe Hummel
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>  // tolower
+
+#include "util.h"
+#include "output.h"
+
+
+//
+// panic
+//
+// Outputs the given error message and exits the program.
+//
+static void panic(char* msg)
+{
+  output_flush();  // what the program output so far comes first
+
+  printf("**UTIL ERROR\n");
+  printf("**UTIL ERROR: %s\n", msg);
+  printf("**UTIL ERROR\n");
+
+  exit(-123);
+}
+
+
+//
+// dupString
+//
+// Duplicates the given string and returns a pointer
+// to the copy.
+//
+// NOTE: this function allocates memory for the copy,
+// the caller takes ownership of the copy and must
+// eventually free that memory.
+//
+char* dupString(char* s)
+{
+  if (s == NULL) panic("s is NULL (dupString)");
+
+  //
+  // +1 for the null terminator:
+  //
+  char* copy = (char*)malloc(strlen(s) + 1);
+  if (copy == NULL) panic("out of memory (dupString)");
+
+  strcpy(copy, s);
+
+  return copy;
+}
+
+//
+// dupAndStripEOLN
+//
+// Duplicates the given string and returns a pointer
+// to the copy; any EOLN characters (\n, \r, etc.)
+// are also removed.
+//
+// NOTE: this function allocates memory for the copy,
+// the caller takes ownership of the copy and must
+// eventually free that memory.
+//
+char* dupAndStripEOLN(char* s)
+{
+  if (s == NULL) panic("s is NULL (dupAndStripEOLN)");
+
+  char* copy = (char*)malloc(strlen(s) + 1);
+  if (copy == NULL) panic("out of memory (dupAndStripEOLN)");
+
+  strcpy(copy, s);
+
+  //
+  // truncate at the first EOLN character, if any:
+  //
+  copy[strcspn(copy, "\r\n")] = '\0';
+
+  return copy;
+}
+
+//
+// icmpStrings
+//
+// case-insensitive comparison of strings s1 and s2.
+// Like strcmp, returns 0 if s1 == s2 and returns a
+// non-zero value if s1 != s2.
+//
+// Example: icmpStrings("apple", "APPLE") returns 0
+//
+int icmpStrings(char* s1, char* s2)
+{
+  if (s1 == NULL) panic("s1 is NULL (icmpStrings)");
+  if (s2 == NULL) panic("s2 is NULL (icmpStrings)");
+
+  size_t len1 = strlen(s1);
+  size_t len2 = strlen(s2);
+
+  if (len1 != len2)
+    return 1;
+
+  for (size_t i = 0; i < len1; i++)
+  {
+    if (s1[i] == s2[i])
+      continue;
+
+    //
+    // differ, but maybe only in case:
+    //
+    if (tolower(s1[i]) != tolower(s2[i]))
+      return 1;
+  }
+
+  return 0;
+}
+
+//
+// hashString
+//
+// Returns the FNV-1a hash of the given string.
+//
+unsigned int hashString(const char* s)
+{
+  unsigned int hash = 2166136261u;
+
+  for ( ; *s != '\0'; s++)
+    hash = (hash ^ (unsigned char)*s) * 16777619u;
+
+  return hash;
+}
+
+//
+// rehash
+//
+// Rebuilds the table of the given set with the given size.
+//
+static void rehash(struct NameSet* set, int table_size)
+{
+  free(set->table);
+
+  set->table_size = table_size;
+  set->table = (int*)malloc(table_size * sizeof(int));
+  if (set->table == NULL) panic("out of memory (rehash)");
+
+  memset(set->table, -1, table_size * sizeof(int));
+
+  unsigned int mask = table_size - 1;
+
+  for (int i = 0; i < set->num_names; i++)
+  {
+    unsigned int slot = hashString(set->names[i]) & mask;
+
+    while (set->table[slot] >= 0)
+      slot = (slot + 1) & mask;
+
+    set->table[slot] = i;
+  }
+}
+
+//
+// nameSetFind
+//
+// Returns the number of the given name, adding it if add is true
+// and it isn't there yet; returns -1 if not found.
+//
+int nameSetFind(struct NameSet* set, char* name, bool add)
+{
+  if (set == NULL) panic("set is NULL (nameSetFind)");
+
+  if (set->table_size == 0)
+  {
+    if (!add)
+      return -1;
+
+    rehash(set, 16);
+  }
+
+  unsigned int mask = set->table_size - 1;
+  unsigned int slot = hashString(name) & mask;
+
+  while (set->table[slot] >= 0)
+  {
+    if (strcmp(set->names[set->table[slot]], name) == 0)
+      return set->table[slot];
+
+    slot = (slot + 1) & mask;
+  }
+
+  if (!add)
+    return -1;
+
+  if (set->num_names == set->capacity)
+  {
+    set->capacity = (set->capacity == 0) ? 8 : 2 * set->capacity;
+    set->names = (char**)realloc(set->names, set->capacity * sizeof(char*));
+    if (set->names == NULL) panic("out of memory (nameSetFind)");
+  }
+
+  int i = set->num_names++;
+  set->names[i] = name;
+  set->table[slot] = i;
+
+  if (2 * set->num_names > set->table_size)
+    rehash(set, 2 * set->table_size);
+
+  return i;
+}
+
+//
+// nameSetClear
+//
+// Empties the given set, freeing its table; the space for the
+// names is kept for the next use.
+//
+void nameSetClear(struct NameSet* set)
+{
+  if (set == NULL) panic("set is NULL (nameSetClear)");
+
+  free(set->table);
+
+  set->table = NULL;
+  set->table_size = 0;
+  set->num_names = 0;
+}
+
+//
+// nameSetFree
+//
+// Frees what the given set allocated, leaving it empty.
+//
+void nameSetFree(struct NameSet* set)
+{
+  if (set == NULL) panic("set is NULL (nameSetFree)");
+
+  nameSetClear(set);
+
+  free(set->names);
+
+  set->names = NULL;
+  set->capacity = 0;
+}
@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <stdbool.h>  // true, false
+
 
 //
 // dupString
@@ -46,3 +48,51 @@ char* dupAndStripEOLN(char* s);
 // Example: icmpStrings("apple", "APPLE") returns 0
 //
 int icmpStrings(char* s1, char* s2);
+
+//
+// hashString
+//
+// Returns the FNV-1a hash of the given string.
+//
+unsigned int hashString(const char* s);
+
+//
+// A set of names, each numbered in the order it was added, with
+// a hash table (open addressing, kept at most half full) from a
+// name to its number, so finding one doesn't mean comparing it
+// to every name before it. The names are not copied. A set that
+// is all zeros, e.g. { 0 }, is empty.
+//
+struct NameSet
+{
+  char** names;       // by number
+  int    num_names;
+  int    capacity;    // of names
+
+  int*   table;       // numbers, -1 => empty
+  int    table_size;  // a power of 2, 0 => no table yet
+};
+
+//
+// nameSetFind
+//
+// Returns the number of the given name, adding it if add is true
+// and it isn't there yet; returns -1 if not found.
+//
+int nameSetFind(struct NameSet* set, char* name, bool add);
+
+//
+// nameSetClear
+//
+// Empties the given set, freeing its table; the space for the
+// names is kept for the next use.
+//
+void nameSetClear(struct NameSet* set);
+
+//
+// nameSetFree
+//
+// Frees what the given set allocated, leaving it empty. The names
+// themselves are not freed.
+//
+void nameSetFree(struct NameSet* set);
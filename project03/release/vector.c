@@ -0,0 +1,570 @@
+/*vector.c*/
+
+//
+// Vectorized kernels for numeric lists: sum, min, max, dot
+// product, element-wise add and scale. See vector.h.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>  // true, false
+#include <stddef.h>   // offsetof
+#include <assert.h>
+
+#include "ram.h"
+#include "vector.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+//
+// The SSE2 kernels load items as raw 16-byte vectors: the type
+// is the first 4 bytes, and the number starts 8 bytes in (an int
+// is the low 4 of those bytes, a real all 8):
+//
+_Static_assert(sizeof(struct RAM_VALUE) == 16, "RAM_VALUE must be 16 bytes");
+_Static_assert(offsetof(struct RAM_VALUE, types) == 8, "RAM_VALUE number must start 8 bytes in");
+#endif
+
+
+//
+// Private functions:
+//
+
+//
+// int_value / real_value
+//
+// Returns the given number as a value.
+//
+static struct RAM_VALUE int_value(int i)
+{
+  struct RAM_VALUE value;
+
+  value.value_type = RAM_TYPE_INT;
+  value.types.i = i;
+
+  return value;
+}
+
+static struct RAM_VALUE real_value(double d)
+{
+  struct RAM_VALUE value;
+
+  value.value_type = RAM_TYPE_REAL;
+  value.types.d = d;
+
+  return value;
+}
+
+//
+// as_real
+//
+// Returns the number in the given int or real value as a real.
+//
+static double as_real(const struct RAM_VALUE* value)
+{
+  if (value->value_type == RAM_TYPE_INT)
+    return value->types.i;
+  else
+    return value->types.d;
+}
+
+//
+// wrap_add / wrap_mul
+//
+// Int arithmetic that wraps around on overflow, the same way the
+// SSE2 instructions do.
+//
+static int wrap_add(int a, int b)
+{
+  return (int)((unsigned int)a + (unsigned int)b);
+}
+
+static int wrap_mul(int a, int b)
+{
+  return (int)((unsigned int)a * (unsigned int)b);
+}
+
+#if defined(__SSE2__)
+
+//
+// load_types
+//
+// Returns the types of the 4 items starting at the given one.
+//
+static inline __m128i load_types(const struct RAM_VALUE* items)
+{
+  __m128i a = _mm_loadu_si128((const __m128i*) &items[0]);
+  __m128i b = _mm_loadu_si128((const __m128i*) &items[1]);
+  __m128i c = _mm_loadu_si128((const __m128i*) &items[2]);
+  __m128i d = _mm_loadu_si128((const __m128i*) &items[3]);
+
+  // 4-byte word 0 of each item:
+  return _mm_unpacklo_epi64(_mm_unpacklo_epi32(a, b), _mm_unpacklo_epi32(c, d));
+}
+
+//
+// load_ints
+//
+// Returns the ints in the 4 items starting at the given one.
+//
+static inline __m128i load_ints(const struct RAM_VALUE* items)
+{
+  __m128i a = _mm_loadu_si128((const __m128i*) &items[0]);
+  __m128i b = _mm_loadu_si128((const __m128i*) &items[1]);
+  __m128i c = _mm_loadu_si128((const __m128i*) &items[2]);
+  __m128i d = _mm_loadu_si128((const __m128i*) &items[3]);
+
+  // 4-byte word 2 of each item:
+  return _mm_unpacklo_epi64(_mm_unpackhi_epi32(a, b), _mm_unpackhi_epi32(c, d));
+}
+
+//
+// load_reals
+//
+// Returns the reals in the 2 items starting at the given one.
+//
+static inline __m128d load_reals(const struct RAM_VALUE* items)
+{
+  __m128d a = _mm_loadu_pd((const double*) &items[0]);
+  __m128d b = _mm_loadu_pd((const double*) &items[1]);
+
+  // 8-byte word 1 of each item:
+  return _mm_unpackhi_pd(a, b);
+}
+
+//
+// store_ints
+//
+// Stores the 4 ints as int items, starting at the given one.
+//
+static inline void store_ints(struct RAM_VALUE* items, __m128i v)
+{
+  __m128i type = _mm_set_epi32(0, RAM_TYPE_INT, 0, RAM_TYPE_INT);
+  __m128i zero = _mm_setzero_si128();
+  __m128i lo = _mm_unpacklo_epi32(v, zero);
+  __m128i hi = _mm_unpackhi_epi32(v, zero);
+
+  _mm_storeu_si128((__m128i*) &items[0], _mm_unpacklo_epi64(type, lo));
+  _mm_storeu_si128((__m128i*) &items[1], _mm_unpackhi_epi64(type, lo));
+  _mm_storeu_si128((__m128i*) &items[2], _mm_unpacklo_epi64(type, hi));
+  _mm_storeu_si128((__m128i*) &items[3], _mm_unpackhi_epi64(type, hi));
+}
+
+//
+// store_reals
+//
+// Stores the 2 reals as real items, starting at the given one.
+//
+static inline void store_reals(struct RAM_VALUE* items, __m128d v)
+{
+  __m128d type = _mm_castsi128_pd(_mm_set_epi32(0, RAM_TYPE_REAL, 0, RAM_TYPE_REAL));
+
+  _mm_storeu_pd((double*) &items[0], _mm_unpacklo_pd(type, v));
+  _mm_storeu_pd((double*) &items[1], _mm_unpackhi_pd(type, v));
+}
+
+//
+// mullo_ints
+//
+// Multiplies 4 pairs of ints, keeping the low 32 bits of each
+// product (SSE2 has no instruction for this; SSE4.1 does).
+//
+static inline __m128i mullo_ints(__m128i a, __m128i b)
+{
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+//
+// sum_ints / sum_reals
+//
+// Returns the sum of the numbers in the vector.
+//
+static inline unsigned int sum_ints(__m128i v)
+{
+  unsigned int lanes[4];
+
+  _mm_storeu_si128((__m128i*) lanes, v);
+
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static inline double sum_reals(__m128d v)
+{
+  return _mm_cvtsd_f64(v) + _mm_cvtsd_f64(_mm_unpackhi_pd(v, v));
+}
+
+#endif
+
+//
+// vector_extreme
+//
+// Returns the smallest item of the list, or the largest one if
+// largest is true; see vector_min and vector_max.
+//
+static struct RAM_VALUE vector_extreme(struct RAM_LIST* xs, int type, bool largest)
+{
+  struct RAM_VALUE* items = xs->items;
+  int n = xs->length;
+  int i = 1;
+
+  assert(n > 0);
+
+  if (type == VECTOR_INT) {
+    int best = items[0].types.i;
+
+#if defined(__SSE2__)
+    if (n >= 4) {
+      __m128i acc = load_ints(&items[0]);
+
+      for (i = 4; i + 4 <= n; i += 4) {
+        __m128i v = load_ints(&items[i]);
+        __m128i take = largest ? _mm_cmpgt_epi32(v, acc) : _mm_cmplt_epi32(v, acc);
+
+        acc = _mm_or_si128(_mm_and_si128(take, v), _mm_andnot_si128(take, acc));
+      }
+
+      int lanes[4];
+      _mm_storeu_si128((__m128i*) lanes, acc);
+
+      best = lanes[0];
+      for (int k = 1; k < 4; k++) {
+        if (largest ? lanes[k] > best : lanes[k] < best)
+          best = lanes[k];
+      }
+    }
+#endif
+
+    for ( ; i < n; i++) {
+      int x = items[i].types.i;
+
+      if (largest ? x > best : x < best)
+        best = x;
+    }
+
+    return int_value(best);
+  }
+
+  if (type == VECTOR_REAL) {
+    double best = items[0].types.d;
+
+#if defined(__SSE2__)
+    if (n >= 2) {
+      __m128d acc = load_reals(&items[0]);
+
+      for (i = 2; i + 2 <= n; i += 2) {
+        __m128d v = load_reals(&items[i]);
+
+        acc = largest ? _mm_max_pd(acc, v) : _mm_min_pd(acc, v);
+      }
+
+      double lo = _mm_cvtsd_f64(acc);
+      double hi = _mm_cvtsd_f64(_mm_unpackhi_pd(acc, acc));
+
+      best = (largest ? hi > lo : hi < lo) ? hi : lo;
+    }
+#endif
+
+    for ( ; i < n; i++) {
+      double x = items[i].types.d;
+
+      if (largest ? x > best : x < best)
+        best = x;
+    }
+
+    return real_value(best);
+  }
+
+  //
+  // ints and reals, compared as reals; the result is the first
+  // item with the best value, whatever its type:
+  //
+  int best = 0;
+
+  for ( ; i < n; i++) {
+    double x = as_real(&items[i]);
+    double b = as_real(&items[best]);
+
+    if (largest ? x > b : x < b)
+      best = i;
+  }
+
+  return items[best];
+}
+
+
+//
+// Public functions:
+//
+
+//
+// vector_type
+//
+// Returns the kind of numbers the list holds.
+//
+int vector_type(struct RAM_LIST* list)
+{
+  struct RAM_VALUE* items = list->items;
+  int n = list->length;
+  int i = 0;
+
+  bool ints = true;   // only ints so far?
+  bool reals = true;  // only reals so far?
+
+#if defined(__SSE2__)
+  __m128i int_type = _mm_set1_epi32(RAM_TYPE_INT);
+  __m128i real_type = _mm_set1_epi32(RAM_TYPE_REAL);
+  __m128i all_ints = _mm_set1_epi32(-1);
+  __m128i all_reals = _mm_set1_epi32(-1);
+
+  for ( ; i + 4 <= n; i += 4) {
+    __m128i types = load_types(&items[i]);
+    __m128i is_int = _mm_cmpeq_epi32(types, int_type);
+    __m128i is_real = _mm_cmpeq_epi32(types, real_type);
+
+    if (_mm_movemask_epi8(_mm_or_si128(is_int, is_real)) != 0xFFFF)
+      return VECTOR_NOT_NUMERIC;
+
+    all_ints = _mm_and_si128(all_ints, is_int);
+    all_reals = _mm_and_si128(all_reals, is_real);
+  }
+
+  ints = (_mm_movemask_epi8(all_ints) == 0xFFFF);
+  reals = (_mm_movemask_epi8(all_reals) == 0xFFFF);
+#endif
+
+  for ( ; i < n; i++) {
+    if (items[i].value_type == RAM_TYPE_INT)
+      reals = false;
+    else if (items[i].value_type == RAM_TYPE_REAL)
+      ints = false;
+    else
+      return VECTOR_NOT_NUMERIC;
+  }
+
+  if (ints)
+    return VECTOR_INT;
+  else if (reals)
+    return VECTOR_REAL;
+  else
+    return VECTOR_MIXED;
+}
+
+//
+// vector_sum
+//
+// Returns the sum of the items.
+//
+struct RAM_VALUE vector_sum(struct RAM_LIST* xs, int type)
+{
+  struct RAM_VALUE* items = xs->items;
+  int n = xs->length;
+  int i = 0;
+
+  if (type == VECTOR_INT) {
+    unsigned int sum = 0;
+
+#if defined(__SSE2__)
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+
+    for ( ; i + 8 <= n; i += 8) {
+      acc0 = _mm_add_epi32(acc0, load_ints(&items[i]));
+      acc1 = _mm_add_epi32(acc1, load_ints(&items[i + 4]));
+    }
+
+    sum = sum_ints(_mm_add_epi32(acc0, acc1));
+#endif
+
+    for ( ; i < n; i++)
+      sum += (unsigned int)items[i].types.i;
+
+    return int_value((int)sum);
+  }
+
+  double sum = 0.0;
+
+#if defined(__SSE2__)
+  if (type == VECTOR_REAL) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd();
+    __m128d acc3 = _mm_setzero_pd();
+
+    for ( ; i + 8 <= n; i += 8) {
+      acc0 = _mm_add_pd(acc0, load_reals(&items[i]));
+      acc1 = _mm_add_pd(acc1, load_reals(&items[i + 2]));
+      acc2 = _mm_add_pd(acc2, load_reals(&items[i + 4]));
+      acc3 = _mm_add_pd(acc3, load_reals(&items[i + 6]));
+    }
+
+    sum = sum_reals(_mm_add_pd(_mm_add_pd(acc0, acc1), _mm_add_pd(acc2, acc3)));
+  }
+#endif
+
+  for ( ; i < n; i++)
+    sum += as_real(&items[i]);
+
+  return real_value(sum);
+}
+
+//
+// vector_min / vector_max
+//
+// Returns the smallest / largest item of a non-empty list.
+//
+struct RAM_VALUE vector_min(struct RAM_LIST* xs, int type)
+{
+  return vector_extreme(xs, type, false);
+}
+
+struct RAM_VALUE vector_max(struct RAM_LIST* xs, int type)
+{
+  return vector_extreme(xs, type, true);
+}
+
+//
+// vector_dot
+//
+// Returns the dot product of two lists of the same length.
+//
+struct RAM_VALUE vector_dot(struct RAM_LIST* xs, int xtype, struct RAM_LIST* ys, int ytype)
+{
+  struct RAM_VALUE* x = xs->items;
+  struct RAM_VALUE* y = ys->items;
+  int n = xs->length;
+  int i = 0;
+
+  assert(ys->length == n);
+
+  if (xtype == VECTOR_INT && ytype == VECTOR_INT) {
+    unsigned int sum = 0;
+
+#if defined(__SSE2__)
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+
+    for ( ; i + 8 <= n; i += 8) {
+      acc0 = _mm_add_epi32(acc0, mullo_ints(load_ints(&x[i]), load_ints(&y[i])));
+      acc1 = _mm_add_epi32(acc1, mullo_ints(load_ints(&x[i + 4]), load_ints(&y[i + 4])));
+    }
+
+    sum = sum_ints(_mm_add_epi32(acc0, acc1));
+#endif
+
+    for ( ; i < n; i++)
+      sum += (unsigned int)x[i].types.i * (unsigned int)y[i].types.i;
+
+    return int_value((int)sum);
+  }
+
+  double sum = 0.0;
+
+#if defined(__SSE2__)
+  if (xtype == VECTOR_REAL && ytype == VECTOR_REAL) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+
+    for ( ; i + 4 <= n; i += 4) {
+      acc0 = _mm_add_pd(acc0, _mm_mul_pd(load_reals(&x[i]), load_reals(&y[i])));
+      acc1 = _mm_add_pd(acc1, _mm_mul_pd(load_reals(&x[i + 2]), load_reals(&y[i + 2])));
+    }
+
+    sum = sum_reals(_mm_add_pd(acc0, acc1));
+  }
+#endif
+
+  for ( ; i < n; i++)
+    sum += as_real(&x[i]) * as_real(&y[i]);
+
+  return real_value(sum);
+}
+
+//
+// vector_add
+//
+// Stores xs[i] + ys[i] for each i into result.
+//
+void vector_add(struct RAM_LIST* xs, int xtype, struct RAM_LIST* ys, int ytype, struct RAM_LIST* result)
+{
+  struct RAM_VALUE* x = xs->items;
+  struct RAM_VALUE* y = ys->items;
+  struct RAM_VALUE* out = result->items;
+  int n = xs->length;
+  int i = 0;
+
+  assert(ys->length == n);
+  assert(result->length == 0 && result->capacity >= n);
+
+#if defined(__SSE2__)
+  if (xtype == VECTOR_INT && ytype == VECTOR_INT) {
+    for ( ; i + 4 <= n; i += 4)
+      store_ints(&out[i], _mm_add_epi32(load_ints(&x[i]), load_ints(&y[i])));
+  }
+  else if (xtype == VECTOR_REAL && ytype == VECTOR_REAL) {
+    for ( ; i + 2 <= n; i += 2)
+      store_reals(&out[i], _mm_add_pd(load_reals(&x[i]), load_reals(&y[i])));
+  }
+#endif
+
+  //
+  // the rest of the items (all of them if the types are mixed),
+  // one at a time:
+  //
+  for ( ; i < n; i++) {
+    if (x[i].value_type == RAM_TYPE_INT && y[i].value_type == RAM_TYPE_INT)
+      out[i] = int_value(wrap_add(x[i].types.i, y[i].types.i));
+    else
+      out[i] = real_value(as_real(&x[i]) + as_real(&y[i]));
+  }
+
+  // numbers own nothing, so there is nothing more to account for:
+  result->length = n;
+}
+
+//
+// vector_scale
+//
+// Stores xs[i] * k for each i into result.
+//
+void vector_scale(struct RAM_LIST* xs, int xtype, struct RAM_VALUE k, struct RAM_LIST* result)
+{
+  struct RAM_VALUE* x = xs->items;
+  struct RAM_VALUE* out = result->items;
+  int n = xs->length;
+  int i = 0;
+
+  assert(result->length == 0 && result->capacity >= n);
+
+#if defined(__SSE2__)
+  if (xtype == VECTOR_INT && k.value_type == RAM_TYPE_INT) {
+    __m128i kv = _mm_set1_epi32(k.types.i);
+
+    for ( ; i + 4 <= n; i += 4)
+      store_ints(&out[i], mullo_ints(load_ints(&x[i]), kv));
+  }
+  else if (xtype == VECTOR_REAL) {
+    __m128d kv = _mm_set1_pd(as_real(&k));
+
+    for ( ; i + 2 <= n; i += 2)
+      store_reals(&out[i], _mm_mul_pd(load_reals(&x[i]), kv));
+  }
+#endif
+
+  for ( ; i < n; i++) {
+    if (x[i].value_type == RAM_TYPE_INT && k.value_type == RAM_TYPE_INT)
+      out[i] = int_value(wrap_mul(x[i].types.i, k.types.i));
+    else
+      out[i] = real_value(as_real(&x[i]) * as_real(&k));
+  }
+
+  result->length = n;
+}
@@ -0,0 +1,92 @@
+/*vector.h*/
+
+//
+// Vectorized kernels behind the numeric list builtins sum(),
+// min(), max(), dot(), add() and scale(). One call runs over the
+// whole list in C, instead of the interpreter stepping through a
+// loop one item at a time.
+//
+// The kernels work directly on a list's items. Each item is a
+// 16-byte value whose number sits at a fixed offset, so with SSE2
+// the kernels gather 4 ints (or 2 reals) per load and operate on
+// them as one vector; without SSE2 the same loops run one item at
+// a time. Lists of all ints or all reals take the vector path;
+// lists that mix the two are handled item by item.
+//
+// Int results wrap around on overflow. Real sums are computed with
+// several accumulators, so the additions happen in a different
+// order than a while loop would do them, and the last bits of the
+// result may differ.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include "ram.h"
+
+
+//
+// What kind of numbers does a list hold?
+//
+enum VECTOR_TYPES
+{
+  VECTOR_NOT_NUMERIC = 0,  // some item is not an int or real
+  VECTOR_INT,              // only ints (or nothing at all)
+  VECTOR_REAL,             // only reals
+  VECTOR_MIXED             // ints and reals
+};
+
+
+//
+// vector_type
+//
+// Returns the kind of numbers the list holds (see above).
+//
+int vector_type(struct RAM_LIST* list);
+
+//
+// vector_sum
+//
+// Returns the sum of the items: an int if the list holds only
+// ints, a real otherwise. The sum of an empty list is 0.
+//
+struct RAM_VALUE vector_sum(struct RAM_LIST* xs, int type);
+
+//
+// vector_min / vector_max
+//
+// Returns the smallest / largest item, which must exist (the list
+// is not empty). As in Python, the result is the item itself, so
+// min([1, 2.5]) is the int 1.
+//
+struct RAM_VALUE vector_min(struct RAM_LIST* xs, int type);
+struct RAM_VALUE vector_max(struct RAM_LIST* xs, int type);
+
+//
+// vector_dot
+//
+// Returns the dot product of two lists of the same length: an
+// int if both hold only ints, a real otherwise.
+//
+struct RAM_VALUE vector_dot(struct RAM_LIST* xs, int xtype, struct RAM_LIST* ys, int ytype);
+
+//
+// vector_add
+//
+// Stores xs[i] + ys[i] for each i into result, which must be an
+// empty list with room for all of them. Each sum is an int if
+// both items are ints, a real otherwise.
+//
+void vector_add(struct RAM_LIST* xs, int xtype, struct RAM_LIST* ys, int ytype, struct RAM_LIST* result);
+
+//
+// vector_scale
+//
+// Stores xs[i] * k for each i into result, which must be an empty
+// list with room for all of them; k is an int or a real. Each
+// product is an int if both numbers are ints, a real otherwise.
+//
+void vector_scale(struct RAM_LIST* xs, int xtype, struct RAM_VALUE k, struct RAM_LIST* result);
@@ -18,79 +18,57 @@
 #include "buildings.h"
 #include "footways.h"
 #include "osm.h"
-#include "tinyxml2.h"
+#include "osmextractor.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
-// readMapBuildings
+// registerWith
 //
-// Given an XML document, reads through the document and 
-// stores all the buildings into the given vector.
+// Registers with the extractor for the university buildings of
+// the map, which are then read by readMapBuilding as the map is
+// read.
 //
-void Buildings::readMapBuildings(XMLDocument& xmldoc)
+void Buildings::registerWith(OSMExtractor& extractor)
 {
-  XMLElement* osm = xmldoc.FirstChildElement("osm");
-  assert(osm != nullptr);
+  uint64_t building = extractor.defineFeature({ { "building", "university" } });
 
-  //
-  // Parse the XML document way by way, looking for university buildings:
-  //
-  XMLElement* way = osm->FirstChildElement("way");
-
-  while (way != nullptr)
-  {
-    const XMLAttribute* attr = way->FindAttribute("id");
-    assert(attr != nullptr);
-
-    //
-    // if this is a building, store info into vector:
-    //
-    if (osmContainsKeyValue(way, "building", "university"))
+  extractor.registerHandler(OSMElement::WAY, building, [this](const OSMElement& e)
     {
-      string name = osmGetKeyValue(way, "name");
-
-      string streetAddr = osmGetKeyValue(way, "addr:housenumber")
-        + " "
-        + osmGetKeyValue(way, "addr:street");
-
-      //
-      // create building object, then add the associated
-      // node ids to the object:
-      //
-      long long id = attr->Int64Value();
-
-      Building B(id, name, streetAddr);
-
-      XMLElement* nd = way->FirstChildElement("nd");
-
-      while (nd != nullptr)
-      {
-        const XMLAttribute* ndref = nd->FindAttribute("ref");
-        assert(ndref != nullptr);
-
-        long long id = ndref->Int64Value();
+      this->readMapBuilding(e);
+    });
+}
 
-        B.add(id);
+//
+// readMapBuilding
+//
+// Given a university building of the map as it is read, stores
+// it into the vector.
+//
+void Buildings::readMapBuilding(const OSMElement& e)
+{
+  string name = osmGetKeyValue(e, "name");
 
-        // advance to next node ref:
-        nd = nd->NextSiblingElement("nd");
-      }
+  string streetAddr = osmGetKeyValue(e, "addr:housenumber")
+    + " "
+    + osmGetKeyValue(e, "addr:street");
 
-      //
-      // add the building to the vector:
-      //
-      this->MapBuildings.push_back(B);
-    }//if
+  //
+  // create building object, then add the associated
+  // node ids to the object:
+  //
+  Building B(e.ID, name, streetAddr);
 
-    way = way->NextSiblingElement("way");
-  }//while
+  for (long long id : e.NodeIDs)
+  {
+    B.add(id);
+  }
 
   //
-  // done:
+  // add the building to the vector:
   //
+  this->MapBuildings.push_back(B);
 }
 
 //
@@ -16,10 +16,10 @@
 
 #include "building.h"
 #include "footways.h"
-#include "tinyxml2.h"
+#include "osm.h"
+#include "osmextractor.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
@@ -31,12 +31,21 @@ public:
   vector<Building> MapBuildings;
 
   //
-  // readMapBuildings
+  // registerWith
   //
-  // Given an XML document, reads through the document and 
-  // stores all the buildings into the given vector.
+  // Registers with the extractor for the university buildings of
+  // the map, which are then read by readMapBuilding as the map is
+  // read.
   //
-  void readMapBuildings(XMLDocument& xmldoc);
+  void registerWith(OSMExtractor& extractor);
+
+  //
+  // readMapBuilding
+  //
+  // Given a university building of the map as it is read, stores
+  // it into the vector.
+  //
+  void readMapBuilding(const OSMElement& e);
 
   //
   // accessors / getters
@@ -15,73 +15,51 @@
 
 #include "footways.h"
 #include "osm.h"
-#include "tinyxml2.h"
+#include "osmextractor.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
-// readMapFootways
+// registerWith
 //
-// Given an XML document, reads through the document and 
-// stores all the footways into the given vector.
+// Registers with the extractor for the footways of the map,
+// which are then read by readMapFootway as the map is read.
 //
-void Footways::readMapFootways(XMLDocument& xmldoc)
+void Footways::registerWith(OSMExtractor& extractor)
 {
-  XMLElement* osm = xmldoc.FirstChildElement("osm");
-  assert(osm != nullptr);
+  uint64_t footway = extractor.defineFeature({
+    { "highway", "footway" }, { "area:highway", "footway" } });
 
+  extractor.registerHandler(OSMElement::WAY, footway, [this](const OSMElement& e)
+    {
+      this->readMapFootway(e);
+    });
+}
+
+//
+// readMapFootway
+//
+// Given a footway of the map as it is read, stores it into the
+// vector.
+//
+void Footways::readMapFootway(const OSMElement& e)
+{
   //
-  // Parse the XML document way by way, looking for university buildings:
+  // create footway object, then add the associated
+  // node ids to the object:
   //
-  XMLElement* way = osm->FirstChildElement("way");
+  Footway F(e.ID);
 
-  while (way != nullptr)
+  for (long long id : e.NodeIDs)
   {
-    const XMLAttribute* attr = way->FindAttribute("id");
-    assert(attr != nullptr);
-
-    //
-    // if this is a building, store info into vector:
-    //
-    if (osmContainsKeyValue(way, "highway", "footway") || osmContainsKeyValue(way, "area:highway", "footway"))
-    {
-      //
-      // create footway object, then add the associated
-      // node ids to the object:
-      //
-      long long id = attr->Int64Value();
-
-      Footway F(id);
-
-      XMLElement* nd = way->FirstChildElement("nd");
-
-      while (nd != nullptr)
-      {
-        const XMLAttribute* ndref = nd->FindAttribute("ref");
-        assert(ndref != nullptr);
-
-        long long id = ndref->Int64Value();
-
-        F.add(id);
-
-        // advance to next node ref:
-        nd = nd->NextSiblingElement("nd");
-      }
-
-      //
-      // add the footway to the vector:
-      //
-      this->MapFootways.push_back(F);
-    }//if
-
-    way = way->NextSiblingElement("way");
-  }//while
+    F.add(id);
+  }
 
   //
-  // done:
+  // add the footway to the vector:
   //
+  this->MapFootways.push_back(F);
 }
 
 //
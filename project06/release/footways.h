@@ -14,10 +14,10 @@
 #include <iostream>
 
 #include "footway.h"
-#include "tinyxml2.h"
+#include "osm.h"
+#include "osmextractor.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
@@ -29,12 +29,20 @@ public:
   vector<Footway> MapFootways;
 
   //
-  // readMapFootways
+  // registerWith
   //
-  // Given an XML document, reads through the document and 
-  // stores all the footways into the given vector.
+  // Registers with the extractor for the footways of the map,
+  // which are then read by readMapFootway as the map is read.
   //
-  void readMapFootways(XMLDocument& xmldoc);
+  void registerWith(OSMExtractor& extractor);
+
+  //
+  // readMapFootway
+  //
+  // Given a footway of the map as it is read, stores it into the
+  // vector.
+  //
+  void readMapFootway(const OSMElement& e);
 
   //
   // accessors / getters
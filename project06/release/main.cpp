@@ -19,21 +19,39 @@
 #include "footway.h"
 #include "footways.h"
 #include "osm.h"
-#include "tinyxml2.h"
+#include "osmextractor.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
 // main
 //
-int main()
+// usage: a.out [-nodes map|sorted|eytzinger]
+//
+// The option picks how the nodes are kept (see nodes.h); the
+// default is map.
+//
+int main(int argc, char* argv[])
 {
-  XMLDocument xmldoc;
-  Nodes nodes;
+  Nodes::Backends backend = Nodes::MAP;
+
+  if (argc == 3 && string(argv[1]) == "-nodes" && string(argv[2]) == "map")
+    backend = Nodes::MAP;
+  else if (argc == 3 && string(argv[1]) == "-nodes" && string(argv[2]) == "sorted")
+    backend = Nodes::SORTED;
+  else if (argc == 3 && string(argv[1]) == "-nodes" && string(argv[2]) == "eytzinger")
+    backend = Nodes::EYTZINGER;
+  else if (argc != 1)
+  {
+    cout << "usage: " << argv[0] << " [-nodes map|sorted|eytzinger]" << endl;
+    return 0;
+  }
+
+  Nodes nodes(backend);
   Buildings buildings;
   Footways footways;
+  OSMExtractor extractor;
   
   cout << "** NU open street map **" << endl;
 
@@ -44,34 +62,29 @@ int main()
   getline(cin, filename);
 
   //
-  // 1. load XML-based map file 
+  // 1. read the XML-based map file in one pass, storing the nodes,
+  // which are the various known positions on the map, and the
+  // university buildings and footways as they are read:
   //
-  if (!osmLoadMapFile(filename, xmldoc))
+  nodes.registerWith(extractor);
+  buildings.registerWith(extractor);
+  footways.registerWith(extractor);
+
+  if (!extractor.readMapFile(filename))
   {
     // failed, error message already output
     return 0;
   }
-  
-  //
-  // 2. read the nodes, which are the various known positions on the map:
-  //
-  nodes.readMapNodes(xmldoc);
-
-  //
-  // 3. read the university buildings and footways:
-  //
-  buildings.readMapBuildings(xmldoc);
-  footways.readMapFootways(xmldoc);
 
   //
-  // 4. stats
+  // 2. stats
   //
   cout << "# of nodes: " << nodes.getNumMapNodes() << endl;
   cout << "# of buildings: " << buildings.getNumMapBuildings() << endl;
   cout << "# of footways: " << footways.getNumMapFootways() << endl;
 
   //
-  // 5. now let the user for search for 1 or more buildings:
+  // 3. now let the user for search for 1 or more buildings:
   //
   while (true)
   {
@@ -9,10 +9,6 @@
 // 
 // References:
 // 
-// TinyXML: 
-//   files: https://github.com/leethomason/tinyxml2
-//   docs:  http://leethomason.github.io/tinyxml2/
-// 
 // OpenStreetMap: https://www.openstreetmap.org
 // OpenStreetMap docs:  
 //   https://wiki.openstreetmap.org/wiki/Main_Page
@@ -30,62 +26,75 @@
 
 #include "nodes.h"
 #include "osm.h"
-#include "tinyxml2.h"
+#include "osmextractor.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
-// readMapNodes
-//
-// Given an XML document, reads through the document and 
-// stores all the nodes into the given vector. Each node
-// is a point on the map, with a unique id along with 
-// (lat, lon) position. Some nodes are entrances to buildings,
-// which we capture as well.
+// constructor
 //
-void Nodes::readMapNodes(XMLDocument& xmldoc)
+Nodes::Nodes(Backends backend)
+  : Backend(backend)
 {
-  XMLElement* osm = xmldoc.FirstChildElement("osm");
-  assert(osm != nullptr);
+  // map and vector are default initialized by their constructors
+}
+
 
+//
+// registerWith
+//
+// Registers with the extractor for all the nodes of the map,
+// which are then read by readMapNode as the map is read, and
+// put in order by finishMapNodes once it has been read.
+//
+void Nodes::registerWith(OSMExtractor& extractor)
+{
   //
-  // Parse the XML document node by node: 
+  // is a node an entrance? Check for a 
+  // standard entrance, the main entrance, or
+  // one-way entrance.
   //
-  XMLElement* node = osm->FirstChildElement("node");
+  this->Entrance = extractor.defineFeature({
+    { "entrance", "yes" }, { "entrance", "main" }, { "entrance", "entrance" } });
 
-  while (node != nullptr)
-  {
-    const XMLAttribute* attrId = node->FindAttribute("id");
-    const XMLAttribute* attrLat = node->FindAttribute("lat");
-    const XMLAttribute* attrLon = node->FindAttribute("lon");
+  extractor.registerHandler(OSMElement::NODE, 0, [this](const OSMElement& e)
+    {
+      this->readMapNode(e);
+    });
 
-    assert(attrId != nullptr);
-    assert(attrLat != nullptr);
-    assert(attrLon != nullptr);
+  extractor.registerDoneHandler([this]()
+    {
+      this->finishMapNodes();
+    });
+}
 
-    long long id = attrId->Int64Value();
-    double latitude = attrLat->DoubleValue();
-    double longitude = attrLon->DoubleValue();
 
-    //
-    // is this node an entrance? Check for a 
-    // standard entrance, the main entrance, or
-    // one-way entrance.
-    //
-    bool entrance = false;
+//
+// readMapNode
+//
+// Given a node of the map as it is read, stores it. Each node
+// is a point on the map, with a unique id along with (lat, lon)
+// position. Some nodes are entrances to buildings, which we
+// capture as well.
+//
+void Nodes::readMapNode(const OSMElement& e)
+{
+  long long id = e.ID;
+  double latitude = e.Lat;
+  double longitude = e.Lon;
 
-    if (osmContainsKeyValue(node, "entrance", "yes") ||
-      osmContainsKeyValue(node, "entrance", "main") ||
-      osmContainsKeyValue(node, "entrance", "entrance"))
-    {
-      entrance = true;
-    }
+  //
+  // is this node an entrance? classified as it was read:
+  //
+  bool entrance = (e.Features & this->Entrance) != 0;
 
+  //
+  // Add node to map, or a record of it to the flat array, which
+  // is put in order once all the nodes have been read:
+  //
+  if (this->Backend == MAP) {
     //
-    // Add node to vector:
-    // 
     // This creates an object then pushes copy into vector:
     //
     //   Node N(id, latitude, longitude, entrance);
@@ -94,12 +103,152 @@ void Nodes::readMapNodes(XMLDocument& xmldoc)
     // This creates just one object "emplace":
     //
     this->MapNodes.emplace(id, Node(id, latitude, longitude, entrance));
+  }
+  else {
+    assert(!this->Finished);
+
+    this->FlatNodes.push_back(NodeRecord{ id, latitude, longitude, entrance });
+  }
+}
+
+
+//
+// finishMapNodes
+//
+// Puts the nodes in order for find, once all of them have been
+// read. If a node id is read more than once, the first is kept.
+//
+void Nodes::finishMapNodes()
+{
+  if (this->Backend == MAP || this->Finished)  // a map is always in order
+    return;
+
+  vector<NodeRecord>& records = this->FlatNodes;
+
+  //
+  // the ids arrive almost sorted, usually sorted; a stable sort
+  // keeps the first of any duplicates first:
+  //
+  auto byID = [](const NodeRecord& R1, const NodeRecord& R2) { return R1.ID < R2.ID; };
+
+  if (!is_sorted(records.begin(), records.end(), byID))
+    stable_sort(records.begin(), records.end(), byID);
+
+  auto last = unique(records.begin(), records.end(),
+    [](const NodeRecord& R1, const NodeRecord& R2) { return R1.ID == R2.ID; });
+
+  records.erase(last, records.end());
+
+  if (this->Backend == EYTZINGER)
+  {
+    //
+    // lay the sorted records out as a tree, by visiting the tree
+    // in order --- leftmost node first --- and filling each node
+    // with the next record:
+    //
+    size_t n = records.size();
+    vector<NodeRecord> tree(n + 1);
+    size_t k = 1;
+
+    while (2 * k <= n)
+      k = 2 * k;
+
+    for (const NodeRecord& R : records)
+    {
+      tree[k] = R;
+
+      if (2 * k + 1 <= n) {  // leftmost node of the right subtree:
+        k = 2 * k + 1;
+        while (2 * k <= n)
+          k = 2 * k;
+      }
+      else {  // up past the right children we came from:
+        while (k & 1)
+          k >>= 1;
+        k >>= 1;
+      }
+    }
+
+    records.swap(tree);
+  }
 
+  records.shrink_to_fit();
+  this->Finished = true;
+}
+
+
+//
+// findSorted
+//
+// Binary search of the sorted records: the range the id may be in
+// is halved until one record is left, choosing the half with a
+// conditional move rather than a branch, so there are no branch
+// mispredictions, and the loop runs the same log2(N) times for
+// every id.
+//
+bool Nodes::findSorted(long long id, const NodeRecord*& found) const
+{
+  size_t n = this->FlatNodes.size();
+
+  if (n == 0)
+    return false;
+
+  const NodeRecord* base = this->FlatNodes.data();
+
+  while (n > 1)
+  {
+    size_t half = n / 2;
+
+    base = (base[half].ID <= id) ? base + half : base;
+    n -= half;
+  }
+
+  found = base;
+
+  return base->ID == id;
+}
+
+
+//
+// findEytzinger
+//
+// Search of the records laid out as a tree: going left or right
+// is 2k or 2k+1, without a branch, and the records 2 levels down
+// are prefetched while this level is compared. At the end, k has
+// gone past a leaf; the bits of k record the turns taken, and
+// shifting off the right turns after the last left turn gives the
+// first record >= id.
+//
+bool Nodes::findEytzinger(long long id, const NodeRecord*& found) const
+{
+  if (this->FlatNodes.empty())
+    return false;
+
+  const NodeRecord* tree = this->FlatNodes.data();
+  size_t n = this->FlatNodes.size() - 1;
+  size_t k = 1;
+
+  while (k <= n)
+  {
     //
-    // next node element in the XML doc:
+    // the 4 grandchildren 4k .. 4k+3 are 2 cache lines; near the
+    // leaves they're past the end, so the index is clamped to the
+    // last record, which keeps the pointer inside the array:
     //
-    node = node->NextSiblingElement("node");
+    __builtin_prefetch(tree + min(4 * k, n));
+    __builtin_prefetch(tree + min(4 * k + 2, n));
+
+    k = 2 * k + (tree[k].ID < id);
   }
+
+  k >>= __builtin_ffsll(~k);
+
+  if (k == 0)  // id is greater than them all
+    return false;
+
+  found = &tree[k];
+
+  return tree[k].ID == id;
 }
 
 
@@ -112,68 +261,46 @@ void Nodes::readMapNodes(XMLDocument& xmldoc)
 //
 bool Nodes::find(long long id, double& lat, double& lon, bool& isEntrance) const
 {
-  auto ptr = this->MapNodes.find(id);
-  if (ptr == this->MapNodes.end()) { // not found:
-    return false;
-  }
-  else { // found:
-    lat = ptr->second.getLat();
-    lon = ptr->second.getLon();
-    isEntrance = ptr->second.getIsEntrance();
-
-    return true;
-  }
-  //
-  // linear search:
-  //
-  /*
-  for (Node& N : this->MapNodes)
+  if (this->Backend == MAP)
   {
-    if (N.getID() == id) {
-      lat = N.getLat();
-      lon = N.getLon();
-      isEntrance = N.getIsEntrance();
+    auto ptr = this->MapNodes.find(id);
+    if (ptr == this->MapNodes.end()) { // not found:
+      return false;
+    }
+    else { // found:
+      lat = ptr->second.getLat();
+      lon = ptr->second.getLon();
+      isEntrance = ptr->second.getIsEntrance();
 
       return true;
     }
   }
-  */
 
-  //
-  // binary search:
-  //
-  // int low = 0; 
-  // int high = (int)this->MapNodes.size() - 1;
-
-  // while (low <= high) {
-  //   int mid = low + ((high - low) / 2);
-
-  //   long long nodeid = this->MapNodes[mid].getID();
-
-  //   if (id == nodeid) { // found!
-  //     lat = this->MapNodes[mid].getLat();
-  //     lon = this->MapNodes[mid].getLon();
-  //     isEntrance = this->MapNodes[mid].getIsEntrance();
-
-  //     return true;
-  //   }
-  //   else if (id < nodeid) { // search left:
-  //     high = mid - 1;
-  //   }
-  //   else { // search right:
-  //     low = mid + 1; 
-  //   }
-  // }//while
-
-  // //
-  // // if get here, not found:
-  // //
-  // return false;
+  assert(this->Finished);
+
+  const NodeRecord* R = nullptr;
+  bool found = (this->Backend == SORTED) ? this->findSorted(id, R) : this->findEytzinger(id, R);
+
+  if (!found) { // not found:
+    return false;
+  }
+  else { // found:
+    lat = R->Lat;
+    lon = R->Lon;
+    isEntrance = R->IsEntrance;
+
+    return true;
+  }
 }
 
 //
 // accessors / getters
 //
 int Nodes::getNumMapNodes() {
-  return (int) this->MapNodes.size();
+  if (this->Backend == MAP)
+    return (int) this->MapNodes.size();
+  else if (this->Backend == EYTZINGER && this->Finished)
+    return (int) this->FlatNodes.size() - 1;  // [0] is unused
+  else
+    return (int) this->FlatNodes.size();
 }
@@ -0,0 +1,224 @@
+/*nodesbench.cpp*/
+
+//
+// Benchmark of the Nodes backends (see nodes.h): loads the same
+// synthetic nodes into each, then times Nodes::find on
+//
+//   hits     ids of nodes, in random order
+//   misses   ids in the same range that aren't nodes
+//   ways     runs of 8 consecutive nodes from random places,
+//            like the nodes of a building or footway
+//
+// and checks that every backend finds the same nodes. Sizes go
+// from 10K nodes up, by factors of 10:
+//
+//   ./nodesbench.out [max # of nodes, default 1000000]
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#ifdef __GLIBC__
+#include <malloc.h>  // mallinfo2
+#endif
+
+#include "nodes.h"
+#include "osm.h"
+
+using namespace std;
+
+
+static const int NUM_LOOKUPS = 1000000;  // of each kind
+static const int WAY_LENGTH = 8;
+
+
+//
+// liveKB
+//
+// Returns the heap in use right now, in KB, or 0 if the C library
+// can't tell us.
+//
+static long liveKB()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 info = mallinfo2();
+
+  return (long)((info.uordblks + info.hblkhd) / 1024);
+#else
+  return 0;
+#endif
+}
+
+//
+// seconds
+//
+// Returns the seconds since the given time.
+//
+static double seconds(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+//
+// generate
+//
+// Returns n nodes as they would be read from a map: ids increasing
+// by small gaps, with a few out of order, about 1 in 10 an entrance.
+//
+static vector<OSMElement> generate(int n, mt19937_64& random)
+{
+  vector<OSMElement> elements(n);
+  long long id = 1000000000;
+  uniform_real_distribution<double> position(0.0, 0.1);
+
+  for (OSMElement& e : elements)
+  {
+    id += 1 + random() % 7;
+
+    e.Kind = OSMElement::NODE;
+    e.ID = id;
+    e.Lat = 42.0 + position(random);
+    e.Lon = -87.7 + position(random);
+    e.Features = (random() % 10 == 0) ? 1 : 0;
+  }
+
+  for (int i = 0; i + 1 < n; i += 100)  // almost sorted
+    swap(elements[i], elements[i + 1]);
+
+  return elements;
+}
+
+//
+// lookup
+//
+// Finds each of the given ids, returning the time per id in ns, and
+// a checksum of what was found via sum.
+//
+static double lookup(const Nodes& nodes, const vector<long long>& ids, double& sum)
+{
+  double lat, lon;
+  bool entrance;
+
+  sum = 0.0;
+
+  auto start = chrono::steady_clock::now();
+
+  for (long long id : ids)
+  {
+    if (nodes.find(id, lat, lon, entrance))
+      sum += lat + lon + entrance;
+    else
+      sum += 1.0;
+  }
+
+  return seconds(start) * 1e9 / ids.size();
+}
+
+
+//
+// main
+//
+// usage: nodesbench.out [max # of nodes]
+//
+int main(int argc, char* argv[])
+{
+  int max = (argc > 1) ? atoi(argv[1]) : 1000000;
+  bool ok = true;
+
+  struct
+  {
+    string name;
+    Nodes::Backends backend;
+  } backends[] = { { "map", Nodes::MAP }, { "sorted", Nodes::SORTED }, { "eytzinger", Nodes::EYTZINGER } };
+
+  for (int n = 10000; n <= max; n *= 10)
+  {
+    mt19937_64 random(n);
+    vector<OSMElement> elements = generate(n, random);
+
+    //
+    // the ids to look up:
+    //
+    vector<long long> hits, misses, ways;
+
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+      const OSMElement& e = elements[random() % n];
+
+      hits.push_back(e.ID);
+      misses.push_back(e.ID + 1 + (long long)(random() % 2) * n * 10);  // a gap, or past the end
+    }
+
+    sort(elements.begin(), elements.end(), [](const OSMElement& e1, const OSMElement& e2) { return e1.ID < e2.ID; });
+
+    for (int i = 0; i < NUM_LOOKUPS / WAY_LENGTH; i++)
+    {
+      int start = random() % (n - WAY_LENGTH);
+
+      for (int j = 0; j < WAY_LENGTH; j++)
+        ways.push_back(elements[start + j].ID);
+    }
+
+    shuffle(elements.begin(), elements.end() - n / 2, random);  // the first half read out of order
+
+    cout << n << " nodes:" << endl;
+
+    double expected[3];
+
+    for (int b = 0; b < 3; b++)
+    {
+      long before = liveKB();
+      auto start = chrono::steady_clock::now();
+
+      Nodes nodes(backends[b].backend);
+      OSMExtractor extractor;
+
+      nodes.registerWith(extractor);  // for the entrance feature, 1
+
+      for (const OSMElement& e : elements)
+        nodes.readMapNode(e);
+
+      nodes.finishMapNodes();
+
+      double load = seconds(start);
+      long memory = liveKB() - before;
+
+      double sums[3];
+      double hit = lookup(nodes, hits, sums[0]);
+      double miss = lookup(nodes, misses, sums[1]);
+      double way = lookup(nodes, ways, sums[2]);
+
+      bool same = (nodes.getNumMapNodes() == n);
+
+      for (int i = 0; i < 3; i++)
+      {
+        if (b == 0)
+          expected[i] = sums[i];
+        else
+          same = same && sums[i] == expected[i];
+      }
+
+      cout << "  " << setw(9) << left << backends[b].name << right << fixed
+        << " load " << setprecision(3) << setw(6) << load << " s, "
+        << setw(8) << setprecision(1) << memory / 1024.0 << " MB; find (ns): "
+        << "hits " << setw(6) << hit
+        << ", misses " << setw(6) << miss
+        << ", ways " << setw(6) << way
+        << (same ? "" : " (**WRONG**)") << endl;
+
+      ok = ok && same;
+    }
+  }
+
+  cout << (ok ? "ok" : "**FAILED") << endl;
+
+  return ok ? 0 : -1;
+}
@@ -9,10 +9,6 @@
 // 
 // References:
 // 
-// TinyXML: 
-//   files: https://github.com/leethomason/tinyxml2
-//   docs:  http://leethomason.github.io/tinyxml2/
-// 
 // OpenStreetMap: https://www.openstreetmap.org
 // OpenStreetMap docs:  
 //   https://wiki.openstreetmap.org/wiki/Main_Page
@@ -20,50 +16,451 @@
 //   https://wiki.openstreetmap.org/wiki/Node
 //   https://wiki.openstreetmap.org/wiki/Way
 //   https://wiki.openstreetmap.org/wiki/Relation
+//   https://wiki.openstreetmap.org/wiki/OSM_XML
 //
 
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <string_view>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
 #include <cassert>
 
 #include "osm.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
-// osmLoadMapFile
-// 
-// Given the filename for an XML doc, tries to open and load
-// that file into the given xmldoc variable (which is passed
-// by reference). Returns true if successful, false if the 
-// file could not be opened OR the file does not contain 
-// an Open Street Map document.
+// The file is read a chunk at a time, so memory stays proportional
+// to what the collections keep, not to the size of the file:
+//
+static const size_t CHUNK_SIZE = 64 * 1024;
+
+//
+// OSMReader
+//
+// The state of a map file being read: the text read but not yet
+// parsed, which always starts at a chunk boundary or a markup '<',
+// and how deep we are in the elements.
+//
+struct OSMReader
+{
+  ifstream File;
+  string   Text;
+  size_t   Pos = 0;   // next char to parse
+  int      Depth = 0;
+  bool     SawOSM = false;
+  bool     InElement = false;  // reading a node or way?
+};
+
+
+//
+// fill
+//
+// Drops the text that has been parsed, and appends the next chunk
+// of the file. Returns false at the end of the file.
 //
-bool osmLoadMapFile(string filename, XMLDocument& xmldoc)
+static bool fill(OSMReader& reader)
 {
+  reader.Text.erase(0, reader.Pos);
+  reader.Pos = 0;
+
+  size_t length = reader.Text.size();
+
+  reader.Text.resize(length + CHUNK_SIZE);
+  reader.File.read(&reader.Text[length], CHUNK_SIZE);
+  reader.Text.resize(length + (size_t)reader.File.gcount());
+
+  return reader.Text.size() > length;
+}
+
+
+//
+// nextMarkup
+//
+// Finds the next markup --- a tag, comment, declaration, ... ---
+// skipping the text before it, and returns it via markup, from
+// its '<' to its '>'. The view is good until the next call.
+// Returns false at the end of the file, with truncated set if the
+// file ends in the middle of the markup.
+//
+static bool nextMarkup(OSMReader& reader, string_view& markup, bool& truncated)
+{
+  truncated = false;
+
   //
-  // load the XML document:
+  // find the '<', reading on as need be:
   //
-  xmldoc.LoadFile(filename.c_str());
+  size_t start;
+
+  while ((start = reader.Text.find('<', reader.Pos)) == string::npos)
+  {
+    reader.Pos = reader.Text.size();  // text between elements, ignored
+
+    if (!fill(reader))
+      return false;
+  }
+
+  reader.Pos = start;
+
+  //
+  // find the end, which depends on the kind of markup: an end
+  // tag can't be inside a comment, and a '>' can be in a quoted
+  // attribute value:
+  //
+  for (;;)
+  {
+    const string& text = reader.Text;
+    size_t end = string::npos;
+
+    if (text.size() - reader.Pos >= 9 || reader.File.eof())  // enough to tell the kind
+    {
+      if (text.compare(reader.Pos, 4, "<!--") == 0) {
+        end = text.find("-->", reader.Pos + 4);
+        if (end != string::npos)
+          end += 2;
+      }
+      else if (text.compare(reader.Pos, 9, "<![CDATA[") == 0) {
+        end = text.find("]]>", reader.Pos + 9);
+        if (end != string::npos)
+          end += 2;
+      }
+      else {
+        char quote = '\0';
+
+        for (size_t i = reader.Pos + 1; i < text.size(); i++)
+        {
+          char c = text[i];
+
+          if (quote != '\0') {
+            if (c == quote)
+              quote = '\0';
+          }
+          else if (c == '"' || c == '\'') {
+            quote = c;
+          }
+          else if (c == '>') {
+            end = i;
+            break;
+          }
+        }
+      }
+    }
+
+    if (end != string::npos)
+    {
+      markup = string_view(text.data() + reader.Pos, end + 1 - reader.Pos);
+      reader.Pos = end + 1;
+      return true;
+    }
+
+    //
+    // not all there yet:
+    //
+    if (!fill(reader)) {
+      truncated = true;
+      return false;
+    }
+  }
+}
+
+
+//
+// decode
+//
+// Returns the given attribute value with its character references
+// (&amp;, &#65;, ...) replaced by the characters.
+//
+static string decode(string_view value)
+{
+  string s;
+
+  if (value.find('&') == string_view::npos) {
+    s.assign(value.data(), value.size());
+    return s;
+  }
+
+  for (size_t i = 0; i < value.size(); i++)
+  {
+    size_t semi = value.find(';', i);
+
+    if (value[i] != '&' || semi == string_view::npos) {
+      s += value[i];
+      continue;
+    }
+
+    string_view name = value.substr(i + 1, semi - i - 1);
+
+    if (name == "amp") s += '&';
+    else if (name == "lt") s += '<';
+    else if (name == "gt") s += '>';
+    else if (name == "quot") s += '"';
+    else if (name == "apos") s += '\'';
+    else if (name.size() > 1 && name[0] == '#')
+    {
+      bool hex = (name[1] == 'x' || name[1] == 'X');
+      unsigned long code = strtoul(string(name.substr(hex ? 2 : 1)).c_str(), nullptr, hex ? 16 : 10);
+
+      //
+      // as UTF-8:
+      //
+      if (code < 0x80)
+        s += (char)code;
+      else if (code < 0x800) {
+        s += (char)(0xC0 | (code >> 6));
+        s += (char)(0x80 | (code & 0x3F));
+      }
+      else if (code < 0x10000) {
+        s += (char)(0xE0 | (code >> 12));
+        s += (char)(0x80 | ((code >> 6) & 0x3F));
+        s += (char)(0x80 | (code & 0x3F));
+      }
+      else {
+        s += (char)(0xF0 | (code >> 18));
+        s += (char)(0x80 | ((code >> 12) & 0x3F));
+        s += (char)(0x80 | ((code >> 6) & 0x3F));
+        s += (char)(0x80 | (code & 0x3F));
+      }
+    }
+    else {  // unknown, keep as is
+      s += value[i];
+      continue;
+    }
+
+    i = semi;
+  }
+
+  return s;
+}
+
+
+//
+// nextAttribute
+//
+// Returns the next attribute of a start tag, starting at pos, via
+// name and value, the value undecoded. Returns false when there
+// are no more.
+//
+static bool nextAttribute(string_view tag, size_t& pos, string_view& name, string_view& value)
+{
+  const char* spaces = " \t\r\n";
+
+  pos = tag.find_first_not_of(spaces, pos);
+  if (pos == string_view::npos || tag[pos] == '/' || tag[pos] == '>')
+    return false;
+
+  size_t equals = tag.find('=', pos);
+  if (equals == string_view::npos)
+    return false;
+
+  name = tag.substr(pos, equals - pos);
+  name = name.substr(0, name.find_last_not_of(spaces) + 1);
+
+  size_t open = tag.find_first_of("\"'", equals);
+  if (open == string_view::npos)
+    return false;
+
+  size_t close = tag.find(tag[open], open + 1);
+  if (close == string_view::npos)
+    return false;
+
+  value = tag.substr(open + 1, close - open - 1);
+  pos = close + 1;
 
-  if (xmldoc.ErrorID() != 0)  // failed:
+  return true;
+}
+
+
+//
+// startElement
+//
+// Handles a start tag, self-closing or not: <osm>, the <node> and
+// <way> elements in it, and the <tag> and <nd> elements in those.
+// Everything else is skipped. Returns false if the file is not an
+// Open Street Map.
+//
+static bool startElement(OSMReader& reader, string_view tag, bool selfClosing,
+  OSMElement& element, function<void(OSMElement&)>& visit)
+{
+  size_t pos = tag.find_first_of(" \t\r\n/>", 1);
+  string_view elementName = tag.substr(1, pos - 1);
+  string_view name, value;
+
+  if (reader.Depth == 0)
+  {
+    if (elementName != "osm" || reader.SawOSM)
+      return false;
+
+    reader.SawOSM = true;
+  }
+  else if (reader.Depth == 1 && (elementName == "node" || elementName == "way"))
+  {
+    bool sawId = false, sawLat = false, sawLon = false;
+
+    element.Kind = (elementName == "node") ? OSMElement::NODE : OSMElement::WAY;
+    element.ID = 0;
+    element.Lat = 0.0;
+    element.Lon = 0.0;
+    element.Tags.clear();
+    element.NodeIDs.clear();
+
+    //
+    // the value ends with its quote, which stops the conversion:
+    //
+    while (nextAttribute(tag, pos, name, value))
+    {
+      if (name == "id") {
+        element.ID = strtoll(value.data(), nullptr, 10);
+        sawId = true;
+      }
+      else if (name == "lat") {
+        element.Lat = strtod(value.data(), nullptr);
+        sawLat = true;
+      }
+      else if (name == "lon") {
+        element.Lon = strtod(value.data(), nullptr);
+        sawLon = true;
+      }
+    }
+
+    assert(sawId);
+    assert(element.Kind == OSMElement::WAY || (sawLat && sawLon));
+
+    reader.InElement = true;
+  }
+  else if (reader.Depth == 2 && reader.InElement && elementName == "tag")
+  {
+    string_view k, v;
+    bool sawK = false, sawV = false;
+
+    while (nextAttribute(tag, pos, name, value))
+    {
+      if (name == "k") {
+        k = value;
+        sawK = true;
+      }
+      else if (name == "v") {
+        v = value;
+        sawV = true;
+      }
+    }
+
+    if (sawK && sawV)
+      element.Tags.emplace_back(decode(k), decode(v));
+  }
+  else if (reader.Depth == 2 && reader.InElement && elementName == "nd")
+  {
+    bool sawRef = false;
+
+    while (nextAttribute(tag, pos, name, value))
+    {
+      if (name == "ref") {
+        element.NodeIDs.push_back(strtoll(value.data(), nullptr, 10));
+        sawRef = true;
+      }
+    }
+
+    assert(sawRef);
+  }
+
+  if (selfClosing) {
+    if (reader.Depth == 1 && reader.InElement) {
+      visit(element);
+      reader.InElement = false;
+    }
+  }
+  else {
+    reader.Depth++;
+  }
+
+  return true;
+}
+
+
+//
+// osmReadMapFile
+//
+// Given the filename for an XML doc, reads through the file and
+// calls visit with each node and way in it, in order, as it is
+// read; the whole file is never in memory at once. The element is
+// reused for the next one once visit returns. Returns true
+// if successful, false if the file could not be opened, is not
+// well-formed, OR does not contain an Open Street Map document,
+// in which case the elements read before the problem was found
+// have already been visited.
+//
+bool osmReadMapFile(string filename, function<void(OSMElement&)> visit)
+{
+  OSMReader reader;
+  OSMElement element;
+  string_view markup;
+  bool truncated;
+  bool wellFormed = true;
+
+  reader.File.open(filename, ios::binary);
+
+  if (!reader.File.is_open())  // failed:
   {
     cout << "**ERROR: unable to open XML file '" << filename << "'." << endl;
     return false;
   }
 
+  while (nextMarkup(reader, markup, truncated))
+  {
+    if (markup.size() < 3 || markup[1] == '?' || markup[1] == '!')
+      continue;  // declaration, comment, CDATA, DOCTYPE
+
+    if (markup[1] == '/')  // end tag:
+    {
+      if (reader.Depth == 0) {  // no start tag for it
+        wellFormed = false;
+        break;
+      }
+
+      reader.Depth--;
+
+      if (reader.Depth == 1 && reader.InElement) {
+        visit(element);
+        reader.InElement = false;
+      }
+
+      continue;
+    }
+
+    //
+    // a tag must start with a name; anything else, e.g. in a file
+    // that isn't XML at all, isn't well-formed:
+    //
+    if (!isalpha((unsigned char)markup[1]) && markup[1] != '_' && markup[1] != ':') {
+      wellFormed = false;
+      break;
+    }
+
+    bool selfClosing = (markup[markup.size() - 2] == '/');
+
+    if (!startElement(reader, markup, selfClosing, element, visit))
+    {
+      //
+      // top-level element should be "osm" if the file is a valid open
+      // street map:
+      //
+      cout << "**ERROR: unable to find top-level 'osm' XML element." << endl;
+      cout << "**ERROR: this file is probably not an Open Street Map." << endl;
+      return false;
+    }
+  }
+
   //
-  // top-level element should be "osm" if the file is a valid open 
-  // street map:
+  // a file with no elements at all, e.g. text, isn't an XML doc
+  // either; one whose top-level element isn't "osm" was reported
+  // above:
   //
-  XMLElement* osm = xmldoc.FirstChildElement("osm");
-
-  if (osm == nullptr)
+  if (!wellFormed || truncated || reader.Depth != 0 || !reader.SawOSM)  // failed:
   {
-    cout << "**ERROR: unable to find top-level 'osm' XML element." << endl;
-    cout << "**ERROR: this file is probably not an Open Street Map." << endl;
+    cout << "**ERROR: unable to open XML file '" << filename << "'." << endl;
     return false;
   }
 
@@ -77,9 +474,9 @@ bool osmLoadMapFile(string filename, XMLDocument& xmldoc)
 //
 // osmContainsKeyValue
 //
-// Given a pointer to an XML Element, searches through all 
-// the tags associated with this element looking for the 
-// given (key, value) pair.  For example, the call
+// Given a node or way, searches through all the tags associated
+// with it looking for the given (key, value) pair.  For example,
+// the call
 //
 //   containsKeyValue(e, "entrance", "yes")
 //
@@ -87,30 +484,14 @@ bool osmLoadMapFile(string filename, XMLDocument& xmldoc)
 //
 //   <tag k="entrance" v="yes"/>
 //
-bool osmContainsKeyValue(XMLElement* e, string key, string value)
+bool osmContainsKeyValue(const OSMElement& e, string key, string value)
 {
-  XMLElement* tag = e->FirstChildElement("tag");
-
-  while (tag != nullptr)
+  for (const pair<string, string>& tag : e.Tags)
   {
-    const XMLAttribute* keyAttribute = tag->FindAttribute("k");
-    const XMLAttribute* valueAttribute = tag->FindAttribute("v");
-
-    if (keyAttribute != nullptr && valueAttribute != nullptr)
+    if (tag.first == key && tag.second == value)  // found it:
     {
-      string elemkey(keyAttribute->Value());
-      string elemvalue(valueAttribute->Value());
-
-      if (elemkey == key && elemvalue == value)  // found it:
-      {
-        return true;
-      }
+      return true;
     }
-
-    //
-    // not a match, try the next tag:
-    //
-    tag = tag->NextSiblingElement("tag");
   }
 
   //
@@ -123,10 +504,9 @@ bool osmContainsKeyValue(XMLElement* e, string key, string value)
 //
 // osmGetKeyValue
 //
-// Given a pointer to an XML Element, searches through all 
-// the tags associated with this element looking for the 
-// given key. If found, returns the associated value. For
-// example, given the call
+// Given a node or way, searches through all the tags associated
+// with it looking for the given key. If found, returns the
+// associated value. For example, given the call
 //
 //   getKeyValue(e, "entrance")
 //
@@ -136,31 +516,14 @@ bool osmContainsKeyValue(XMLElement* e, string key, string value)
 // 
 // If the key is not found, the empty string "" is returned.
 //
-string osmGetKeyValue(XMLElement* e, string key)
+string osmGetKeyValue(const OSMElement& e, string key)
 {
-  XMLElement* tag = e->FirstChildElement("tag");
-
-  while (tag != nullptr)
+  for (const pair<string, string>& tag : e.Tags)
   {
-    const XMLAttribute* keyAttribute = tag->FindAttribute("k");
-    const XMLAttribute* valueAttribute = tag->FindAttribute("v");
-
-    if (keyAttribute != nullptr && valueAttribute != nullptr)
+    if (tag.first == key)  // found it:
     {
-      string elemkey(keyAttribute->Value());
-      
-      if (elemkey == key)  // found it:
-      {
-        string elemvalue(valueAttribute->Value());
-
-        return elemvalue;
-      }
+      return tag.second;
     }
-
-    //
-    // not a match, try the next tag:
-    //
-    tag = tag->NextSiblingElement("tag");
   }
 
   //
@@ -9,10 +9,6 @@
 // 
 // References:
 // 
-// TinyXML: 
-//   files: https://github.com/leethomason/tinyxml2
-//   docs:  http://leethomason.github.io/tinyxml2/
-// 
 // OpenStreetMap: https://www.openstreetmap.org
 // OpenStreetMap docs:  
 //   https://wiki.openstreetmap.org/wiki/Main_Page
@@ -20,19 +16,47 @@
 //   https://wiki.openstreetmap.org/wiki/Node
 //   https://wiki.openstreetmap.org/wiki/Way
 //   https://wiki.openstreetmap.org/wiki/Relation
+//   https://wiki.openstreetmap.org/wiki/OSM_XML
 //
 
 #pragma once
 
-#include "tinyxml2.h"
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstdint>
 
 using namespace std;
-using namespace tinyxml2;
+
+
+//
+// OSMElement
+//
+// A node or way of the map, as the file is read: its id, its
+// position (nodes only), its tags as (key, value) pairs, and the
+// ids of its nodes (ways only). One element is read at a time, so
+// what a collection wants to keep it must copy. Features is set
+// when the element is classified (see osmextractor.h).
+//
+class OSMElement
+{
+public:
+  enum Kinds { NODE, WAY };
+
+  Kinds Kind;
+  long long ID;
+  double Lat;
+  double Lon;
+  vector<pair<string, string>> Tags;
+  vector<long long> NodeIDs;
+  uint64_t Features = 0;
+};
 
 
 //
 // Helper functions:
 //
-bool osmLoadMapFile(string filename, XMLDocument& xmldoc);
-bool osmContainsKeyValue(XMLElement* e, string key, string value);
-string osmGetKeyValue(XMLElement* e, string key);
+bool osmReadMapFile(string filename, function<void(OSMElement&)> visit);
+bool osmContainsKeyValue(const OSMElement& e, string key, string value);
+string osmGetKeyValue(const OSMElement& e, string key);
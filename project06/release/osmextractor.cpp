@@ -0,0 +1,139 @@
+/*osmextractor.cpp*/
+
+//
+// Extracts the features of an Open Street Map in one pass.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+
+#include "osmextractor.h"
+#include "osm.h"
+
+using namespace std;
+
+
+//
+// defineFeature
+//
+// Defines a feature: the elements with any of the given
+// (key, value) tags. Returns the feature, a bit of an element's
+// Features.
+//
+uint64_t OSMExtractor::defineFeature(vector<pair<string, string>> anyOf)
+{
+  assert(this->NumFeatures < 64);
+
+  uint64_t feature = (uint64_t)1 << this->NumFeatures;
+  this->NumFeatures++;
+
+  for (const pair<string, string>& tag : anyOf)
+  {
+    vector<pair<string, uint64_t>>& values = this->FeaturesByTag[tag.first];
+
+    //
+    // another feature with the same tag shares its entry:
+    //
+    bool found = false;
+
+    for (pair<string, uint64_t>& value : values)
+    {
+      if (value.first == tag.second) {
+        value.second |= feature;
+        found = true;
+      }
+    }
+
+    if (!found)
+      values.emplace_back(tag.second, feature);
+  }
+
+  return feature;
+}
+
+
+//
+// registerHandler
+//
+// Registers a handler to be called with each element of the
+// given kind that has the given feature, or with every element
+// of the kind if the feature is 0.
+//
+void OSMExtractor::registerHandler(OSMElement::Kinds kind, uint64_t feature, function<void(const OSMElement&)> handler)
+{
+  this->Handlers.push_back(Handler{ kind, feature, handler });
+}
+
+
+//
+// registerDoneHandler
+//
+// Registers a handler to be called once the whole map has been
+// read successfully.
+//
+void OSMExtractor::registerDoneHandler(function<void()> handler)
+{
+  this->DoneHandlers.push_back(handler);
+}
+
+
+//
+// dispatch
+//
+// Finds the features of the given element, looking at each of
+// its tags once, then calls the handlers interested in it.
+//
+void OSMExtractor::dispatch(OSMElement& e)
+{
+  e.Features = 0;
+
+  for (const pair<string, string>& tag : e.Tags)
+  {
+    auto ptr = this->FeaturesByTag.find(tag.first);
+
+    if (ptr == this->FeaturesByTag.end())  // no feature has this key:
+      continue;
+
+    for (const pair<string, uint64_t>& value : ptr->second)
+    {
+      if (value.first == tag.second)
+        e.Features |= value.second;
+    }
+  }
+
+  for (const Handler& handler : this->Handlers)
+  {
+    if (handler.Kind == e.Kind && (handler.Feature == 0 || (e.Features & handler.Feature) != 0))
+      handler.Handle(e);
+  }
+}
+
+
+//
+// readMapFile
+//
+// Reads the given map file, dispatching each element as it is
+// read, then calls the done handlers. Returns true if successful,
+// false if not.
+//
+bool OSMExtractor::readMapFile(string filename)
+{
+  bool success = osmReadMapFile(filename, [this](OSMElement& e)
+    {
+      this->dispatch(e);
+    });
+
+  if (!success)
+    return false;
+
+  for (const function<void()>& handler : this->DoneHandlers)
+    handler();
+
+  return true;
+}
@@ -0,0 +1,99 @@
+/*osmextractor.h*/
+
+//
+// Extracts the features of an Open Street Map in one pass.
+//
+// Clarissa Shieh
+// Northwestern University
+// CS 211
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+#include "osm.h"
+
+using namespace std;
+
+
+//
+// OSMExtractor
+//
+// Reads a map file once, handing each node and way to every
+// collection that registered for it. A collection first defines
+// the features it's interested in --- a building is a way tagged
+// building=university, say --- then registers a handler for the
+// elements with a feature (or all elements of a kind). As each
+// element is read, its tags are looked at once to find all its
+// features, which are then in the element's Features, and it is
+// dispatched to the interested handlers. A new kind of feature
+// adds a definition and a handler, not another pass over the map.
+//
+class OSMExtractor
+{
+private:
+  //
+  // a registered handler:
+  //
+  struct Handler
+  {
+    OSMElement::Kinds Kind;
+    uint64_t Feature;  // 0 => every element of the kind
+    function<void(const OSMElement&)> Handle;
+  };
+
+  //
+  // the features by tag: key => (value, features with that tag)
+  //
+  unordered_map<string, vector<pair<string, uint64_t>>> FeaturesByTag;
+  int NumFeatures = 0;
+
+  vector<Handler> Handlers;
+  vector<function<void()>> DoneHandlers;
+
+  void dispatch(OSMElement& e);
+
+public:
+  //
+  // defineFeature
+  //
+  // Defines a feature: the elements with any of the given
+  // (key, value) tags. Returns the feature, a bit of an element's
+  // Features. At most 64 features can be defined.
+  //
+  uint64_t defineFeature(vector<pair<string, string>> anyOf);
+
+  //
+  // registerHandler
+  //
+  // Registers a handler to be called with each element of the
+  // given kind that has the given feature, or with every element
+  // of the kind if the feature is 0. Handlers are called in the
+  // order they were registered.
+  //
+  void registerHandler(OSMElement::Kinds kind, uint64_t feature, function<void(const OSMElement&)> handler);
+
+  //
+  // registerDoneHandler
+  //
+  // Registers a handler to be called once the whole map has been
+  // read successfully, e.g. to index what was collected.
+  //
+  void registerDoneHandler(function<void()> handler);
+
+  //
+  // readMapFile
+  //
+  // Reads the given map file (see osmReadMapFile), dispatching
+  // each element as it is read, then calls the done handlers.
+  // Returns true if successful, false if not, with an error
+  // message already output.
+  //
+  bool readMapFile(string filename);
+};
@@ -19,10 +19,8 @@
 #include "busstops.h"
 #include "nodes.h"
 #include "osm.h"
-#include "tinyxml2.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
@@ -18,10 +18,8 @@
 #include "nodes.h"
 #include "busstop.h"
 #include "dist.h"
-#include "tinyxml2.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
@@ -19,22 +19,40 @@
 #include "busstop.h"
 #include "busstops.h"
 #include "osm.h"
-#include "tinyxml2.h"
+#include "osmextractor.h"
 #include "curl_util.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
 // main
 //
-int main()
+// usage: a.out [-nodes map|sorted|eytzinger]
+//
+// The option picks how the nodes are kept (see nodes.h); the
+// default is map.
+//
+int main(int argc, char* argv[])
 {
-  XMLDocument xmldoc;
-  Nodes nodes;
+  Nodes::Backends backend = Nodes::MAP;
+
+  if (argc == 3 && string(argv[1]) == "-nodes" && string(argv[2]) == "map")
+    backend = Nodes::MAP;
+  else if (argc == 3 && string(argv[1]) == "-nodes" && string(argv[2]) == "sorted")
+    backend = Nodes::SORTED;
+  else if (argc == 3 && string(argv[1]) == "-nodes" && string(argv[2]) == "eytzinger")
+    backend = Nodes::EYTZINGER;
+  else if (argc != 1)
+  {
+    cout << "usage: " << argv[0] << " [-nodes map|sorted|eytzinger]" << endl;
+    return 0;
+  }
+
+  Nodes nodes(backend);
   Buildings buildings;
   BusStops busstops;
+  OSMExtractor extractor;
   
   CURL* curl = curl_easy_init();
   if (curl == nullptr) {
@@ -53,34 +71,33 @@ int main()
   getline(cin, filename);
 
   //
-  // 1. load XML-based map file 
+  // 1. read the XML-based map file in one pass, storing the nodes,
+  // which are the various known positions on the map, and the
+  // university buildings as they are read:
   //
-  if (!osmLoadMapFile(filename, xmldoc))
+  nodes.registerWith(extractor);
+  buildings.registerWith(extractor);
+
+  if (!extractor.readMapFile(filename))
   {
     // failed, error message already output
     return 0;
   }
-  
-  //
-  // 2. read the nodes, which are the various known positions on the map:
-  //
-  nodes.readMapNodes(xmldoc);
 
   //
-  // 3. read the university buildings and bus stops:
+  // 2. read the bus stops:
   //
-  buildings.readMapBuildings(xmldoc);
   busstops.readMapBusStops("bus-stops.txt");
 
   //
-  // 4. stats
+  // 3. stats
   //
   cout << "# of nodes: " << nodes.getNumMapNodes() << endl;
   cout << "# of buildings: " << buildings.getNumMapBuildings() << endl;
   cout << "# of bus stops: " << busstops.getNumMapBusStops() << endl;
 
   //
-  // 5. now let the user for search for 1 or more buildings:
+  // 4. now let the user for search for 1 or more buildings:
   //
   while (true)
   {
@@ -9,10 +9,6 @@
 // 
 // References:
 // 
-// TinyXML: 
-//   files: https://github.com/leethomason/tinyxml2
-//   docs:  http://leethomason.github.io/tinyxml2/
-// 
 // OpenStreetMap: https://www.openstreetmap.org
 // OpenStreetMap docs:  
 //   https://wiki.openstreetmap.org/wiki/Main_Page
@@ -25,33 +21,91 @@
 #pragma once
 
 #include <map>
+#include <vector>
 
 #include "node.h"
-#include "tinyxml2.h"
+#include "osm.h"
+#include "osmextractor.h"
 
 using namespace std;
-using namespace tinyxml2;
 
 
 //
-// Keeps track of all the nodes in the map.
+// Keeps track of all the nodes in the map, in one of several ways
+// (backends), which find searches differently:
+//
+//   MAP        a map from id to Node, i.e. a red-black tree with a
+//              heap-allocated tree node per Node
+//   SORTED     a flat array of packed records, sorted by id once
+//              all the nodes have been read, searched by a binary
+//              search without branches
+//   EYTZINGER  the same records, laid out as a binary tree in
+//              breadth-first (Eytzinger) order: the root at 1, the
+//              children of k at 2k and 2k+1. The first levels of
+//              every search share a few cache lines, and the next
+//              levels can be prefetched.
+//
+// Node ids arrive almost sorted, so sorting the records is cheap.
 //
 class Nodes
 {
+public:
+  enum Backends { MAP, SORTED, EYTZINGER };
+
 private:
+  //
+  // a node of the flat backends, 32 bytes:
+  //
+  struct NodeRecord
+  {
+    long long ID;
+    double Lat;
+    double Lon;
+    bool   IsEntrance;
+  };
+
+  Backends Backend;
   map<long long, Node> MapNodes;
+  vector<NodeRecord> FlatNodes;  // EYTZINGER: from 1, [0] is unused
+  bool Finished = false;  // are FlatNodes in order yet?
+
+  uint64_t Entrance = 0;  // feature of nodes that are entrances
+
+  bool findSorted(long long id, const NodeRecord*& found) const;
+  bool findEytzinger(long long id, const NodeRecord*& found) const;
 
 public:
   //
-  // readMapNodes
+  // constructor
+  //
+  Nodes(Backends backend = MAP);
+
+  //
+  // registerWith
+  //
+  // Registers with the extractor for all the nodes of the map,
+  // which are then read by readMapNode as the map is read, and
+  // put in order by finishMapNodes once it has been read.
+  //
+  void registerWith(OSMExtractor& extractor);
+
+  //
+  // readMapNode
+  //
+  // Given a node of the map as it is read, stores it. Each node
+  // is a point on the map, with a unique id along with (lat, lon)
+  // position. Some nodes are entrances to buildings, which we
+  // capture as well.
+  //
+  void readMapNode(const OSMElement& e);
+
+  //
+  // finishMapNodes
   //
-  // Given an XML document, reads through the document and 
-  // stores all the nodes into the given vector. Each node
-  // is a point on the map, with a unique id along with 
-  // (lat, lon) position. Some nodes are entrances to buildings,
-  // which we capture as well.
+  // Puts the nodes in order for find, once all of them have been
+  // read. If a node id is read more than once, the first is kept.
   //
-  void readMapNodes(XMLDocument& xmldoc);
+  void finishMapNodes();
 
   //
   // find